@@ -77,6 +77,8 @@
 #define OMX_TizoniaIndexParamChromecastSession       OMX_IndexVendorStartUnused + 21 /**< reference: OMX_TIZONIA_PARAM_CHROMECASTSESSIONTYPE */
 #define OMX_TizoniaIndexParamAudioPlexSession        OMX_IndexVendorStartUnused + 22 /**< reference: OMX_TIZONIA_AUDIO_PARAM_PLEXSESSIONTYPE */
 #define OMX_TizoniaIndexParamAudioPlexPlaylist       OMX_IndexVendorStartUnused + 23 /**< reference: OMX_TIZONIA_AUDIO_PARAM_PLEXPLAYLISTTYPE */
+#define OMX_TizoniaIndexParamVideoVp8Decoder         OMX_IndexVendorStartUnused + 24 /**< reference: OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE */
+#define OMX_TizoniaIndexParamFastTunnel              OMX_IndexVendorStartUnused + 25 /**< reference: OMX_TIZONIA_PARAM_FASTTUNNELTYPE */
 
 /**
  * OMX_AUDIO_CODINGTYPE extensions
@@ -547,4 +549,42 @@ typedef struct OMX_TIZONIA_AUDIO_PARAM_PLEXPLAYLISTTYPE {
     OMX_U8 cPlaylistName[OMX_MAX_STRINGNAME_SIZE];
 } OMX_TIZONIA_AUDIO_PARAM_PLEXPLAYLISTTYPE;
 
+/**
+ * VP8 decoder component
+ *
+ * Decoder threading options. They take effect the next time the component
+ * transitions from OMX_StateLoaded to OMX_StateIdle. Note that VP8 decoding
+ * threads work on a frame's token partitions concurrently, so only streams
+ * encoded with more than one token partition (see
+ * OMX_VIDEO_PARAM_VP8TYPE::nDCTPartitions) decode faster with nThreads > 1.
+ */
+typedef struct OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_U32 nThreads;        /**< Number of decoding threads; 0 means one per
+                                  online CPU (Default: 0) */
+    OMX_BOOL bFrameParallel; /**< Decode consecutive frames in parallel, when
+                                  the codec library supports it (Default:
+                                  OMX_FALSE) */
+} OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE;
+
+/**
+ * Fast tunnel (libtizonia components only)
+ *
+ * Retrieved by a libtizonia output (or input) port from its tunnelled peer
+ * during OMX_ComponentTunnelRequest. When both components live in the same
+ * process, pChannel is the peer kernel's in-process buffer channel for port
+ * nPortIndex; buffer headers written there skip the peer's
+ * OMX_EmptyThisBuffer/OMX_FillThisBuffer entry points. Components that do not
+ * support this index return OMX_ErrorUnsupportedIndex and the tunnel uses
+ * the standard OpenMAX IL calls.
+ */
+typedef struct OMX_TIZONIA_PARAM_FASTTUNNELTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_PTR pChannel;        /**< Opaque; only meaningful in-process */
+} OMX_TIZONIA_PARAM_FASTTUNNELTYPE;
+
 #endif /* OMX_TizoniaExt_h */
@@ -31,6 +31,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <assert.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -68,6 +69,8 @@
 #define TIZ_IL_CORE_RM_NAME "OMX.Aratelia.ilcore"
 #define TIZ_DEFAULT_COMP_ENTRY_POINT_NAME "OMX_ComponentInit"
 #define TIZ_CORE_QUEUE_MAX_ITEMS 30
+#define TIZ_CORE_REGISTRY_CACHE_KEY "component-registry-cache"
+#define TIZ_CORE_REGISTRY_CACHE_MAGIC "tizonia-component-registry-cache 1"
 
 typedef struct role_list_item role_list_item_t;
 typedef role_list_item_t * role_list_t;
@@ -434,6 +437,43 @@ get_component_roles (OMX_COMPONENTTYPE * ap_hdl, role_list_t * app_role_list)
   return rc;
 }
 
+static tiz_core_registry_item_t *
+find_last_in_registry (void)
+{
+  tiz_core_t * p_core = get_core ();
+  tiz_core_registry_item_t * p_registry_last = NULL;
+
+  assert (p_core);
+
+  p_registry_last = p_core->p_registry;
+  while (p_registry_last && p_registry_last->p_next)
+    {
+      p_registry_last = p_registry_last->p_next;
+    }
+
+  return p_registry_last;
+}
+
+static void
+append_to_registry (tiz_core_registry_item_t * ap_reg_item)
+{
+  tiz_core_t * p_core = get_core ();
+  tiz_core_registry_item_t * p_registry_last = NULL;
+
+  assert (p_core);
+  assert (ap_reg_item);
+
+  if (NULL == (p_registry_last = find_last_in_registry ()))
+    {
+      /* First entry in the registry */
+      p_core->p_registry = ap_reg_item;
+    }
+  else
+    {
+      p_registry_last->p_next = ap_reg_item;
+    }
+}
+
 static OMX_ERRORTYPE
 add_to_comp_registry (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
                       OMX_PTR ap_entry_point, OMX_PTR ap_dl_hdl,
@@ -529,31 +569,7 @@ add_to_comp_registry (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
     {
 
       /* Add to registry */
-      if (NULL == (p_core->p_registry))
-        {
-          /* First entry in the registry */
-          TIZ_LOG (TIZ_PRIORITY_TRACE, "Component added (first component) [%s]",
-                   comp_name);
-
-          p_core->p_registry = p_registry_new;
-        }
-      else
-        {
-          /* Find the last entry in the registry */
-          p_registry_last = p_core->p_registry;
-          while (true)
-            {
-              if (p_registry_last->p_next)
-                {
-                  p_registry_last = p_registry_last->p_next;
-                }
-              else
-                {
-                  break;
-                }
-            }
-          p_registry_last->p_next = p_registry_new;
-        }
+      append_to_registry (p_registry_new);
 
       /* Finish filling the registry entry... */
       p_registry_new->p_comp_name
@@ -767,6 +783,377 @@ free_paths (char ** pp_paths, unsigned long npaths)
   tiz_mem_free (pp_paths);
 }
 
+/*
+ * Component registry cache
+ *
+ * Building the registry requires loading every plugin and instantiating each
+ * component to retrieve its name and roles. The result is saved to the file
+ * configured with 'component-registry-cache', together with the device, inode
+ * and modification time of every component path and every library examined.
+ * On the next OMX_Init, if all of those still match, the registry is built
+ * from the file and no library is loaded until OMX_GetHandle needs it.
+ *
+ * Format (tab-separated):
+ *   tizonia-component-registry-cache 1
+ *   D <path> <dev> <ino> <mtime-sec> <mtime-nsec>           (one per path)
+ *   L <path> <file> <dev> <ino> <size> <mtime-sec> <mtime-nsec>
+ *   C <component name>                         (component in previous L)
+ *   R <role>                                   (role of previous C)
+ */
+
+static void
+stat_to_cache_fields (const struct stat * ap_st, unsigned long long * ap_fields)
+{
+  assert (ap_fields);
+  if (ap_st)
+    {
+      ap_fields[0] = (unsigned long long) ap_st->st_dev;
+      ap_fields[1] = (unsigned long long) ap_st->st_ino;
+      ap_fields[2] = (unsigned long long) ap_st->st_size;
+      ap_fields[3] = (unsigned long long) ap_st->st_mtim.tv_sec;
+      ap_fields[4] = (unsigned long long) ap_st->st_mtim.tv_nsec;
+    }
+  else
+    {
+      /* The path did not exist */
+      memset (ap_fields, 0, 5 * sizeof (unsigned long long));
+    }
+}
+
+static bool
+cache_fields_match (const char * ap_path, char ** app_tokens,
+                    const bool a_with_size)
+{
+  struct stat st;
+  unsigned long long fields[5];
+  int i = 0;
+  int j = 0;
+
+  assert (ap_path);
+  assert (app_tokens);
+
+  stat_to_cache_fields (0 == stat (ap_path, &st) ? &st : NULL, fields);
+
+  for (i = 0; i < 5; ++i)
+    {
+      /* Directory sizes are not recorded */
+      if (2 == i && !a_with_size)
+        {
+          continue;
+        }
+      if (strtoull (app_tokens[j++], NULL, 10) != fields[i])
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+static int
+tokenize_cache_line (char * ap_line, char ** app_tokens, const int a_max)
+{
+  char * p_save = NULL;
+  char * p_tok = NULL;
+  int ntokens = 0;
+
+  assert (ap_line);
+  assert (app_tokens);
+
+  ap_line[strcspn (ap_line, "\n")] = '\0';
+  for (p_tok = strtok_r (ap_line, "\t", &p_save); p_tok && ntokens < a_max;
+       p_tok = strtok_r (NULL, "\t", &p_save))
+    {
+      app_tokens[ntokens++] = p_tok;
+    }
+  return ntokens;
+}
+
+static char *
+make_full_path (char * ap_buf, const char * ap_dir, const char * ap_file)
+{
+  assert (ap_buf);
+  assert (ap_dir);
+  assert (ap_file);
+  (void) snprintf (ap_buf, PATH_MAX, "%s%s%s", ap_dir,
+                   (ap_dir[0] && ap_dir[strlen (ap_dir) - 1] == '/') ? "" : "/",
+                   ap_file);
+  return ap_buf;
+}
+
+static OMX_ERRORTYPE
+load_registry_cache (const char * ap_cache_path, char ** app_paths,
+                     const unsigned long a_npaths)
+{
+  FILE * p_file = NULL;
+  char * p_line = NULL;
+  size_t line_len = 0;
+  char * tokens[8];
+  char full_path[PATH_MAX];
+  const char * p_lib_dir = NULL;
+  unsigned long ndirs = 0;
+  tiz_core_registry_item_t * p_item = NULL;
+  role_list_item_t * p_last_role = NULL;
+  char lib_dir[PATH_MAX];
+  char lib_name[NAME_MAX + 1];
+  bool valid = true;
+  int ntokens = 0;
+
+  assert (ap_cache_path);
+  assert (app_paths);
+
+  if (NULL == (p_file = fopen (ap_cache_path, "r")))
+    {
+      TIZ_LOG (TIZ_PRIORITY_DEBUG, "No registry cache found at [%s]",
+               ap_cache_path);
+      return OMX_ErrorUndefined;
+    }
+
+  valid = (getline (&p_line, &line_len, p_file) > 0
+           && 0 == strncmp (p_line, TIZ_CORE_REGISTRY_CACHE_MAGIC,
+                            strlen (TIZ_CORE_REGISTRY_CACHE_MAGIC)));
+
+  while (valid && getline (&p_line, &line_len, p_file) > 0)
+    {
+      ntokens = tokenize_cache_line (p_line, tokens, 8);
+      if (ntokens < 2 || strlen (tokens[0]) != 1)
+        {
+          valid = false;
+          break;
+        }
+
+      switch (tokens[0][0])
+        {
+          case 'D':
+            {
+              /* The component paths must be the same, in the same order,
+                 and none of them may have changed */
+              valid = (6 == ntokens && !p_lib_dir && ndirs < a_npaths
+                       && 0 == strcmp (tokens[1], app_paths[ndirs])
+                       && cache_fields_match (tokens[1], &tokens[2], false));
+              ndirs++;
+            }
+            break;
+          case 'L':
+            {
+              valid = (8 == ntokens && ndirs == a_npaths
+                       && strlen (tokens[1]) < PATH_MAX
+                       && strlen (tokens[2]) <= NAME_MAX
+                       && cache_fields_match (
+                            make_full_path (full_path, tokens[1], tokens[2]),
+                            &tokens[3], true));
+              if (valid)
+                {
+                  strcpy (lib_dir, tokens[1]);
+                  strcpy (lib_name, tokens[2]);
+                  p_lib_dir = lib_dir;
+                  p_item = NULL;
+                }
+            }
+            break;
+          case 'C':
+            {
+              valid = (2 == ntokens && p_lib_dir
+                       && !find_comp_in_registry (tokens[1]));
+              if (valid)
+                {
+                  if (!(p_item = tiz_mem_calloc (
+                          1, sizeof (tiz_core_registry_item_t))))
+                    {
+                      valid = false;
+                      break;
+                    }
+                  p_item->p_comp_name
+                    = strndup (tokens[1], OMX_MAX_STRINGNAME_SIZE);
+                  p_item->p_dl_name = strndup (lib_name, NAME_MAX);
+                  p_item->p_dl_path = strndup (lib_dir, PATH_MAX);
+                  append_to_registry (p_item);
+                  p_last_role = NULL;
+                  valid = (p_item->p_comp_name && p_item->p_dl_name
+                           && p_item->p_dl_path);
+                }
+            }
+            break;
+          case 'R':
+            {
+              role_list_item_t * p_role = NULL;
+              valid = (2 == ntokens && p_item
+                       && strlen (tokens[1]) < OMX_MAX_STRINGNAME_SIZE
+                       && (p_role = tiz_mem_calloc (1, sizeof (role_list_item_t))));
+              if (valid)
+                {
+                  strcpy ((char *) p_role->role, tokens[1]);
+                  if (p_last_role)
+                    {
+                      p_last_role->p_next = p_role;
+                    }
+                  else
+                    {
+                      p_item->p_roles = p_role;
+                    }
+                  p_last_role = p_role;
+                }
+            }
+            break;
+          default:
+            {
+              valid = false;
+            }
+            break;
+        };
+    }
+
+  /* Every component needs at least one role */
+  for (p_item = get_core ()->p_registry; valid && p_item;
+       p_item = p_item->p_next)
+    {
+      valid = (NULL != p_item->p_roles);
+    }
+
+  free (p_line);
+  (void) fclose (p_file);
+
+  if (!valid || ndirs != a_npaths)
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE,
+               "Registry cache [%s] is stale; rescanning component paths",
+               ap_cache_path);
+      delete_registry ();
+      return OMX_ErrorUndefined;
+    }
+
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+make_cache_dir (const char * ap_cache_path)
+{
+  char dir[PATH_MAX];
+  char * p = NULL;
+
+  assert (ap_cache_path);
+
+  if (strlen (ap_cache_path) >= PATH_MAX)
+    {
+      return OMX_ErrorUndefined;
+    }
+
+  strcpy (dir, ap_cache_path);
+  for (p = dir + 1; *p; ++p)
+    {
+      if ('/' == *p)
+        {
+          *p = '\0';
+          if (0 != mkdir (dir, 0755) && EEXIST != errno)
+            {
+              return OMX_ErrorUndefined;
+            }
+          *p = '/';
+        }
+    }
+  return OMX_ErrorNone;
+}
+
+/* Creates the temporary cache file and writes the component paths'
+   information. The paths are stat'ed before they are scanned, so that any
+   change made while scanning invalidates the cache. */
+static FILE *
+open_registry_cache (const char * ap_cache_path, char * ap_tmp_path,
+                     char ** app_paths, const unsigned long a_npaths)
+{
+  FILE * p_file = NULL;
+  unsigned long long fields[5];
+  struct stat st;
+  unsigned long i = 0;
+
+  assert (ap_tmp_path);
+  assert (app_paths);
+
+  if (!ap_cache_path || '\0' == ap_cache_path[0]
+      || OMX_ErrorNone != make_cache_dir (ap_cache_path))
+    {
+      return NULL;
+    }
+
+  (void) snprintf (ap_tmp_path, PATH_MAX, "%s.%d", ap_cache_path,
+                   (int) getpid ());
+  if (NULL == (p_file = fopen (ap_tmp_path, "w")))
+    {
+      TIZ_LOG (TIZ_PRIORITY_DEBUG, "Unable to create [%s] - [%s]",
+               ap_tmp_path, strerror (errno));
+      return NULL;
+    }
+
+  fprintf (p_file, "%s\n", TIZ_CORE_REGISTRY_CACHE_MAGIC);
+  for (i = 0; i < a_npaths; ++i)
+    {
+      stat_to_cache_fields (0 == stat (app_paths[i], &st) ? &st : NULL,
+                            fields);
+      fprintf (p_file, "D\t%s\t%llu\t%llu\t%llu\t%llu\n", app_paths[i],
+               fields[0], fields[1], fields[3], fields[4]);
+    }
+
+  return p_file;
+}
+
+static bool
+write_lib_to_registry_cache (FILE * ap_file, const char * ap_dl_path,
+                             const char * ap_dl_name,
+                             const tiz_core_registry_item_t * ap_item)
+{
+  char full_path[PATH_MAX];
+  unsigned long long fields[5];
+  struct stat st;
+  const role_list_item_t * p_role = NULL;
+
+  assert (ap_file);
+  assert (ap_dl_path);
+  assert (ap_dl_name);
+
+  if (0 != stat (make_full_path (full_path, ap_dl_path, ap_dl_name), &st))
+    {
+      return false;
+    }
+
+  stat_to_cache_fields (&st, fields);
+  fprintf (ap_file, "L\t%s\t%s\t%llu\t%llu\t%llu\t%llu\t%llu\n", ap_dl_path,
+           ap_dl_name, fields[0], fields[1], fields[2], fields[3], fields[4]);
+
+  for (; ap_item; ap_item = ap_item->p_next)
+    {
+      fprintf (ap_file, "C\t%s\n", ap_item->p_comp_name);
+      for (p_role = ap_item->p_roles; p_role; p_role = p_role->p_next)
+        {
+          fprintf (ap_file, "R\t%s\n", (const char *) p_role->role);
+        }
+    }
+
+  return !ferror (ap_file);
+}
+
+static void
+close_registry_cache (FILE * ap_file, const char * ap_tmp_path,
+                      const char * ap_cache_path, const bool a_commit)
+{
+  bool ok = a_commit;
+
+  assert (ap_file);
+  assert (ap_tmp_path);
+  assert (ap_cache_path);
+
+  ok = (0 == fclose (ap_file)) && ok;
+  if (!ok || 0 != rename (ap_tmp_path, ap_cache_path))
+    {
+      TIZ_LOG (TIZ_PRIORITY_DEBUG, "Unable to save registry cache [%s]",
+               ap_cache_path);
+      (void) unlink (ap_tmp_path);
+    }
+  else
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "Registry cache saved to [%s]",
+               ap_cache_path);
+    }
+}
+
 static OMX_ERRORTYPE
 scan_component_folders (void)
 {
@@ -775,6 +1162,11 @@ scan_component_folders (void)
   char ** pp_paths;
   unsigned long npaths = 0;
   struct dirent * p_dir_entry = NULL;
+  const char * p_cache_path = NULL;
+  char tmp_cache_path[PATH_MAX];
+  FILE * p_cache = NULL;
+  bool cache_ok = true;
+  tiz_core_registry_item_t * p_last = NULL;
 
   if (NULL == (pp_paths = find_component_paths (&npaths)))
     {
@@ -782,6 +1174,21 @@ scan_component_folders (void)
       return OMX_ErrorInsufficientResources;
     }
 
+  p_cache_path
+    = tiz_rcfile_get_value ("il-core", TIZ_CORE_REGISTRY_CACHE_KEY);
+  if (p_cache_path && '\0' != p_cache_path[0]
+      && OMX_ErrorNone
+           == load_registry_cache (p_cache_path, pp_paths, npaths))
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "Component registry loaded from [%s]",
+               p_cache_path);
+      free_paths (pp_paths, npaths);
+      return OMX_ErrorNone;
+    }
+
+  p_cache
+    = open_registry_cache (p_cache_path, tmp_cache_path, pp_paths, npaths);
+
   for (i = 0; i < (int) npaths; i++)
     {
       TIZ_LOG (TIZ_PRIORITY_TRACE, "Looking for component plugins : %s",
@@ -805,13 +1212,30 @@ scan_component_folders (void)
                   TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s]", p_dir_entry->d_name);
                   if (p_dir_entry->d_type == DT_REG)
                     {
+                      p_last = find_last_in_registry ();
                       if (OMX_ErrorInsufficientResources
                           == cache_comp_info (pp_paths[i], p_dir_entry->d_name))
                         {
                           (void) closedir (p_dir);
+                          if (p_cache)
+                            {
+                              close_registry_cache (p_cache, tmp_cache_path,
+                                                    p_cache_path, false);
+                            }
                           free_paths (pp_paths, npaths);
                           return OMX_ErrorInsufficientResources;
                         }
+                      if (p_cache)
+                        {
+                          /* Record the library, and the component found in
+                             it, if any */
+                          cache_ok = write_lib_to_registry_cache (
+                                       p_cache, pp_paths[i],
+                                       p_dir_entry->d_name,
+                                       p_last ? p_last->p_next
+                                              : get_core ()->p_registry)
+                                     && cache_ok;
+                        }
                     }
                 }
             } /* while */
@@ -820,6 +1244,11 @@ scan_component_folders (void)
         }
     }
 
+  if (p_cache)
+    {
+      close_registry_cache (p_cache, tmp_cache_path, p_cache_path, cache_ok);
+    }
+
   free_paths (pp_paths, npaths);
 
   return OMX_ErrorNone;
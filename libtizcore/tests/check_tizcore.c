@@ -33,13 +33,16 @@
 
 
 #include <stdlib.h>
+#include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <check.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <signal.h>
 #include <limits.h>
+#include <time.h>
 
 #include <tizplatform.h>
 
@@ -284,6 +287,101 @@ START_TEST (test_ilcore_role_of_comp_enum)
   fail_if (error != OMX_ErrorNone);
 }
 
+END_TEST
+
+static OMX_U32
+count_components (void)
+{
+  OMX_S8 comp_name[OMX_MAX_STRINGNAME_SIZE];
+  OMX_U32 index = 0;
+
+  while (OMX_ErrorNone
+         == OMX_ComponentNameEnum ((OMX_STRING) comp_name,
+                                   OMX_MAX_STRINGNAME_SIZE, index))
+    {
+      index++;
+    }
+  return index;
+}
+
+static double
+timed_init_and_deinit (OMX_U32 * ap_ncomps)
+{
+  struct timespec start, end;
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+
+  assert (ap_ncomps);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  error = OMX_Init ();
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  fail_if (error != OMX_ErrorNone);
+
+  *ap_ncomps = count_components ();
+
+  error = OMX_Deinit ();
+  fail_if (error != OMX_ErrorNone);
+
+  return (end.tv_sec - start.tv_sec) * 1000.0
+         + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+START_TEST (test_ilcore_registry_cache_startup)
+{
+  const char * p_cache = NULL;
+  OMX_U32 cold_ncomps = 0;
+  OMX_U32 warm_ncomps = 0;
+  double cold_ms = 0;
+  double warm_ms = 0;
+  int i = 0;
+  const int nruns = 10;
+  struct stat cold_st;
+  struct stat warm_st;
+  FILE * p_file = NULL;
+
+  p_cache = tiz_rcfile_get_value ("il-core", "component-registry-cache");
+  fail_if (NULL == p_cache);
+
+  /* Cold start: no cache, all the plugins are loaded */
+  (void) unlink (p_cache);
+  cold_ms = timed_init_and_deinit (&cold_ncomps);
+  fail_if (0 == cold_ncomps);
+  fail_if (0 != access (p_cache, R_OK));
+
+  /* The cache is only ever replaced (renamed into place) when the component
+     paths are rescanned, so its inode and mtime identify the scan */
+  fail_if (0 != stat (p_cache, &cold_st));
+
+  /* Warm starts: the registry is restored from the cache */
+  for (i = 0; i < nruns; ++i)
+    {
+      warm_ms += timed_init_and_deinit (&warm_ncomps);
+      fail_if (warm_ncomps != cold_ncomps);
+    }
+  warm_ms /= nruns;
+
+  /* No warm start has rescanned the paths */
+  fail_if (0 != stat (p_cache, &warm_st));
+  fail_if (warm_st.st_ino != cold_st.st_ino);
+  fail_if (warm_st.st_mtime != cold_st.st_mtime);
+  fail_if (warm_st.st_size != cold_st.st_size);
+
+  /* Sanity check: an unusable cache is detected and rebuilt */
+  p_file = fopen (p_cache, "w");
+  fail_if (NULL == p_file);
+  fputs ("not a registry cache\n", p_file);
+  fclose (p_file);
+  (void) timed_init_and_deinit (&warm_ncomps);
+  fail_if (warm_ncomps != cold_ncomps);
+  fail_if (0 != stat (p_cache, &warm_st));
+  fail_if (warm_st.st_ino == cold_st.st_ino);
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "OMX_Init: cold [%.3f ms] warm (avg of %d) [%.3f ms] - "
+           "[%u] components",
+           cold_ms, nruns, warm_ms, (unsigned int) cold_ncomps);
+}
+
 END_TEST Suite * tizcore_suite (void)
 {
   TCase *tc_ilcore;
@@ -302,6 +400,7 @@ END_TEST Suite * tizcore_suite (void)
   /*   tcase_add_test (tc_ilcore, test_ilcore_setup_tunnel_tear_down_tunnel); */
   tcase_add_test (tc_ilcore, test_ilcore_comp_of_role_enum);
   tcase_add_test (tc_ilcore, test_ilcore_role_of_comp_enum);
+  tcase_add_test (tc_ilcore, test_ilcore_registry_cache_startup);
 
   /* TODO: Negative case for OMX_ErrorPortsNotConnected error */
 
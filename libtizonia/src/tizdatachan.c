@@ -0,0 +1,214 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizdatachan.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia OpenMAX IL - Data channel from a foreign thread
+ *
+ * The ring's 'wakeup pending' flag doubles as the ownership token of the
+ * embedded pluggable event: while it is raised, the event is (or is about to
+ * be) in the component's queue and must not be touched by anyone but the
+ * event handler.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+
+#include <tizplatform.h>
+
+#include "tizscheduler.h"
+#include "tizobject.h"
+#include "tizutils.h"
+#include "tizdatachan.h"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.tizonia.datachan"
+#endif
+
+struct tiz_data_chan
+{
+  tiz_spscring_t * p_ring;
+  OMX_HANDLETYPE p_hdl;
+  tiz_data_chan_ready_f pf_ready;
+  tiz_event_pluggable_t event;
+  /* Set when the channel is destroyed with a notification in flight; only
+     accessed from the component's thread */
+  bool zombie;
+};
+
+static void
+free_chan (tiz_data_chan_t * ap_chan)
+{
+  assert (ap_chan);
+  tiz_spscring_destroy (ap_chan->p_ring);
+  ap_chan->p_ring = NULL;
+  tiz_mem_free (ap_chan);
+}
+
+static void
+data_chan_event_handler (OMX_PTR ap_servant, tiz_event_pluggable_t * ap_event)
+{
+  tiz_data_chan_t * p_chan = NULL;
+
+  assert (ap_event);
+  p_chan = ap_event->p_data;
+  assert (p_chan);
+
+  if (p_chan->zombie)
+    {
+      free_chan (p_chan);
+      return;
+    }
+
+  /* Lower the flag before reading anything, so that data written from now on
+     results in a new notification */
+  (void) tiz_spscring_ack_wakeup (p_chan->p_ring);
+  if (p_chan->pf_ready)
+    {
+      p_chan->pf_ready (ap_servant, p_chan);
+    }
+}
+
+OMX_ERRORTYPE
+tiz_data_chan_init (tiz_data_chan_ptr_t * app_chan, OMX_PTR ap_servant,
+                    size_t a_capacity, tiz_data_chan_ready_f apf_ready)
+{
+  tiz_data_chan_t * p_chan = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (app_chan);
+  assert (ap_servant);
+  assert (apf_ready);
+
+  if (!(p_chan = tiz_mem_calloc (1, sizeof (tiz_data_chan_t))))
+    {
+      TIZ_ERROR (handleOf (ap_servant),
+                 "[OMX_ErrorInsufficientResources] : "
+                 "Could not allocate the data channel.");
+      return OMX_ErrorInsufficientResources;
+    }
+
+  if (OMX_ErrorNone
+      != (rc = tiz_spscring_init (&(p_chan->p_ring), a_capacity)))
+    {
+      tiz_mem_free (p_chan);
+      return rc;
+    }
+
+  p_chan->p_hdl = handleOf (ap_servant);
+  p_chan->pf_ready = apf_ready;
+  p_chan->event.p_servant = ap_servant;
+  p_chan->event.p_data = p_chan;
+  p_chan->event.pf_hdlr = data_chan_event_handler;
+  p_chan->zombie = false;
+  *app_chan = p_chan;
+
+  TIZ_TRACE (p_chan->p_hdl, "data channel [%p] capacity [%zu]", p_chan,
+             tiz_spscring_capacity (p_chan->p_ring));
+
+  return OMX_ErrorNone;
+}
+
+void
+tiz_data_chan_destroy (tiz_data_chan_t * ap_chan)
+{
+  if (ap_chan)
+    {
+      if (tiz_spscring_ack_wakeup (ap_chan->p_ring))
+        {
+          /* The event is still queued up; let its handler do the cleanup */
+          ap_chan->zombie = true;
+        }
+      else
+        {
+          free_chan (ap_chan);
+        }
+    }
+}
+
+size_t
+tiz_data_chan_write (tiz_data_chan_t * ap_chan, const void * ap_data,
+                     size_t a_nbytes)
+{
+  bool wakeup = false;
+  size_t nbytes = 0;
+
+  assert (ap_chan);
+
+  nbytes = tiz_spscring_write (ap_chan->p_ring, ap_data, a_nbytes, &wakeup);
+  if (wakeup
+      && OMX_ErrorNone
+           != tiz_comp_event_pluggable (ap_chan->p_hdl, &(ap_chan->event)))
+    {
+      /* The notification could not be queued. Lower the flag again so that
+         the next write retries. */
+      (void) tiz_spscring_ack_wakeup (ap_chan->p_ring);
+    }
+  return nbytes;
+}
+
+size_t
+tiz_data_chan_space (const tiz_data_chan_t * ap_chan)
+{
+  assert (ap_chan);
+  return tiz_spscring_space (ap_chan->p_ring);
+}
+
+size_t
+tiz_data_chan_available (const tiz_data_chan_t * ap_chan)
+{
+  assert (ap_chan);
+  return tiz_spscring_available (ap_chan->p_ring);
+}
+
+size_t
+tiz_data_chan_peek (const tiz_data_chan_t * ap_chan, const void ** app_data)
+{
+  assert (ap_chan);
+  return tiz_spscring_peek (ap_chan->p_ring, app_data);
+}
+
+void
+tiz_data_chan_advance (tiz_data_chan_t * ap_chan, size_t a_nbytes)
+{
+  assert (ap_chan);
+  tiz_spscring_advance (ap_chan->p_ring, a_nbytes);
+}
+
+size_t
+tiz_data_chan_read (tiz_data_chan_t * ap_chan, void * ap_data,
+                    size_t a_nbytes)
+{
+  assert (ap_chan);
+  return tiz_spscring_read (ap_chan->p_ring, ap_data, a_nbytes);
+}
+
+void
+tiz_data_chan_clear (tiz_data_chan_t * ap_chan)
+{
+  assert (ap_chan);
+  tiz_spscring_clear (ap_chan->p_ring);
+}
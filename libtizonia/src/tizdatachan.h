@@ -0,0 +1,178 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizdatachan.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia OpenMAX IL - Data channel from a foreign thread
+ *
+ *
+ */
+
+#ifndef TIZDATACHAN_H
+#define TIZDATACHAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tizdatachan 'tizdatachan' : Data channel from a foreign thread
+ *
+ * A data channel moves bytes produced on a thread that the component does not
+ * own (e.g. a callback from a third-party library) into one of the
+ * component's servants, typically the processor. The bytes are copied once,
+ * into a pre-allocated single-producer/single-consumer ring; no memory is
+ * allocated on the data path. The producer never blocks: when the ring is
+ * full, the write fails and the producer is expected to retry later.
+ *
+ * The servant is notified through a single 'pluggable' event that is embedded
+ * in the channel. Only the first write after the servant has been notified
+ * enqueues it, so a fast producer can not flood the component's event queue.
+ *
+ * @ingroup libtizonia
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+
+/**
+ * Data channel opaque structure.
+ * @ingroup tizdatachan
+ */
+typedef struct tiz_data_chan tiz_data_chan_t;
+typedef /*@null@ */ tiz_data_chan_t * tiz_data_chan_ptr_t;
+
+/**
+ * Callback invoked in the component's thread when there is data to be read
+ * from the channel. The servant should read as much as it can; data left in
+ * the channel does not produce another notification until more is written.
+ *
+ * @ingroup tizdatachan
+ */
+typedef void (*tiz_data_chan_ready_f) (OMX_PTR ap_servant,
+                                       tiz_data_chan_t * ap_chan);
+
+/**
+ * Create a data channel.
+ *
+ * @ingroup tizdatachan
+ *
+ * @param app_chan A channel opaque handle to be initialised.
+ * @param ap_servant The servant that consumes the data. Its component's
+ * event queue is used for notifications.
+ * @param a_capacity The number of bytes the channel can hold. It is rounded
+ * up to the next power of two.
+ * @param apf_ready The notification callback.
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_data_chan_init (/*@out@*/ tiz_data_chan_ptr_t * app_chan,
+                    OMX_PTR ap_servant, size_t a_capacity,
+                    tiz_data_chan_ready_f apf_ready);
+
+/**
+ * Destroy a data channel. The producer must not be using the channel
+ * anymore. If a notification is still in the component's event queue, the
+ * memory is released when that notification is delivered. If ap_chan is
+ * NULL, no operation is performed.
+ *
+ * @ingroup tizdatachan
+ */
+void
+tiz_data_chan_destroy (/*@null@ */ tiz_data_chan_t * ap_chan);
+
+/**
+ * Producer side. Copy a_nbytes into the channel, notifying the servant if
+ * needed. This function may be called from any thread, but only from one
+ * thread at a time.
+ *
+ * @ingroup tizdatachan
+ *
+ * @return The number of bytes written: either a_nbytes or, if there is not
+ * enough space in the channel, 0.
+ */
+size_t
+tiz_data_chan_write (tiz_data_chan_t * ap_chan, const void * ap_data,
+                     size_t a_nbytes);
+
+/**
+ * Producer side. Retrieve the number of bytes that can currently be written.
+ *
+ * @ingroup tizdatachan
+ */
+size_t
+tiz_data_chan_space (const tiz_data_chan_t * ap_chan);
+
+/**
+ * Consumer side. Retrieve the number of bytes that can currently be read.
+ *
+ * @ingroup tizdatachan
+ */
+size_t
+tiz_data_chan_available (const tiz_data_chan_t * ap_chan);
+
+/**
+ * Consumer side. Obtain a pointer to the largest contiguous chunk of readable
+ * bytes, without consuming them.
+ *
+ * @ingroup tizdatachan
+ *
+ * @return The number of bytes in the chunk.
+ */
+size_t
+tiz_data_chan_peek (const tiz_data_chan_t * ap_chan, const void ** app_data);
+
+/**
+ * Consumer side. Consume a_nbytes, previously obtained with
+ * tiz_data_chan_peek.
+ *
+ * @ingroup tizdatachan
+ */
+void
+tiz_data_chan_advance (tiz_data_chan_t * ap_chan, size_t a_nbytes);
+
+/**
+ * Consumer side. Copy up to a_nbytes out of the channel.
+ *
+ * @ingroup tizdatachan
+ *
+ * @return The number of bytes read.
+ */
+size_t
+tiz_data_chan_read (tiz_data_chan_t * ap_chan, void * ap_data,
+                    size_t a_nbytes);
+
+/**
+ * Consumer side. Discard all the bytes currently stored in the channel.
+ *
+ * @ingroup tizdatachan
+ */
+void
+tiz_data_chan_clear (tiz_data_chan_t * ap_chan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZDATACHAN_H */
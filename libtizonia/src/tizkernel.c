@@ -127,9 +127,11 @@ init_ports_and_lists (void * ap_obj)
   tiz_check_omx_ret_oom (
     tiz_vector_init (&(p_obj->p_ports_), sizeof (OMX_PTR)));
   tiz_check_omx_ret_oom (
-    tiz_vector_init (&(p_obj->p_ingress_), sizeof (tiz_vector_t *)));
+    tiz_vector_init (&(p_obj->p_ingress_), sizeof (tiz_krn_hdr_lst_t *)));
   tiz_check_omx_ret_oom (
-    tiz_vector_init (&(p_obj->p_egress_), sizeof (tiz_vector_t *)));
+    tiz_vector_init (&(p_obj->p_egress_), sizeof (tiz_krn_hdr_lst_t *)));
+  TIZ_PD_ZERO (&(p_obj->ready_));
+  tiz_mem_set (p_obj->p_fast_chans_, 0, sizeof (p_obj->p_fast_chans_));
 
   p_obj->p_cport_ = NULL;
   p_obj->p_proc_ = NULL;
@@ -156,7 +158,15 @@ deinit_ports_and_lists (void * ap_obj)
 {
   tiz_krn_t * p_obj = ap_obj;
   OMX_PTR * pp_port = NULL;
-  tiz_vector_t * p_list = NULL;
+  tiz_krn_hdr_lst_t * p_list = NULL;
+  OMX_U32 pid = 0;
+
+  /* delete the fast tunnel channels */
+  for (pid = 0; pid < TIZ_COMP_MAX_PORTS; ++pid)
+    {
+      tiz_data_chan_destroy (p_obj->p_fast_chans_[pid]);
+      p_obj->p_fast_chans_[pid] = NULL;
+    }
 
   /* delete the config port */
   factory_delete (p_obj->p_cport_);
@@ -176,9 +186,8 @@ deinit_ports_and_lists (void * ap_obj)
   /* delete the ingress and egress lists */
   while (tiz_vector_length (p_obj->p_ingress_) > 0)
     {
-      p_list = *(tiz_vector_t **) tiz_vector_back (p_obj->p_ingress_);
-      tiz_vector_clear (p_list);
-      tiz_vector_destroy (p_list);
+      p_list = *(tiz_krn_hdr_lst_t **) tiz_vector_back (p_obj->p_ingress_);
+      hdr_lst_destroy (p_list);
       tiz_vector_pop_back (p_obj->p_ingress_);
     }
   tiz_vector_destroy (p_obj->p_ingress_);
@@ -186,13 +195,13 @@ deinit_ports_and_lists (void * ap_obj)
 
   while (tiz_vector_length (p_obj->p_egress_) > 0)
     {
-      p_list = *(tiz_vector_t **) tiz_vector_back (p_obj->p_egress_);
-      tiz_vector_clear (p_list);
-      tiz_vector_destroy (p_list);
+      p_list = *(tiz_krn_hdr_lst_t **) tiz_vector_back (p_obj->p_egress_);
+      hdr_lst_destroy (p_list);
       tiz_vector_pop_back (p_obj->p_egress_);
     }
   tiz_vector_destroy (p_obj->p_egress_);
   p_obj->p_egress_ = NULL;
+  TIZ_PD_ZERO (&(p_obj->ready_));
 }
 
 static OMX_ERRORTYPE
@@ -283,6 +292,41 @@ krn_GetComponentVersion (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                                       ap_comp_uuid);
 }
 
+static OMX_ERRORTYPE
+get_fast_tunnel (tiz_krn_t * ap_krn, OMX_HANDLETYPE ap_hdl,
+                 OMX_TIZONIA_PARAM_FASTTUNNELTYPE * ap_fast_tunnel)
+{
+  const OMX_U32 pid = ap_fast_tunnel->nPortIndex;
+  OMX_PTR p_port = NULL;
+
+  assert (ap_krn);
+  assert (ap_fast_tunnel);
+
+  if (OMX_ErrorNone != check_pid (ap_krn, pid) || pid >= TIZ_COMP_MAX_PORTS)
+    {
+      return OMX_ErrorBadPortIndex;
+    }
+
+  if (!ap_krn->p_fast_chans_[pid])
+    {
+      /* A header can only be in the channel once, so there is room for all
+         the headers of the tunnel even if the peer later asks for a few more
+         buffers. In the unlikely event that the channel fills up, the peer
+         falls back to the standard buffer calls. */
+      p_port = get_port (ap_krn, pid);
+      tiz_check_omx (tiz_data_chan_init (
+        &(ap_krn->p_fast_chans_[pid]), ap_krn,
+        MAX (TIZ_KRN_FAST_TUNNEL_MIN_HEADERS, 4 * tiz_port_buffer_count (p_port))
+          * sizeof (OMX_BUFFERHEADERTYPE *),
+        fast_tunnel_ready));
+    }
+
+  TIZ_TRACE (ap_hdl, "pid [%d] fast tunnel channel [%p]", pid,
+             ap_krn->p_fast_chans_[pid]);
+  ap_fast_tunnel->pChannel = ap_krn->p_fast_chans_[pid];
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 krn_GetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                   OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
@@ -313,6 +357,12 @@ krn_GetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
       return rc;
     }
 
+  if (OMX_TizoniaIndexParamFastTunnel == a_index)
+    {
+      return get_fast_tunnel ((tiz_krn_t *) p_obj, ap_hdl,
+                              (OMX_TIZONIA_PARAM_FASTTUNNELTYPE *) ap_struct);
+    }
+
   {
     OMX_PORT_PARAM_TYPE * p_struct = (OMX_PORT_PARAM_TYPE *) ap_struct;
 
@@ -1181,6 +1231,10 @@ krn_stop_and_return (void * ap_obj)
       tiz_srv_remove_from_queue (ap_obj, &process_efb_from_servant_queue,
                                  OMX_ALL, p_obj);
 
+      /* Likewise, any headers that a tunnelled peer has handed over through
+         this port's fast tunnel channel */
+      process_efb_from_fast_tunnel (p_obj, i);
+
       /* This will move any processor callbacks currently queued in the
          kernel's servant queue into the corresponding port egress list. This
          guarantees that all buffers held by the component are correctly
@@ -1255,15 +1309,16 @@ krn_stop_and_return (void * ap_obj)
 }
 
 static OMX_ERRORTYPE
-krn_receive_pluggable_event (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
-                             tiz_event_pluggable_t * ap_event)
+krn_receive_pluggable_event (void * ap_obj, tiz_event_pluggable_t * ap_event)
 {
   tiz_krn_msg_t * p_msg = NULL;
   tiz_krn_msg_plg_event_t * p_plgevt = NULL;
 
   assert (ap_obj);
+  assert (ap_event);
 
-  TIZ_KRN_INIT_MSG_OOM (ap_obj, ap_hdl, p_msg, ETIZKrnMsgPluggableEvent);
+  TIZ_KRN_INIT_MSG_OOM (ap_obj, handleOf (ap_obj), p_msg,
+                        ETIZKrnMsgPluggableEvent);
 
   assert (p_msg);
   p_plgevt = &(p_msg->pe);
@@ -1292,22 +1347,30 @@ krn_register_port (void * ap_obj, OMX_PTR ap_port, const bool ais_config)
     }
 
   {
-    /* Create the corresponding ingress and egress lists */
-    tiz_vector_t * p_in_list = NULL;
-    tiz_vector_t * p_out_list = NULL;
+    /* Create the corresponding ingress and egress lists. These are rings
+       sized after the port's nBufferCountActual; they only grow if the buffer
+       count is later increased beyond that. */
+    tiz_krn_hdr_lst_t * p_in_list = NULL;
+    tiz_krn_hdr_lst_t * p_out_list = NULL;
     OMX_U32 pid = 0;
+    OMX_U32 capacity = 0;
+
+    pid = tiz_vector_length (p_obj->p_ports_);
+    tiz_port_set_index (ap_port, pid);
+    capacity = tiz_port_buffer_count (ap_port);
+
     tiz_check_omx (
-      tiz_vector_init (&(p_in_list), sizeof (OMX_BUFFERHEADERTYPE *)));
+      hdr_lst_init (&p_in_list, pid, capacity, &(p_obj->ready_)));
     assert (p_in_list);
-    tiz_check_omx (
-      tiz_vector_init (&(p_out_list), sizeof (OMX_BUFFERHEADERTYPE *)));
+    if (OMX_ErrorNone != hdr_lst_init (&p_out_list, pid, capacity, NULL))
+      {
+        hdr_lst_destroy (p_in_list);
+        return OMX_ErrorInsufficientResources;
+      }
     assert (p_out_list);
     tiz_check_omx (tiz_vector_push_back (p_obj->p_ingress_, &p_in_list));
     tiz_check_omx (tiz_vector_push_back (p_obj->p_egress_, &p_out_list));
 
-    pid = tiz_vector_length (p_obj->p_ports_);
-    tiz_port_set_index (ap_port, pid);
-
     switch (tiz_port_domain (ap_port))
       {
         case OMX_PortDomainAudio:
@@ -1589,7 +1652,8 @@ krn_select (const void * ap_obj, const OMX_U32 a_nports, tiz_pd_set_t * ap_set)
   const tiz_krn_t * p_obj = ap_obj;
   OMX_S32 i = 0;
   OMX_S32 nports = 0;
-  tiz_vector_t * p_list = NULL;
+  OMX_S32 nbits = 0;
+  _tiz_pd_mask mask = 0;
 
   assert (ap_obj);
   assert (ap_set);
@@ -1601,14 +1665,19 @@ krn_select (const void * ap_obj, const OMX_U32 a_nports, tiz_pd_set_t * ap_set)
       nports = a_nports;
     }
 
-  /* Loop through the first nports in the ingress list */
-  for (i = 0; i < nports; ++i)
+  if (nports > _TIZ_PD_SETSIZE)
     {
-      p_list = get_ingress_lst (p_obj, i);
-      if (tiz_vector_length (p_list) > 0)
-        {
-          TIZ_PD_SET (i, ap_set);
-        }
+      nports = _TIZ_PD_SETSIZE;
+    }
+
+  /* The ingress lists keep the ready-ports set up to date; copy the bits of
+     the first nports, one word at a time */
+  for (i = 0; nports > 0; ++i, nports -= nbits)
+    {
+      nbits = nports < _TIZ_NPDBITS ? nports : _TIZ_NPDBITS;
+      mask = (nbits < _TIZ_NPDBITS) ? ((_tiz_pd_mask) 1 << nbits) - 1
+                                    : ~(_tiz_pd_mask) 0;
+      TIZ_PDS_BITS (ap_set)[i] |= (TIZ_PDS_BITS (&(p_obj->ready_))[i] & mask);
     }
 
   return OMX_ErrorNone;
@@ -1639,7 +1708,7 @@ krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid, const OMX_U32 a_pos,
   tiz_krn_t * p_obj = (tiz_krn_t *) ap_obj;
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   OMX_BUFFERHEADERTYPE * p_hdr = NULL;
-  tiz_vector_t * p_list = NULL;
+  tiz_krn_hdr_lst_t * p_list = NULL;
   OMX_PTR p_port = NULL;
 
   assert (ap_obj);
@@ -1665,10 +1734,10 @@ krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid, const OMX_U32 a_pos,
   p_list = get_ingress_lst (p_obj, a_pid);
 
   /* Ingress list's size shall not be larger than the port's buffer count */
-  assert (tiz_vector_length (p_list) <= tiz_port_buffer_count (p_port));
+  assert (hdr_lst_length (p_list) <= tiz_port_buffer_count (p_port));
 
   /* Only try to retrieve the buffer if that position exists in the list */
-  if (a_pos < tiz_vector_length (p_list))
+  if (a_pos < hdr_lst_length (p_list))
     {
       OMX_DIRTYPE pdir = OMX_DirMax;
 
@@ -1679,7 +1748,7 @@ krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid, const OMX_U32 a_pos,
       TIZ_TRACE (handleOf (p_obj),
                  "port's [%d] HEADER [%p] BUFFER [%p] ingress "
                  "list length [%d]...",
-                 a_pid, p_hdr, p_hdr->pBuffer, tiz_vector_length (p_list));
+                 a_pid, p_hdr, p_hdr->pBuffer, hdr_lst_length (p_list));
 
       pdir = tiz_port_dir (p_port);
 
@@ -1700,7 +1769,7 @@ krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid, const OMX_U32 a_pos,
         }
 
       /* ... and delete it from the list */
-      tiz_vector_erase (p_list, a_pos, 1);
+      hdr_lst_erase (p_list, a_pos);
 
       /* Now increment by one the claimed buffers count on this port */
       (void) TIZ_PORT_INC_CLAIMED_COUNT (p_port);
@@ -1759,11 +1828,11 @@ tiz_krn_super_claim_buffer (const void * a_class, const void * ap_obj,
 }
 
 static OMX_ERRORTYPE
-krn_release_buffer (const void * ap_obj, const OMX_U32 a_pid,
-                    OMX_BUFFERHEADERTYPE * ap_hdr)
+release_buffer (const void * ap_obj, const OMX_U32 a_pid,
+                OMX_BUFFERHEADERTYPE * ap_hdr, const OMX_BOOL a_defer_flush)
 {
   tiz_krn_t * p_obj = (tiz_krn_t *) ap_obj;
-  tiz_vector_t * p_list = NULL;
+  tiz_krn_hdr_lst_t * p_list = NULL;
   OMX_PTR p_port = NULL;
 
   assert (ap_obj);
@@ -1786,11 +1855,19 @@ krn_release_buffer (const void * ap_obj, const OMX_U32 a_pid,
   p_list = get_egress_lst (p_obj, a_pid);
 
   TIZ_TRACE (handleOf (p_obj), "HEADER [%p] pid [%d] egress length [%d]...",
-             ap_hdr, a_pid, tiz_vector_length (p_list));
+             ap_hdr, a_pid, hdr_lst_length (p_list));
 
-  assert (tiz_vector_length (p_list) < tiz_port_buffer_count (p_port));
+  assert (hdr_lst_length (p_list) < tiz_port_buffer_count (p_port));
+
+  return enqueue_callback_msg (p_obj, ap_hdr, a_pid, tiz_port_dir (p_port),
+                               a_defer_flush);
+}
 
-  return enqueue_callback_msg (p_obj, ap_hdr, a_pid, tiz_port_dir (p_port));
+static OMX_ERRORTYPE
+krn_release_buffer (const void * ap_obj, const OMX_U32 a_pid,
+                    OMX_BUFFERHEADERTYPE * ap_hdr)
+{
+  return release_buffer (ap_obj, a_pid, ap_hdr, OMX_FALSE);
 }
 
 OMX_ERRORTYPE
@@ -1812,6 +1889,48 @@ tiz_krn_super_release_buffer (const void * a_class, const void * ap_obj,
   return superclass->release_buffer (ap_obj, a_pid, ap_hdr);
 }
 
+static OMX_ERRORTYPE
+krn_release_buffers (const void * ap_obj, const OMX_U32 a_pid,
+                     OMX_BUFFERHEADERTYPE ** app_hdrs, const OMX_U32 a_nhdrs)
+{
+  OMX_U32 i = 0;
+
+  assert (ap_obj);
+  assert (app_hdrs || 0 == a_nhdrs);
+
+  /* One callback message per header is still needed (the servant queue is
+     searched by header when ports are flushed or disabled), but only the last
+     one triggers the flushing of the egress lists. This is what allows
+     flush_egress to hand the whole batch over to a tunnelled peer at once. */
+  for (i = 0; i < a_nhdrs; ++i)
+    {
+      tiz_check_omx (release_buffer (ap_obj, a_pid, app_hdrs[i],
+                                     (i + 1 < a_nhdrs) ? OMX_TRUE : OMX_FALSE));
+    }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+tiz_krn_release_buffers (const void * ap_obj, const OMX_U32 a_pid,
+                         OMX_BUFFERHEADERTYPE ** app_hdrs,
+                         const OMX_U32 a_nhdrs)
+{
+  const tiz_krn_class_t * class = classOf (ap_obj);
+  assert (class->release_buffers);
+  return class->release_buffers (ap_obj, a_pid, app_hdrs, a_nhdrs);
+}
+
+OMX_ERRORTYPE
+tiz_krn_super_release_buffers (const void * a_class, const void * ap_obj,
+                               const OMX_U32 a_pid,
+                               OMX_BUFFERHEADERTYPE ** app_hdrs,
+                               const OMX_U32 a_nhdrs)
+{
+  const tiz_krn_class_t * superclass = super (a_class);
+  assert (ap_obj && superclass->release_buffers);
+  return superclass->release_buffers (ap_obj, a_pid, app_hdrs, a_nhdrs);
+}
+
 static OMX_ERRORTYPE
 krn_claim_eglimage (const void * ap_obj, const OMX_U32 a_pid,
                     const OMX_BUFFERHEADERTYPE * ap_hdr, OMX_PTR * app_eglimage)
@@ -2251,6 +2370,10 @@ krn_class_ctor (void * ap_obj, va_list * app)
         {
           *(voidf *) &p_obj->release_buffer = method;
         }
+      else if (selector == (voidf) tiz_krn_release_buffers)
+        {
+          *(voidf *) &p_obj->release_buffers = method;
+        }
       else if (selector == (voidf) tiz_krn_claim_eglimage)
         {
           *(voidf *) &p_obj->claim_eglimage = method;
@@ -2383,6 +2506,8 @@ tiz_krn_init (void * ap_tos, void * ap_hdl)
      tiz_krn_claim_buffer, krn_claim_buffer,
      /* TIZ_CLASS_COMMENT: release_buffer */
      tiz_krn_release_buffer, krn_release_buffer,
+     /* TIZ_CLASS_COMMENT: release_buffers */
+     tiz_krn_release_buffers, krn_release_buffers,
      /* TIZ_CLASS_COMMENT: claim_eglimage */
      tiz_krn_claim_eglimage, krn_claim_eglimage,
      /* TIZ_CLASS_COMMENT: deregister_all_ports */
@@ -106,6 +106,25 @@ tiz_krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid,
 OMX_ERRORTYPE
 tiz_krn_release_buffer (const void * ap_obj, const OMX_U32 a_pid,
                         OMX_BUFFERHEADERTYPE * ap_hdr);
+/**
+ * Release a batch of OpenMAX IL headers on the same port. The headers are
+ * returned in order, and the port's egress list is flushed only once, after
+ * the last header of the batch has been processed. When the port is
+ * tunnelled with another Tizonia component, the whole batch is delivered to
+ * the peer in a single message (see tiz_comp_empty_buffers).
+ *
+ * @ingroup tizkernel
+ *
+ * @param ap_obj The 'kernel' servant object.
+ * @param a_pid The index of the port the headers belong to.
+ * @param app_hdrs The list of headers.
+ * @param a_nhdrs The number of headers in the list.
+ * @return OMX_ErrorNone on success, other OMX_ERRORTYPE on error.
+ */
+OMX_ERRORTYPE
+tiz_krn_release_buffers (const void * ap_obj, const OMX_U32 a_pid,
+                         OMX_BUFFERHEADERTYPE ** app_hdrs,
+                         const OMX_U32 a_nhdrs);
 /**
  * Retrieve the EGL image associated to a particular OpenMAX IL header.
  *
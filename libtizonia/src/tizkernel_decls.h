@@ -38,6 +38,7 @@ extern "C" {
 #include <tizrmproxy_c.h>
 
 #include "tizservant_decls.h"
+#include "tizdatachan.h"
 
 typedef struct tiz_krn_msg_sendcommand tiz_krn_msg_sendcommand_t;
 
@@ -76,6 +77,7 @@ struct tiz_krn_msg_callback
   OMX_BUFFERHEADERTYPE * p_hdr;
   OMX_U32 pid;
   OMX_DIRTYPE dir;
+  OMX_BOOL defer_flush; /* more callbacks of the same batch follow */
 };
 
 typedef struct tiz_krn_msg_plg_event tiz_krn_msg_plg_event_t;
@@ -105,14 +107,38 @@ struct tiz_krn_msg_str
   OMX_STRING str;
 };
 
+/* Per-port list of buffer headers. This is a ring buffer whose capacity is a
+   power of two, initially sized from the port's nBufferCountActual, so that
+   adding headers at the back and claiming them from the front are O(1)
+   operations. Ingress lists also keep the kernel's ready-ports set up to
+   date. */
+typedef struct tiz_krn_hdr_lst tiz_krn_hdr_lst_t;
+struct tiz_krn_hdr_lst
+{
+  OMX_BUFFERHEADERTYPE ** pp_hdrs;
+  OMX_U32 mask;
+  OMX_U32 head;
+  OMX_U32 len;
+  OMX_U32 pid;
+  tiz_pd_set_t * p_ready; /* NULL for egress lists */
+};
+
+/* Minimum number of headers that a fast tunnel channel can hold (see
+   OMX_TizoniaIndexParamFastTunnel) */
+#define TIZ_KRN_FAST_TUNNEL_MIN_HEADERS 64
+
 typedef struct tiz_krn tiz_krn_t;
 struct tiz_krn
 {
   /* Object */
   const tiz_srv_t _;
   tiz_vector_t * p_ports_;
-  tiz_vector_t * p_ingress_;
-  tiz_vector_t * p_egress_;
+  tiz_vector_t * p_ingress_; /* vector of tiz_krn_hdr_lst_t *, one per port */
+  tiz_vector_t * p_egress_;  /* vector of tiz_krn_hdr_lst_t *, one per port */
+  tiz_pd_set_t ready_; /* ports with a non-empty ingress list */
+  /* per-port channels that tunnelled libtizonia peers use to hand over their
+     buffer headers; created on demand */
+  tiz_data_chan_t * p_fast_chans_[TIZ_COMP_MAX_PORTS];
   OMX_PTR p_cport_;
   OMX_PTR p_proc_;
   bool eos_;
@@ -148,6 +174,11 @@ tiz_krn_super_release_buffer (const void * a_class, const void * ap_obj,
                               const OMX_U32 a_pid,
                               OMX_BUFFERHEADERTYPE * ap_hdr);
 OMX_ERRORTYPE
+tiz_krn_super_release_buffers (const void * a_class, const void * ap_obj,
+                               const OMX_U32 a_pid,
+                               OMX_BUFFERHEADERTYPE ** app_hdrs,
+                               const OMX_U32 a_nhdrs);
+OMX_ERRORTYPE
 tiz_krn_super_claim_eglimage (const void * a_class, const void * ap_obj,
                               const OMX_U32 a_pid,
                               const OMX_BUFFERHEADERTYPE * p_hdr,
@@ -181,6 +212,9 @@ struct tiz_krn_class
    OMX_BUFFERHEADERTYPE ** p_hdr);
   OMX_ERRORTYPE (*release_buffer)
   (const void * ap_obj, const OMX_U32 a_pid, OMX_BUFFERHEADERTYPE * p_hdr);
+  OMX_ERRORTYPE (*release_buffers)
+  (const void * ap_obj, const OMX_U32 a_pid, OMX_BUFFERHEADERTYPE ** app_hdrs,
+   const OMX_U32 a_nhdrs);
   OMX_ERRORTYPE (*claim_eglimage)
   (const void * ap_obj, const OMX_U32 a_pid, const OMX_BUFFERHEADERTYPE * p_hdr,
    OMX_PTR * app_eglimage);
@@ -538,7 +538,7 @@ static OMX_ERRORTYPE dispatch_cb (void *ap_obj, OMX_PTR ap_msg)
   tiz_krn_msg_t *p_msg = ap_msg;
   tiz_krn_msg_callback_t *p_msg_cb = NULL;
   tiz_fsm_state_id_t now = (tiz_fsm_state_id_t)OMX_StateMax;
-  tiz_vector_t *p_egress_lst = NULL;
+  tiz_krn_hdr_lst_t *p_egress_lst = NULL;
   OMX_PTR p_port = NULL;
   OMX_S32 claimed_count = 0;
   OMX_HANDLETYPE p_hdl = NULL;
@@ -579,13 +579,13 @@ static OMX_ERRORTYPE dispatch_cb (void *ap_obj, OMX_PTR ap_msg)
       if (NULL == p_hdr && OMX_DirMax == p_msg_cb->dir)
         {
           TIZ_TRACE (p_hdl, "Enqueueing another dummy callback...");
-          rc = enqueue_callback_msg (p_obj, NULL, 0, OMX_DirMax);
+          rc = enqueue_callback_msg (p_obj, NULL, 0, OMX_DirMax, OMX_FALSE);
         }
       else
         {
           /* ...add the header to the egress list... */
           if (OMX_ErrorNone
-              != (rc = tiz_vector_push_back (p_egress_lst, &p_hdr)))
+              != (rc = hdr_lst_push_back (p_egress_lst, p_hdr)))
             {
               TIZ_ERROR (p_hdl,
                          "[%s] : Could not add HEADER [%p] "
@@ -611,7 +611,7 @@ static OMX_ERRORTYPE dispatch_cb (void *ap_obj, OMX_PTR ap_msg)
     }
 
   /* ...add the header to the egress list... */
-  if (OMX_ErrorNone != (rc = tiz_vector_push_back (p_egress_lst, &p_hdr)))
+  if (OMX_ErrorNone != (rc = hdr_lst_push_back (p_egress_lst, p_hdr)))
     {
       TIZ_ERROR (p_hdl,
                  "[%s] : Could not add header [%p] to "
@@ -634,8 +634,15 @@ static OMX_ERRORTYPE dispatch_cb (void *ap_obj, OMX_PTR ap_msg)
           TIZ_TRACE (p_hdl, "nbufs [%d]", nbufs);
         }
 
-      /* Here, we always flush the egress lists for ALL ports */
-      if (OMX_ErrorNone != (rc = flush_egress (p_obj, OMX_ALL, OMX_FALSE)))
+      /* If more headers of the same batch are about to follow, the egress
+       * lists are flushed when the last one arrives. Otherwise, we always
+       * flush the egress lists for ALL ports */
+      if (OMX_TRUE == p_msg_cb->defer_flush && claimed_count > 0)
+        {
+          TIZ_TRACE (p_hdl, "HEADER [%p] - deferring egress flush", p_hdr);
+        }
+      else if (OMX_ErrorNone
+               != (rc = flush_egress (p_obj, OMX_ALL, OMX_FALSE)))
         {
           TIZ_ERROR (p_hdl, "[%s] : Could not flush the egress lists",
                      tiz_err_to_str (rc));
@@ -865,6 +872,136 @@ static OMX_ERRORTYPE dispatch_ftb (void *ap_obj, OMX_PTR ap_msg)
   return dispatch_efb (ap_obj, ap_msg, ETIZKrnMsgFillThisBuffer);
 }
 
+static bool fast_tunnel_accepts (const tiz_krn_t *ap_obj, const void *ap_port,
+                                 const OMX_U32 a_pid)
+{
+  bool accepted = false;
+
+  /* These are the checks that fsm_EmptyThisBuffer/fsm_FillThisBuffer and the
+     current state object would have applied had the header come through
+     OMX_EmptyThisBuffer or OMX_FillThisBuffer. Keep them in sync. */
+  if (TIZ_PORT_IS_DISABLED (ap_port) && !TIZ_PORT_IS_BEING_ENABLED (ap_port)
+      && !TIZ_PORT_IS_BEING_DISABLED (ap_port))
+    {
+      return false;
+    }
+
+  switch (tiz_fsm_get_substate (tiz_get_fsm (handleOf (ap_obj))))
+    {
+      case EStateExecuting:
+      case EStatePause:
+      case ESubStateExecutingToIdle: /* tizexecuting's */
+      case ESubStatePauseToIdle:     /* tizpause's */
+        {
+          accepted = true;
+        }
+        break;
+      case EStateIdle:
+        {
+          /* idle_FillThisBuffer takes any header; idle_EmptyThisBuffer only
+             those for disabled ports */
+          accepted = (OMX_DirOutput == tiz_port_dir (ap_port)
+                      || !TIZ_PORT_IS_ENABLED (ap_port));
+        }
+        break;
+      case EStateLoaded:
+        {
+          accepted = !TIZ_PORT_IS_ENABLED (ap_port);
+        }
+        break;
+      default:
+        {
+          /* EStateWaitForResources, ESubStateLoadedToIdle,
+             ESubStateIdleToLoaded and ESubStateIdleToExecuting override
+             ETB/FTB with OMX_ErrorNotImplemented */
+          accepted = false;
+        }
+        break;
+    };
+
+  return accepted;
+}
+
+/* Keeps a header that this kernel can't accept from a fast tunnel yet in the
+   port's ingress list, without notifying the processor. The peer has already
+   let go of it, so it can't be refused the way an
+   OMX_EmptyThisBuffer/OMX_FillThisBuffer call would be. From there it is
+   handled like a queued ETB/FTB message moved by stop-and-return: the
+   processor finds it the next time it claims a buffer from this port, and
+   flushes and port disables return it to the peer. */
+static void fast_tunnel_hold (tiz_krn_t *ap_obj, OMX_PTR ap_port,
+                              const OMX_U32 a_pid, OMX_BUFFERHEADERTYPE *ap_hdr)
+{
+  assert (ap_obj);
+  assert (ap_port);
+  assert (ap_hdr);
+
+  TIZ_DEBUG (handleOf (ap_obj),
+             "[fast tunnel] : holding HEADER [%p] on port [%d] "
+             "in current state",
+             ap_hdr, a_pid);
+  if (0 >= add_to_buflst (ap_obj, ap_obj->p_ingress_, ap_hdr, ap_port))
+    {
+      TIZ_ERROR (handleOf (ap_obj),
+                 "[OMX_ErrorInsufficientResources] : "
+                 "on port [%d] while adding buffer to ingress list",
+                 a_pid);
+      tiz_srv_issue_err_event (ap_obj, OMX_ErrorInsufficientResources);
+    }
+}
+
+/* Called when a tunnelled libtizonia peer has written headers into one of
+   the fast tunnel channels. The headers go straight into the port's ingress
+   list, without a kernel message being allocated for each of them. */
+static void fast_tunnel_ready (OMX_PTR ap_obj, tiz_data_chan_t *ap_chan)
+{
+  tiz_krn_t *p_obj = ap_obj;
+  OMX_BUFFERHEADERTYPE *p_hdrs[TIZ_COMP_MAX_BUFFER_BATCH];
+  tiz_krn_msg_t msg;
+  OMX_PTR p_port = NULL;
+  OMX_U32 pid = 0;
+  size_t nhdrs = 0;
+  size_t i = 0;
+
+  assert (p_obj);
+  assert (ap_chan);
+
+  for (pid = 0; pid < TIZ_COMP_MAX_PORTS && p_obj->p_fast_chans_[pid] != ap_chan;
+       ++pid)
+    {
+    }
+  assert (pid < TIZ_COMP_MAX_PORTS);
+
+  p_port = get_port (p_obj, pid);
+  msg.p_hdl = handleOf (p_obj);
+  msg.class = (OMX_DirInput == tiz_port_dir (p_port)
+                   ? ETIZKrnMsgEmptyThisBuffer
+                   : ETIZKrnMsgFillThisBuffer);
+
+  /* Writes are made of whole header pointers, and so are reads */
+  while ((nhdrs = tiz_data_chan_read (ap_chan, p_hdrs, sizeof(p_hdrs))
+                  / sizeof(OMX_BUFFERHEADERTYPE *)) > 0)
+    {
+      for (i = 0; i < nhdrs; ++i)
+        {
+          OMX_ERRORTYPE rc = OMX_ErrorNone;
+          if (!fast_tunnel_accepts (p_obj, p_port, pid))
+            {
+              fast_tunnel_hold (p_obj, p_port, pid, p_hdrs[i]);
+              continue;
+            }
+          msg.ef.p_hdr = p_hdrs[i];
+          if (OMX_ErrorNone != (rc = dispatch_efb (p_obj, &msg, msg.class))
+              && OMX_ErrorNoMore != rc)
+            {
+              TIZ_ERROR (msg.p_hdl, "[%s] : while dispatching HEADER [%p]",
+                         tiz_err_to_str (rc), p_hdrs[i]);
+              tiz_srv_issue_err_event (p_obj, rc);
+            }
+        }
+    }
+}
+
 static OMX_ERRORTYPE dispatch_pe (void *ap_obj, OMX_PTR ap_msg)
 {
   tiz_krn_msg_t *p_msg = ap_msg;
@@ -990,7 +1127,7 @@ static OMX_ERRORTYPE dispatch_pause_to_exe (tiz_krn_t *ap_krn,
   *ap_done = true;
   /* Enqueue a dummy callback msg to be processed ...   */
   /* ...in case there are headers present in the egress lists... */
-  return enqueue_callback_msg (ap_krn, NULL, 0, OMX_DirMax);
+  return enqueue_callback_msg (ap_krn, NULL, 0, OMX_DirMax, OMX_FALSE);
 }
 
 static OMX_ERRORTYPE dispatch_exe_to_exe (tiz_krn_t *ap_krn,
@@ -94,26 +94,191 @@ static void preemption_complete (OMX_U32 rid, OMX_PTR ap_data)
   deliver_pluggable_event (rid, ap_data);
 }
 
-static inline tiz_vector_t *get_ingress_lst (const tiz_krn_t *ap_obj,
-                                             OMX_U32 a_pid)
+static inline void hdr_lst_update_ready (tiz_krn_hdr_lst_t *ap_lst)
+{
+  assert (ap_lst);
+  if (ap_lst->p_ready && ap_lst->pid < _TIZ_PD_SETSIZE)
+    {
+      if (ap_lst->len > 0)
+        {
+          TIZ_PD_SET (ap_lst->pid, ap_lst->p_ready);
+        }
+      else
+        {
+          TIZ_PD_CLR (ap_lst->pid, ap_lst->p_ready);
+        }
+    }
+}
+
+static OMX_ERRORTYPE hdr_lst_reserve (tiz_krn_hdr_lst_t *ap_lst,
+                                      OMX_U32 a_capacity)
+{
+  OMX_BUFFERHEADERTYPE **pp_hdrs = NULL;
+  OMX_U32 capacity = 1;
+  OMX_U32 i = 0;
+
+  assert (ap_lst);
+
+  if (ap_lst->pp_hdrs && a_capacity <= ap_lst->mask + 1)
+    {
+      return OMX_ErrorNone;
+    }
+
+  while (capacity < a_capacity)
+    {
+      capacity <<= 1;
+    }
+
+  tiz_check_null_ret_oom (
+      (pp_hdrs = tiz_mem_calloc (capacity, sizeof(OMX_BUFFERHEADERTYPE *))));
+
+  /* Copy the existing headers, in order, to the front of the new ring */
+  for (i = 0; i < ap_lst->len; ++i)
+    {
+      pp_hdrs[i] = ap_lst->pp_hdrs[(ap_lst->head + i) & ap_lst->mask];
+    }
+
+  tiz_mem_free (ap_lst->pp_hdrs);
+  ap_lst->pp_hdrs = pp_hdrs;
+  ap_lst->mask = capacity - 1;
+  ap_lst->head = 0;
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE hdr_lst_init (tiz_krn_hdr_lst_t **app_lst,
+                                   const OMX_U32 a_pid,
+                                   const OMX_U32 a_capacity,
+                                   tiz_pd_set_t *ap_ready)
+{
+  tiz_krn_hdr_lst_t *p_lst = NULL;
+
+  assert (app_lst);
+
+  tiz_check_null_ret_oom (
+      (p_lst = tiz_mem_calloc (1, sizeof(tiz_krn_hdr_lst_t))));
+  p_lst->pid = a_pid;
+  p_lst->p_ready = ap_ready;
+
+  if (OMX_ErrorNone != hdr_lst_reserve (p_lst, a_capacity > 0 ? a_capacity : 1))
+    {
+      tiz_mem_free (p_lst);
+      return OMX_ErrorInsufficientResources;
+    }
+
+  hdr_lst_update_ready (p_lst);
+  *app_lst = p_lst;
+  return OMX_ErrorNone;
+}
+
+static void hdr_lst_destroy (tiz_krn_hdr_lst_t *ap_lst)
+{
+  if (ap_lst)
+    {
+      tiz_mem_free (ap_lst->pp_hdrs);
+      tiz_mem_free (ap_lst);
+    }
+}
+
+static inline OMX_S32 hdr_lst_length (const tiz_krn_hdr_lst_t *ap_lst)
+{
+  assert (ap_lst);
+  return ap_lst->len;
+}
+
+static inline OMX_BUFFERHEADERTYPE *hdr_lst_at (const tiz_krn_hdr_lst_t *ap_lst,
+                                                const OMX_U32 a_index)
+{
+  assert (ap_lst);
+  assert (a_index < ap_lst->len);
+  return ap_lst->pp_hdrs[(ap_lst->head + a_index) & ap_lst->mask];
+}
+
+static inline OMX_ERRORTYPE hdr_lst_push_back (tiz_krn_hdr_lst_t *ap_lst,
+                                               OMX_BUFFERHEADERTYPE *ap_hdr)
+{
+  assert (ap_lst);
+  if (ap_lst->len > ap_lst->mask)
+    {
+      /* Only happens if nBufferCountActual was raised after the list was
+       * created */
+      tiz_check_omx (hdr_lst_reserve (ap_lst, (ap_lst->mask + 1) << 1));
+    }
+  ap_lst->pp_hdrs[(ap_lst->head + ap_lst->len) & ap_lst->mask] = ap_hdr;
+  ap_lst->len++;
+  hdr_lst_update_ready (ap_lst);
+  return OMX_ErrorNone;
+}
+
+static inline void hdr_lst_erase (tiz_krn_hdr_lst_t *ap_lst,
+                                  const OMX_U32 a_index)
+{
+  OMX_U32 i = 0;
+  assert (ap_lst);
+  assert (a_index < ap_lst->len);
+
+  if (0 == a_index)
+    {
+      /* Common case: the header at the front is claimed */
+      ap_lst->head = (ap_lst->head + 1) & ap_lst->mask;
+    }
+  else
+    {
+      for (i = a_index; i + 1 < ap_lst->len; ++i)
+        {
+          ap_lst->pp_hdrs[(ap_lst->head + i) & ap_lst->mask]
+              = ap_lst->pp_hdrs[(ap_lst->head + i + 1) & ap_lst->mask];
+        }
+    }
+  ap_lst->len--;
+  hdr_lst_update_ready (ap_lst);
+}
+
+static inline void hdr_lst_clear (tiz_krn_hdr_lst_t *ap_lst)
+{
+  assert (ap_lst);
+  ap_lst->head = 0;
+  ap_lst->len = 0;
+  hdr_lst_update_ready (ap_lst);
+}
+
+static OMX_ERRORTYPE hdr_lst_append (tiz_krn_hdr_lst_t *ap_dst,
+                                     const tiz_krn_hdr_lst_t *ap_src)
+{
+  OMX_U32 i = 0;
+  assert (ap_dst);
+  assert (ap_src);
+  tiz_check_omx (hdr_lst_reserve (ap_dst, ap_dst->len + ap_src->len));
+  for (i = 0; i < ap_src->len; ++i)
+    {
+      tiz_check_omx (hdr_lst_push_back (ap_dst, hdr_lst_at (ap_src, i)));
+    }
+  return OMX_ErrorNone;
+}
+
+static inline tiz_krn_hdr_lst_t *get_hdr_lst (const tiz_vector_t *ap_lsts,
+                                              OMX_U32 a_pid)
+{
+  tiz_krn_hdr_lst_t **pp_lst = NULL;
+  assert (ap_lsts);
+  pp_lst = tiz_vector_at (ap_lsts, a_pid);
+  assert (pp_lst && *pp_lst);
+  return *pp_lst;
+}
+
+static inline tiz_krn_hdr_lst_t *get_ingress_lst (const tiz_krn_t *ap_obj,
+                                                  OMX_U32 a_pid)
 {
-  tiz_vector_t *p_list = NULL;
   assert (ap_obj);
   /* Grab the port's ingress list */
-  p_list = tiz_vector_at (ap_obj->p_ingress_, a_pid);
-  assert (p_list && *(tiz_vector_t **)p_list);
-  return (*(tiz_vector_t **)p_list);
+  return get_hdr_lst (ap_obj->p_ingress_, a_pid);
 }
 
-static inline tiz_vector_t *get_egress_lst (const tiz_krn_t *ap_obj,
-                                            OMX_U32 a_pid)
+static inline tiz_krn_hdr_lst_t *get_egress_lst (const tiz_krn_t *ap_obj,
+                                                 OMX_U32 a_pid)
 {
-  tiz_vector_t *p_list = NULL;
   assert (ap_obj);
   /* Grab the port's egress list */
-  p_list = tiz_vector_at (ap_obj->p_egress_, a_pid);
-  assert (p_list && *(tiz_vector_t **)p_list);
-  return (*(tiz_vector_t **)p_list);
+  return get_hdr_lst (ap_obj->p_egress_, a_pid);
 }
 
 static inline OMX_PTR get_port (const tiz_krn_t *ap_obj, const OMX_U32 a_pid)
@@ -126,71 +291,62 @@ static inline OMX_PTR get_port (const tiz_krn_t *ap_obj, const OMX_U32 a_pid)
   return *pp_port;
 }
 
-static inline OMX_BUFFERHEADERTYPE *get_header (const tiz_vector_t *ap_list,
+static inline OMX_BUFFERHEADERTYPE *get_header (const tiz_krn_hdr_lst_t *ap_list,
                                                 OMX_U32 a_index)
 {
-  OMX_BUFFERHEADERTYPE **pp_hdr = NULL;
+  OMX_BUFFERHEADERTYPE *p_hdr = NULL;
   assert (ap_list);
-  assert (a_index < tiz_vector_length (ap_list));
   /* Retrieve the header... */
-  pp_hdr = tiz_vector_at (ap_list, a_index);
-  assert (pp_hdr && *pp_hdr);
-  return *pp_hdr;
+  p_hdr = hdr_lst_at (ap_list, a_index);
+  assert (p_hdr);
+  return p_hdr;
 }
 
 static OMX_S32 move_to_ingress (void *ap_obj, OMX_U32 a_pid)
 {
 
   tiz_krn_t *p_obj = ap_obj;
-  tiz_vector_t *p_elist = NULL;
-  tiz_vector_t *p_ilist = NULL;
+  tiz_krn_hdr_lst_t *p_elist = NULL;
+  tiz_krn_hdr_lst_t *p_ilist = NULL;
   const OMX_S32 nports = tiz_vector_length (p_obj->p_ports_);
   OMX_ERRORTYPE rc = OMX_ErrorNone;
 
   assert (a_pid < nports);
 
-  p_elist = tiz_vector_at (p_obj->p_egress_, a_pid);
-  p_ilist = tiz_vector_at (p_obj->p_ingress_, a_pid);
-  assert (p_elist && *(tiz_vector_t **)p_elist);
-  p_elist = *(tiz_vector_t **)p_elist;
-  assert (p_ilist && *(tiz_vector_t **)p_elist);
-  p_ilist = *(tiz_vector_t **)p_ilist;
-  rc = tiz_vector_append (p_ilist, p_elist);
-  tiz_vector_clear (p_elist);
+  p_elist = get_egress_lst (p_obj, a_pid);
+  p_ilist = get_ingress_lst (p_obj, a_pid);
+  rc = hdr_lst_append (p_ilist, p_elist);
+  hdr_lst_clear (p_elist);
 
   if (OMX_ErrorNone != rc)
     {
       return -1;
     }
 
-  return tiz_vector_length (p_ilist);
+  return hdr_lst_length (p_ilist);
 }
 
 static OMX_S32 move_to_egress (void *ap_obj, OMX_U32 a_pid)
 {
   tiz_krn_t *p_obj = ap_obj;
   const OMX_S32 nports = tiz_vector_length (p_obj->p_ports_);
-  tiz_vector_t *p_elist = NULL;
-  tiz_vector_t *p_ilist = NULL;
+  tiz_krn_hdr_lst_t *p_elist = NULL;
+  tiz_krn_hdr_lst_t *p_ilist = NULL;
   OMX_ERRORTYPE rc = OMX_ErrorNone;
 
   assert (a_pid < nports);
 
-  p_elist = tiz_vector_at (p_obj->p_egress_, a_pid);
-  p_ilist = tiz_vector_at (p_obj->p_ingress_, a_pid);
-  assert (p_elist && *(tiz_vector_t **)p_elist);
-  p_elist = *(tiz_vector_t **)p_elist;
-  assert (p_ilist && *(tiz_vector_t **)p_ilist);
-  p_ilist = *(tiz_vector_t **)p_ilist;
-  rc = tiz_vector_append (p_elist, p_ilist);
-  tiz_vector_clear (p_ilist);
+  p_elist = get_egress_lst (p_obj, a_pid);
+  p_ilist = get_ingress_lst (p_obj, a_pid);
+  rc = hdr_lst_append (p_elist, p_ilist);
+  hdr_lst_clear (p_ilist);
 
   if (OMX_ErrorNone != rc)
     {
       return -1;
     }
 
-  return tiz_vector_length (p_elist);
+  return hdr_lst_length (p_elist);
 }
 
 static OMX_S32 add_to_buflst (void *ap_obj, tiz_vector_t *ap_dst2darr,
@@ -198,7 +354,7 @@ static OMX_S32 add_to_buflst (void *ap_obj, tiz_vector_t *ap_dst2darr,
                               const void *ap_port)
 {
   const tiz_krn_t *p_obj = ap_obj;
-  tiz_vector_t *p_list = NULL;
+  tiz_krn_hdr_lst_t *p_list = NULL;
   const OMX_U32 pid = tiz_port_index (ap_port);
 
   assert (ap_obj);
@@ -206,43 +362,40 @@ static OMX_S32 add_to_buflst (void *ap_obj, tiz_vector_t *ap_dst2darr,
   assert (ap_hdr);
   assert (tiz_vector_length (ap_dst2darr) >= pid);
 
-  p_list = tiz_vector_at (ap_dst2darr, pid);
-  assert (p_list && *(tiz_vector_t **)p_list);
-  p_list = *(tiz_vector_t **)p_list;
+  p_list = get_hdr_lst (ap_dst2darr, pid);
 
   TIZ_TRACE (handleOf (p_obj),
              "HEADER [%p] BUFFER [%p] PID [%d] "
              "list size [%d] buf count [%d]",
-             ap_hdr, ap_hdr->pBuffer, pid, tiz_vector_length (p_list),
+             ap_hdr, ap_hdr->pBuffer, pid, hdr_lst_length (p_list),
              tiz_port_buffer_count (ap_port));
 
-  assert (tiz_vector_length (p_list) < tiz_port_buffer_count (ap_port));
+  assert (hdr_lst_length (p_list) < tiz_port_buffer_count (ap_port));
 
-  if (OMX_ErrorNone != tiz_vector_push_back (p_list, &ap_hdr))
+  if (OMX_ErrorNone
+      != hdr_lst_push_back (p_list, (OMX_BUFFERHEADERTYPE *)ap_hdr))
     {
       return -1;
     }
   else
     {
-      assert (tiz_vector_length (p_list) <= tiz_port_buffer_count (ap_port));
-      return tiz_vector_length (p_list);
+      assert (hdr_lst_length (p_list) <= tiz_port_buffer_count (ap_port));
+      return hdr_lst_length (p_list);
     }
 }
 
 static OMX_S32 clear_hdr_contents (tiz_vector_t *ap_hdr_lst, OMX_U32 a_pid)
 {
-  tiz_vector_t *p_list = NULL;
+  tiz_krn_hdr_lst_t *p_list = NULL;
   OMX_BUFFERHEADERTYPE *p_hdr = NULL;
   OMX_S32 i, hdr_count = 0;
 
   assert (ap_hdr_lst);
   assert (tiz_vector_length (ap_hdr_lst) >= a_pid);
 
-  p_list = tiz_vector_at (ap_hdr_lst, a_pid);
-  assert (p_list && *(tiz_vector_t **)p_list);
-  p_list = *(tiz_vector_t **)p_list;
+  p_list = get_hdr_lst (ap_hdr_lst, a_pid);
 
-  hdr_count = tiz_vector_length (p_list);
+  hdr_count = hdr_lst_length (p_list);
   for (i = 0; i < hdr_count; ++i)
     {
       p_hdr = get_header (p_list, i);
@@ -256,25 +409,34 @@ static OMX_ERRORTYPE append_buflsts (tiz_vector_t *ap_dst2darr,
                                      const tiz_vector_t *ap_srclst,
                                      OMX_U32 a_pid)
 {
-  tiz_vector_t *p_list = NULL;
+  tiz_krn_hdr_lst_t *p_list = NULL;
+  OMX_BUFFERHEADERTYPE **pp_hdr = NULL;
+  OMX_S32 i = 0;
+  const OMX_S32 nhdrs = tiz_vector_length (ap_srclst);
+
   assert (ap_dst2darr);
   assert (ap_srclst);
   assert (tiz_vector_length (ap_dst2darr) >= a_pid);
 
-  p_list = tiz_vector_at (ap_dst2darr, a_pid);
-  assert (p_list && *(tiz_vector_t **)p_list);
-  p_list = *(tiz_vector_t **)p_list;
+  p_list = get_hdr_lst (ap_dst2darr, a_pid);
 
   /* Make sure the list is empty, before appending anything */
-  tiz_vector_clear (p_list);
+  hdr_lst_clear (p_list);
 
-  return tiz_vector_append (p_list, ap_srclst);
+  tiz_check_omx (hdr_lst_reserve (p_list, nhdrs));
+  for (i = 0; i < nhdrs; ++i)
+    {
+      pp_hdr = tiz_vector_at (ap_srclst, i);
+      assert (pp_hdr && *pp_hdr);
+      tiz_check_omx (hdr_lst_push_back (p_list, *pp_hdr));
+    }
+
+  return OMX_ErrorNone;
 }
 
 static void clear_hdr_lsts (void *ap_obj, const OMX_U32 a_pid)
 {
   tiz_krn_t *p_obj = ap_obj;
-  tiz_vector_t *p_list = NULL;
   OMX_S32 i = 0;
   OMX_U32 pid = 0;
   OMX_S32 nports = 0;
@@ -285,17 +447,8 @@ static void clear_hdr_lsts (void *ap_obj, const OMX_U32 a_pid)
   do
     {
       pid = ((OMX_ALL != a_pid) ? a_pid : i);
-
-      p_list = tiz_vector_at (p_obj->p_ingress_, pid);
-      assert (p_list && *(tiz_vector_t **)p_list);
-      p_list = *(tiz_vector_t **)p_list;
-      tiz_vector_clear (p_list);
-
-      p_list = tiz_vector_at (p_obj->p_egress_, pid);
-      assert (p_list && *(tiz_vector_t **)p_list);
-      p_list = *(tiz_vector_t **)p_list;
-      tiz_vector_clear (p_list);
-
+      hdr_lst_clear (get_ingress_lst (p_obj, pid));
+      hdr_lst_clear (get_egress_lst (p_obj, pid));
       ++i;
     }
   while (OMX_ALL == pid && i < nports);
@@ -343,7 +496,7 @@ static OMX_ERRORTYPE propagate_ingress (void *ap_obj, OMX_U32 a_pid)
 {
   tiz_krn_t *p_obj = ap_obj;
   void *p_prc = NULL;
-  tiz_vector_t *p_list = NULL;
+  tiz_krn_hdr_lst_t *p_list = NULL;
   OMX_PTR p_port = NULL;
   OMX_BUFFERHEADERTYPE *p_hdr = NULL;
   OMX_S32 i = 0;
@@ -370,9 +523,9 @@ static OMX_ERRORTYPE propagate_ingress (void *ap_obj, OMX_U32 a_pid)
       /* Grab the port's ingress list */
       p_list = get_ingress_lst (p_obj, pid);
       TIZ_TRACE (handleOf (p_obj), "port [%d]'s ingress list length [%d]...",
-                 pid, tiz_vector_length (p_list));
+                 pid, hdr_lst_length (p_list));
 
-      nbufs = tiz_vector_length (p_list);
+      nbufs = hdr_lst_length (p_list);
       for (j = 0; j < nbufs; ++j)
         {
           /* Retrieve the header... */
@@ -575,11 +728,75 @@ static OMX_ERRORTYPE flush_marks (void *ap_obj, OMX_PTR ap_port)
   return rc;
 }
 
+static OMX_ERRORTYPE issue_tunneled_buf_callbacks (
+    const tiz_krn_t *ap_obj, OMX_PTR ap_port, OMX_BUFFERHEADERTYPE **app_hdrs,
+    OMX_U32 *ap_nhdrs, const OMX_DIRTYPE a_pdir, OMX_HANDLETYPE ap_thdl)
+{
+  tiz_data_chan_t *p_chan = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_obj);
+  assert (ap_port);
+  assert (app_hdrs);
+  assert (ap_nhdrs);
+  assert (ap_thdl);
+
+  if (*ap_nhdrs > 0 && (p_chan = tiz_port_get_fast_tunnel (ap_port)))
+    {
+      /* The peer is a libtizonia component: hand the headers directly to its
+       * kernel. */
+      if (tiz_data_chan_write (p_chan, app_hdrs,
+                               *ap_nhdrs * sizeof(OMX_BUFFERHEADERTYPE *))
+          > 0)
+        {
+          TIZ_DEBUG (handleOf (ap_obj), "[fast tunnel] : [%d] HEADERS [%s]",
+                     *ap_nhdrs, TIZ_CNAME (ap_thdl));
+          *ap_nhdrs = 0;
+          return OMX_ErrorNone;
+        }
+
+      /* The channel is full. The headers already in it still reach the peer
+       * ahead of this batch: the peer is either draining the channel right
+       * now or has its notification queued before the message sent
+       * below. But headers written to the channel from now on could overtake
+       * this batch, so the channel is not used again for this tunnel. */
+      TIZ_WARN (handleOf (ap_obj),
+                "[fast tunnel] : channel full; "
+                "using standard buffer calls with [%s]",
+                TIZ_CNAME (ap_thdl));
+      tiz_port_reset_fast_tunnel (ap_port);
+    }
+
+  if (*ap_nhdrs > 0)
+    {
+      TIZ_DEBUG (handleOf (ap_obj), "[%s] : [%d] HEADERS [%s]",
+                 OMX_DirInput == a_pdir ? "tiz_comp_fill_buffers"
+                                        : "tiz_comp_empty_buffers",
+                 *ap_nhdrs, TIZ_CNAME (ap_thdl));
+      /* Input ports return their buffers upstream (FillThisBuffer), output
+       * ports pass them on downstream (EmptyThisBuffer). Either way, the peer
+       * is handed the whole batch at once. */
+      rc = (OMX_DirInput == a_pdir
+                ? tiz_comp_fill_buffers (ap_thdl, app_hdrs, *ap_nhdrs)
+                : tiz_comp_empty_buffers (ap_thdl, app_hdrs, *ap_nhdrs));
+      if (OMX_ErrorNone != rc)
+        {
+          TIZ_ERROR (handleOf (ap_obj), "[%s] : while sending [%d] HEADERS "
+                                        "to [%s]",
+                     tiz_err_to_str (rc), *ap_nhdrs, TIZ_CNAME (ap_thdl));
+        }
+      /* The batch has left this component, whatever the outcome */
+      *ap_nhdrs = 0;
+    }
+
+  return rc;
+}
+
 static OMX_ERRORTYPE flush_egress (void *ap_obj, const OMX_U32 a_pid,
                                    const OMX_BOOL a_clear)
 {
   tiz_krn_t *p_obj = ap_obj;
-  tiz_vector_t *p_list = NULL;
+  tiz_krn_hdr_lst_t *p_list = NULL;
   OMX_PTR p_port = NULL;
   OMX_BUFFERHEADERTYPE *p_hdr = NULL;
   OMX_S32 i = 0;
@@ -588,6 +805,9 @@ static OMX_ERRORTYPE flush_egress (void *ap_obj, const OMX_U32 a_pid,
   OMX_HANDLETYPE p_hdl = handleOf (p_obj);
   OMX_HANDLETYPE p_thdl = NULL;
   OMX_S32 nports = 0;
+  OMX_BUFFERHEADERTYPE *p_batch[TIZ_COMP_MAX_BUFFER_BATCH];
+  OMX_U32 nbatch = 0;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
 
   assert (ap_obj);
 
@@ -609,9 +829,9 @@ static OMX_ERRORTYPE flush_egress (void *ap_obj, const OMX_U32 a_pid,
       TIZ_TRACE (p_hdl,
                  "pid [%d] loop index=[%d] egress length [%d] "
                  "- p_thdl [%p]...",
-                 pid, i, tiz_vector_length (p_list), p_thdl);
+                 pid, i, hdr_lst_length (p_list), p_thdl);
 
-      while (tiz_vector_length (p_list) > 0)
+      while (OMX_ErrorNone == rc && hdr_lst_length (p_list) > 0)
         {
           /* Retrieve the header... */
           p_hdr = get_header (p_list, 0);
@@ -627,11 +847,20 @@ static OMX_ERRORTYPE flush_egress (void *ap_obj, const OMX_U32 a_pid,
              * if pre-announcements are enabled on the port. */
             if (OMX_DirInput == pdir && TIZ_PORT_IS_ALLOCATOR (p_port))
               {
-                tiz_check_omx (tiz_port_populate_header (p_port, p_hdr));
+                rc = tiz_port_populate_header (p_port, p_hdr);
               }
 
             /* Propagate buffer marks... */
-            tiz_check_omx (process_marks (p_obj, p_hdr, pid, p_hdl));
+            if (OMX_ErrorNone == rc)
+              {
+                rc = process_marks (p_obj, p_hdr, pid, p_hdl);
+              }
+
+            if (OMX_ErrorNone != rc)
+              {
+                /* This header stays in the egress list */
+                break;
+              }
 
             if (OMX_TRUE == a_clear)
               {
@@ -671,18 +900,43 @@ static OMX_ERRORTYPE flush_egress (void *ap_obj, const OMX_U32 a_pid,
                   }
               }
 
-            /* get rid of the buffer */
-            tiz_srv_issue_buf_callback ((OMX_PTR)ap_obj, p_hdr, pid, pdir,
-                                        p_thdl);
+            /* get rid of the buffer; headers going to a tunneled peer are
+             * batched, so that the peer is woken up only once */
+            if (p_thdl)
+              {
+                p_batch[nbatch++] = p_hdr;
+              }
+            else
+              {
+                tiz_srv_issue_buf_callback ((OMX_PTR)ap_obj, p_hdr, pid, pdir,
+                                            p_thdl);
+              }
             /* ... and delete it from the list. */
-            tiz_vector_erase (p_list, 0, 1);
+            hdr_lst_erase (p_list, 0);
+
+            /* An error returned by the tunneled peer is logged by
+             * issue_tunneled_buf_callbacks; it must not stop the flush nor
+             * fail this component's own transition. */
+            if (TIZ_COMP_MAX_BUFFER_BATCH == nbatch)
+              {
+                (void) issue_tunneled_buf_callbacks (p_obj, p_port, p_batch,
+                                                     &nbatch, pdir, p_thdl);
+              }
           }
         }
+
+      if (p_thdl)
+        {
+          /* The headers in the batch are no longer in the egress list, so
+           * they must be sent even if the loop above stopped on an error */
+          (void) issue_tunneled_buf_callbacks (p_obj, p_port, p_batch, &nbatch,
+                                               pdir, p_thdl);
+        }
       ++i;
     }
-  while (OMX_ALL == a_pid && i < nports);
+  while (OMX_ErrorNone == rc && OMX_ALL == a_pid && i < nports);
 
-  return OMX_ErrorNone;
+  return rc;
 }
 
 static const OMX_STRING krn_msg_to_str (tiz_krn_msg_class_t a_msg)
@@ -915,6 +1169,34 @@ static OMX_BOOL process_efb_from_servant_queue (OMX_PTR ap_elem,
   return rc;
 }
 
+static void process_efb_from_fast_tunnel (tiz_krn_t *ap_obj, const OMX_U32 a_pid)
+{
+  tiz_data_chan_t *p_chan = NULL;
+  OMX_BUFFERHEADERTYPE *p_hdr = NULL;
+  OMX_PTR p_port = NULL;
+
+  assert (ap_obj);
+
+  if (a_pid >= TIZ_COMP_MAX_PORTS || !(p_chan = ap_obj->p_fast_chans_[a_pid]))
+    {
+      return;
+    }
+
+  p_port = get_port (ap_obj, a_pid);
+  while (sizeof(p_hdr) == tiz_data_chan_read (p_chan, &p_hdr, sizeof(p_hdr)))
+    {
+      TIZ_TRACE (handleOf (ap_obj), "HEADER [%p] BUFFER [%p] PID [%d]", p_hdr,
+                 p_hdr->pBuffer, a_pid);
+      if (0 >= add_to_buflst (ap_obj, ap_obj->p_ingress_, p_hdr, p_port))
+        {
+          TIZ_ERROR (handleOf (ap_obj),
+                     "Error on port [%d] while "
+                     "adding buffer to ingress list",
+                     a_pid);
+        }
+    }
+}
+
 static OMX_BOOL process_cbacks_from_servant_queue (OMX_PTR ap_elem,
                                                    OMX_S32 a_data1,
                                                    OMX_PTR ap_data2)
@@ -1004,7 +1286,7 @@ static inline tiz_krn_msg_t *init_krn_message (
 static OMX_ERRORTYPE enqueue_callback_msg (
     const void *ap_obj,
     /*@null@*/ OMX_BUFFERHEADERTYPE *ap_hdr, const OMX_U32 a_pid,
-    const OMX_DIRTYPE a_dir)
+    const OMX_DIRTYPE a_dir, const OMX_BOOL a_defer_flush)
 {
   tiz_krn_t *p_obj = (tiz_krn_t *)ap_obj;
   tiz_krn_msg_t *p_msg = NULL;
@@ -1029,6 +1311,7 @@ static OMX_ERRORTYPE enqueue_callback_msg (
   p_msg_cb->p_hdr = ap_hdr;
   p_msg_cb->pid = a_pid;
   p_msg_cb->dir = a_dir;
+  p_msg_cb->defer_flush = a_defer_flush;
   return tiz_srv_enqueue (ap_obj, p_msg, 1);
 }
 
@@ -1238,7 +1521,7 @@ static bool all_buffers_returned (void *ap_obj)
   tiz_krn_t *p_obj = ap_obj;
   OMX_S32 nports = 0;
   OMX_PTR p_port = NULL;
-  tiz_vector_t *p_list = NULL;
+  tiz_krn_hdr_lst_t *p_list = NULL;
   OMX_U32 i;
   OMX_S32 nbuf = 0, nbufin = 0;
 
@@ -1260,7 +1543,7 @@ static bool all_buffers_returned (void *ap_obj)
         {
           p_list = get_ingress_lst (p_obj, i);
 
-          if ((nbufin = tiz_vector_length (p_list)) != nbuf)
+          if ((nbufin = hdr_lst_length (p_list)) != nbuf)
             {
               int j = 0;
               OMX_BUFFERHEADERTYPE *p_hdr = NULL;
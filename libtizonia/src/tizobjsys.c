@@ -31,7 +31,10 @@
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include <tizplatform.h>
 
@@ -86,13 +89,6 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.tizonia.objsys"
 #endif
 
-struct tiz_os
-{
-  tiz_map_t * p_map;
-  OMX_HANDLETYPE p_hdl;
-  tiz_soa_t * p_soa;
-};
-
 typedef enum tiz_os_type tiz_os_type_t;
 enum tiz_os_type
 {
@@ -180,10 +176,60 @@ enum tiz_os_type
   ETIZDemuxercfgport,
   ETIZMp4port_class,
   ETIZMp4port,
+  ETIZOsTypeMax
 };
 
 #define TIZ_OS_BASE_TYPE_END ETIZConfigport
 
+/* Class objects instantiated from the registry are laid out with this
+   alignment */
+#define TIZ_OS_TYPE_ALIGN(n) (((n) + 15) & ~((size_t) 15))
+
+struct tiz_os
+{
+  /* Types registered by the component itself, keyed by name */
+  tiz_map_t * p_map;
+  OMX_HANDLETYPE p_hdl;
+  tiz_soa_t * p_soa;
+  /* The library's types, indexed by tiz_os_type_t */
+  void ** pp_types;
+  /* A single allocation that holds the base types, when they have been
+     instantiated from the registry */
+  char * p_base_types;
+  size_t base_types_size;
+};
+
+/* A class object as built by its type init function, with the tos and hdl
+   fields cleared. Its class and super class are recorded as type ids, so
+   that copies can be relocated to another tiz_os instance. */
+typedef struct tiz_os_proto tiz_os_proto_t;
+struct tiz_os_proto
+{
+  tiz_class_t * p_obj;
+  size_t size;
+  tiz_os_type_t class_id;
+  tiz_os_type_t super_id;
+};
+
+/* Process-wide registry of class prototypes. It is populated by the first
+   component that builds each type, and released when the last tiz_os
+   instance is destroyed. */
+typedef struct tiz_os_registry tiz_os_registry_t;
+struct tiz_os_registry
+{
+  pthread_mutex_t mutex;
+  OMX_U32 ref_count;
+  bool base_types_ready;
+  size_t base_types_size;
+  tiz_os_proto_t protos[ETIZOsTypeMax];
+};
+
+static tiz_os_registry_t g_registry = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+/* Type ids sorted by type name, for name lookups */
+static tiz_os_type_t g_sorted_types[ETIZOsTypeMax];
+static pthread_once_t g_sorted_types_once = PTHREAD_ONCE_INIT;
+
 static const tiz_os_type_init_f tiz_os_type_to_fnt_tbl[] = {
   tiz_class_init,
   tiz_object_init,
@@ -415,6 +461,157 @@ os_map_free_func (OMX_PTR ap_key, OMX_PTR ap_value)
   tiz_mem_free (ap_value);
 }
 
+static int
+os_type_name_cmp (const void * ap_a, const void * ap_b)
+{
+  const tiz_os_type_t * p_a = ap_a;
+  const tiz_os_type_t * p_b = ap_b;
+  return strcmp (tiz_os_type_to_str_tbl[*p_a].str,
+                 tiz_os_type_to_str_tbl[*p_b].str);
+}
+
+static void
+sort_types (void)
+{
+  OMX_S32 i = 0;
+  for (i = 0; i < ETIZOsTypeMax; ++i)
+    {
+      assert (tiz_os_type_to_str_tbl[i].type == i);
+      g_sorted_types[i] = (tiz_os_type_t) i;
+    }
+  qsort (g_sorted_types, ETIZOsTypeMax, sizeof (tiz_os_type_t),
+         os_type_name_cmp);
+}
+
+static OMX_S32
+os_type_id (const char * a_type_name)
+{
+  OMX_S32 lo = 0;
+  OMX_S32 hi = ETIZOsTypeMax - 1;
+
+  (void) pthread_once (&g_sorted_types_once, sort_types);
+
+  while (lo <= hi)
+    {
+      const OMX_S32 mid = lo + (hi - lo) / 2;
+      const int cmp
+        = strncmp (a_type_name, tiz_os_type_to_str_tbl[g_sorted_types[mid]].str,
+                   OMX_MAX_STRINGNAME_SIZE);
+      if (0 == cmp)
+        {
+          return g_sorted_types[mid];
+        }
+      else if (cmp < 0)
+        {
+          hi = mid - 1;
+        }
+      else
+        {
+          lo = mid + 1;
+        }
+    }
+  return -1;
+}
+
+/* Reverse lookup of one of the library's class objects */
+static OMX_S32
+os_find_type_id (const tiz_os_t * ap_os, const void * ap_obj)
+{
+  OMX_S32 type_id = 0;
+  for (type_id = 0; type_id < ETIZOsTypeMax; ++type_id)
+    {
+      if (ap_os->pp_types[type_id] == ap_obj)
+        {
+          return type_id;
+        }
+    }
+  return -1;
+}
+
+static void
+registry_acquire (void)
+{
+  (void) pthread_mutex_lock (&(g_registry.mutex));
+  ++g_registry.ref_count;
+  (void) pthread_mutex_unlock (&(g_registry.mutex));
+}
+
+static void
+registry_release (void)
+{
+  (void) pthread_mutex_lock (&(g_registry.mutex));
+  assert (g_registry.ref_count > 0);
+  if (0 == --g_registry.ref_count)
+    {
+      OMX_S32 type_id = 0;
+      for (type_id = 0; type_id < ETIZOsTypeMax; ++type_id)
+        {
+          tiz_mem_free (g_registry.protos[type_id].p_obj);
+          g_registry.protos[type_id].p_obj = NULL;
+        }
+      g_registry.base_types_ready = false;
+      g_registry.base_types_size = 0;
+    }
+  (void) pthread_mutex_unlock (&(g_registry.mutex));
+}
+
+/* Keep a copy of a class object that was built by its type init function.
+   Must be called with the registry mutex held. */
+static bool
+registry_capture (const tiz_os_t * ap_os, const OMX_S32 a_type_id)
+{
+  tiz_os_proto_t * p_proto = &(g_registry.protos[a_type_id]);
+  const tiz_class_t * p_obj = ap_os->pp_types[a_type_id];
+  OMX_S32 class_id = -1;
+  OMX_S32 super_id = -1;
+
+  assert (p_obj);
+
+  if (p_proto->p_obj)
+    {
+      return true;
+    }
+
+  class_id = os_find_type_id (ap_os, classOf (p_obj));
+  super_id = os_find_type_id (ap_os, p_obj->super);
+  if (class_id < 0 || super_id < 0)
+    {
+      return false;
+    }
+
+  p_proto->size = sizeOf (p_obj);
+  if (!(p_proto->p_obj = tiz_mem_alloc (p_proto->size)))
+    {
+      return false;
+    }
+  memcpy (p_proto->p_obj, p_obj, p_proto->size);
+  p_proto->p_obj->tos = NULL;
+  p_proto->p_obj->hdl = NULL;
+  p_proto->class_id = (tiz_os_type_t) class_id;
+  p_proto->super_id = (tiz_os_type_t) super_id;
+  return true;
+}
+
+/* Copy a prototype into ap_mem and relocate it to this tiz_os instance. The
+   type's class and super class must be registered in the instance already. */
+static void
+os_instantiate (tiz_os_t * ap_os, const OMX_S32 a_type_id, void * ap_mem)
+{
+  const tiz_os_proto_t * p_proto = &(g_registry.protos[a_type_id]);
+  tiz_class_t * p_obj = ap_mem;
+  const void * p_class = ap_os->pp_types[p_proto->class_id];
+
+  assert (p_proto->p_obj);
+  assert (p_class);
+  assert (ap_os->pp_types[p_proto->super_id]);
+
+  memcpy (p_obj, p_proto->p_obj, p_proto->size);
+  memcpy ((char *) p_obj, (char *) &p_class, sizeof (tiz_class_t *));
+  p_obj->super = ap_os->pp_types[p_proto->super_id];
+  p_obj->tos = ap_os;
+  p_obj->hdl = ap_os->p_hdl;
+}
+
 #ifdef _DEBUG
 static OMX_S32
 print_function (OMX_PTR ap_key, OMX_PTR ap_value, OMX_PTR ap_arg)
@@ -430,8 +627,17 @@ static void
 print_types (const tiz_os_t * ap_os)
 {
 #ifdef _DEBUG
+  OMX_S32 type_id = 0;
   assert (ap_os);
   assert (ap_os->p_map);
+  for (type_id = 0; type_id < ETIZOsTypeMax; ++type_id)
+    {
+      if (ap_os->pp_types[type_id])
+        {
+          (void) print_function (tiz_os_type_to_str_tbl[type_id].str,
+                                 ap_os->pp_types[type_id], (tiz_os_t *) ap_os);
+        }
+    }
   tiz_map_for_each (ap_os->p_map, print_function, (tiz_os_t *) ap_os);
 #endif
 }
@@ -471,27 +677,141 @@ os_register_type (tiz_os_t * ap_os, const tiz_os_type_init_f a_type_init_f,
   return rc;
 }
 
+/* Register one of the library's types, from the registry if possible */
+static void *
+os_get_type_by_id (tiz_os_t * ap_os, const OMX_S32 a_type_id)
+{
+  const tiz_os_proto_t * p_proto = &(g_registry.protos[a_type_id]);
+  bool have_proto = false;
+  void * p_obj = NULL;
+
+  assert (a_type_id >= 0 && a_type_id < ETIZOsTypeMax);
+
+  if (ap_os->pp_types[a_type_id])
+    {
+      return ap_os->pp_types[a_type_id];
+    }
+
+  /* Prototypes are immutable while this instance holds a reference to the
+     registry */
+  (void) pthread_mutex_lock (&(g_registry.mutex));
+  have_proto = (NULL != p_proto->p_obj);
+  (void) pthread_mutex_unlock (&(g_registry.mutex));
+
+  if (have_proto)
+    {
+      if (os_get_type_by_id (ap_os, p_proto->class_id)
+          && os_get_type_by_id (ap_os, p_proto->super_id)
+          && (p_obj = tiz_mem_alloc (p_proto->size)))
+        {
+          os_instantiate (ap_os, a_type_id, p_obj);
+          ap_os->pp_types[a_type_id] = p_obj;
+        }
+    }
+  else
+    {
+      TIZ_TRACE (ap_os->p_hdl, "Registering type [%s]...",
+                 tiz_os_type_to_str_tbl[a_type_id].str);
+      if ((p_obj = tiz_os_type_to_fnt_tbl[a_type_id](ap_os, ap_os->p_hdl)))
+        {
+          ap_os->pp_types[a_type_id] = p_obj;
+          (void) pthread_mutex_lock (&(g_registry.mutex));
+          (void) registry_capture (ap_os, a_type_id);
+          (void) pthread_mutex_unlock (&(g_registry.mutex));
+        }
+    }
+
+  return p_obj;
+}
+
+static OMX_ERRORTYPE
+instantiate_base_types (tiz_os_t * ap_os)
+{
+  size_t offset = 0;
+  OMX_S32 type_id = 0;
+
+  assert (ap_os);
+  assert (g_registry.base_types_ready);
+
+  ap_os->base_types_size = g_registry.base_types_size;
+  if (!(ap_os->p_base_types = tiz_mem_alloc (ap_os->base_types_size)))
+    {
+      return OMX_ErrorInsufficientResources;
+    }
+
+  /* Lay out all the objects first; tizclass and tizobject refer to each
+     other */
+  for (type_id = 0; type_id <= TIZ_OS_BASE_TYPE_END; ++type_id)
+    {
+      ap_os->pp_types[type_id] = ap_os->p_base_types + offset;
+      offset += TIZ_OS_TYPE_ALIGN (g_registry.protos[type_id].size);
+    }
+  assert (offset == ap_os->base_types_size);
+
+  for (type_id = 0; type_id <= TIZ_OS_BASE_TYPE_END; ++type_id)
+    {
+      os_instantiate (ap_os, type_id, ap_os->pp_types[type_id]);
+    }
+
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 register_base_types (tiz_os_t * ap_os)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  const OMX_S32 count
-    = sizeof (tiz_os_type_to_str_tbl) / sizeof (tiz_os_type_str_t);
   OMX_S32 type_id = 0;
-  OMX_S32 last_element = 0;
+  bool ready = false;
 
   assert (ap_os);
-  assert (count >= TIZ_OS_BASE_TYPE_END);
-  last_element = TIZ_OS_BASE_TYPE_END;
+  assert (ETIZOsTypeMax
+          == sizeof (tiz_os_type_to_str_tbl) / sizeof (tiz_os_type_str_t));
+  assert (ETIZOsTypeMax
+          == sizeof (tiz_os_type_to_fnt_tbl) / sizeof (tiz_os_type_init_f));
+
+  (void) pthread_mutex_lock (&(g_registry.mutex));
+  ready = g_registry.base_types_ready;
+  (void) pthread_mutex_unlock (&(g_registry.mutex));
 
-  for (type_id = 0; type_id <= last_element && OMX_ErrorNone == rc; ++type_id)
+  if (ready)
+    {
+      TIZ_TRACE (ap_os->p_hdl, "Instantiating base types from the registry");
+      return instantiate_base_types (ap_os);
+    }
+
+  for (type_id = 0; type_id <= TIZ_OS_BASE_TYPE_END; ++type_id)
     {
       TIZ_TRACE (ap_os->p_hdl, "Registering type [%s]...",
                  tiz_os_type_to_str_tbl[type_id].str);
-      rc = os_register_type (ap_os, tiz_os_type_to_fnt_tbl[type_id],
-                             tiz_os_type_to_str_tbl[type_id].str, type_id);
+      if (!(ap_os->pp_types[type_id]
+            = tiz_os_type_to_fnt_tbl[type_id](ap_os, ap_os->p_hdl)))
+        {
+          return OMX_ErrorInsufficientResources;
+        }
     }
-  return rc;
+
+  /* Keep the base types for the next components. This is done once they
+     are all built, as tizobject's init function fixes up tizclass. */
+  (void) pthread_mutex_lock (&(g_registry.mutex));
+  if (!g_registry.base_types_ready)
+    {
+      size_t size = 0;
+      for (type_id = 0; type_id <= TIZ_OS_BASE_TYPE_END; ++type_id)
+        {
+          tiz_mem_free (g_registry.protos[type_id].p_obj);
+          g_registry.protos[type_id].p_obj = NULL;
+        }
+      for (type_id = 0; type_id <= TIZ_OS_BASE_TYPE_END
+                        && registry_capture (ap_os, type_id);
+           ++type_id)
+        {
+          size += TIZ_OS_TYPE_ALIGN (g_registry.protos[type_id].size);
+        }
+      g_registry.base_types_ready = (type_id > TIZ_OS_BASE_TYPE_END);
+      g_registry.base_types_size = size;
+    }
+  (void) pthread_mutex_unlock (&(g_registry.mutex));
+
+  return OMX_ErrorNone;
 }
 
 OMX_ERRORTYPE
@@ -512,9 +832,18 @@ tiz_os_init (tiz_os_t ** app_os, const OMX_HANDLETYPE ap_hdl,
 
   assert (p_os);
 
+  if (NULL
+      == (p_os->pp_types = tiz_mem_calloc (ETIZOsTypeMax, sizeof (void *))))
+    {
+      os_free (ap_soa, p_os);
+      p_os = NULL;
+      return OMX_ErrorInsufficientResources;
+    }
+
   if (OMX_ErrorNone != tiz_map_init (&(p_os->p_map), os_map_compare_func,
                                      os_map_free_func, NULL))
     {
+      tiz_mem_free (p_os->pp_types);
       os_free (ap_soa, p_os);
       p_os = NULL;
       return OMX_ErrorInsufficientResources;
@@ -522,6 +851,7 @@ tiz_os_init (tiz_os_t ** app_os, const OMX_HANDLETYPE ap_hdl,
 
   p_os->p_hdl = ap_hdl;
   p_os->p_soa = ap_soa;
+  registry_acquire ();
 
   *app_os = p_os;
 
@@ -533,12 +863,25 @@ tiz_os_destroy (tiz_os_t * ap_os)
 {
   if (ap_os)
     {
+      OMX_S32 type_id = 0;
       while (!tiz_map_empty (ap_os->p_map))
         {
           tiz_map_erase_at (ap_os->p_map, 0);
         };
       tiz_map_destroy (ap_os->p_map);
+      for (type_id = 0; type_id < ETIZOsTypeMax; ++type_id)
+        {
+          char * p_obj = ap_os->pp_types[type_id];
+          if (!(ap_os->p_base_types && p_obj >= ap_os->p_base_types
+                && p_obj < ap_os->p_base_types + ap_os->base_types_size))
+            {
+              tiz_mem_free (p_obj);
+            }
+        }
+      tiz_mem_free (ap_os->p_base_types);
+      tiz_mem_free (ap_os->pp_types);
       os_free (ap_os->p_soa, ap_os);
+      registry_release ();
     }
 }
 
@@ -558,50 +901,31 @@ tiz_os_register_base_types (tiz_os_t * ap_os)
   return register_base_types (ap_os);
 }
 
-static OMX_ERRORTYPE
-register_additional_type (tiz_os_t * ap_os, const char * a_type_name)
-{
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  const OMX_S32 count
-    = sizeof (tiz_os_type_to_str_tbl) / sizeof (tiz_os_type_str_t);
-  OMX_S32 type_id = TIZ_OS_BASE_TYPE_END + 1;
-
-  assert (ap_os);
-
-  for (; type_id < count && OMX_ErrorNone == rc; ++type_id)
-    {
-      if (0 == strncmp (a_type_name, tiz_os_type_to_str_tbl[type_id].str,
-                        OMX_MAX_STRINGNAME_SIZE))
-        {
-          TIZ_TRACE (ap_os->p_hdl, "Registering additional type [%s]...",
-                     a_type_name);
-          rc = os_register_type (ap_os, tiz_os_type_to_fnt_tbl[type_id],
-                                 a_type_name, type_id);
-          break;
-        }
-    }
-  return rc;
-}
-
 void *
 tiz_os_get_type (const tiz_os_t * ap_os, const char * a_type_name)
 {
   void * res = NULL;
+  OMX_S32 type_id = -1;
   assert (ap_os);
   assert (ap_os->p_map);
   assert (a_type_name);
-  res = tiz_map_find (ap_os->p_map, (OMX_PTR) a_type_name);
-  TIZ_TRACE (ap_os->p_hdl, "Get type [%s]->[%p] - total types [%d]",
-             a_type_name, res, tiz_map_size (ap_os->p_map));
-  if (!res)
+  if ((type_id = os_type_id (a_type_name)) >= 0)
     {
-      if (OMX_ErrorNone
-          == register_additional_type ((tiz_os_t *) ap_os, a_type_name))
+      res = ap_os->pp_types[type_id];
+      if (!res)
         {
+          TIZ_TRACE (ap_os->p_hdl, "Registering additional type [%s]...",
+                     a_type_name);
+          res = os_get_type_by_id ((tiz_os_t *) ap_os, type_id);
           print_types (ap_os);
-          res = tiz_map_find (ap_os->p_map, (OMX_PTR) a_type_name);
         }
     }
+  else
+    {
+      res = tiz_map_find (ap_os->p_map, (OMX_PTR) a_type_name);
+    }
+  TIZ_TRACE (ap_os->p_hdl, "Get type [%s]->[%p] - component types [%d]",
+             a_type_name, res, tiz_map_size (ap_os->p_map));
   assert (res);
   return res;
 }
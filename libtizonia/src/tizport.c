@@ -53,6 +53,9 @@
 
 #define TIZ_HDR_NOT_FOUND -1
 
+#define TIZ_PORT_RCFILE_SECTION "ilcore"
+#define TIZ_PORT_FAST_TUNNELS_RCFILE_KEY "fast-tunnels"
+
 #define TIZ_LOG_PORT_DEFINITION(hdl, pd)                                      \
   do                                                                          \
     {                                                                         \
@@ -394,6 +397,7 @@ port_ctor (void * ap_obj, va_list * app)
     }
 
   p_obj->thdl_ = NULL;
+  p_obj->p_fast_chan_ = NULL;
   p_obj->tpid_ = 0;
   p_obj->claimed_count_ = 0;
 
@@ -720,6 +724,15 @@ port_GetExtensionIndex (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   return rc;
 }
 
+static bool
+fast_tunnels_enabled (void)
+{
+  /* Off unless 'fast-tunnels = true' is set in the [ilcore] section */
+  const char * p_value = tiz_rcfile_get_value (TIZ_PORT_RCFILE_SECTION,
+                                               TIZ_PORT_FAST_TUNNELS_RCFILE_KEY);
+  return (p_value && 0 == strncmp (p_value, "true", 4));
+}
+
 static OMX_ERRORTYPE
 port_ComponentTunnelRequest (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                              OMX_U32 a_pid, OMX_HANDLETYPE ap_thdl,
@@ -731,10 +744,15 @@ port_ComponentTunnelRequest (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
     = {sizeof (OMX_PARAM_PORTDEFINITIONTYPE), _spec_version};
   OMX_PARAM_BUFFERSUPPLIERTYPE buf_supplier
     = {sizeof (OMX_PARAM_BUFFERSUPPLIERTYPE), _spec_version};
+  OMX_TIZONIA_PARAM_FASTTUNNELTYPE fast_tunnel
+    = {sizeof (OMX_TIZONIA_PARAM_FASTTUNNELTYPE), _spec_version};
 
   TIZ_TRACE (ap_hdl, "ap_hdl [%p] a_pid [%d] ap_thdl [%p] a_tpid [%d]", ap_hdl,
              a_pid, ap_thdl, a_tpid);
 
+  /* Any previous fast tunnel is no longer valid */
+  p_obj->p_fast_chan_ = NULL;
+
   /* See if the tunnel is being torn down */
   if (!ap_thdl)
     {
@@ -839,10 +857,26 @@ port_ComponentTunnelRequest (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
       p_obj->bufsupplier_.eBufferSupplier = supplier;
     }
 
+  /* When fast tunnels are enabled and the peer is a libtizonia component,
+     the peer hands over a channel that lets the kernel pass buffer headers
+     directly to the peer's kernel, bypassing its
+     OMX_EmptyThisBuffer/OMX_FillThisBuffer. Any other component returns
+     OMX_ErrorUnsupportedIndex and the standard calls are used. */
+  fast_tunnel.nPortIndex = a_tpid;
+  fast_tunnel.pChannel = NULL;
+  if (fast_tunnels_enabled ()
+      && OMX_ErrorNone
+           == OMX_GetParameter (ap_thdl, OMX_TizoniaIndexParamFastTunnel,
+                                &fast_tunnel))
+    {
+      p_obj->p_fast_chan_ = fast_tunnel.pChannel;
+    }
+
   tiz_port_set_flags (p_obj, 1, EFlagTunneled);
 
-  TIZ_TRACE (ap_hdl, "Tunnel request success [%p:%d] -> [%p:%d]", ap_hdl,
-             p_obj->pid_, p_obj->thdl_, p_obj->tpid_);
+  TIZ_TRACE (ap_hdl, "Tunnel request success [%p:%d] -> [%p:%d] fast [%s]",
+             ap_hdl, p_obj->pid_, p_obj->thdl_, p_obj->tpid_,
+             p_obj->p_fast_chan_ ? "YES" : "NO");
 
   return OMX_ErrorNone;
 }
@@ -1379,6 +1413,36 @@ tiz_port_get_tunnel_comp (const void * ap_obj)
   return class->get_tunnel_comp (ap_obj);
 }
 
+static tiz_data_chan_t *
+port_get_fast_tunnel (const void * ap_obj)
+{
+  const tiz_port_t * p_obj = ap_obj;
+  return p_obj->thdl_ ? p_obj->p_fast_chan_ : NULL;
+}
+
+tiz_data_chan_t *
+tiz_port_get_fast_tunnel (const void * ap_obj)
+{
+  const tiz_port_class_t * class = classOf (ap_obj);
+  assert (class->get_fast_tunnel);
+  return class->get_fast_tunnel (ap_obj);
+}
+
+static void
+port_reset_fast_tunnel (void * ap_obj)
+{
+  tiz_port_t * p_obj = ap_obj;
+  p_obj->p_fast_chan_ = NULL;
+}
+
+void
+tiz_port_reset_fast_tunnel (void * ap_obj)
+{
+  const tiz_port_class_t * class = classOf (ap_obj);
+  assert (class->reset_fast_tunnel);
+  class->reset_fast_tunnel (ap_obj);
+}
+
 static OMX_PTR
 port_get_eglimage (const void * ap_obj, const OMX_BUFFERHEADERTYPE * ap_hdr)
 {
@@ -2377,6 +2441,14 @@ port_class_ctor (void * ap_obj, va_list * app)
         {
           *(voidf *) &p_obj->get_tunnel_comp = method;
         }
+      else if (selector == (voidf) tiz_port_get_fast_tunnel)
+        {
+          *(voidf *) &p_obj->get_fast_tunnel = method;
+        }
+      else if (selector == (voidf) tiz_port_reset_fast_tunnel)
+        {
+          *(voidf *) &p_obj->reset_fast_tunnel = method;
+        }
       else if (selector == (voidf) tiz_port_get_eglimage)
         {
           *(voidf *) &p_obj->get_eglimage = method;
@@ -2548,6 +2620,10 @@ tiz_port_init (void * ap_tos, void * ap_hdl)
      /* TIZ_CLASS_COMMENT: */
      tiz_port_get_tunnel_comp, port_get_tunnel_comp,
      /* TIZ_CLASS_COMMENT: */
+     tiz_port_get_fast_tunnel, port_get_fast_tunnel,
+     /* TIZ_CLASS_COMMENT: */
+     tiz_port_reset_fast_tunnel, port_reset_fast_tunnel,
+     /* TIZ_CLASS_COMMENT: */
      tiz_port_get_eglimage, port_get_eglimage,
      /* TIZ_CLASS_COMMENT: */
      tiz_port_get_hdrs_list, port_get_hdrs_list,
@@ -36,6 +36,7 @@ extern "C" {
 #include "tizapi.h"
 #include "tizscheduler.h"
 #include "tizplatform.h"
+#include "tizdatachan.h"
 
 #include "OMX_Core.h"
 #include "OMX_Component.h"
@@ -129,6 +130,12 @@ tiz_port_domain (const void * ap_obj);
 OMX_HANDLETYPE
 tiz_port_get_tunnel_comp (const void * ap_obj);
 
+tiz_data_chan_t *
+tiz_port_get_fast_tunnel (const void * ap_obj);
+
+void
+tiz_port_reset_fast_tunnel (void * ap_obj);
+
 OMX_PTR
 tiz_port_get_eglimage (const void * ap_obj,
                        const OMX_BUFFERHEADERTYPE * ap_hdr);
@@ -36,6 +36,7 @@ extern "C" {
 #include "tizport.h"
 #include "tizapi_decls.h"
 #include "tizutils.h"
+#include "tizdatachan.h"
 #include "OMX_Component.h"
 #include "OMX_TizoniaExt.h"
 
@@ -52,6 +53,7 @@ struct tiz_port
   OMX_U32 tpid_;
   OMX_S32 claimed_count_;
   OMX_HANDLETYPE thdl_;
+  tiz_data_chan_t * p_fast_chan_; /* peer's in-process channel, if any */
   tiz_port_options_t opts_;
   tiz_pd_set_t flags_;
   OMX_PARAM_PORTDEFINITIONTYPE portdef_;
@@ -104,6 +106,8 @@ struct tiz_port_class
   OMX_DIRTYPE (*dir) (const void * ap_obj);
   OMX_PORTDOMAINTYPE (*domain) (const void * ap_obj);
   OMX_HANDLETYPE (*get_tunnel_comp) (const void * ap_obj);
+  tiz_data_chan_t * (*get_fast_tunnel) (const void * ap_obj);
+  void (*reset_fast_tunnel) (void * ap_obj);
   OMX_PTR (*get_eglimage)
   (const void * ap_obj, const OMX_BUFFERHEADERTYPE * ap_hdr);
   tiz_vector_t * (*get_hdrs_list) (void * ap_obj);
@@ -168,9 +168,23 @@ static OMX_ERRORTYPE
 enqueue_buffersready_msg (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                           OMX_BUFFERHEADERTYPE * ap_hdr, OMX_U32 a_pid)
 {
-  const tiz_prc_t * p_obj = ap_obj;
+  tiz_prc_t * p_obj = (tiz_prc_t *) ap_obj;
   tiz_prc_msg_t * p_msg = NULL;
   tiz_prc_msg_buffersready_t * p_msg_br = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (a_pid < _TIZ_PD_SETSIZE);
+
+  /* buffers_ready looks at all the buffers available on the port, so the
+     message that is already queued will take care of this one as well */
+  if (TIZ_PD_ISSET (a_pid, &(p_obj->br_pending_)))
+    {
+      TIZ_TRACE (ap_hdl, "BuffersReady : HEADER [%p] (already pending)",
+                 ap_hdr);
+      (void) __atomic_add_fetch (&(p_obj->br_suppressed_), 1,
+                                 __ATOMIC_RELAXED);
+      return OMX_ErrorNone;
+    }
 
   TIZ_TRACE (ap_hdl, "BuffersReady : HEADER [%p]", ap_hdr);
 
@@ -185,8 +199,15 @@ enqueue_buffersready_msg (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   p_msg_br->p_buffer = ap_hdr;
   p_msg_br->pid = a_pid;
 
-  /* Enqueueing with the lowest priority */
-  return tiz_srv_enqueue (ap_obj, p_msg, 1);
+  /* Enqueueing with the lowest priority. The header is the lookup key used
+     to find this message again on flush or disable */
+  if (OMX_ErrorNone
+      == (rc = tiz_srv_enqueue_keyed (ap_obj, p_msg, 1, ap_hdr)))
+    {
+      TIZ_PD_SET (a_pid, &(p_obj->br_pending_));
+      (void) __atomic_add_fetch (&(p_obj->br_enqueued_), 1, __ATOMIC_RELAXED);
+    }
+  return rc;
 }
 
 static inline OMX_U32
@@ -275,6 +296,9 @@ dispatch_br (void * ap_obj, OMX_PTR ap_msg)
   assert (p_msg_br);
   assert (p_msg_br->p_buffer);
 
+  /* From now on, a new arrival on this port needs a new message */
+  TIZ_PD_CLR (p_msg_br->pid, &(p_obj->br_pending_));
+
   p_krn = tiz_get_krn (p_msg->p_hdl);
   p_port = tiz_krn_get_port (p_krn, p_msg_br->pid);
   now = tiz_fsm_get_substate (tiz_get_fsm (p_msg->p_hdl));
@@ -513,10 +537,12 @@ remove_buffer_from_servant_queue (OMX_PTR ap_elem, OMX_S32 a_data1,
 
       if (p_hdr == p_msg_br->p_buffer)
         {
+          tiz_prc_t * p_prc = tiz_get_prc (p_msg->p_hdl);
           /* Found, return TRUE so this item will be removed from the servant
            * queue */
           TIZ_TRACE (p_msg->p_hdl,
                      "tiz_prc_msg_buffersready_t : Found HEADER [%p]", p_hdr);
+          TIZ_PD_CLR (p_msg_br->pid, &(p_prc->br_pending_));
           rc = OMX_TRUE;
         }
     }
@@ -537,7 +563,11 @@ remove_buffer_from_servant_queue (OMX_PTR ap_elem, OMX_S32 a_data1,
 static void *
 prc_ctor (void * ap_obj, va_list * app)
 {
-  return super_ctor (typeOf (ap_obj, "tizprc"), ap_obj, app);
+  tiz_prc_t * p_obj = super_ctor (typeOf (ap_obj, "tizprc"), ap_obj, app);
+  TIZ_PD_ZERO (&(p_obj->br_pending_));
+  p_obj->br_enqueued_ = 0;
+  p_obj->br_suppressed_ = 0;
+  return p_obj;
 }
 
 static void *
@@ -630,10 +660,12 @@ prc_remove_from_queue (const void * ap_obj, tiz_pq_func_f apf_func,
 {
   tiz_srv_t * p_obj = (tiz_srv_t *) ap_obj;
   /* Actual implementation is in the parent class */
-  /* Replace dummy parameters apf_func and a_data1 */
-  tiz_srv_super_remove_from_queue (typeOf (ap_obj, "tizprc"), p_obj,
-                                   &remove_buffer_from_servant_queue,
-                                   ETIZPrcMsgBuffersReady, ap_data2);
+  /* Replace dummy parameters apf_func and a_data1. BuffersReady messages are
+     enqueued using their header as key, so only those need to be visited */
+  assert (ap_data2);
+  tiz_srv_super_remove_keyed_from_queue (
+    typeOf (ap_obj, "tizprc"), p_obj, ap_data2,
+    &remove_buffer_from_servant_queue, ETIZPrcMsgBuffersReady, ap_data2);
 }
 
 static OMX_ERRORTYPE
@@ -816,6 +848,18 @@ tiz_prc_config_change (const void * ap_obj, OMX_U32 a_pid,
   return class->config_change (ap_obj, a_pid, a_config_idx);
 }
 
+void
+tiz_prc_br_info (const void * ap_obj, tiz_prc_br_info_t * ap_info)
+{
+  const tiz_prc_t * p_obj = ap_obj;
+  assert (p_obj);
+  assert (ap_info);
+  ap_info->enqueued
+    = __atomic_load_n (&(p_obj->br_enqueued_), __ATOMIC_RELAXED);
+  ap_info->suppressed
+    = __atomic_load_n (&(p_obj->br_suppressed_), __ATOMIC_RELAXED);
+}
+
 /*
  * tizprc_class
  */
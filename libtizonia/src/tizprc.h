@@ -61,6 +61,28 @@ tiz_prc_port_enable (const void * ap_obj, OMX_U32 a_pid);
 OMX_ERRORTYPE
 tiz_prc_config_change (const void * ap_obj, OMX_U32 a_pid,
                        OMX_INDEXTYPE a_config_idx);
+
+/**
+ * BuffersReady message statistics.
+ * @ingroup tizprc
+ */
+typedef struct tiz_prc_br_info tiz_prc_br_info_t;
+struct tiz_prc_br_info
+{
+  OMX_U64 enqueued;   /**< BuffersReady messages queued up */
+  OMX_U64 suppressed; /**< Buffer arrivals that did not need a message,
+                           because one was already queued for the port */
+};
+
+/**
+ * Retrieve the processor's BuffersReady message statistics. Only one
+ * BuffersReady message per port is outstanding at any time.
+ * @ingroup tizprc
+ * @param ap_obj The processor servant.
+ * @param ap_info The structure to be filled in.
+ */
+void
+tiz_prc_br_info (const void * ap_obj, tiz_prc_br_info_t * ap_info);
 #ifdef __cplusplus
 }
 #endif
@@ -37,12 +37,16 @@ extern "C" {
 
 #include "tizprc.h"
 #include "tizservant_decls.h"
+#include "tizutils.h"
 
 typedef struct tiz_prc tiz_prc_t;
 struct tiz_prc
 {
   /* Object */
   const tiz_srv_t _;
+  tiz_pd_set_t br_pending_; /* ports with a BuffersReady message queued */
+  OMX_U64 br_enqueued_;
+  OMX_U64 br_suppressed_;
 };
 
 OMX_ERRORTYPE
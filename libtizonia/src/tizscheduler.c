@@ -31,7 +31,12 @@
 #endif
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <OMX_Core.h>
 #include <OMX_Component.h>
@@ -55,6 +60,15 @@
 
 #define SCHED_OMX_DEFAULT_ROLE "default"
 #define SCHED_QUEUE_MAX_ITEMS 30
+#define SCHED_MSG_POOL_SIZE 64
+#define SCHED_MSG_POOL_NIL 0xFFFFFFFF
+#define SCHED_RCFILE_SECTION "ilcore"
+#define SCHED_POOL_RCFILE_KEY "scheduler-pool-threads"
+#define SCHED_POOL_MAX_THREADS 64
+#define SCHED_POOL_MSG_BUDGET 16
+#define SCHED_POOL_DEQUE_INITIAL_SIZE 16
+#define SCHED_POLICY_RCFILE_KEY "scheduling-policy"
+#define SCHED_POLICY_PLUGIN_KEY ".scheduling_policy"
 
 #ifndef S_SPLINT_S
 #define TIZ_COMP_INIT_MSG(hdl, msg, msgtype)         \
@@ -122,6 +136,50 @@ struct tiz_srv_group
   OMX_COMPONENTTYPE * p_hdl;
 };
 
+typedef struct tiz_sched_msg_pool tiz_sched_msg_pool_t;
+typedef struct tiz_sched_pool tiz_sched_pool_t;
+
+/* The servants, in the order they are visited on each scheduling round */
+typedef enum tiz_sched_srv_id tiz_sched_srv_id_t;
+enum tiz_sched_srv_id
+{
+  ETIZSchedSrvFsm = 0,
+  ETIZSchedSrvKer,
+  ETIZSchedSrvPrc,
+  ETIZSchedSrvMax,
+};
+
+typedef struct tiz_sched_srv_stats tiz_sched_srv_stats_t;
+struct tiz_sched_srv_stats
+{
+  OMX_U64 ticks;
+  OMX_U64 nsecs;       /* time spent in tiz_srv_tick */
+  OMX_U64 preemptions; /* turns that ended while the servant was still ready */
+};
+
+/* A servant scheduling policy. On each round, every ready servant is given a
+   turn of up to 'budget' consecutive ticks. A turn also ends early when a
+   scheduler message is pending, if the servant 'yields_to_msgs'. With
+   'adaptive' set, the processor's budget is halved every time its turn left
+   messages waiting, and doubled back (up to 'budget') otherwise. */
+typedef struct tiz_sched_policy tiz_sched_policy_t;
+struct tiz_sched_policy
+{
+  const char * p_name;
+  OMX_U32 budget[ETIZSchedSrvMax];
+  bool yields_to_msgs[ETIZSchedSrvMax];
+  bool adaptive;
+};
+
+static const tiz_sched_policy_t tiz_sched_policy_tbl[] = {
+  /* One tick per servant and round; the round is abandoned as soon as there
+     are messages in the queue */
+  {"round-robin", {1, 1, 1}, {true, true, true}, false},
+  /* Keep the processor running while it has buffers to work on; command
+     handling is delayed by at most one (adaptive) processor turn */
+  {"processor-priority", {1, 1, 32}, {true, true, false}, true},
+};
+
 typedef struct tiz_scheduler tiz_scheduler_t;
 struct tiz_scheduler
 {
@@ -132,7 +190,15 @@ struct tiz_scheduler
   OMX_S32 thread_id;
   tiz_mutex_t mutex;
   tiz_sem_t sem;
-  tiz_queue_t * p_queue;
+  tiz_lfqueue_t * p_queue;
+  tiz_sched_msg_pool_t * p_msg_pool;
+  tiz_sched_pool_t * p_pool; /* NULL when the scheduler owns its thread */
+  const tiz_sched_policy_t * p_policy;
+  OMX_U32 prc_budget; /* current processor budget, for adaptive policies */
+  OMX_U64 msgs_delayed; /* processor turns that left messages waiting */
+  tiz_sched_srv_stats_t srv_stats[ETIZSchedSrvMax];
+  OMX_S32 scheduled; /* Pool mode only: non-zero while the scheduler is
+                        queued in, or being run by, a pool worker */
   tiz_soa_t * p_soa;
   tiz_os_t * p_objsys;
   OMX_S32 error;
@@ -175,6 +241,8 @@ enum tiz_sched_msg_class
   ETIZSchedMsgEvIo,
   ETIZSchedMsgEvTimer,
   ETIZSchedMsgEvStat,
+  ETIZSchedMsgEmptyBuffers,
+  ETIZSchedMsgFillBuffers,
   ETIZSchedMsgMax,
 };
 
@@ -273,6 +341,14 @@ struct tiz_sched_msg_emptyfillbuffer
   OMX_BUFFERHEADERTYPE * p_hdr;
 };
 
+typedef struct tiz_sched_msg_emptyfillbuffers
+  tiz_sched_msg_emptyfillbuffers_t;
+struct tiz_sched_msg_emptyfillbuffers
+{
+  OMX_U32 nhdrs;
+  OMX_BUFFERHEADERTYPE * p_hdrs[TIZ_COMP_MAX_BUFFER_BATCH];
+};
+
 typedef struct tiz_sched_msg_tunnelrequest tiz_sched_msg_tunnelrequest_t;
 struct tiz_sched_msg_tunnelrequest
 {
@@ -370,6 +446,7 @@ struct tiz_sched_msg
     tiz_sched_msg_allocbuffer_t ab;
     tiz_sched_msg_freebuffer_t fb;
     tiz_sched_msg_emptyfillbuffer_t efb;
+    tiz_sched_msg_emptyfillbuffers_t efbs;
     tiz_sched_msg_tunnelrequest_t tr;
     tiz_sched_msg_plg_event_t pe;
     tiz_sched_msg_regroles_t rr;
@@ -383,6 +460,60 @@ struct tiz_sched_msg
   };
 };
 
+/* Scheduler messages are allocated on the caller's thread and freed on the
+   scheduler's thread. This pool is a lock-free LIFO of pre-allocated
+   messages; the head packs the index of the top node with an ABA tag. When the
+   pool runs dry, messages are allocated from the heap. */
+typedef struct tiz_sched_msg_node tiz_sched_msg_node_t;
+struct tiz_sched_msg_node
+{
+  tiz_sched_msg_t msg; /* must be the first member */
+  uint32_t next;
+};
+
+struct tiz_sched_msg_pool
+{
+  uint64_t head TIZ_CACHELINE_ALIGNED;
+  uint64_t hits TIZ_CACHELINE_ALIGNED;
+  uint64_t misses;
+  tiz_sched_msg_node_t nodes[SCHED_MSG_POOL_SIZE];
+};
+
+/* When 'scheduler-pool-threads' is set in tizonia.conf, schedulers do not get
+   a thread of their own. Instead, a scheduler with pending messages becomes a
+   task that is queued in one of the workers of a process-wide pool. Each
+   worker owns a deque of tasks; idle workers steal from the other end of
+   their peers' deques. A scheduler is queued at most once at any time (see
+   'scheduled'), so its messages are still processed one at a time and in
+   order. */
+typedef struct tiz_sched_pool_worker tiz_sched_pool_worker_t;
+struct tiz_sched_pool_worker
+{
+  tiz_sched_pool_t * p_pool;
+  tiz_thread_t thread;
+  OMX_S32 thread_id;
+  tiz_mutex_t mutex; /* protects the deque */
+  tiz_scheduler_t ** pp_tasks;
+  OMX_U32 capacity;
+  OMX_U32 head;
+  OMX_U32 len;
+};
+
+struct tiz_sched_pool
+{
+  tiz_mutex_t mutex;
+  tiz_cond_t cond;
+  OMX_S32 target;    /* number of threads configured */
+  OMX_S32 nthreads;  /* number of workers started, may exceed target */
+  OMX_S32 nblocked;  /* workers waiting on a blocking API call */
+  OMX_S32 nsleeping; /* workers waiting for tasks */
+  OMX_S32 ntasks;    /* tasks queued across all workers */
+  OMX_U32 next;      /* round-robin index for submissions from non-workers */
+  OMX_U32 nusers;    /* schedulers attached to the pool */
+  bool stop;
+  tiz_sched_pool_worker_t workers[SCHED_POOL_MAX_THREADS];
+};
+
 /* Forward declarations */
 static OMX_ERRORTYPE
 do_init (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
@@ -440,6 +571,10 @@ static OMX_ERRORTYPE
 do_etmr (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
 static OMX_ERRORTYPE
 do_estat (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
+static OMX_ERRORTYPE
+do_etbs (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
+static OMX_ERRORTYPE
+do_ftbs (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
 
 static OMX_ERRORTYPE
 init_servants (tiz_scheduler_t *, tiz_sched_msg_t *);
@@ -457,6 +592,14 @@ static OMX_ERRORTYPE
 restore_hooks (tiz_scheduler_t * ap_sched, const OMX_U32 a_role_pos);
 static void
 delete_hooks (tiz_scheduler_t * ap_sched, tiz_map_t * ap_map);
+static OMX_ERRORTYPE
+sched_pool_notify (tiz_scheduler_t * ap_sched);
+static bool
+sched_pool_is_worker (tiz_sched_pool_t * ap_pool);
+static void
+sched_pool_block_begin (tiz_sched_pool_t * ap_pool);
+static void
+sched_pool_block_end (tiz_sched_pool_t * ap_pool);
 
 typedef OMX_ERRORTYPE (*tiz_sched_msg_dispatch_f) (tiz_scheduler_t * ap_sched,
                                                    tiz_sched_state_t * ap_state,
@@ -466,6 +609,7 @@ static const tiz_sched_msg_dispatch_f tiz_sched_msg_to_fnt_tbl[] = {
   do_sconfig, do_gei,    do_gs,    do_tr,   do_ub,     do_ab,     do_fb,
   do_etb,     do_ftb,    do_scbs,  do_uei,  do_cre,    do_plgevt, do_rr,
   do_rt,      do_rph,    do_reh,   do_rreh, do_eio,    do_etmr,   do_estat,
+  do_etbs,    do_ftbs,
 };
 
 static OMX_BOOL
@@ -509,6 +653,8 @@ static tiz_sched_msg_str_t tiz_sched_msg_to_str_tbl[] = {
   {ETIZSchedMsgEvIo, "{ETIZSchedMsgEvIo,"},
   {ETIZSchedMsgEvTimer, "ETIZSchedMsgEvTimer"},
   {ETIZSchedMsgEvStat, "ETIZSchedMsgEvStat"},
+  {ETIZSchedMsgEmptyBuffers, "ETIZSchedMsgEmptyBuffers"},
+  {ETIZSchedMsgFillBuffers, "ETIZSchedMsgFillBuffers"},
   {ETIZSchedMsgMax, "ETIZSchedMsgMax"},
 };
 
@@ -569,6 +715,13 @@ static OMX_BOOL tiz_sched_blocking_apis_tbl[] = {
   OMX_FALSE,    /* ETIZSchedMsgEvIo */
   OMX_FALSE,    /* ETIZSchedMsgEvTimer */
   OMX_FALSE,    /* ETIZSchedMsgEvStat */
+#ifdef EFB_FTB_SHOULD_BLOCK
+  OMX_TRUE, /* ETIZSchedMsgEmptyBuffers */
+  OMX_TRUE, /* ETIZSchedMsgFillBuffers */
+#else
+  OMX_FALSE, /* ETIZSchedMsgEmptyBuffers */
+  OMX_FALSE, /* ETIZSchedMsgFillBuffers */
+#endif
   OMX_BOOL_MAX, /* ETIZSchedMsgMax */
 };
 
@@ -771,7 +924,20 @@ send_msg_blocking (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
   assert (ap_msg);
   assert (ap_sched);
   ap_msg->will_block = OMX_TRUE;
-  tiz_check_omx_ret_oom (tiz_queue_send (ap_sched->p_queue, ap_msg));
+  tiz_check_omx_ret_oom (tiz_lfqueue_send (ap_sched->p_queue, ap_msg));
+  if (ap_sched->p_pool)
+    {
+      tiz_check_omx (sched_pool_notify (ap_sched));
+      if (sched_pool_is_worker (ap_sched->p_pool))
+        {
+          /* A component running on the pool is calling into another
+             component; make sure the pool does not run out of workers */
+          sched_pool_block_begin (ap_sched->p_pool);
+          tiz_check_omx_ret_oom (tiz_sem_wait (&(ap_sched->sem)));
+          sched_pool_block_end (ap_sched->p_pool);
+          return ap_sched->error;
+        }
+    }
   tiz_check_omx_ret_oom (tiz_sem_wait (&(ap_sched->sem)));
   return ap_sched->error;
 }
@@ -782,7 +948,8 @@ send_msg_non_blocking (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
   assert (ap_msg);
   assert (ap_sched);
   ap_msg->will_block = OMX_FALSE;
-  return tiz_queue_send (ap_sched->p_queue, ap_msg);
+  tiz_check_omx (tiz_lfqueue_send (ap_sched->p_queue, ap_msg));
+  return ap_sched->p_pool ? sched_pool_notify (ap_sched) : OMX_ErrorNone;
 }
 
 static inline OMX_ERRORTYPE
@@ -794,7 +961,8 @@ send_msg (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
   assert (ap_sched);
   assert (ap_msg);
 
-  if (tid == ap_sched->thread_id && ap_msg->class != ETIZSchedMsgPluggableEvent)
+  if (tid == __atomic_load_n (&(ap_sched->thread_id), __ATOMIC_RELAXED)
+      && ap_msg->class != ETIZSchedMsgPluggableEvent)
     {
       TIZ_WARN (ap_sched->child.p_hdl,
                 "WARNING: (API %s called from IL callback context...)",
@@ -1657,6 +1825,169 @@ do_estat (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
                              p_msg_estat->id, p_msg_estat->events);
 }
 
+static OMX_ERRORTYPE
+do_efbs (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg,
+         const OMX_DIRTYPE a_dir)
+{
+  tiz_sched_msg_emptyfillbuffers_t * p_msg_efbs = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  OMX_U32 i = 0;
+
+  assert (ap_sched);
+  assert (ap_msg);
+  p_msg_efbs = &(ap_msg->efbs);
+  assert (p_msg_efbs);
+  assert (p_msg_efbs->nhdrs <= TIZ_COMP_MAX_BUFFER_BATCH);
+
+  /* Each header goes through the fsm individually, so that the usual state and
+     port checks are applied to every one of them. The first error found is
+     reported, but the rest of the batch is still delivered. */
+  for (i = 0; i < p_msg_efbs->nhdrs; ++i)
+    {
+      OMX_ERRORTYPE hdr_rc
+        = (OMX_DirInput == a_dir
+             ? tiz_api_EmptyThisBuffer (ap_sched->child.p_fsm, ap_msg->p_hdl,
+                                        p_msg_efbs->p_hdrs[i])
+             : tiz_api_FillThisBuffer (ap_sched->child.p_fsm, ap_msg->p_hdl,
+                                       p_msg_efbs->p_hdrs[i]));
+      if (OMX_ErrorNone != hdr_rc)
+        {
+          TIZ_ERROR (ap_sched->child.p_hdl, "[%s] : HEADER [%p] (%d of %d)",
+                     tiz_err_to_str (hdr_rc), p_msg_efbs->p_hdrs[i], i + 1,
+                     p_msg_efbs->nhdrs);
+          if (OMX_ErrorNone == rc)
+            {
+              rc = hdr_rc;
+            }
+        }
+    }
+
+  return rc;
+}
+
+static OMX_ERRORTYPE
+do_etbs (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
+         tiz_sched_msg_t * ap_msg)
+{
+  assert (ap_state && ETIZSchedStateStarted == *ap_state);
+  return do_efbs (ap_sched, ap_msg, OMX_DirInput);
+}
+
+static OMX_ERRORTYPE
+do_ftbs (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
+         tiz_sched_msg_t * ap_msg)
+{
+  assert (ap_state && ETIZSchedStateStarted == *ap_state);
+  return do_efbs (ap_sched, ap_msg, OMX_DirOutput);
+}
+
+static inline uint64_t
+msg_pool_pack (const uint32_t a_idx, const uint32_t a_tag)
+{
+  return ((uint64_t) a_tag << 32) | a_idx;
+}
+
+static tiz_sched_msg_pool_t *
+msg_pool_init (void)
+{
+  tiz_sched_msg_pool_t * p_pool = NULL;
+  uint32_t i = 0;
+
+  if (0 != posix_memalign ((void **) &p_pool, TIZ_CACHELINE_SIZE,
+                           sizeof (tiz_sched_msg_pool_t)))
+    {
+      return NULL;
+    }
+
+  tiz_mem_set (p_pool, 0, sizeof (tiz_sched_msg_pool_t));
+  for (i = 0; i < SCHED_MSG_POOL_SIZE; ++i)
+    {
+      p_pool->nodes[i].next
+        = (i + 1 < SCHED_MSG_POOL_SIZE) ? i + 1 : SCHED_MSG_POOL_NIL;
+    }
+  p_pool->head = msg_pool_pack (0, 0);
+  return p_pool;
+}
+
+static void
+msg_pool_destroy (tiz_sched_msg_pool_t * ap_pool)
+{
+  tiz_mem_free (ap_pool);
+}
+
+static inline bool
+msg_pool_owns (const tiz_sched_msg_pool_t * ap_pool,
+               const tiz_sched_msg_t * ap_msg)
+{
+  const char * p_msg = (const char *) ap_msg;
+  return (ap_pool && p_msg >= (const char *) &(ap_pool->nodes[0])
+          && p_msg < (const char *) &(ap_pool->nodes[SCHED_MSG_POOL_SIZE]));
+}
+
+static tiz_sched_msg_t *
+msg_pool_get (tiz_sched_msg_pool_t * ap_pool)
+{
+  uint64_t head = 0;
+  uint64_t new_head = 0;
+  uint32_t idx = 0;
+
+  if (!ap_pool)
+    {
+      return NULL;
+    }
+
+  head = __atomic_load_n (&(ap_pool->head), __ATOMIC_ACQUIRE);
+  do
+    {
+      idx = (uint32_t) head;
+      if (SCHED_MSG_POOL_NIL == idx)
+        {
+          (void) __atomic_add_fetch (&(ap_pool->misses), 1, __ATOMIC_RELAXED);
+          return NULL;
+        }
+      new_head = msg_pool_pack (
+        __atomic_load_n (&(ap_pool->nodes[idx].next), __ATOMIC_RELAXED),
+        (uint32_t) (head >> 32) + 1);
+    }
+  while (!__atomic_compare_exchange_n (&(ap_pool->head), &head, new_head, true,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  (void) __atomic_add_fetch (&(ap_pool->hits), 1, __ATOMIC_RELAXED);
+  return &(ap_pool->nodes[idx].msg);
+}
+
+static void
+msg_pool_put (tiz_sched_msg_pool_t * ap_pool, tiz_sched_msg_t * ap_msg)
+{
+  tiz_sched_msg_node_t * p_node = (tiz_sched_msg_node_t *) ap_msg;
+  const uint32_t idx = p_node - ap_pool->nodes;
+  uint64_t head = __atomic_load_n (&(ap_pool->head), __ATOMIC_ACQUIRE);
+
+  assert (idx < SCHED_MSG_POOL_SIZE);
+
+  do
+    {
+      __atomic_store_n (&(p_node->next), (uint32_t) head, __ATOMIC_RELAXED);
+    }
+  while (!__atomic_compare_exchange_n (
+    &(ap_pool->head), &head, msg_pool_pack (idx, (uint32_t) (head >> 32) + 1),
+    true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+static inline void
+free_scheduler_message (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
+{
+  assert (ap_sched);
+  if (msg_pool_owns (ap_sched->p_msg_pool, ap_msg))
+    {
+      msg_pool_put (ap_sched->p_msg_pool, ap_msg);
+    }
+  else
+    {
+      tiz_mem_free (ap_msg);
+    }
+}
+
 /* NOTE: Start ignoring splint warnings in this section of code */
 /*@ignore@*/
 static inline tiz_sched_msg_t *
@@ -1668,8 +1999,16 @@ init_scheduler_message (OMX_HANDLETYPE ap_hdl,
   assert (ap_hdl);
   assert (a_msg_class < ETIZSchedMsgMax);
 
-  if (!(p_msg
-        = (tiz_sched_msg_t *) tiz_mem_calloc (1, sizeof (tiz_sched_msg_t))))
+  if ((p_msg = msg_pool_get (get_sched (ap_hdl)->p_msg_pool)))
+    {
+      tiz_mem_set (p_msg, 0, sizeof (tiz_sched_msg_t));
+    }
+  else
+    {
+      p_msg = (tiz_sched_msg_t *) tiz_mem_calloc (1, sizeof (tiz_sched_msg_t));
+    }
+
+  if (!p_msg)
     {
       TIZ_ERROR (ap_hdl,
                  "[OMX_ErrorInsufficientResources] : "
@@ -1948,7 +2287,7 @@ sched_SetConfig (OMX_HANDLETYPE ap_hdl, OMX_INDEXTYPE a_index,
       if (!(p_msg_sconf->p_struct
             = tiz_mem_calloc (1, (*(OMX_U32 *) ap_struct))))
         {
-          tiz_mem_free (p_msg);
+          free_scheduler_message (p_sched, p_msg);
           TIZ_ERROR (ap_hdl,
                      "[OMX_ErrorInsufficientResources] : "
                      "(While allocating memory for config struct)");
@@ -2324,16 +2663,88 @@ dispatch_msg (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
   /* Return error to client */
   ap_sched->error = rc;
 
-  tiz_mem_free (ap_msg);
+  free_scheduler_message (ap_sched, ap_msg);
 
   return signal_client;
 }
 
+static inline OMX_U64
+sched_now_nsecs (void)
+{
+  struct timespec ts;
+  (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (OMX_U64) ts.tv_sec * 1000000000ULL + (OMX_U64) ts.tv_nsec;
+}
+
+static OMX_ERRORTYPE
+tick_servant (tiz_scheduler_t * ap_sched, const tiz_sched_srv_id_t a_id,
+              void * ap_srv, bool * ap_ticked)
+{
+  const tiz_sched_policy_t * p_policy = NULL;
+  tiz_sched_srv_stats_t * p_stats = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  OMX_U32 budget = 0;
+  OMX_U32 nticks = 0;
+  OMX_U64 start = 0;
+  bool adapt = false;
+
+  assert (ap_sched);
+  assert (ap_srv);
+  assert (ap_ticked);
+  assert (a_id < ETIZSchedSrvMax);
+
+  if (!tiz_srv_is_ready (ap_srv))
+    {
+      return OMX_ErrorNone;
+    }
+
+  p_policy = ap_sched->p_policy;
+  p_stats = &(ap_sched->srv_stats[a_id]);
+  adapt = (ETIZSchedSrvPrc == a_id && p_policy->adaptive);
+  budget = adapt ? ap_sched->prc_budget : p_policy->budget[a_id];
+  start = sched_now_nsecs ();
+
+  do
+    {
+      rc = tiz_srv_tick (ap_srv);
+      ++nticks;
+    }
+  while (OMX_ErrorNone == rc && nticks < budget && tiz_srv_is_ready (ap_srv)
+         && !(p_policy->yields_to_msgs[a_id]
+              && tiz_lfqueue_length (ap_sched->p_queue) > 0));
+
+  p_stats->ticks += nticks;
+  p_stats->nsecs += sched_now_nsecs () - start;
+  if (OMX_ErrorNone == rc && tiz_srv_is_ready (ap_srv))
+    {
+      p_stats->preemptions++;
+    }
+
+  if (adapt)
+    {
+      if (tiz_lfqueue_length (ap_sched->p_queue) > 0)
+        {
+          ap_sched->msgs_delayed++;
+          ap_sched->prc_budget = MAX (1, ap_sched->prc_budget / 2);
+        }
+      else
+        {
+          ap_sched->prc_budget
+            = MIN (p_policy->budget[a_id], ap_sched->prc_budget * 2);
+        }
+    }
+
+  *ap_ticked = true;
+  return rc;
+}
+
 static void
 schedule_servants (tiz_scheduler_t * ap_sched, const tiz_sched_state_t ap_state)
 {
-  OMX_PTR * p_ready = NULL;
+  void * srvs[ETIZSchedSrvMax];
   OMX_ERRORTYPE rc = OMX_ErrorNone;
+  bool ticked = false;
+  OMX_U32 i = 0;
 
   assert (ap_sched);
   assert (ETIZSchedStateStopped < ap_state);
@@ -2347,39 +2758,30 @@ schedule_servants (tiz_scheduler_t * ap_sched, const tiz_sched_state_t ap_state)
       return;
     }
 
-  /* Find the servant that is ready */
-  /* Round-robin policy: fsm->ker->prc */
+  srvs[ETIZSchedSrvFsm] = ap_sched->child.p_fsm;
+  srvs[ETIZSchedSrvKer] = ap_sched->child.p_ker;
+  srvs[ETIZSchedSrvPrc] = ap_sched->child.p_prc;
+
+  /* Find the servants that are ready, and give each one a turn, as per the
+     scheduling policy: fsm->ker->prc */
   TIZ_TRACE (ap_sched->child.p_hdl, "READY fsm [%s] ker [%s] prc [%s]",
              tiz_srv_is_ready (ap_sched->child.p_fsm) ? "YES" : "NO",
              tiz_srv_is_ready (ap_sched->child.p_ker) ? "YES" : "NO",
              tiz_srv_is_ready (ap_sched->child.p_prc) ? "YES" : "NO");
   do
     {
-      p_ready = NULL;
-      if (tiz_srv_is_ready (ap_sched->child.p_fsm))
-        {
-          p_ready = ap_sched->child.p_fsm;
-          rc = tiz_srv_tick (p_ready);
-        }
-
-      if (OMX_ErrorNone == rc && tiz_srv_is_ready (ap_sched->child.p_ker))
-        {
-          p_ready = ap_sched->child.p_ker;
-          rc = tiz_srv_tick (p_ready);
-        }
-
-      if (OMX_ErrorNone == rc && tiz_srv_is_ready (ap_sched->child.p_prc))
+      ticked = false;
+      for (i = 0; i < ETIZSchedSrvMax && OMX_ErrorNone == rc; ++i)
         {
-          p_ready = ap_sched->child.p_prc;
-          rc = tiz_srv_tick (p_ready);
+          rc = tick_servant (ap_sched, i, srvs[i], &ticked);
         }
 
-      if (tiz_queue_length (ap_sched->p_queue) > 0)
+      if (tiz_lfqueue_length (ap_sched->p_queue) > 0)
         {
           break;
         }
     }
-  while (p_ready && (OMX_ErrorNone == rc));
+  while (ticked && (OMX_ErrorNone == rc));
 
   /*   if (OMX_ErrorNone != rc) */
   /*     { */
@@ -2389,6 +2791,86 @@ schedule_servants (tiz_scheduler_t * ap_sched, const tiz_sched_state_t ap_state)
   /*     } */
 }
 
+static const tiz_sched_policy_t *
+find_sched_policy (const char * ap_name)
+{
+  const OMX_S32 count
+    = sizeof (tiz_sched_policy_tbl) / sizeof (tiz_sched_policy_t);
+  OMX_S32 i = 0;
+
+  if (ap_name)
+    {
+      for (i = 0; i < count; ++i)
+        {
+          if (0 == strcmp (tiz_sched_policy_tbl[i].p_name, ap_name))
+            {
+              return &(tiz_sched_policy_tbl[i]);
+            }
+        }
+    }
+  return NULL;
+}
+
+static void
+configure_sched_policy (tiz_scheduler_t * ap_sched)
+{
+  char fqd_key[OMX_MAX_STRINGNAME_SIZE];
+  const char * p_name = NULL;
+
+  assert (ap_sched);
+
+  /* A per-component setting ('OMX.component.name.scheduling_policy' in the
+     [plugins] section) takes precedence over the [ilcore] default */
+  strncpy (fqd_key, ap_sched->cname, OMX_MAX_STRINGNAME_SIZE - 1);
+  fqd_key[OMX_MAX_STRINGNAME_SIZE - 1] = '\0';
+  strncat (fqd_key, SCHED_POLICY_PLUGIN_KEY,
+           OMX_MAX_STRINGNAME_SIZE - strlen (fqd_key) - 1);
+
+  if (!(p_name = tiz_rcfile_get_value ("plugins", fqd_key)))
+    {
+      p_name = tiz_rcfile_get_value (SCHED_RCFILE_SECTION,
+                                     SCHED_POLICY_RCFILE_KEY);
+    }
+
+  if (!(ap_sched->p_policy = find_sched_policy (p_name)))
+    {
+      if (p_name)
+        {
+          TIZ_LOG (TIZ_PRIORITY_WARN,
+                   "[%s] Unknown scheduling policy [%s], using [%s]",
+                   ap_sched->cname, p_name, tiz_sched_policy_tbl[0].p_name);
+        }
+      ap_sched->p_policy = &(tiz_sched_policy_tbl[0]);
+    }
+
+  ap_sched->prc_budget = ap_sched->p_policy->budget[ETIZSchedSrvPrc];
+  ap_sched->msgs_delayed = 0;
+  tiz_mem_set (ap_sched->srv_stats, 0, sizeof (ap_sched->srv_stats));
+}
+
+static void
+log_sched_stats (const tiz_scheduler_t * ap_sched)
+{
+  static const char * srv_names[ETIZSchedSrvMax] = {"fsm", "ker", "prc"};
+  OMX_U32 i = 0;
+
+  assert (ap_sched);
+
+  for (i = 0; i < ETIZSchedSrvMax; ++i)
+    {
+      const tiz_sched_srv_stats_t * p_stats = &(ap_sched->srv_stats[i]);
+      TIZ_LOG (TIZ_PRIORITY_TRACE,
+               "[%s] policy [%s] %s : ticks [%llu] time [%llu] us "
+               "preemptions [%llu]",
+               ap_sched->cname, ap_sched->p_policy->p_name, srv_names[i],
+               (unsigned long long) p_stats->ticks,
+               (unsigned long long) p_stats->nsecs / 1000,
+               (unsigned long long) p_stats->preemptions);
+    }
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s] messages delayed by the processor [%llu]",
+           ap_sched->cname, (unsigned long long) ap_sched->msgs_delayed);
+}
+
 static void *
 il_sched_thread_func (void * p_arg)
 {
@@ -2398,12 +2880,12 @@ il_sched_thread_func (void * p_arg)
 
   assert (p_sched);
 
-  p_sched->thread_id = tiz_thread_id ();
+  __atomic_store_n (&(p_sched->thread_id), tiz_thread_id (), __ATOMIC_RELAXED);
   tiz_check_omx_ret_null (tiz_sem_post (&(p_sched->sem)));
 
   for (;;)
     {
-      tiz_check_omx_ret_null (tiz_queue_receive (p_sched->p_queue, &p_data));
+      tiz_check_omx_ret_null (tiz_lfqueue_receive (p_sched->p_queue, &p_data));
 
       assert (p_data);
       signal_client
@@ -2425,52 +2907,611 @@ il_sched_thread_func (void * p_arg)
   return NULL;
 }
 
+static tiz_sched_pool_t * gp_sched_pool = NULL;
+static OMX_S32 g_sched_pool_threads = 0;
+static tiz_mutex_t g_sched_pool_mutex;
+static OMX_ERRORTYPE g_sched_pool_init_rc = OMX_ErrorNone;
+static pthread_once_t g_sched_pool_once = PTHREAD_ONCE_INIT;
+
 static OMX_ERRORTYPE
-start_scheduler (tiz_scheduler_t * ap_sched)
+deque_reserve (tiz_sched_pool_worker_t * ap_worker)
 {
-  assert (ap_sched);
+  tiz_scheduler_t ** pp_tasks = NULL;
+  OMX_U32 capacity = 0;
+  OMX_U32 i = 0;
 
-  /* Create scheduler thread */
-  tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_sched->mutex)));
-  tiz_check_omx_ret_oom (tiz_thread_create (&(ap_sched->thread), 0, 0,
-                                            il_sched_thread_func, ap_sched));
+  assert (ap_worker);
 
-  tiz_check_omx_ret_oom (tiz_mutex_unlock (&(ap_sched->mutex)));
-  tiz_check_omx_ret_oom (tiz_sem_wait (&(ap_sched->sem)));
+  if (ap_worker->len < ap_worker->capacity)
+    {
+      return OMX_ErrorNone;
+    }
 
+  capacity = ap_worker->capacity ? ap_worker->capacity * 2
+                                 : SCHED_POOL_DEQUE_INITIAL_SIZE;
+  tiz_check_null_ret_oom (
+    (pp_tasks = tiz_mem_calloc (capacity, sizeof (tiz_scheduler_t *))));
+  for (i = 0; i < ap_worker->len; ++i)
+    {
+      pp_tasks[i]
+        = ap_worker->pp_tasks[(ap_worker->head + i) % ap_worker->capacity];
+    }
+  tiz_mem_free (ap_worker->pp_tasks);
+  ap_worker->pp_tasks = pp_tasks;
+  ap_worker->capacity = capacity;
+  ap_worker->head = 0;
   return OMX_ErrorNone;
 }
 
-static void
-delete_scheduler (tiz_scheduler_t * ap_sched)
+static OMX_ERRORTYPE
+deque_push (tiz_sched_pool_worker_t * ap_worker, tiz_scheduler_t * ap_sched,
+            const bool a_front)
 {
-  OMX_PTR p_result = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_worker);
   assert (ap_sched);
-  (void) tiz_thread_join (&(ap_sched->thread), &p_result);
-  delete_roles (ap_sched);
-  delete_hooks (ap_sched, ap_sched->child.p_alloc_hooks_map);
-  ap_sched->child.p_alloc_hooks_map = NULL;
-  delete_hooks (ap_sched, ap_sched->child.p_eglimage_hooks_map);
-  ap_sched->child.p_eglimage_hooks_map = NULL;
-  (void) tiz_mutex_destroy (&(ap_sched->mutex));
-  (void) tiz_sem_destroy (&(ap_sched->sem));
-  tiz_queue_destroy (ap_sched->p_queue);
-  ap_sched->p_queue = NULL;
-  tiz_mem_free (ap_sched);
+
+  tiz_check_omx (tiz_mutex_lock (&(ap_worker->mutex)));
+  if (OMX_ErrorNone == (rc = deque_reserve (ap_worker)))
+    {
+      if (a_front)
+        {
+          ap_worker->head
+            = (ap_worker->head + ap_worker->capacity - 1) % ap_worker->capacity;
+          ap_worker->pp_tasks[ap_worker->head] = ap_sched;
+        }
+      else
+        {
+          ap_worker->pp_tasks[(ap_worker->head + ap_worker->len)
+                              % ap_worker->capacity]
+            = ap_sched;
+        }
+      ap_worker->len++;
+    }
+  tiz_check_omx (tiz_mutex_unlock (&(ap_worker->mutex)));
+  return rc;
 }
 
 static tiz_scheduler_t *
-instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
+deque_pop (tiz_sched_pool_worker_t * ap_worker, const bool a_front)
 {
   tiz_scheduler_t * p_sched = NULL;
-  int len = 0;
 
-  assert (ap_hdl);
+  assert (ap_worker);
 
-  if (!(p_sched = tiz_mem_calloc (1, sizeof (tiz_scheduler_t))))
+  tiz_check_omx_ret_null (tiz_mutex_lock (&(ap_worker->mutex)));
+  if (ap_worker->len > 0)
     {
-      TIZ_LOG (TIZ_PRIORITY_ERROR,
-               "[OMX_ErrorInsufficientResources] : "
+      if (a_front)
+        {
+          p_sched = ap_worker->pp_tasks[ap_worker->head];
+          ap_worker->head = (ap_worker->head + 1) % ap_worker->capacity;
+        }
+      else
+        {
+          p_sched = ap_worker->pp_tasks[(ap_worker->head + ap_worker->len - 1)
+                                        % ap_worker->capacity];
+        }
+      ap_worker->len--;
+    }
+  tiz_check_omx_ret_null (tiz_mutex_unlock (&(ap_worker->mutex)));
+  return p_sched;
+}
+
+static tiz_sched_pool_worker_t *
+sched_pool_current_worker (tiz_sched_pool_t * ap_pool)
+{
+  const OMX_S32 tid = tiz_thread_id ();
+  const OMX_S32 nthreads
+    = __atomic_load_n (&(ap_pool->nthreads), __ATOMIC_ACQUIRE);
+  OMX_S32 i = 0;
+
+  for (i = 0; i < nthreads; ++i)
+    {
+      if (tid
+          == __atomic_load_n (&(ap_pool->workers[i].thread_id),
+                              __ATOMIC_RELAXED))
+        {
+          return &(ap_pool->workers[i]);
+        }
+    }
+  return NULL;
+}
+
+static bool
+sched_pool_is_worker (tiz_sched_pool_t * ap_pool)
+{
+  assert (ap_pool);
+  return (NULL != sched_pool_current_worker (ap_pool));
+}
+
+static OMX_ERRORTYPE
+sched_pool_submit (tiz_sched_pool_t * ap_pool, tiz_scheduler_t * ap_sched,
+                   const bool a_requeue)
+{
+  tiz_sched_pool_worker_t * p_worker = NULL;
+
+  assert (ap_pool);
+  assert (ap_sched);
+
+  /* Workers keep the tasks they generate (locality); other threads spread
+     them round-robin */
+  if (!(p_worker = sched_pool_current_worker (ap_pool)))
+    {
+      const OMX_U32 idx = __atomic_fetch_add (&(ap_pool->next), 1,
+                                              __ATOMIC_RELAXED);
+      p_worker
+        = &(ap_pool->workers[idx % __atomic_load_n (&(ap_pool->nthreads),
+                                                    __ATOMIC_ACQUIRE)]);
+    }
+
+  /* Schedulers that used up their message budget go to the front, i.e. the
+     end that the owner drains last and thieves steal from first */
+  tiz_check_omx (deque_push (p_worker, ap_sched, a_requeue));
+
+  (void) __atomic_add_fetch (&(ap_pool->ntasks), 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&(ap_pool->nsleeping), __ATOMIC_SEQ_CST) > 0)
+    {
+      tiz_check_omx (tiz_mutex_lock (&(ap_pool->mutex)));
+      (void) tiz_cond_signal (&(ap_pool->cond));
+      tiz_check_omx (tiz_mutex_unlock (&(ap_pool->mutex)));
+    }
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+sched_pool_notify (tiz_scheduler_t * ap_sched)
+{
+  assert (ap_sched);
+  assert (ap_sched->p_pool);
+  if (0 == __atomic_exchange_n (&(ap_sched->scheduled), 1, __ATOMIC_SEQ_CST))
+    {
+      const OMX_ERRORTYPE rc
+        = sched_pool_submit (ap_sched->p_pool, ap_sched, false);
+      if (OMX_ErrorNone != rc)
+        {
+          __atomic_store_n (&(ap_sched->scheduled), 0, __ATOMIC_SEQ_CST);
+        }
+      return rc;
+    }
+  return OMX_ErrorNone;
+}
+
+static tiz_scheduler_t *
+sched_pool_next_task (tiz_sched_pool_t * ap_pool,
+                      tiz_sched_pool_worker_t * ap_worker)
+{
+  tiz_scheduler_t * p_sched = NULL;
+  OMX_S32 nthreads = 0;
+  OMX_S32 i = 0;
+  bool stop = false;
+
+  assert (ap_pool);
+  assert (ap_worker);
+
+  for (;;)
+    {
+      /* Own tasks first, newest first... */
+      p_sched = deque_pop (ap_worker, false);
+
+      /* ... then steal the oldest task of a peer */
+      nthreads = __atomic_load_n (&(ap_pool->nthreads), __ATOMIC_ACQUIRE);
+      for (i = 1; !p_sched && i < nthreads; ++i)
+        {
+          tiz_sched_pool_worker_t * p_victim
+            = &(ap_pool->workers[((ap_worker - ap_pool->workers) + i)
+                                 % nthreads]);
+          p_sched = deque_pop (p_victim, true);
+        }
+
+      if (p_sched)
+        {
+          (void) __atomic_sub_fetch (&(ap_pool->ntasks), 1, __ATOMIC_SEQ_CST);
+          return p_sched;
+        }
+
+      tiz_check_omx_ret_null (tiz_mutex_lock (&(ap_pool->mutex)));
+      (void) __atomic_add_fetch (&(ap_pool->nsleeping), 1, __ATOMIC_SEQ_CST);
+      while (0 == __atomic_load_n (&(ap_pool->ntasks), __ATOMIC_SEQ_CST)
+             && !ap_pool->stop)
+        {
+          (void) tiz_cond_wait (&(ap_pool->cond), &(ap_pool->mutex));
+        }
+      (void) __atomic_sub_fetch (&(ap_pool->nsleeping), 1, __ATOMIC_SEQ_CST);
+      stop = ap_pool->stop;
+      tiz_check_omx_ret_null (tiz_mutex_unlock (&(ap_pool->mutex)));
+
+      if (stop)
+        {
+          return NULL;
+        }
+    }
+}
+
+static void
+sched_pool_run (tiz_scheduler_t * ap_sched)
+{
+  OMX_PTR p_data = NULL;
+  OMX_BOOL signal_client = OMX_FALSE;
+  OMX_U32 budget = SCHED_POOL_MSG_BUDGET;
+
+  assert (ap_sched);
+  assert (ap_sched->p_pool);
+
+  __atomic_store_n (&(ap_sched->thread_id), tiz_thread_id (),
+                    __ATOMIC_RELAXED);
+
+  while (budget-- > 0
+         && OMX_ErrorNone
+              == tiz_lfqueue_timed_receive (ap_sched->p_queue, &p_data, 0))
+    {
+      assert (p_data);
+      signal_client = dispatch_msg (ap_sched, &(ap_sched->state),
+                                    (tiz_sched_msg_t *) p_data);
+
+      if (ETIZSchedStateStopped == ap_sched->state)
+        {
+          /* The component is going away. 'scheduled' is left set so that the
+             scheduler is never queued again, and the client is signalled
+             last, as it will delete the scheduler as soon as it wakes up. */
+          __atomic_store_n (&(ap_sched->thread_id), 0, __ATOMIC_RELAXED);
+          if (OMX_TRUE == signal_client)
+            {
+              (void) tiz_sem_post (&(ap_sched->sem));
+            }
+          return;
+        }
+
+      if (OMX_TRUE == signal_client)
+        {
+          (void) tiz_sem_post (&(ap_sched->sem));
+        }
+
+      schedule_servants (ap_sched, ap_sched->state);
+    }
+
+  __atomic_store_n (&(ap_sched->thread_id), 0, __ATOMIC_RELAXED);
+
+  /* Messages sent after 'scheduled' is cleared queue the scheduler again;
+     those sent before are picked up here */
+  __atomic_store_n (&(ap_sched->scheduled), 0, __ATOMIC_SEQ_CST);
+  if (tiz_lfqueue_length (ap_sched->p_queue) > 0
+      && 0 == __atomic_exchange_n (&(ap_sched->scheduled), 1,
+                                   __ATOMIC_SEQ_CST))
+    {
+      if (OMX_ErrorNone != sched_pool_submit (ap_sched->p_pool, ap_sched, true))
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR,
+                   "[OMX_ErrorInsufficientResources] : "
+                   "[%s] could not be queued in the scheduler pool",
+                   ap_sched->cname);
+          __atomic_store_n (&(ap_sched->scheduled), 0, __ATOMIC_SEQ_CST);
+        }
+    }
+}
+
+static void *
+sched_pool_worker_thread_func (void * p_arg)
+{
+  tiz_sched_pool_worker_t * p_worker = p_arg;
+  tiz_scheduler_t * p_sched = NULL;
+  char thread_name[16];
+
+  assert (p_worker);
+  assert (p_worker->p_pool);
+
+  __atomic_store_n (&(p_worker->thread_id), tiz_thread_id (),
+                    __ATOMIC_RELAXED);
+  (void) snprintf (thread_name, sizeof (thread_name), "tizsched-%02d",
+                   (int) (p_worker - p_worker->p_pool->workers));
+  (void) tiz_thread_setname (&(p_worker->thread), thread_name);
+
+  while ((p_sched = sched_pool_next_task (p_worker->p_pool, p_worker)))
+    {
+      sched_pool_run (p_sched);
+    }
+
+  return NULL;
+}
+
+/* Must be called with the pool's mutex held, or before the pool is shared */
+static OMX_ERRORTYPE
+sched_pool_start_worker (tiz_sched_pool_t * ap_pool)
+{
+  tiz_sched_pool_worker_t * p_worker = NULL;
+
+  assert (ap_pool);
+
+  if (ap_pool->nthreads >= SCHED_POOL_MAX_THREADS)
+    {
+      return OMX_ErrorInsufficientResources;
+    }
+
+  p_worker = &(ap_pool->workers[ap_pool->nthreads]);
+  p_worker->p_pool = ap_pool;
+  tiz_check_omx_ret_oom (tiz_mutex_init (&(p_worker->mutex)));
+  if (OMX_ErrorNone != deque_reserve (p_worker))
+    {
+      (void) tiz_mutex_destroy (&(p_worker->mutex));
+      return OMX_ErrorInsufficientResources;
+    }
+
+  /* Make the worker visible to submitters and thieves before it starts */
+  __atomic_store_n (&(ap_pool->nthreads), ap_pool->nthreads + 1,
+                    __ATOMIC_RELEASE);
+  if (OMX_ErrorNone
+      != tiz_thread_create (&(p_worker->thread), 0, 0,
+                            sched_pool_worker_thread_func, p_worker))
+    {
+      __atomic_store_n (&(ap_pool->nthreads), ap_pool->nthreads - 1,
+                        __ATOMIC_RELEASE);
+      tiz_mem_free (p_worker->pp_tasks);
+      p_worker->pp_tasks = NULL;
+      p_worker->capacity = 0;
+      (void) tiz_mutex_destroy (&(p_worker->mutex));
+      return OMX_ErrorInsufficientResources;
+    }
+
+  return OMX_ErrorNone;
+}
+
+static void
+sched_pool_block_begin (tiz_sched_pool_t * ap_pool)
+{
+  assert (ap_pool);
+  if (OMX_ErrorNone == tiz_mutex_lock (&(ap_pool->mutex)))
+    {
+      /* Keep 'target' workers available; the extra worker stays in the pool
+         until the pool is destroyed */
+      ap_pool->nblocked++;
+      if (ap_pool->nthreads - ap_pool->nblocked < ap_pool->target
+          && OMX_ErrorNone != sched_pool_start_worker (ap_pool))
+        {
+          TIZ_LOG (TIZ_PRIORITY_WARN,
+                   "Scheduler pool : could not start an additional worker "
+                   "([%d] threads, [%d] blocked)",
+                   ap_pool->nthreads, ap_pool->nblocked);
+        }
+      (void) tiz_mutex_unlock (&(ap_pool->mutex));
+    }
+}
+
+static void
+sched_pool_block_end (tiz_sched_pool_t * ap_pool)
+{
+  assert (ap_pool);
+  if (OMX_ErrorNone == tiz_mutex_lock (&(ap_pool->mutex)))
+    {
+      ap_pool->nblocked--;
+      (void) tiz_mutex_unlock (&(ap_pool->mutex));
+    }
+}
+
+static void
+sched_pool_destroy (tiz_sched_pool_t * ap_pool)
+{
+  OMX_PTR p_result = NULL;
+  OMX_S32 i = 0;
+
+  if (ap_pool)
+    {
+      if (OMX_ErrorNone == tiz_mutex_lock (&(ap_pool->mutex)))
+        {
+          ap_pool->stop = true;
+          (void) tiz_cond_broadcast (&(ap_pool->cond));
+          (void) tiz_mutex_unlock (&(ap_pool->mutex));
+        }
+
+      for (i = 0; i < ap_pool->nthreads; ++i)
+        {
+          tiz_sched_pool_worker_t * p_worker = &(ap_pool->workers[i]);
+          (void) tiz_thread_join (&(p_worker->thread), &p_result);
+          (void) tiz_mutex_destroy (&(p_worker->mutex));
+          tiz_mem_free (p_worker->pp_tasks);
+        }
+
+      (void) tiz_cond_destroy (&(ap_pool->cond));
+      (void) tiz_mutex_destroy (&(ap_pool->mutex));
+      tiz_mem_free (ap_pool);
+    }
+}
+
+static tiz_sched_pool_t *
+sched_pool_init (const OMX_S32 a_nthreads)
+{
+  tiz_sched_pool_t * p_pool = NULL;
+  OMX_S32 i = 0;
+
+  assert (a_nthreads > 0);
+
+  tiz_check_null (
+    (p_pool = tiz_mem_calloc (1, sizeof (tiz_sched_pool_t))));
+  if (OMX_ErrorNone != tiz_mutex_init (&(p_pool->mutex)))
+    {
+      tiz_mem_free (p_pool);
+      return NULL;
+    }
+  if (OMX_ErrorNone != tiz_cond_init (&(p_pool->cond)))
+    {
+      (void) tiz_mutex_destroy (&(p_pool->mutex));
+      tiz_mem_free (p_pool);
+      return NULL;
+    }
+
+  p_pool->target = a_nthreads;
+  for (i = 0; i < a_nthreads; ++i)
+    {
+      if (OMX_ErrorNone != sched_pool_start_worker (p_pool))
+        {
+          sched_pool_destroy (p_pool);
+          return NULL;
+        }
+    }
+
+  return p_pool;
+}
+
+static OMX_S32
+sched_pool_configured_threads (void)
+{
+  const char * p_value = NULL;
+  long nthreads = 0;
+
+  /* 0 (the default) means one dedicated thread per component */
+  if ((p_value
+       = tiz_rcfile_get_value (SCHED_RCFILE_SECTION, SCHED_POOL_RCFILE_KEY)))
+    {
+      nthreads = strtol (p_value, NULL, 10);
+    }
+
+  if (nthreads < 0)
+    {
+      nthreads = 0;
+    }
+  else if (nthreads > SCHED_POOL_MAX_THREADS)
+    {
+      nthreads = SCHED_POOL_MAX_THREADS;
+    }
+
+  return (OMX_S32) nthreads;
+}
+
+static void
+sched_pool_global_init (void)
+{
+  g_sched_pool_threads = sched_pool_configured_threads ();
+  TIZ_LOG (TIZ_PRIORITY_NOTICE, "Scheduler pool threads [%d]%s",
+           g_sched_pool_threads,
+           g_sched_pool_threads > 0 ? "" : " (one thread per component)");
+  if (g_sched_pool_threads > 0)
+    {
+      g_sched_pool_init_rc = tiz_mutex_init (&g_sched_pool_mutex);
+    }
+}
+
+/* Returns the process-wide pool, creating it if needed, or NULL if schedulers
+   must use dedicated threads */
+static tiz_sched_pool_t *
+sched_pool_acquire (void)
+{
+  tiz_sched_pool_t * p_pool = NULL;
+
+  (void) pthread_once (&g_sched_pool_once, sched_pool_global_init);
+  if (g_sched_pool_threads <= 0 || OMX_ErrorNone != g_sched_pool_init_rc)
+    {
+      /* Fall back to dedicated threads */
+      return NULL;
+    }
+
+  tiz_check_omx_ret_null (tiz_mutex_lock (&g_sched_pool_mutex));
+
+  if (!gp_sched_pool)
+    {
+      gp_sched_pool = sched_pool_init (g_sched_pool_threads);
+    }
+  if ((p_pool = gp_sched_pool))
+    {
+      p_pool->nusers++;
+    }
+
+  tiz_check_omx_ret_null (tiz_mutex_unlock (&g_sched_pool_mutex));
+  return p_pool;
+}
+
+static void
+sched_pool_release (tiz_sched_pool_t * ap_pool)
+{
+  tiz_sched_pool_t * p_pool_to_destroy = NULL;
+
+  assert (ap_pool);
+
+  if (OMX_ErrorNone != tiz_mutex_lock (&g_sched_pool_mutex))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to lock the scheduler pool");
+      return;
+    }
+  assert (ap_pool == gp_sched_pool);
+  assert (ap_pool->nusers > 0);
+  /* A worker can't join itself; in that (unusual) case the pool is kept
+     around for the next component */
+  if (0 == --ap_pool->nusers && !sched_pool_is_worker (ap_pool))
+    {
+      p_pool_to_destroy = gp_sched_pool;
+      gp_sched_pool = NULL;
+    }
+  (void) tiz_mutex_unlock (&g_sched_pool_mutex);
+
+  sched_pool_destroy (p_pool_to_destroy);
+}
+
+static OMX_ERRORTYPE
+start_scheduler (tiz_scheduler_t * ap_sched)
+{
+  assert (ap_sched);
+
+  if (ap_sched->p_pool)
+    {
+      /* Nothing to start; the scheduler is queued in the pool as soon as it
+         receives its first message */
+      return OMX_ErrorNone;
+    }
+
+  /* Create scheduler thread */
+  tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_sched->mutex)));
+  tiz_check_omx_ret_oom (tiz_thread_create (&(ap_sched->thread), 0, 0,
+                                            il_sched_thread_func, ap_sched));
+
+  tiz_check_omx_ret_oom (tiz_mutex_unlock (&(ap_sched->mutex)));
+  tiz_check_omx_ret_oom (tiz_sem_wait (&(ap_sched->sem)));
+
+  return OMX_ErrorNone;
+}
+
+static void
+delete_scheduler (tiz_scheduler_t * ap_sched)
+{
+  OMX_PTR p_result = NULL;
+  assert (ap_sched);
+  if (!ap_sched->p_pool)
+    {
+      (void) tiz_thread_join (&(ap_sched->thread), &p_result);
+    }
+  delete_roles (ap_sched);
+  delete_hooks (ap_sched, ap_sched->child.p_alloc_hooks_map);
+  ap_sched->child.p_alloc_hooks_map = NULL;
+  delete_hooks (ap_sched, ap_sched->child.p_eglimage_hooks_map);
+  ap_sched->child.p_eglimage_hooks_map = NULL;
+  (void) tiz_mutex_destroy (&(ap_sched->mutex));
+  (void) tiz_sem_destroy (&(ap_sched->sem));
+  tiz_lfqueue_destroy (ap_sched->p_queue);
+  ap_sched->p_queue = NULL;
+  log_sched_stats (ap_sched);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s] message pool hits [%llu] misses [%llu]",
+           ap_sched->cname, (unsigned long long) ap_sched->p_msg_pool->hits,
+           (unsigned long long) ap_sched->p_msg_pool->misses);
+  msg_pool_destroy (ap_sched->p_msg_pool);
+  ap_sched->p_msg_pool = NULL;
+  if (ap_sched->p_pool)
+    {
+      sched_pool_release (ap_sched->p_pool);
+      ap_sched->p_pool = NULL;
+    }
+  tiz_mem_free (ap_sched);
+}
+
+static tiz_scheduler_t *
+instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
+{
+  tiz_scheduler_t * p_sched = NULL;
+  int len = 0;
+
+  assert (ap_hdl);
+
+  if (!(p_sched = tiz_mem_calloc (1, sizeof (tiz_scheduler_t))))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "[OMX_ErrorInsufficientResources] : "
                "(Could not allocate tiz_scheduler_t structure)");
       return NULL;
     }
@@ -2478,7 +3519,8 @@ instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
   tiz_check_omx_ret_null (tiz_mutex_init (&(p_sched->mutex)));
   tiz_check_omx_ret_null (tiz_sem_init (&(p_sched->sem), 0));
   tiz_check_omx_ret_null (
-    tiz_queue_init (&(p_sched->p_queue), SCHED_QUEUE_MAX_ITEMS));
+    tiz_lfqueue_init (&(p_sched->p_queue), SCHED_QUEUE_MAX_ITEMS));
+  tiz_check_null ((p_sched->p_msg_pool = msg_pool_init ()));
 
   p_sched->child.p_fsm = NULL;
   p_sched->child.p_ker = NULL;
@@ -2492,11 +3534,15 @@ instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
   p_sched->state = ETIZSchedStateStarting;
   p_sched->appdata = NULL;
   p_sched->cbacks = NULL;
+  p_sched->p_pool = sched_pool_acquire ();
+  p_sched->scheduled = 0;
 
   len = strnlen (ap_cname, OMX_MAX_STRINGNAME_SIZE - 1);
   strncpy (p_sched->cname, ap_cname, len);
   p_sched->cname[len] = '\0';
 
+  configure_sched_policy (p_sched);
+
   ((OMX_COMPONENTTYPE *) ap_hdl)->pComponentPrivate = p_sched;
 
   return p_sched;
@@ -2550,7 +3596,10 @@ init_servants (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
   assert (ap_sched);
   assert (ap_msg);
 
-  tiz_check_omx_ret_oom (set_thread_name (ap_sched));
+  if (!ap_sched->p_pool)
+    {
+      tiz_check_omx_ret_oom (set_thread_name (ap_sched));
+    }
 
   p_hdl = ap_sched->child.p_hdl;
 
@@ -3039,12 +4088,103 @@ tiz_comp_event_stat (const OMX_HANDLETYPE ap_hdl, tiz_event_stat_t * ap_ev_stat,
   (void) send_msg (get_sched (ap_hdl), p_msg);
 }
 
+void
+tiz_comp_msg_pool_info (const OMX_HANDLETYPE ap_hdl,
+                        tiz_comp_msg_pool_info_t * ap_info)
+{
+  tiz_scheduler_t * p_sched = get_sched (ap_hdl);
+  assert (p_sched);
+  assert (p_sched->p_msg_pool);
+  assert (ap_info);
+  ap_info->size = SCHED_MSG_POOL_SIZE;
+  ap_info->hits
+    = __atomic_load_n (&(p_sched->p_msg_pool->hits), __ATOMIC_RELAXED);
+  ap_info->misses
+    = __atomic_load_n (&(p_sched->p_msg_pool->misses), __ATOMIC_RELAXED);
+}
+
+static OMX_ERRORTYPE
+send_buffers (const OMX_HANDLETYPE ap_hdl, OMX_BUFFERHEADERTYPE ** app_hdrs,
+              const OMX_U32 a_nhdrs, const tiz_sched_msg_class_t a_class)
+{
+  OMX_COMPONENTTYPE * p_omx_comp = (OMX_COMPONENTTYPE *) ap_hdl;
+  tiz_sched_msg_t * p_msg = NULL;
+  tiz_sched_msg_emptyfillbuffers_t * p_msg_efbs = NULL;
+  OMX_U32 sent = 0;
+  OMX_U32 n = 0;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  if (!ap_hdl || !app_hdrs)
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "[OMX_ErrorBadParameter] : "
+               "(Null pointer argument received)");
+      return OMX_ErrorBadParameter;
+    }
+
+  /* The peer may not be a Tizonia component; in that case, simply fall back
+     to the standard, one-header-at-a-time, OpenMAX IL API. The caller no
+     longer owns any of these headers, so all of them are sent; the first
+     error found is reported. */
+  if (p_omx_comp->EmptyThisBuffer != sched_EmptyThisBuffer)
+    {
+      for (sent = 0; sent < a_nhdrs; ++sent)
+        {
+          OMX_ERRORTYPE hdr_rc
+            = (ETIZSchedMsgEmptyBuffers == a_class
+                 ? OMX_EmptyThisBuffer (ap_hdl, app_hdrs[sent])
+                 : OMX_FillThisBuffer (ap_hdl, app_hdrs[sent]));
+          if (OMX_ErrorNone == rc)
+            {
+              rc = hdr_rc;
+            }
+        }
+      return rc;
+    }
+
+  while (sent < a_nhdrs)
+    {
+      OMX_ERRORTYPE msg_rc = OMX_ErrorNone;
+      n = MIN (a_nhdrs - sent, TIZ_COMP_MAX_BUFFER_BATCH);
+      TIZ_COMP_INIT_MSG_OOM (ap_hdl, p_msg, a_class);
+      assert (p_msg);
+      p_msg_efbs = &(p_msg->efbs);
+      assert (p_msg_efbs);
+      memcpy (p_msg_efbs->p_hdrs, app_hdrs + sent,
+              n * sizeof (OMX_BUFFERHEADERTYPE *));
+      p_msg_efbs->nhdrs = n;
+      msg_rc = send_msg (get_sched (ap_hdl), p_msg);
+      if (OMX_ErrorNone == rc)
+        {
+          rc = msg_rc;
+        }
+      sent += n;
+    }
+
+  return rc;
+}
+
+OMX_ERRORTYPE
+tiz_comp_empty_buffers (const OMX_HANDLETYPE ap_hdl,
+                        OMX_BUFFERHEADERTYPE ** app_hdrs, const OMX_U32 a_nhdrs)
+{
+  return send_buffers (ap_hdl, app_hdrs, a_nhdrs, ETIZSchedMsgEmptyBuffers);
+}
+
+OMX_ERRORTYPE
+tiz_comp_fill_buffers (const OMX_HANDLETYPE ap_hdl,
+                       OMX_BUFFERHEADERTYPE ** app_hdrs, const OMX_U32 a_nhdrs)
+{
+  return send_buffers (ap_hdl, app_hdrs, a_nhdrs, ETIZSchedMsgFillBuffers);
+}
+
 size_t
 tiz_comp_event_queue_unused_spaces (const OMX_HANDLETYPE ap_hdl)
 {
   tiz_scheduler_t * p_sched = get_sched (ap_hdl);
   assert (p_sched);
-  return SCHED_QUEUE_MAX_ITEMS - tiz_queue_length (p_sched->p_queue);
+  return tiz_lfqueue_capacity (p_sched->p_queue)
+         - tiz_lfqueue_length (p_sched->p_queue);
 }
 
 void *
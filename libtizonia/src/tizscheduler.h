@@ -403,6 +403,48 @@ void
 tiz_comp_event_stat (const OMX_HANDLETYPE ap_hdl, tiz_event_stat_t * ap_ev_stat,
                      void * ap_arg, const uint32_t a_id, const int a_events);
 
+/**
+ * Maximum number of buffer headers carried by a single scheduler message
+ * when buffers are submitted in batches.
+ * @ingroup tizscheduler
+ */
+#define TIZ_COMP_MAX_BUFFER_BATCH 16
+
+/**
+ * Submit a batch of buffers to a component's input ports. This is equivalent
+ * to calling OMX_EmptyThisBuffer once per header, but the headers are handed
+ * over to the component's thread in as few messages as possible (one per
+ * TIZ_COMP_MAX_BUFFER_BATCH headers), so that the component is woken up only
+ * once. If ap_hdl is not a Tizonia component, the headers are submitted one
+ * by one using OMX_EmptyThisBuffer.
+ *
+ * @ingroup tizscheduler
+ *
+ * @param ap_hdl The OpenMAX IL handle.
+ * @param app_hdrs The list of buffer headers.
+ * @param a_nhdrs The number of headers in the list.
+ * @return OMX_ErrorNone on success, other OMX_ERRORTYPE on error.
+ */
+OMX_ERRORTYPE
+tiz_comp_empty_buffers (const OMX_HANDLETYPE ap_hdl,
+                        OMX_BUFFERHEADERTYPE ** app_hdrs,
+                        const OMX_U32 a_nhdrs);
+
+/**
+ * Submit a batch of buffers to a component's output ports. This is the
+ * OMX_FillThisBuffer counterpart of tiz_comp_empty_buffers.
+ *
+ * @ingroup tizscheduler
+ *
+ * @param ap_hdl The OpenMAX IL handle.
+ * @param app_hdrs The list of buffer headers.
+ * @param a_nhdrs The number of headers in the list.
+ * @return OMX_ErrorNone on success, other OMX_ERRORTYPE on error.
+ */
+OMX_ERRORTYPE
+tiz_comp_fill_buffers (const OMX_HANDLETYPE ap_hdl,
+                       OMX_BUFFERHEADERTYPE ** app_hdrs, const OMX_U32 a_nhdrs);
+
 /**
  * Retrieve the current maximum number of items that could be insterted into the queue.
  * @ingroup tizscheduler
@@ -412,6 +454,28 @@ tiz_comp_event_stat (const OMX_HANDLETYPE ap_hdl, tiz_event_stat_t * ap_ev_stat,
 size_t
 tiz_comp_event_queue_unused_spaces (const OMX_HANDLETYPE ap_hdl);
 
+/**
+ * Scheduler message pool statistics.
+ * @ingroup tizscheduler
+ */
+typedef struct tiz_comp_msg_pool_info tiz_comp_msg_pool_info_t;
+struct tiz_comp_msg_pool_info
+{
+  OMX_U32 size;   /**< Number of pre-allocated scheduler messages */
+  OMX_U64 hits;   /**< Messages served from the pool */
+  OMX_U64 misses; /**< Messages that had to be allocated from the heap */
+};
+
+/**
+ * Retrieve the statistics of the component's scheduler message pool.
+ * @ingroup tizscheduler
+ * @param ap_hdl The OpenMAX IL handle.
+ * @param ap_info The structure to be filled in.
+ */
+void
+tiz_comp_msg_pool_info (const OMX_HANDLETYPE ap_hdl,
+                        tiz_comp_msg_pool_info_t * ap_info);
+
 /* Utility functions */
 
 /**
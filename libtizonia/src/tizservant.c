@@ -311,6 +311,34 @@ tiz_srv_super_enqueue (const void * a_class, const void * ap_obj,
   return superclass->enqueue (ap_obj, ap_data, a_priority);
 }
 
+static OMX_ERRORTYPE
+srv_enqueue_keyed (const void * ap_obj, OMX_PTR ap_data, OMX_U32 a_priority,
+                   OMX_PTR ap_key)
+{
+  tiz_srv_t * p_srv = (tiz_srv_t *) ap_obj;
+  assert (p_srv);
+  return tiz_pqueue_send_keyed (p_srv->p_pq_, ap_data, a_priority, ap_key);
+}
+
+OMX_ERRORTYPE
+tiz_srv_enqueue_keyed (const void * ap_obj, OMX_PTR ap_data,
+                       OMX_U32 a_priority, OMX_PTR ap_key)
+{
+  const tiz_srv_class_t * class = classOf (ap_obj);
+  assert (class->enqueue_keyed);
+  return class->enqueue_keyed (ap_obj, ap_data, a_priority, ap_key);
+}
+
+OMX_ERRORTYPE
+tiz_srv_super_enqueue_keyed (const void * a_class, const void * ap_obj,
+                             OMX_PTR ap_data, OMX_U32 a_priority,
+                             OMX_PTR ap_key)
+{
+  const tiz_srv_class_t * superclass = super (a_class);
+  assert (ap_obj && superclass->enqueue_keyed);
+  return superclass->enqueue_keyed (ap_obj, ap_data, a_priority, ap_key);
+}
+
 static void
 srv_remove_from_queue (const void * ap_obj, tiz_pq_func_f apf_func,
                        OMX_S32 a_data1, OMX_PTR ap_data2)
@@ -339,6 +367,39 @@ tiz_srv_super_remove_from_queue (const void * a_class, const void * ap_obj,
   superclass->remove_from_queue (ap_obj, apf_func, a_data1, ap_data2);
 }
 
+static void
+srv_remove_keyed_from_queue (const void * ap_obj, OMX_PTR ap_key,
+                             tiz_pq_func_f apf_func, OMX_S32 a_data1,
+                             OMX_PTR ap_data2)
+{
+  tiz_srv_t * p_srv = (tiz_srv_t *) ap_obj;
+  assert (p_srv);
+  tiz_pqueue_remove_func_keyed (p_srv->p_pq_, ap_key, apf_func, a_data1,
+                                ap_data2);
+}
+
+void
+tiz_srv_remove_keyed_from_queue (const void * ap_obj, OMX_PTR ap_key,
+                                 tiz_pq_func_f apf_func, OMX_S32 a_data1,
+                                 OMX_PTR ap_data2)
+{
+  const tiz_srv_class_t * class = classOf (ap_obj);
+  assert (class->remove_keyed_from_queue);
+  class->remove_keyed_from_queue (ap_obj, ap_key, apf_func, a_data1, ap_data2);
+}
+
+void
+tiz_srv_super_remove_keyed_from_queue (const void * a_class,
+                                       const void * ap_obj, OMX_PTR ap_key,
+                                       tiz_pq_func_f apf_func,
+                                       OMX_S32 a_data1, OMX_PTR ap_data2)
+{
+  const tiz_srv_class_t * superclass = super (a_class);
+  assert (ap_obj && superclass->remove_keyed_from_queue);
+  superclass->remove_keyed_from_queue (ap_obj, ap_key, apf_func, a_data1,
+                                       ap_data2);
+}
+
 static OMX_ERRORTYPE
 srv_dispatch_msg (const void * ap_obj, OMX_PTR ap_data)
 {
@@ -1179,10 +1240,18 @@ srv_class_ctor (void * ap_obj, va_list * app)
         {
           *(voidf *) &p_srv->enqueue = method;
         }
+      else if (selector == (voidf) tiz_srv_enqueue_keyed)
+        {
+          *(voidf *) &p_srv->enqueue_keyed = method;
+        }
       else if (selector == (voidf) tiz_srv_remove_from_queue)
         {
           *(voidf *) &p_srv->remove_from_queue = method;
         }
+      else if (selector == (voidf) tiz_srv_remove_keyed_from_queue)
+        {
+          *(voidf *) &p_srv->remove_keyed_from_queue = method;
+        }
       else if (selector == (voidf) tiz_srv_dispatch_msg)
         {
           *(voidf *) &p_srv->dispatch_msg = method;
@@ -1362,8 +1431,12 @@ tiz_srv_init (void * ap_tos, void * ap_hdl)
      /* TIZ_CLASS_COMMENT: */
      tiz_srv_enqueue, srv_enqueue,
      /* TIZ_CLASS_COMMENT: */
+     tiz_srv_enqueue_keyed, srv_enqueue_keyed,
+     /* TIZ_CLASS_COMMENT: */
      tiz_srv_remove_from_queue, srv_remove_from_queue,
      /* TIZ_CLASS_COMMENT: */
+     tiz_srv_remove_keyed_from_queue, srv_remove_keyed_from_queue,
+     /* TIZ_CLASS_COMMENT: */
      tiz_srv_dispatch_msg, srv_dispatch_msg,
      /* TIZ_CLASS_COMMENT: */
      tiz_srv_is_ready, srv_is_ready,
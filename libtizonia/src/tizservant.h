@@ -61,11 +61,20 @@ tiz_srv_init_msg (void * ap_obj, size_t msg_sz);
 OMX_ERRORTYPE
 tiz_srv_enqueue (const void * ap_obj, OMX_PTR ap_data, OMX_U32 a_priority);
 
+OMX_ERRORTYPE
+tiz_srv_enqueue_keyed (const void * ap_obj, OMX_PTR ap_data,
+                       OMX_U32 a_priority, OMX_PTR ap_key);
+
 void
 tiz_srv_remove_from_queue (const void * ap_obj,
                            /*@null@*/ tiz_pq_func_f apf_func, OMX_S32 a_data1,
                            OMX_PTR ap_data2);
 
+void
+tiz_srv_remove_keyed_from_queue (const void * ap_obj, OMX_PTR ap_key,
+                                 tiz_pq_func_f apf_func, OMX_S32 a_data1,
+                                 OMX_PTR ap_data2);
+
 OMX_ERRORTYPE
 tiz_srv_dispatch_msg (const void * ap_obj, OMX_PTR ap_data);
 
@@ -93,7 +93,7 @@ egl_image_validation_hook (const OMX_HANDLETYPE ap_hdl,
 }
 
 static OMX_PTR
-instantiate_pcm_port (OMX_HANDLETYPE ap_hdl)
+instantiate_pcm_port_with_dir (OMX_HANDLETYPE ap_hdl, const OMX_DIRTYPE a_dir)
 {
   OMX_AUDIO_PARAM_PCMMODETYPE pcmmode;
   OMX_AUDIO_CONFIG_VOLUMETYPE volume;
@@ -104,7 +104,7 @@ instantiate_pcm_port (OMX_HANDLETYPE ap_hdl)
   };
   tiz_port_options_t port_opts = {
     OMX_PortDomainAudio,
-    OMX_DirInput,
+    a_dir,
     TC_PORT_MIN_BUF_COUNT,
     TC_PORT_MIN_BUF_SIZE,
     TC_PORT_NONCONTIGUOUS,
@@ -147,6 +147,18 @@ instantiate_pcm_port (OMX_HANDLETYPE ap_hdl)
                       &encodings, &pcmmode, &volume, &mute);
 }
 
+static OMX_PTR
+instantiate_pcm_port (OMX_HANDLETYPE ap_hdl)
+{
+  return instantiate_pcm_port_with_dir (ap_hdl, OMX_DirInput);
+}
+
+static OMX_PTR
+instantiate_pcm_output_port (OMX_HANDLETYPE ap_hdl)
+{
+  return instantiate_pcm_port_with_dir (ap_hdl, OMX_DirOutput);
+}
+
 static OMX_PTR
 instantiate_config_port (OMX_HANDLETYPE ap_hdl)
 {
@@ -180,9 +192,11 @@ OMX_ComponentInit (OMX_HANDLETYPE ap_hdl)
   role_factory1.nports = 1;
   role_factory1.pf_proc = instantiate_processor;
 
+  /* Role #2 is a source, so that two instances of this component can be
+     tunnelled together (role #2 -> role #1) */
   strcpy ((OMX_STRING) role_factory2.role, TC_DEFAULT_ROLE2);
   role_factory2.pf_cport = instantiate_config_port;
-  role_factory2.pf_port[0] = instantiate_pcm_port;
+  role_factory2.pf_port[0] = instantiate_pcm_output_port;
   role_factory2.nports = 1;
   role_factory2.pf_proc = instantiate_processor;
 
@@ -33,6 +33,8 @@
 #include "tiztcproc.h"
 #include "tiztcproc_decls.h"
 #include "tizkernel.h"
+#include "tizport.h"
+#include "tizport-macros.h"
 #include "tizscheduler.h"
 
 #include "tizplatform.h"
@@ -44,6 +46,10 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.tizonia.test_comp"
 #endif
 
+/* Role #2 (output port) flags OMX_BUFFERFLAG_EOS on this buffer. Buffers
+   keep flowing after that one. */
+#define TC_SOURCE_EOS_BUFFER_COUNT 20000
+
 /*
  * tiztcprc
  */
@@ -52,6 +58,7 @@ static void *
 tcprc_ctor (void *ap_obj, va_list * app)
 {
   tiz_tcprc_t *p_obj = super_ctor (typeOf (ap_obj, "tiztcprc"), ap_obj, app);
+  p_obj->nbufs_ = 0;
   return p_obj;
 }
 
@@ -67,6 +74,19 @@ tiztc_proc_render_buffer (OMX_BUFFERHEADERTYPE * p_hdr)
   return OMX_ErrorNone;
 }
 
+static OMX_ERRORTYPE
+tiztc_proc_produce_buffer (tiz_tcprc_t * ap_prc, OMX_BUFFERHEADERTYPE * p_hdr)
+{
+  p_hdr->nOffset = 0;
+  p_hdr->nFilledLen = p_hdr->nAllocLen;
+  p_hdr->nFlags = 0;
+  if (++ap_prc->nbufs_ == TC_SOURCE_EOS_BUFFER_COUNT)
+    {
+      p_hdr->nFlags |= OMX_BUFFERFLAG_EOS;
+    }
+  return OMX_ErrorNone;
+}
+
 /*
  * from tiz_srv class
  */
@@ -86,6 +106,9 @@ tcprc_deallocate_resources (void *ap_obj)
 static OMX_ERRORTYPE
 tcprc_prepare_to_transfer (void *ap_obj, OMX_U32 a_pid)
 {
+  tiz_tcprc_t *p_obj = ap_obj;
+  assert (p_obj);
+  p_obj->nbufs_ = 0;
   return OMX_ErrorNone;
 }
 
@@ -108,16 +131,34 @@ tcprc_stop_and_return (void *ap_obj)
 static OMX_ERRORTYPE
 tcprc_buffers_ready (const void *ap_obj)
 {
+  tiz_tcprc_t *p_obj = (tiz_tcprc_t *) ap_obj;
   void *p_krn = tiz_get_krn (handleOf (ap_obj));
+  void *p_port = tiz_krn_get_port (p_krn, 0);
   OMX_BUFFERHEADERTYPE *p_hdr = NULL;
   OMX_ERRORTYPE rc = OMX_ErrorNone;
 
   rc = tiz_krn_claim_buffer (p_krn, 0, 0, &p_hdr);
-  if (OMX_ErrorNone == rc && p_hdr)
+  if (OMX_DirOutput == tiz_port_dir (p_port))
     {
-      OMX_PTR p_eglimage = NULL;
-      tiz_check_omx (tiz_krn_claim_eglimage (p_krn, 0, p_hdr, &p_eglimage));
-      TIZ_PRINTF_DBG_MAG ("eglimage [%p]\n", p_eglimage);
+      /* Fill all the headers available; the kernel reports EOS on output
+         ports */
+      while (OMX_ErrorNone == rc && p_hdr)
+        {
+          tiz_check_omx (tiztc_proc_produce_buffer (p_obj, p_hdr));
+          (void)tiz_krn_release_buffer (p_krn, 0, p_hdr);
+          p_hdr = NULL;
+          rc = tiz_krn_claim_buffer (p_krn, 0, 0, &p_hdr);
+        }
+    }
+  else if (OMX_ErrorNone == rc && p_hdr)
+    {
+      /* Buffers supplied through a tunnel are not EGL images */
+      if (!TIZ_PORT_IS_TUNNELED (p_port))
+        {
+          OMX_PTR p_eglimage = NULL;
+          tiz_check_omx (tiz_krn_claim_eglimage (p_krn, 0, p_hdr, &p_eglimage));
+          TIZ_PRINTF_DBG_MAG ("eglimage [%p]\n", p_eglimage);
+        }
       tiz_check_omx (tiztc_proc_render_buffer (p_hdr));
       if ((p_hdr->nFlags & OMX_BUFFERFLAG_EOS) != 0)
         {
@@ -42,7 +42,7 @@ extern "C"
   {
     /* Object */
     const tiz_prc_t _;
-
+    OMX_U32 nbufs_; /* buffers produced since the last Idle->Exe */
   };
 
   typedef struct tiz_tcprc_class tiz_tcprc_class_t;
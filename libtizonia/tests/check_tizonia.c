@@ -49,6 +49,7 @@
 #include "tizscheduler.h"
 #include "tizfsm.h"
 #include "tizkernel.h"
+#include "tizprc.h"
 
 #include "check_tizonia.h"
 
@@ -82,6 +83,7 @@ struct check_common_context
   OMX_ERRORTYPE error;
   OMX_U32 port;
   OMX_BUFFERHEADERTYPE *p_hdr;
+  OMX_BOOL eos;
 };
 
 static bool
@@ -206,6 +208,7 @@ _ctx_init (cc_ctx_t * app_ctx)
   p_ctx->error = OMX_ErrorMax;
   p_ctx->port = OMX_ALL;
   p_ctx->p_hdr = NULL;
+  p_ctx->eos = OMX_FALSE;
 
   * app_ctx = p_ctx;
 
@@ -309,6 +312,38 @@ _ctx_wait (cc_ctx_t * app_ctx, OMX_U32 a_millis, OMX_BOOL * ap_has_timedout)
 
 }
 
+/* Unlike _ctx_wait, this ignores any other event signaled in the meantime
+   (e.g. a state transition); see check_graph_EventHandler */
+static OMX_ERRORTYPE
+_ctx_wait_eos (cc_ctx_t * app_ctx, OMX_U32 a_millis, OMX_BOOL * ap_has_timedout)
+{
+  check_common_context_t *p_ctx = NULL;
+  assert (app_ctx);
+  p_ctx = * app_ctx;
+
+  * ap_has_timedout = OMX_FALSE;
+
+  if (tiz_mutex_lock (&p_ctx->mutex))
+    {
+      return OMX_ErrorBadParameter;
+    }
+
+  while (!p_ctx->eos)
+    {
+      if (OMX_ErrorTimeout == tiz_cond_timedwait (&p_ctx->cond,
+                                                  &p_ctx->mutex, a_millis)
+          && !p_ctx->eos)
+        {
+          * ap_has_timedout = OMX_TRUE;
+          break;
+        }
+    }
+
+  tiz_mutex_unlock (&p_ctx->mutex);
+
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 _ctx_reset (cc_ctx_t * app_ctx)
 {
@@ -326,6 +361,7 @@ _ctx_reset (cc_ctx_t * app_ctx)
   p_ctx->error = OMX_ErrorMax;
   p_ctx->port = OMX_ALL;
   p_ctx->p_hdr = NULL;
+  p_ctx->eos = OMX_FALSE;
 
   tiz_mutex_unlock (&p_ctx->mutex);
 
@@ -441,19 +477,57 @@ static OMX_CALLBACKTYPE _check_cbacks = {
   check_FillBufferDone
 };
 
+/* Same as check_EventHandler, but buffers flow through the tunnel, so
+   OMX_EventBufferFlag is expected too */
+OMX_ERRORTYPE
+check_graph_EventHandler (OMX_HANDLETYPE ap_hdl,
+                          OMX_PTR ap_app_data,
+                          OMX_EVENTTYPE eEvent,
+                          OMX_U32 nData1, OMX_U32 nData2, OMX_PTR pEventData)
+{
+  check_common_context_t *p_ctx = NULL;
+  cc_ctx_t *pp_ctx = NULL;
+  assert (ap_app_data);
+  pp_ctx = (cc_ctx_t *) ap_app_data;
+  p_ctx = *pp_ctx;
+
+  if (OMX_EventBufferFlag == eEvent)
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "OMX_BUFFERFLAG_EOS on port [%d]", nData1);
+      /* Only _ctx_wait_eos is woken up; a pending state transition wait is
+         not affected */
+      tiz_mutex_lock (&p_ctx->mutex);
+      p_ctx->eos = OMX_TRUE;
+      tiz_cond_broadcast (&p_ctx->cond);
+      tiz_mutex_unlock (&p_ctx->mutex);
+      return OMX_ErrorNone;
+    }
+
+  return check_EventHandler (ap_hdl, ap_app_data, eEvent, nData1, nData2,
+                             pEventData);
+}
+
+static OMX_CALLBACKTYPE _check_graph_cbacks = {
+  check_graph_EventHandler,
+  check_EmptyBufferDone,
+  check_FillBufferDone
+};
+
 static OMX_ERRORTYPE
 check_tizonia_GetParameter (OMX_HANDLETYPE ap_hdl,
                              OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
 {
-  fail_if(OMX_IndexParamPortDefinition != a_index);
-
   if (OMX_IndexParamPortDefinition == a_index)
     {
       OMX_PARAM_PORTDEFINITIONTYPE *p_port_def = ap_struct;
       p_port_def->eDir = OMX_DirOutput; /* Pretend this is an output port */
+      return OMX_ErrorNone;
     }
 
-  return OMX_ErrorNone;
+  /* Not a libtizonia component; the tunnel must work without the fast
+     path */
+  fail_if(OMX_TizoniaIndexParamFastTunnel != a_index);
+  return OMX_ErrorUnsupportedIndex;
 }
 
 static OMX_ERRORTYPE
@@ -534,6 +608,51 @@ START_TEST (test_tizonia_getstate)
 }
 END_TEST
 
+START_TEST (test_tizonia_msg_pool)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  OMX_STATETYPE state;
+  OMX_CALLBACKTYPE callBacks;
+  OMX_U32 appData;
+  tiz_comp_msg_pool_info_t before;
+  tiz_comp_msg_pool_info_t after;
+  OMX_U32 i = 0;
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetHandle (&p_hdl,
+                         COMPONENT_NAME, (OMX_PTR *) (&appData), &callBacks);
+  fail_if (OMX_ErrorNone != error);
+
+  tiz_comp_msg_pool_info (p_hdl, &before);
+  fail_if (0 == before.size);
+
+  for (i = 0; i < 100; ++i)
+    {
+      error = OMX_GetState (p_hdl, &state);
+      fail_if (OMX_ErrorNone != error);
+      fail_if (OMX_StateLoaded != state);
+    }
+
+  /* Blocking API calls never have more than one message outstanding, so
+     these must all have been served from the pool */
+  tiz_comp_msg_pool_info (p_hdl, &after);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "pool hits [%llu] misses [%llu]",
+           (unsigned long long) after.hits,
+           (unsigned long long) after.misses);
+  fail_if (after.hits - before.hits != 100);
+  fail_if (after.misses != before.misses);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+}
+END_TEST
+
 START_TEST (test_tizonia_gethandle_freehandle)
 {
   OMX_ERRORTYPE error = OMX_ErrorNone;
@@ -558,6 +677,57 @@ START_TEST (test_tizonia_gethandle_freehandle)
 }
 END_TEST
 
+#define GRAPH_SETUP_COMPONENTS 4
+#define GRAPH_SETUP_ITERATIONS 50
+
+START_TEST (test_tizonia_graph_setup_latency)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE hdls[GRAPH_SETUP_COMPONENTS];
+  OMX_U32 appData;
+  OMX_CALLBACKTYPE callBacks;
+  struct timeval start, end;
+  double elapsed_us = 0;
+  int i = 0;
+  int j = 0;
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  /* The first graph pays for building the component type prototypes; the
+     following ones are instantiated from them */
+  for (i = 0; i < GRAPH_SETUP_ITERATIONS; ++i)
+    {
+      gettimeofday (&start, NULL);
+      for (j = 0; j < GRAPH_SETUP_COMPONENTS; ++j)
+        {
+          error = OMX_GetHandle (&hdls[j], COMPONENT_NAME,
+                                 (OMX_PTR *) (&appData), &callBacks);
+          fail_if (OMX_ErrorNone != error);
+        }
+      gettimeofday (&end, NULL);
+      if (i > 0)
+        {
+          elapsed_us += (end.tv_sec - start.tv_sec) * 1e6
+                        + (end.tv_usec - start.tv_usec);
+        }
+      for (j = 0; j < GRAPH_SETUP_COMPONENTS; ++j)
+        {
+          error = OMX_FreeHandle (hdls[j]);
+          fail_if (OMX_ErrorNone != error);
+        }
+    }
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "OMX_GetHandle : [%.1f] us/component "
+           "(graph of %d)",
+           elapsed_us / ((GRAPH_SETUP_ITERATIONS - 1) * GRAPH_SETUP_COMPONENTS),
+           GRAPH_SETUP_COMPONENTS);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+}
+END_TEST
+
 START_TEST (test_tizonia_getparameter)
 {
   OMX_ERRORTYPE error = OMX_ErrorNone;
@@ -600,6 +770,54 @@ START_TEST (test_tizonia_getparameter)
 }
 END_TEST
 
+START_TEST (test_tizonia_fast_tunnel_param)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  OMX_U32 appData;
+  OMX_CALLBACKTYPE callBacks;
+  OMX_TIZONIA_PARAM_FASTTUNNELTYPE fast_tunnel;
+  OMX_PTR p_chan = NULL;
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetHandle (&p_hdl,
+                         COMPONENT_NAME, (OMX_PTR *) (&appData), &callBacks);
+  fail_if (OMX_ErrorNone != error);
+
+  fast_tunnel.nSize = sizeof (OMX_TIZONIA_PARAM_FASTTUNNELTYPE);
+  fast_tunnel.nVersion.nVersion = OMX_VERSION;
+  fast_tunnel.nPortIndex = 0;
+  fast_tunnel.pChannel = NULL;
+
+  /* The channel is created on demand... */
+  error = OMX_GetParameter (p_hdl, OMX_TizoniaIndexParamFastTunnel,
+                            &fast_tunnel);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (NULL == fast_tunnel.pChannel);
+  p_chan = fast_tunnel.pChannel;
+
+  /* ... and then reused */
+  fast_tunnel.pChannel = NULL;
+  error = OMX_GetParameter (p_hdl, OMX_TizoniaIndexParamFastTunnel,
+                            &fast_tunnel);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (p_chan != fast_tunnel.pChannel);
+
+  fast_tunnel.nPortIndex = 99;
+  error = OMX_GetParameter (p_hdl, OMX_TizoniaIndexParamFastTunnel,
+                            &fast_tunnel);
+  fail_if (OMX_ErrorBadPortIndex != error);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+}
+END_TEST
+
 START_TEST (test_tizonia_roles)
 {
   OMX_S8 role [OMX_MAX_STRINGNAME_SIZE];
@@ -702,6 +920,148 @@ START_TEST (test_tizonia_roles)
 }
 END_TEST
 
+/* Mirrors TC_SOURCE_EOS_BUFFER_COUNT in the test component: role #2 flags
+   EOS on this buffer */
+#define TUNNELLED_GRAPH_BUFFERS 20000
+/* duration in msec of the wait for the EOS to reach the sink */
+#define TUNNELLED_GRAPH_EOS_TIMEOUT 30000
+
+static void
+_graph_set_state (OMX_HANDLETYPE ap_hdl, cc_ctx_t * ap_ctx,
+                  OMX_STATETYPE a_state)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  error = _ctx_reset (ap_ctx);
+  fail_if (OMX_ErrorNone != error);
+  error = OMX_SendCommand (ap_hdl, OMX_CommandStateSet, a_state, NULL);
+  fail_if (OMX_ErrorNone != error);
+}
+
+static void
+_graph_wait_state (cc_ctx_t * ap_ctx, OMX_STATETYPE a_state)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_BOOL timedout = OMX_FALSE;
+  error = _ctx_wait (ap_ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (a_state != ((check_common_context_t *) (*ap_ctx))->state);
+}
+
+/* Runs role #2 -> role #1 with a_nbufs buffers in the tunnel until the EOS
+   buffer reaches the sink. Returns the elapsed time in usecs. */
+static double
+_run_tunnelled_graph (OMX_U32 a_nbufs)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_src = 0;
+  OMX_HANDLETYPE p_sink = 0;
+  OMX_PARAM_COMPONENTROLETYPE role_type;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  OMX_BOOL timedout = OMX_FALSE;
+  cc_ctx_t src_ctx;
+  cc_ctx_t sink_ctx;
+  struct timeval start, end;
+
+  error = _ctx_init (&src_ctx);
+  fail_if (OMX_ErrorNone != error);
+  error = _ctx_init (&sink_ctx);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetHandle (&p_src, COMPONENT_NAME, (OMX_PTR *) (&src_ctx),
+                         &_check_graph_cbacks);
+  fail_if (OMX_ErrorNone != error);
+  error = OMX_GetHandle (&p_sink, COMPONENT_NAME, (OMX_PTR *) (&sink_ctx),
+                         &_check_graph_cbacks);
+  fail_if (OMX_ErrorNone != error);
+
+  role_type.nSize = sizeof (OMX_PARAM_COMPONENTROLETYPE);
+  role_type.nVersion.nVersion = OMX_VERSION;
+  strcpy ((OMX_STRING) role_type.cRole, COMPONENT_ROLE2);
+  error = OMX_SetParameter (p_src, OMX_IndexParamStandardComponentRole,
+                            &role_type);
+  fail_if (OMX_ErrorNone != error);
+
+  TIZ_INIT_OMX_PORT_STRUCT (port_def, 0);
+  error = OMX_GetParameter (p_src, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_DirOutput != port_def.eDir);
+  port_def.nBufferCountActual = a_nbufs;
+  error = OMX_SetParameter (p_src, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+
+  TIZ_INIT_OMX_PORT_STRUCT (port_def, 0);
+  error = OMX_GetParameter (p_sink, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+  port_def.nBufferCountActual = a_nbufs;
+  error = OMX_SetParameter (p_sink, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_SetupTunnel (p_src, 0, p_sink, 0);
+  fail_if (OMX_ErrorNone != error);
+
+  _graph_set_state (p_src, &src_ctx, OMX_StateIdle);
+  _graph_set_state (p_sink, &sink_ctx, OMX_StateIdle);
+  _graph_wait_state (&src_ctx, OMX_StateIdle);
+  _graph_wait_state (&sink_ctx, OMX_StateIdle);
+
+  /* The sink's input port is the buffer supplier; its Idle->Exe transition
+     waits for the source to be in OMX_StateExecuting */
+  _graph_set_state (p_src, &src_ctx, OMX_StateExecuting);
+  _graph_wait_state (&src_ctx, OMX_StateExecuting);
+
+  gettimeofday (&start, NULL);
+  _graph_set_state (p_sink, &sink_ctx, OMX_StateExecuting);
+  error = _ctx_wait_eos (&sink_ctx, TUNNELLED_GRAPH_EOS_TIMEOUT, &timedout);
+  gettimeofday (&end, NULL);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_StateExecuting != ((check_common_context_t *) (sink_ctx))->state);
+
+  _graph_set_state (p_src, &src_ctx, OMX_StateIdle);
+  _graph_set_state (p_sink, &sink_ctx, OMX_StateIdle);
+  _graph_wait_state (&src_ctx, OMX_StateIdle);
+  _graph_wait_state (&sink_ctx, OMX_StateIdle);
+
+  _graph_set_state (p_src, &src_ctx, OMX_StateLoaded);
+  _graph_set_state (p_sink, &sink_ctx, OMX_StateLoaded);
+  _graph_wait_state (&src_ctx, OMX_StateLoaded);
+  _graph_wait_state (&sink_ctx, OMX_StateLoaded);
+
+  error = OMX_FreeHandle (p_src);
+  fail_if (OMX_ErrorNone != error);
+  error = OMX_FreeHandle (p_sink);
+  fail_if (OMX_ErrorNone != error);
+
+  _ctx_destroy (&src_ctx);
+  _ctx_destroy (&sink_ctx);
+
+  return (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_usec - start.tv_usec);
+}
+
+START_TEST (test_tizonia_tunnelled_graph)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  double elapsed_us = 0;
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  /* With a single buffer in the tunnel, every buffer is a full round trip */
+  elapsed_us = _run_tunnelled_graph (1);
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "Tunnelled graph : [%.2f] us/buffer round trip (1 buffer)",
+           elapsed_us / TUNNELLED_GRAPH_BUFFERS);
+
+  elapsed_us = _run_tunnelled_graph (4);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "Tunnelled graph : [%.0f] buffers/sec (4 buffers)",
+           TUNNELLED_GRAPH_BUFFERS * 1e6 / elapsed_us);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+}
+END_TEST
+
 START_TEST (test_tizonia_preannouncements_extension)
 {
   OMX_ERRORTYPE error = OMX_ErrorNone;
@@ -775,6 +1135,7 @@ START_TEST (test_tizonia_move_to_exe_and_transfer_with_allocbuffer)
   OMX_INDEXTYPE index = OMX_IndexParamPortDefinition;
   OMX_BUFFERHEADERTYPE *p_hdr = NULL;
   OMX_U32 i;
+  tiz_prc_br_info_t br_info;
 
   error = _ctx_init (&ctx);
   fail_if (OMX_ErrorNone != error);
@@ -854,6 +1215,11 @@ START_TEST (test_tizonia_move_to_exe_and_transfer_with_allocbuffer)
   fail_if (OMX_TRUE == timedout);
   fail_if (p_ctx->p_hdr != p_hdr);
 
+  /* One buffer arrival, one BuffersReady notification */
+  tiz_prc_br_info (tiz_get_prc (p_hdl), &br_info);
+  fail_if (1 != br_info.enqueued);
+  fail_if (0 != br_info.suppressed);
+
   /* Initiate transition to IDLE */
   error = _ctx_reset (&ctx);
   state = OMX_StateIdle;
@@ -2047,9 +2413,13 @@ tiz_suite (void)
   (void) test_tizonia_command_cancellation_disabled_to_enabled_with_tunneled_supplied_buffers;
 
   tcase_add_test (tc_tizonia, test_tizonia_getstate);
+  tcase_add_test (tc_tizonia, test_tizonia_msg_pool);
   tcase_add_test (tc_tizonia, test_tizonia_gethandle_freehandle);
+  tcase_add_test (tc_tizonia, test_tizonia_graph_setup_latency);
   tcase_add_test (tc_tizonia, test_tizonia_getparameter);
+  tcase_add_test (tc_tizonia, test_tizonia_fast_tunnel_param);
   tcase_add_test (tc_tizonia, test_tizonia_roles);
+  tcase_add_test (tc_tizonia, test_tizonia_tunnelled_graph);
   tcase_add_test (tc_tizonia, test_tizonia_preannouncements_extension);
   /* TEST DISABLED */
 /*   tcase_add_test (tc_tizonia, */
@@ -30,10 +30,20 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_MEMFD_CREATE
+#define _GNU_SOURCE
+#endif
+
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <unistd.h>
+
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 
 #include "tizmem.h"
 #include "tizlog.h"
@@ -52,6 +62,8 @@ struct tiz_buffer
   int filled_len;
   int offset;
   int seek_mode;
+  bool fixed;    /* Ring mode: the store never grows */
+  bool mirrored; /* The store is mapped twice, back to back */
 };
 
 static long
@@ -81,6 +93,110 @@ alloc_data_store (tiz_buffer_t * ap_buf, const size_t nbytes)
   return ap_buf->p_store;
 }
 
+#ifdef HAVE_MEMFD_CREATE
+/* Maps the same memory object twice, in two adjacent regions of the address
+ * space. This way, data that wraps around the end of the ring can still be
+ * read or written in one go. */
+static void *
+map_mirrored_store (const size_t nbytes)
+{
+  unsigned char * p_addr = NULL;
+  unsigned char * p_store = NULL;
+  int fd = -1;
+
+  assert (nbytes > 0);
+  assert (0 == nbytes % sysconf (_SC_PAGESIZE));
+
+  if ((fd = memfd_create ("tizbuffer", MFD_CLOEXEC)) < 0)
+    {
+      goto end;
+    }
+
+  if (ftruncate (fd, nbytes) < 0)
+    {
+      goto end;
+    }
+
+  /* Reserve the whole region first, so that nothing else is placed in
+   * between the two mappings */
+  if (MAP_FAILED
+      == (p_addr = mmap (NULL, 2 * nbytes, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)))
+    {
+      p_addr = NULL;
+      goto end;
+    }
+
+  if (MAP_FAILED
+        == mmap (p_addr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                 fd, 0)
+      || MAP_FAILED
+           == mmap (p_addr + nbytes, nbytes, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_FIXED, fd, 0))
+    {
+      goto end;
+    }
+
+  p_store = p_addr;
+
+end:
+
+  if (!p_store && p_addr)
+    {
+      (void) munmap (p_addr, 2 * nbytes);
+    }
+
+  if (fd >= 0)
+    {
+      /* The mappings keep the memory object alive */
+      (void) close (fd);
+    }
+
+  return p_store;
+}
+#endif
+
+static inline void *
+alloc_ring_store (tiz_buffer_t * ap_buf, const size_t nbytes)
+{
+  const size_t page_size = sysconf (_SC_PAGESIZE);
+  size_t capacity = 0;
+
+  assert (ap_buf);
+  assert (NULL == ap_buf->p_store);
+
+  if (0 == nbytes || nbytes > INT_MAX / 2)
+    {
+      return NULL;
+    }
+
+  capacity = ((nbytes + page_size - 1) / page_size) * page_size;
+
+#ifdef HAVE_MEMFD_CREATE
+  ap_buf->p_store = map_mirrored_store (capacity);
+  ap_buf->mirrored = (NULL != ap_buf->p_store);
+#endif
+
+  if (!ap_buf->p_store)
+    {
+      /* Without the mirror, the ring behaves like a linear store that is
+         compacted only when a push would not fit at the end */
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to map a mirrored ring store");
+      ap_buf->p_store = tiz_mem_calloc (1, capacity);
+    }
+
+  if (ap_buf->p_store)
+    {
+      ap_buf->alloc_len = capacity;
+      ap_buf->filled_len = 0;
+      ap_buf->offset = 0;
+      ap_buf->seek_mode = TIZ_BUFFER_NON_SEEKABLE;
+      ap_buf->fixed = true;
+    }
+
+  return ap_buf->p_store;
+}
+
 static inline void
 dealloc_data_store (
   /*@special@ */ tiz_buffer_t * ap_buf)
@@ -89,15 +205,71 @@ dealloc_data_store (
 {
   if (ap_buf)
     {
+#ifdef HAVE_MEMFD_CREATE
+      if (ap_buf->mirrored)
+        {
+          (void) munmap (ap_buf->p_store, 2 * ap_buf->alloc_len);
+          ap_buf->p_store = NULL;
+        }
+#endif
       tiz_mem_free (ap_buf->p_store);
       ap_buf->p_store = NULL;
       ap_buf->alloc_len = 0;
       ap_buf->filled_len = 0;
       ap_buf->offset = 0;
       ap_buf->seek_mode = TIZ_BUFFER_NON_SEEKABLE;
+      ap_buf->fixed = false;
+      ap_buf->mirrored = false;
     }
 }
 
+/* Moves the unread data to the front of the store. Only used when a push
+   doesn't fit in the space left at the end of the store. */
+static inline void
+compact_data_store (tiz_buffer_t * ap_buf)
+{
+  assert (ap_buf);
+  assert (!ap_buf->mirrored);
+  if (ap_buf->offset > 0)
+    {
+      memmove (ap_buf->p_store, (ap_buf->p_store + ap_buf->offset),
+               ap_buf->filled_len);
+      ap_buf->offset = 0;
+    }
+}
+
+static int
+push_to_ring (tiz_buffer_t * ap_buf, const void * ap_data,
+              const size_t a_nbytes)
+{
+  size_t nbytes_to_copy = 0;
+  size_t tail = 0;
+
+  assert (ap_buf);
+  assert (ap_buf->fixed);
+
+  nbytes_to_copy = MIN (ap_buf->alloc_len - ap_buf->filled_len, a_nbytes);
+  tail = ap_buf->offset + ap_buf->filled_len;
+
+  if (ap_buf->mirrored)
+    {
+      /* The second mapping makes the write contiguous, even when it wraps */
+      if (tail >= ap_buf->alloc_len)
+        {
+          tail -= ap_buf->alloc_len;
+        }
+    }
+  else if (tail + nbytes_to_copy > ap_buf->alloc_len)
+    {
+      compact_data_store (ap_buf);
+      tail = ap_buf->filled_len;
+    }
+
+  memcpy (ap_buf->p_store + tail, ap_data, nbytes_to_copy);
+  ap_buf->filled_len += nbytes_to_copy;
+  return nbytes_to_copy;
+}
+
 OMX_ERRORTYPE
 tiz_buffer_init (/*@null@ */ tiz_buffer_ptr_t * app_buf, const size_t a_nbytes)
 {
@@ -135,6 +307,28 @@ end:
   return rc;
 }
 
+OMX_ERRORTYPE
+tiz_buffer_init_ring (/*@null@ */ tiz_buffer_ptr_t * app_buf,
+                      const size_t a_capacity)
+{
+  tiz_buffer_t * p_buf = NULL;
+
+  assert (app_buf);
+
+  if ((p_buf = tiz_mem_calloc (1, sizeof (tiz_buffer_t))))
+    {
+      if (!alloc_ring_store (p_buf, a_capacity))
+        {
+          tiz_mem_free (p_buf);
+          p_buf = NULL;
+        }
+    }
+
+  *app_buf = p_buf;
+
+  return p_buf ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+}
+
 void
 tiz_buffer_destroy (tiz_buffer_t * ap_buf)
 {
@@ -149,10 +343,15 @@ int
 tiz_buffer_seek_mode (tiz_buffer_t * ap_buf, const int a_seek_mode)
 {
   int old_val = -1;
+  assert (ap_buf);
+  if (ap_buf->fixed && a_seek_mode == TIZ_BUFFER_SEEKABLE)
+    {
+      /* Ring buffers discard the data as soon as it's been consumed */
+      return -1;
+    }
   if (a_seek_mode == TIZ_BUFFER_SEEKABLE
       || a_seek_mode == TIZ_BUFFER_NON_SEEKABLE)
     {
-      assert (ap_buf);
       old_val = ap_buf->seek_mode;
       ap_buf->seek_mode = a_seek_mode;
     }
@@ -166,18 +365,26 @@ tiz_buffer_push (tiz_buffer_t * ap_buf, const void * ap_data,
   OMX_U32 nbytes_to_copy = 0;
 
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (ap_buf->mirrored
+          || ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+
+  if (ap_buf->fixed)
+    {
+      return (ap_data && a_nbytes > 0) ? push_to_ring (ap_buf, ap_data, a_nbytes)
+                                       : 0;
+    }
 
   if (ap_data && a_nbytes > 0)
     {
       size_t avail = 0;
 
+      /* Data behind the position marker is only discarded when there isn't
+         enough room at the end of the store for the new data */
       if (ap_buf->seek_mode == TIZ_BUFFER_NON_SEEKABLE
-          && ap_buf->offset > 0)
+          && a_nbytes
+               > ap_buf->alloc_len - (ap_buf->offset + ap_buf->filled_len))
         {
-          memmove (ap_buf->p_store, (ap_buf->p_store + ap_buf->offset),
-                   ap_buf->filled_len);
-          ap_buf->offset = 0;
+          compact_data_store (ap_buf);
         }
 
       avail = ap_buf->alloc_len - (ap_buf->offset + ap_buf->filled_len);
@@ -206,7 +413,8 @@ int
 tiz_buffer_available (const tiz_buffer_t * ap_buf)
 {
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (ap_buf->mirrored
+          || ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
   return ap_buf->filled_len;
 }
 
@@ -214,7 +422,8 @@ int
 tiz_buffer_offset (const tiz_buffer_t * ap_buf)
 {
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (ap_buf->mirrored
+          || ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
   return ap_buf->offset;
 }
 
@@ -222,7 +431,8 @@ void *
 tiz_buffer_get (const tiz_buffer_t * ap_buf)
 {
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (ap_buf->mirrored
+          || ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
   return (ap_buf->p_store + ap_buf->offset);
 }
 
@@ -236,6 +446,10 @@ tiz_buffer_advance (tiz_buffer_t * ap_buf, const int nbytes)
       min_nbytes = MIN (nbytes, tiz_buffer_available (ap_buf));
       ap_buf->offset += min_nbytes;
       ap_buf->filled_len -= min_nbytes;
+      if (ap_buf->mirrored && ap_buf->offset >= ap_buf->alloc_len)
+        {
+          ap_buf->offset -= ap_buf->alloc_len;
+        }
     }
   return min_nbytes;
 }
@@ -245,6 +459,13 @@ tiz_buffer_seek (tiz_buffer_t * ap_buf, const long offset, const int whence)
 {
   int rc = -1;
   assert (ap_buf);
+
+  if (ap_buf->fixed)
+    {
+      /* Not supported on ring buffers */
+      return -1;
+    }
+
   assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
 
   int total = ap_buf->offset + ap_buf->filled_len;
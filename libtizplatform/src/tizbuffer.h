@@ -77,6 +77,26 @@ typedef /*@null@ */ tiz_buffer_t * tiz_buffer_ptr_t;
 OMX_ERRORTYPE
 tiz_buffer_init (/*@null@ */ tiz_buffer_ptr_t * app_buf, const size_t a_nbytes);
 
+/**
+ * Create a new fixed-capacity ring buffer object.
+ *
+ * A ring buffer never grows and never moves its data. The store is mapped
+ * twice in adjacent regions of memory (where the platform supports it), so
+ * that the data returned by tiz_buffer_get is always contiguous, even when it
+ * wraps around the end of the ring. Ring buffers only operate in
+ * TIZ_BUFFER_NON_SEEKABLE mode, and tiz_buffer_push stores at most as many
+ * bytes as there is free space in the ring.
+ *
+ * @ingroup tizbuffer
+ * @param app_buf A buffer handle to be initialised.
+ * @param a_capacity The capacity of the ring (rounded up to a multiple of the
+ * page size).
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_buffer_init_ring (/*@null@ */ tiz_buffer_ptr_t * app_buf,
+                      const size_t a_capacity);
+
 /**
  * Destroy a dynamic buffer object.
  *
@@ -93,7 +113,8 @@ tiz_buffer_destroy (tiz_buffer_t * ap_buf);
  * @param ap_buf The dynamic buffer handle.
  * @param a_seek_mode TIZ_BUFFER_NON_SEEKABLE (default) or
  * TIZ_BUFFER_SEEKABLE.
- * @return The old seek mode, or -1 on error.
+ * @return The old seek mode, or -1 on error (or if the buffer is a ring
+ * buffer and a_seek_mode is TIZ_BUFFER_SEEKABLE).
  */
 int
 tiz_buffer_seek_mode (tiz_buffer_t * ap_buf, const int a_seek_mode);
@@ -147,7 +168,8 @@ tiz_buffer_offset (const tiz_buffer_t * ap_buf);
  * from.
  *
  * If the buffer is empty, i.e. tiz_buffer_available returns zero, the
- * pointer returned is the position of the start of the buffer.
+ * pointer returned is the position of the start of the buffer (or, in the case
+ * of a ring buffer, the position where the next push will store data).
  *
  * @ingroup tizbuffer
  * @param ap_buf The dynamic buffer handle.
@@ -184,7 +206,8 @@ tiz_buffer_advance (tiz_buffer_t * ap_buf, const int nbytes);
  * TIZ_BUFFER_SEEK_END.
  * @return 0 on success, -1 on error (e.g. the whence argument was not
  * TIZ_BUFFER_SEEK_SET, TIZ_BUFFER_SEEK_END, or TIZ_BUFFER_SEEK_CUR.  Or the
- * resulting buffer offset would be negative).
+ * resulting buffer offset would be negative, or the buffer is a ring
+ * buffer).
  */
 int
 tiz_buffer_seek (tiz_buffer_t * ap_buf, const long a_offset,
@@ -0,0 +1,374 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizlfqueue.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Lock-free message queue handling
+ *
+ * This is a bounded array-based queue in the style of D. Vyukov's MPMC
+ * queue, restricted to a single consumer. Each cell carries a sequence
+ * number that tells producers and the consumer whether the cell is free or
+ * holds a published item. Parking is done on futex words that are only
+ * touched when a thread actually needs to sleep.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "tizplatform.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.platform.lfqueue"
+#endif
+
+typedef struct tiz_lfqueue_cell tiz_lfqueue_cell_t;
+struct tiz_lfqueue_cell
+{
+  size_t seq;
+  OMX_PTR p_data;
+};
+
+struct tiz_lfqueue
+{
+  /* Written by producers only */
+  size_t tail TIZ_CACHELINE_ALIGNED;
+  /* Written by the consumer only */
+  size_t head TIZ_CACHELINE_ALIGNED;
+  /* Futex word: 1 while the consumer is parked waiting for data */
+  int32_t consumer_parked TIZ_CACHELINE_ALIGNED;
+  /* Number of producers waiting for space and their futex word */
+  int32_t producers_parked;
+  int32_t space_seq;
+  /* Read-only after init */
+  tiz_lfqueue_cell_t * p_cells TIZ_CACHELINE_ALIGNED;
+  size_t mask;
+  OMX_S32 capacity;
+};
+
+static inline int
+futex_wait (int32_t * ap_addr, int32_t a_val, const struct timespec * ap_ts)
+{
+  return syscall (SYS_futex, ap_addr, FUTEX_WAIT_PRIVATE, a_val, ap_ts, NULL,
+                  0);
+}
+
+static inline void
+futex_wake (int32_t * ap_addr, int32_t a_nwaiters)
+{
+  (void) syscall (SYS_futex, ap_addr, FUTEX_WAKE_PRIVATE, a_nwaiters, NULL,
+                  NULL, 0);
+}
+
+static inline OMX_U64
+now_millis (void)
+{
+  struct timespec ts;
+  (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ((OMX_U64) ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static inline bool
+try_enqueue (tiz_lfqueue_t * ap_q, OMX_PTR ap_data)
+{
+  tiz_lfqueue_cell_t * p_cell = NULL;
+  size_t pos = __atomic_load_n (&(ap_q->tail), __ATOMIC_RELAXED);
+
+  for (;;)
+    {
+      size_t seq = 0;
+      intptr_t diff = 0;
+      p_cell = &(ap_q->p_cells[pos & ap_q->mask]);
+      seq = __atomic_load_n (&(p_cell->seq), __ATOMIC_ACQUIRE);
+      diff = (intptr_t) seq - (intptr_t) pos;
+      if (0 == diff)
+        {
+          if (__atomic_compare_exchange_n (&(ap_q->tail), &pos, pos + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          /* full */
+          return false;
+        }
+      else
+        {
+          pos = __atomic_load_n (&(ap_q->tail), __ATOMIC_RELAXED);
+        }
+    }
+
+  p_cell->p_data = ap_data;
+  __atomic_store_n (&(p_cell->seq), pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static inline bool
+try_dequeue (tiz_lfqueue_t * ap_q, OMX_PTR * app_data)
+{
+  const size_t pos = ap_q->head;
+  tiz_lfqueue_cell_t * p_cell = &(ap_q->p_cells[pos & ap_q->mask]);
+  const size_t seq = __atomic_load_n (&(p_cell->seq), __ATOMIC_ACQUIRE);
+
+  if ((intptr_t) seq - (intptr_t) (pos + 1) < 0)
+    {
+      /* empty, or the producer that claimed this cell has not published it
+         yet */
+      return false;
+    }
+
+  assert (seq == pos + 1);
+  *app_data = p_cell->p_data;
+  p_cell->p_data = NULL;
+  __atomic_store_n (&(ap_q->head), pos + 1, __ATOMIC_RELEASE);
+  __atomic_store_n (&(p_cell->seq), pos + ap_q->mask + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static inline void
+wake_consumer (tiz_lfqueue_t * ap_q)
+{
+  /* Order the publication of the item before the check of the parked flag;
+     pairs with the fence in park_consumer. */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&(ap_q->consumer_parked), __ATOMIC_RELAXED)
+      && __atomic_exchange_n (&(ap_q->consumer_parked), 0, __ATOMIC_SEQ_CST))
+    {
+      futex_wake (&(ap_q->consumer_parked), 1);
+    }
+}
+
+static inline void
+wake_producers (tiz_lfqueue_t * ap_q)
+{
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&(ap_q->producers_parked), __ATOMIC_RELAXED) > 0)
+    {
+      (void) __atomic_add_fetch (&(ap_q->space_seq), 1, __ATOMIC_SEQ_CST);
+      futex_wake (&(ap_q->space_seq), INT_MAX);
+    }
+}
+
+static OMX_ERRORTYPE
+park_consumer (tiz_lfqueue_t * ap_q, OMX_PTR * app_data,
+               const struct timespec * ap_ts)
+{
+  __atomic_store_n (&(ap_q->consumer_parked), 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+  /* Re-check after announcing that we are about to sleep, so that a producer
+     that published before seeing the flag is not missed */
+  if (try_dequeue (ap_q, app_data))
+    {
+      __atomic_store_n (&(ap_q->consumer_parked), 0, __ATOMIC_RELAXED);
+      return OMX_ErrorNone;
+    }
+
+  if (-1 == futex_wait (&(ap_q->consumer_parked), 1, ap_ts)
+      && ETIMEDOUT == errno)
+    {
+      __atomic_store_n (&(ap_q->consumer_parked), 0, __ATOMIC_RELAXED);
+      return OMX_ErrorTimeout;
+    }
+
+  __atomic_store_n (&(ap_q->consumer_parked), 0, __ATOMIC_RELAXED);
+  return OMX_ErrorNotReady;
+}
+
+OMX_ERRORTYPE
+tiz_lfqueue_init (tiz_lfqueue_ptr_t * app_q, OMX_S32 a_capacity)
+{
+  tiz_lfqueue_t * p_q = NULL;
+  size_t ncells = 2;
+  size_t i = 0;
+
+  assert (app_q);
+  assert (a_capacity > 0);
+
+  while (ncells < (size_t) a_capacity)
+    {
+      ncells <<= 1;
+    }
+
+  if (0 != posix_memalign ((void **) &p_q, TIZ_CACHELINE_SIZE,
+                           sizeof (tiz_lfqueue_t)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "[OMX_ErrorInsufficientResources] : "
+               "Could not instantiate queue struct.");
+      return OMX_ErrorInsufficientResources;
+    }
+  tiz_mem_set (p_q, 0, sizeof (tiz_lfqueue_t));
+
+  if (!(p_q->p_cells = (tiz_lfqueue_cell_t *) tiz_mem_calloc (
+          ncells, sizeof (tiz_lfqueue_cell_t))))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "[OMX_ErrorInsufficientResources] : "
+               "Could not instantiate queue items.");
+      tiz_mem_free (p_q);
+      return OMX_ErrorInsufficientResources;
+    }
+
+  for (i = 0; i < ncells; ++i)
+    {
+      p_q->p_cells[i].seq = i;
+    }
+
+  p_q->mask = ncells - 1;
+  p_q->capacity = (OMX_S32) ncells;
+  *app_q = p_q;
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "queue [%p] capacity [%d] (requested [%d])",
+           p_q, p_q->capacity, a_capacity);
+
+  return OMX_ErrorNone;
+}
+
+void
+tiz_lfqueue_destroy (tiz_lfqueue_t * ap_q)
+{
+  if (ap_q)
+    {
+      tiz_mem_free (ap_q->p_cells);
+      ap_q->p_cells = NULL;
+      tiz_mem_free (ap_q);
+    }
+}
+
+OMX_ERRORTYPE
+tiz_lfqueue_send (tiz_lfqueue_t * ap_q, OMX_PTR ap_data)
+{
+  assert (ap_q);
+  assert (ap_data);
+
+  while (!try_enqueue (ap_q, ap_data))
+    {
+      const int32_t seq
+        = __atomic_load_n (&(ap_q->space_seq), __ATOMIC_ACQUIRE);
+      (void) __atomic_add_fetch (&(ap_q->producers_parked), 1,
+                                 __ATOMIC_SEQ_CST);
+      if (tiz_lfqueue_length (ap_q) >= ap_q->capacity)
+        {
+          (void) futex_wait (&(ap_q->space_seq), seq, NULL);
+        }
+      (void) __atomic_sub_fetch (&(ap_q->producers_parked), 1,
+                                 __ATOMIC_SEQ_CST);
+    }
+
+  wake_consumer (ap_q);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+tiz_lfqueue_receive (tiz_lfqueue_t * ap_q, OMX_PTR * app_data)
+{
+  assert (ap_q);
+  assert (app_data);
+
+  while (!try_dequeue (ap_q, app_data))
+    {
+      if (OMX_ErrorNone == park_consumer (ap_q, app_data, NULL))
+        {
+          break;
+        }
+    }
+
+  wake_producers (ap_q);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+tiz_lfqueue_timed_receive (tiz_lfqueue_t * ap_q, OMX_PTR * app_data,
+                           OMX_U32 a_millis)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  const OMX_U64 deadline = now_millis () + a_millis;
+
+  assert (ap_q);
+  assert (app_data);
+
+  while (!try_dequeue (ap_q, app_data))
+    {
+      const OMX_U64 now = now_millis ();
+      struct timespec ts;
+
+      if (now >= deadline)
+        {
+          return OMX_ErrorTimeout;
+        }
+
+      ts.tv_sec = (deadline - now) / 1000;
+      ts.tv_nsec = ((deadline - now) % 1000) * 1000000;
+      rc = park_consumer (ap_q, app_data, &ts);
+      if (OMX_ErrorNone == rc)
+        {
+          break;
+        }
+      else if (OMX_ErrorTimeout == rc)
+        {
+          /* One last attempt, in case an item arrived at the deadline */
+          if (!try_dequeue (ap_q, app_data))
+            {
+              return OMX_ErrorTimeout;
+            }
+          break;
+        }
+    }
+
+  wake_producers (ap_q);
+  return OMX_ErrorNone;
+}
+
+OMX_S32
+tiz_lfqueue_capacity (const tiz_lfqueue_t * ap_q)
+{
+  assert (ap_q);
+  return ap_q->capacity;
+}
+
+OMX_S32
+tiz_lfqueue_length (const tiz_lfqueue_t * ap_q)
+{
+  size_t head = 0;
+  size_t tail = 0;
+  assert (ap_q);
+  head = __atomic_load_n (&(ap_q->head), __ATOMIC_ACQUIRE);
+  tail = __atomic_load_n (&(ap_q->tail), __ATOMIC_ACQUIRE);
+  /* tail counts claimed cells, some of which may not be published yet */
+  return (tail > head) ? (OMX_S32) MIN (tail - head, (size_t) ap_q->capacity)
+                       : 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizlfqueue.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Lock-free message queue handling
+ *
+ *
+ */
+
+#ifndef TIZLFQUEUE_H
+#define TIZLFQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tizlfqueue Lock-free message queue handling
+ *
+ * Bounded, lock-free, multi-producer/single-consumer FIFO queue. Senders
+ * never take a lock; a futex-based wakeup is only issued when the consumer
+ * (or a sender waiting for space) is parked.
+ *
+ * @ingroup libtizplatform
+ */
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+
+/**
+ * Lock-free queue opaque structure.
+ * @ingroup tizlfqueue
+ */
+typedef struct tiz_lfqueue tiz_lfqueue_t;
+typedef /*@null@ */ tiz_lfqueue_t * tiz_lfqueue_ptr_t;
+
+/**
+ * Initialize a new empty lock-free queue.
+ *
+ * @ingroup tizlfqueue
+ *
+ * @param app_q A queue opaque handle to be initialised.
+ *
+ * @param a_capacity Maximum number of items that can be send into the
+ * queue. It is rounded up to the next power of two.
+ *
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_lfqueue_init (/*@out@*/ tiz_lfqueue_ptr_t * app_q, OMX_S32 a_capacity);
+
+/**
+ * Destroy a queue. If ap_q is NULL, no operation is performed.
+ *
+ * @ingroup tizlfqueue
+ *
+ */
+void
+tiz_lfqueue_destroy (/*@null@ */ tiz_lfqueue_t * ap_q);
+
+/**
+ * Add an item onto the end of the queue. This function may be called
+ * concurrently from any number of threads. If the queue is full, it blocks
+ * until a space becomes available.
+ *
+ * @ingroup tizlfqueue
+ *
+ */
+OMX_ERRORTYPE
+tiz_lfqueue_send (tiz_lfqueue_t * ap_q, OMX_PTR ap_data);
+
+/**
+ * Retrieve an item from the head of the queue. If the queue is empty, it
+ * blocks until an item becomes available. Only one thread at a time may be
+ * receiving from the queue.
+ *
+ * @ingroup tizlfqueue
+ *
+ */
+OMX_ERRORTYPE
+tiz_lfqueue_receive (tiz_lfqueue_t * ap_q, OMX_PTR * app_data);
+
+/**
+ * Retrieve an item from the head of the queue. If the queue is empty, it waits
+ * for up to a_millis milliseconds or until an item becomes available.
+ *
+ * @ingroup tizlfqueue
+ *
+ * @return OMX_ErrorNone if an item was retrieved, OMX_ErrorTimeout otherwise.
+ */
+OMX_ERRORTYPE
+tiz_lfqueue_timed_receive (tiz_lfqueue_t * ap_q, OMX_PTR * app_data,
+                           OMX_U32 a_millis);
+
+/**
+ * Retrieve the maximum number of items that can be stored in the queue.
+ *
+ * @ingroup tizlfqueue
+ *
+ */
+OMX_S32
+tiz_lfqueue_capacity (const tiz_lfqueue_t * ap_q);
+
+/**
+ * Retrieve the number of items currently stored in the queue. The value
+ * returned is a snapshot and may be stale by the time the caller uses it.
+ *
+ * @ingroup tizlfqueue
+ *
+ */
+OMX_S32
+tiz_lfqueue_length (const tiz_lfqueue_t * ap_q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZLFQUEUE_H */
@@ -30,23 +30,58 @@
 #include <config.h>
 #endif
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <limits.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <time.h>
 #include <alloca.h>
+#include <linux/futex.h>
 
 #include <log4c.h>
 #include <log4c/appender.h>
 #include <log4c/appender_type_rollingfile.h>
 #include <log4c/rollingpolicy.h>
 
+#include "tizmacros.h"
+#include "tizmem.h"
 #include "tizlog.h"
 
+/* TODO: 4096 - this value should be obtained at config time */
+#define TIZ_LOG_MSG_MAX 4096
+/* Number of distinct category names that are cached; power of 2 */
+#define TIZ_LOG_CAT_CACHE_SIZE 256
+/* Per-thread record ring; power of 2 */
+#define TIZ_LOG_RING_SIZE (128 * 1024)
+/* Largest record; calls whose arguments don't fit are formatted by the
+   caller */
+#define TIZ_LOG_REC_MAX (TIZ_LOG_MSG_MAX + 1024)
+/* How often the writer (or, in synchronous mode, tiz_log) re-reads category
+   priorities; the writer also reports drops on this period */
+#define TIZ_LOG_WRITER_PERIOD_MS 1000
+/* In synchronous mode, calls on a thread between clock reads; power of 2 */
+#define TIZ_LOG_SYNC_REFRESH_CALLS 64
+#define TIZ_LOG_SPEC_MAX 64
+
+#define TIZ_LOG_REC_PAD 0x01  /* filler up to the end of the ring */
+#define TIZ_LOG_REC_TEXT 0x02 /* the message is already formatted */
+#define TIZ_LOG_REC_CNAME 0x04 /* a component name is present */
+
+#define TIZ_LOG_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
 typedef struct user_locinfo user_locinfo_t;
 struct user_locinfo
 {
@@ -54,8 +89,96 @@ struct user_locinfo
   int tid;
   const char * cname;
   char * cbuf;
+  /* Time of the tiz_log call, when the event is logged later */
+  const struct timeval * p_ts;
+};
+
+/* A cached log4c category. Entries are keyed by the category name passed to
+   tiz_log; the cache keeps its own copy of the name. */
+typedef struct tiz_log_cat tiz_log_cat_t;
+struct tiz_log_cat
+{
+  const char * p_name;
+  log4c_category_t * p_cat;
+  int priority;
+};
+
+/* A log record, as stored in a thread's ring. It is followed by the
+   file, function, component name and format strings (NUL-terminated), and
+   then the arguments, in the order the format string consumes them. */
+typedef struct tiz_log_rec tiz_log_rec_t;
+struct tiz_log_rec
+{
+  uint32_t size;
+  uint32_t flags;
+  int priority;
+  int line;
+  struct timeval ts;
+  tiz_log_cat_t * p_cat;
+  uint16_t file_len;
+  uint16_t func_len;
+  uint16_t cname_len;
+  uint16_t fmt_len;
+  uint32_t args_len;
+};
+
+/* Single-producer/single-consumer byte ring. The owning thread appends
+   records, the writer thread consumes them. */
+typedef struct tiz_log_ring tiz_log_ring_t;
+struct tiz_log_ring
+{
+  /* Written by the owning thread only */
+  size_t tail TIZ_CACHELINE_ALIGNED;
+  uint32_t dropped;
+  /* Written by the writer thread only */
+  size_t head TIZ_CACHELINE_ALIGNED;
+  uint32_t dropped_reported;
+  /* Set when the owning thread exits */
+  bool orphaned TIZ_CACHELINE_ALIGNED;
+  int tid;
+  char * p_data;
+  tiz_log_ring_t * p_next;
+};
+
+/* A printf conversion specification */
+typedef struct tiz_log_spec tiz_log_spec_t;
+struct tiz_log_spec
+{
+  size_t len;
+  bool width_star;
+  bool prec_star;
+  int prec;
+  char length;
+  char conv;
+};
+
+typedef enum tiz_log_writer_state tiz_log_writer_state_t;
+enum tiz_log_writer_state
+{
+  ETIZLogWriterIdle,
+  ETIZLogWriterRunning,
+  ETIZLogWriterStopping,
+  ETIZLogWriterDisabled
 };
 
+static tiz_log_cat_t g_cats[TIZ_LOG_CAT_CACHE_SIZE];
+static pthread_mutex_t g_cats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t g_cats_refreshed_ms = 0;
+
+static tiz_log_ring_t * gp_rings = NULL;
+static pthread_mutex_t g_rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_ring_key;
+static pthread_once_t g_ring_key_once = PTHREAD_ONCE_INIT;
+
+/* Synchronous logging until tiz_log_init is called */
+static tiz_log_writer_state_t g_writer_state = ETIZLogWriterDisabled;
+static pthread_mutex_t g_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t g_writer_thread;
+static int32_t g_writer_parked = 0;
+
+static __thread tiz_log_ring_t * tp_ring = NULL;
+static __thread int t_tid = 0;
+
 static const char *
 log_layout_format (const log4c_layout_t * a_layout,
                    const log4c_logging_event_t * a_event)
@@ -70,8 +193,10 @@ log_layout_format (const log4c_layout_t * a_layout,
   if (a_event->evt_loc->loc_data)
     {
       struct tm tm;
-      gmtime_r (&a_event->evt_timestamp.tv_sec, &tm);
+      const struct timeval * p_ts = NULL;
       uloc = (user_locinfo_t *) a_event->evt_loc->loc_data;
+      p_ts = uloc->p_ts ? uloc->p_ts : &a_event->evt_timestamp;
+      gmtime_r (&p_ts->tv_sec, &tm);
 
       if (NULL == uloc->cname)
         {
@@ -79,7 +204,7 @@ log_layout_format (const log4c_layout_t * a_layout,
                     "%02d-%02d-%04d %02d:%02d:%02d.%03ld - "
                     "[PID:%i][TID:%i] [%s] [%s] [%s:%s:%i] --- %s\n",
                     tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour,
-                    tm.tm_min, tm.tm_sec, a_event->evt_timestamp.tv_usec / 1000,
+                    tm.tm_min, tm.tm_sec, p_ts->tv_usec / 1000,
                     uloc->pid, uloc->tid,
                     log4c_priority_to_string (a_event->evt_priority),
                     a_event->evt_category, a_event->evt_loc->loc_file,
@@ -94,7 +219,7 @@ log_layout_format (const log4c_layout_t * a_layout,
                     "%02d-%02d-%04d %02d:%02d:%02d.%03ld - "
                     "[PID:%i][TID:%i] [%s] [%s] [%s:%s:%i] --- %s\n",
                     tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour,
-                    tm.tm_min, tm.tm_sec, a_event->evt_timestamp.tv_usec / 1000,
+                    tm.tm_min, tm.tm_sec, p_ts->tv_usec / 1000,
                     uloc->pid, uloc->tid,
                     log4c_priority_to_string (a_event->evt_priority),
                     uloc->cname, a_event->evt_loc->loc_file,
@@ -139,12 +264,1193 @@ log_formatters_init (void)
   return rc;
 }
 
+static inline int
+futex_wait (int32_t * ap_addr, int32_t a_val, const struct timespec * ap_ts)
+{
+  return syscall (SYS_futex, ap_addr, FUTEX_WAIT_PRIVATE, a_val, ap_ts, NULL,
+                  0);
+}
+
+static inline void
+futex_wake (int32_t * ap_addr, int32_t a_nwaiters)
+{
+  (void) syscall (SYS_futex, ap_addr, FUTEX_WAKE_PRIVATE, a_nwaiters, NULL,
+                  NULL, 0);
+}
+
+static inline uint64_t
+now_millis (void)
+{
+  struct timespec ts;
+  (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static inline int
+get_tid (void)
+{
+  if (0 == t_tid)
+    {
+      t_tid = syscall (SYS_gettid);
+    }
+  return t_tid;
+}
+
+static void
+log_event (const log4c_category_t * ap_cat, const char * ap_file, int a_line,
+           const char * ap_func, int a_priority, const char * ap_cname,
+           char * ap_cbuf, const struct timeval * ap_ts, int a_pid,
+           int a_tid, const char * ap_msg)
+{
+  log4c_location_info_t locinfo;
+  user_locinfo_t user_locinfo;
+
+  user_locinfo.pid = a_pid;
+  user_locinfo.tid = a_tid;
+  user_locinfo.cname = ap_cname;
+  user_locinfo.cbuf = ap_cbuf;
+  user_locinfo.p_ts = ap_ts;
+  locinfo.loc_file = ap_file;
+  locinfo.loc_line = a_line;
+  locinfo.loc_function = ap_func;
+  locinfo.loc_data = &user_locinfo;
+
+  log4c_category_log_locinfo (ap_cat, &locinfo, a_priority, "%s", ap_msg);
+}
+
+/*
+ * Category cache
+ */
+
+/* Categories are keyed by name, not by the address of the name: the
+ * string may belong to a plugin that is unloaded, and its address reused by
+ * a different name. */
+static inline size_t
+cat_hash (const char * ap_name)
+{
+  uint32_t h = 2166136261U; /* FNV-1a */
+  while (*ap_name)
+    {
+      h ^= (uint8_t) *ap_name++;
+      h *= 16777619U;
+    }
+  return (size_t) h & (TIZ_LOG_CAT_CACHE_SIZE - 1);
+}
+
+static tiz_log_cat_t *
+get_cat (const char * ap_name)
+{
+  const size_t idx = cat_hash (ap_name);
+  tiz_log_cat_t * p_cat = NULL;
+  size_t i = 0;
+
+  /* Lock-free lookup; entries are never removed while logging is active */
+  for (i = 0; i < TIZ_LOG_CAT_CACHE_SIZE; ++i)
+    {
+      const char * p_key = NULL;
+      p_cat = &(g_cats[(idx + i) & (TIZ_LOG_CAT_CACHE_SIZE - 1)]);
+      p_key = __atomic_load_n (&(p_cat->p_name), __ATOMIC_ACQUIRE);
+      if (p_key && 0 == strcmp (p_key, ap_name))
+        {
+          return p_cat;
+        }
+      if (NULL == p_key)
+        {
+          break;
+        }
+    }
+
+  /* Slow path: first time this category name is seen */
+  (void) pthread_mutex_lock (&g_cats_mutex);
+  for (i = 0; i < TIZ_LOG_CAT_CACHE_SIZE; ++i)
+    {
+      const char * p_key = NULL;
+      p_cat = &(g_cats[(idx + i) & (TIZ_LOG_CAT_CACHE_SIZE - 1)]);
+      p_key = __atomic_load_n (&(p_cat->p_name), __ATOMIC_RELAXED);
+      if (p_key && 0 == strcmp (p_key, ap_name))
+        {
+          break;
+        }
+      if (NULL == p_key)
+        {
+          /* The cache keeps its own copy of the name */
+          char * p_name = strdup (ap_name);
+          if (!p_name)
+            {
+              i = TIZ_LOG_CAT_CACHE_SIZE;
+              break;
+            }
+          p_cat->p_cat = log4c_category_get (ap_name);
+          __atomic_store_n (&(p_cat->priority),
+                            log4c_category_get_chainedpriority (p_cat->p_cat),
+                            __ATOMIC_RELAXED);
+          __atomic_store_n (&(p_cat->p_name), p_name, __ATOMIC_RELEASE);
+          break;
+        }
+    }
+  (void) pthread_mutex_unlock (&g_cats_mutex);
+
+  /* The cache is full (or out of memory); the caller takes the uncached
+   * path */
+  return (i < TIZ_LOG_CAT_CACHE_SIZE) ? p_cat : NULL;
+}
+
+static void
+refresh_cats (void)
+{
+  size_t i = 0;
+  for (i = 0; i < TIZ_LOG_CAT_CACHE_SIZE; ++i)
+    {
+      tiz_log_cat_t * p_cat = &(g_cats[i]);
+      if (__atomic_load_n (&(p_cat->p_name), __ATOMIC_ACQUIRE))
+        {
+          __atomic_store_n (&(p_cat->priority),
+                            log4c_category_get_chainedpriority (p_cat->p_cat),
+                            __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* Without the writer thread, callers take turns to pick up priority changes,
+   at most once per TIZ_LOG_WRITER_PERIOD_MS. The clock is only read every
+   TIZ_LOG_SYNC_REFRESH_CALLS calls on each thread. */
+static inline void
+maybe_refresh_cats (void)
+{
+  static __thread uint32_t t_calls = 0;
+  uint64_t last = 0;
+  uint64_t now = 0;
+
+  if (0 != (++t_calls & (TIZ_LOG_SYNC_REFRESH_CALLS - 1)))
+    {
+      return;
+    }
+
+  last = __atomic_load_n (&g_cats_refreshed_ms, __ATOMIC_RELAXED);
+  now = now_millis ();
+  if (now - last >= TIZ_LOG_WRITER_PERIOD_MS
+      && __atomic_compare_exchange_n (&g_cats_refreshed_ms, &last, now, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+      refresh_cats ();
+    }
+}
+
+static void
+clear_cats (void)
+{
+  size_t i = 0;
+  (void) pthread_mutex_lock (&g_cats_mutex);
+  for (i = 0; i < TIZ_LOG_CAT_CACHE_SIZE; ++i)
+    {
+      free ((char *) g_cats[i].p_name);
+    }
+  memset (g_cats, 0, sizeof (g_cats));
+  (void) pthread_mutex_unlock (&g_cats_mutex);
+}
+
+/*
+ * Per-thread record rings
+ */
+
+static void
+wake_writer (void)
+{
+  /* Order the publication of the record before the check of the parked
+     flag; pairs with the fence in park_writer. */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&g_writer_parked, __ATOMIC_RELAXED)
+      && __atomic_exchange_n (&g_writer_parked, 0, __ATOMIC_SEQ_CST))
+    {
+      futex_wake (&g_writer_parked, 1);
+    }
+}
+
+static void
+ring_key_destroy (void * ap_ring)
+{
+  tiz_log_ring_t * p_ring = ap_ring;
+  assert (p_ring);
+  /* The writer thread releases the ring once it has been drained */
+  __atomic_store_n (&(p_ring->orphaned), true, __ATOMIC_RELEASE);
+  tp_ring = NULL;
+  wake_writer ();
+}
+
+static void
+ring_key_init (void)
+{
+  (void) pthread_key_create (&g_ring_key, ring_key_destroy);
+}
+
+static void
+ring_free (tiz_log_ring_t * ap_ring)
+{
+  if (ap_ring)
+    {
+      tiz_mem_free (ap_ring->p_data);
+      ap_ring->p_data = NULL;
+      free (ap_ring);
+    }
+}
+
+static tiz_log_ring_t *
+get_ring (void)
+{
+  tiz_log_ring_t * p_ring = tp_ring;
+
+  if (p_ring)
+    {
+      return p_ring;
+    }
+
+  (void) pthread_once (&g_ring_key_once, ring_key_init);
+
+  if (0 != posix_memalign ((void **) &p_ring, TIZ_CACHELINE_SIZE,
+                           sizeof (tiz_log_ring_t)))
+    {
+      return NULL;
+    }
+  memset (p_ring, 0, sizeof (tiz_log_ring_t));
+
+  if (!(p_ring->p_data = tiz_mem_alloc (TIZ_LOG_RING_SIZE)))
+    {
+      ring_free (p_ring);
+      return NULL;
+    }
+  p_ring->tid = get_tid ();
+
+  (void) pthread_mutex_lock (&g_rings_mutex);
+  p_ring->p_next = gp_rings;
+  __atomic_store_n (&gp_rings, p_ring, __ATOMIC_RELEASE);
+  (void) pthread_mutex_unlock (&g_rings_mutex);
+
+  (void) pthread_setspecific (g_ring_key, p_ring);
+  tp_ring = p_ring;
+  return p_ring;
+}
+
+static bool
+ring_put (tiz_log_ring_t * ap_ring, const void * ap_rec, const size_t a_size)
+{
+  const size_t tail = ap_ring->tail;
+  const size_t head = __atomic_load_n (&(ap_ring->head), __ATOMIC_ACQUIRE);
+  const size_t offset = tail & (TIZ_LOG_RING_SIZE - 1);
+  const size_t contig = TIZ_LOG_RING_SIZE - offset;
+  const size_t needed = (contig < a_size) ? contig + a_size : a_size;
+  size_t pos = tail;
+
+  assert (0 == (a_size & 7));
+
+  if (TIZ_LOG_RING_SIZE - (tail - head) < needed)
+    {
+      /* Never block the caller; the writer reports the loss */
+      __atomic_store_n (&(ap_ring->dropped), ap_ring->dropped + 1,
+                        __ATOMIC_RELAXED);
+      return false;
+    }
+
+  if (contig < a_size)
+    {
+      /* Records are contiguous; pad the rest of the ring */
+      uint32_t pad[2];
+      pad[0] = (uint32_t) contig;
+      pad[1] = TIZ_LOG_REC_PAD;
+      memcpy (ap_ring->p_data + offset, pad, sizeof (pad));
+      pos += contig;
+    }
+
+  memcpy (ap_ring->p_data + (pos & (TIZ_LOG_RING_SIZE - 1)), ap_rec, a_size);
+  __atomic_store_n (&(ap_ring->tail), pos + a_size, __ATOMIC_RELEASE);
+  return true;
+}
+
+/*
+ * Record serialisation
+ */
+
+/* Parse the printf conversion specification that starts at ap_spec (which
+   points to the '%'). Returns false for anything that can't be captured as
+   a binary argument: positional arguments, wide characters and strings, and
+   %n. */
+static bool
+parse_spec (const char * ap_spec, tiz_log_spec_t * ap_out)
+{
+  const char * p = ap_spec + 1;
+
+  memset (ap_out, 0, sizeof (tiz_log_spec_t));
+  ap_out->prec = -1;
+
+  while (*p && strchr ("-+ #0'", *p))
+    {
+      ++p;
+    }
+
+  if ('*' == *p)
+    {
+      ap_out->width_star = true;
+      ++p;
+    }
+  while (*p >= '0' && *p <= '9')
+    {
+      ++p;
+    }
+
+  if ('.' == *p)
+    {
+      ++p;
+      ap_out->prec = 0;
+      if ('*' == *p)
+        {
+          ap_out->prec_star = true;
+          ++p;
+        }
+      while (*p >= '0' && *p <= '9')
+        {
+          ap_out->prec = ap_out->prec * 10 + (*p - '0');
+          ++p;
+        }
+    }
+
+  if ('$' == *p)
+    {
+      return false;
+    }
+
+  switch (*p)
+    {
+      case 'h':
+        ap_out->length = ('h' == p[1]) ? 'H' : 'h';
+        p += ('H' == ap_out->length) ? 2 : 1;
+        break;
+      case 'l':
+        ap_out->length = ('l' == p[1]) ? 'q' : 'l';
+        p += ('q' == ap_out->length) ? 2 : 1;
+        break;
+      case 'q':
+      case 'L':
+      case 'j':
+      case 'z':
+      case 'Z':
+      case 't':
+        ap_out->length = ('Z' == *p) ? 'z' : *p;
+        ++p;
+        break;
+      default:
+        break;
+    };
+
+  if ('\0' == *p || !strchr ("diouxXcspfFeEgGaA%", *p)
+      || ('l' == ap_out->length && ('c' == *p || 's' == *p)))
+    {
+      return false;
+    }
+
+  ap_out->conv = *p;
+  ap_out->len = (size_t) (p - ap_spec) + 1;
+  return ap_out->len < TIZ_LOG_SPEC_MAX;
+}
+
+#define TIZ_LOG_PUT_ARG(type, value)                        \
+  do                                                        \
+    {                                                       \
+      type v_ = (type) (value);                             \
+      if (len + TIZ_LOG_ALIGN (sizeof (type)) > a_max)      \
+        {                                                   \
+          return -1;                                        \
+        }                                                   \
+      memcpy (ap_dst + len, &v_, sizeof (type));            \
+      len += TIZ_LOG_ALIGN (sizeof (type));                 \
+    }                                                       \
+  while (0)
+
+/* Capture the arguments referenced by ap_format. Returns the number of bytes
+   used, or -1 if the arguments can't be captured. */
+static ssize_t
+put_args (char * ap_dst, const size_t a_max, const char * ap_format,
+          va_list a_va)
+{
+  const char * p = ap_format;
+  size_t len = 0;
+
+  while ((p = strchr (p, '%')))
+    {
+      tiz_log_spec_t spec;
+      if (!parse_spec (p, &spec))
+        {
+          return -1;
+        }
+      p += spec.len;
+
+      if ('%' == spec.conv)
+        {
+          continue;
+        }
+
+      if (spec.width_star)
+        {
+          TIZ_LOG_PUT_ARG (int, va_arg (a_va, int));
+        }
+      if (spec.prec_star)
+        {
+          spec.prec = va_arg (a_va, int);
+          TIZ_LOG_PUT_ARG (int, spec.prec);
+        }
+
+      switch (spec.conv)
+        {
+          case 'd':
+          case 'i':
+          case 'o':
+          case 'u':
+          case 'x':
+          case 'X':
+            {
+              switch (spec.length)
+                {
+                  case 'l':
+                    TIZ_LOG_PUT_ARG (long, va_arg (a_va, long));
+                    break;
+                  case 'q':
+                    TIZ_LOG_PUT_ARG (long long, va_arg (a_va, long long));
+                    break;
+                  case 'j':
+                    TIZ_LOG_PUT_ARG (intmax_t, va_arg (a_va, intmax_t));
+                    break;
+                  case 'z':
+                    TIZ_LOG_PUT_ARG (size_t, va_arg (a_va, size_t));
+                    break;
+                  case 't':
+                    TIZ_LOG_PUT_ARG (ptrdiff_t, va_arg (a_va, ptrdiff_t));
+                    break;
+                  default:
+                    /* int, short and char are promoted to int */
+                    TIZ_LOG_PUT_ARG (int, va_arg (a_va, int));
+                    break;
+                };
+            }
+            break;
+          case 'c':
+            TIZ_LOG_PUT_ARG (int, va_arg (a_va, int));
+            break;
+          case 'p':
+            TIZ_LOG_PUT_ARG (void *, va_arg (a_va, void *));
+            break;
+          case 's':
+            {
+              const char * p_str = va_arg (a_va, const char *);
+              uint32_t slen = UINT32_MAX;
+              if (p_str)
+                {
+                  /* Don't read past the precision; the string need not be
+                     NUL-terminated in that case */
+                  slen = (uint32_t) (spec.prec >= 0
+                                       ? strnlen (p_str, (size_t) spec.prec)
+                                       : strlen (p_str));
+                }
+              TIZ_LOG_PUT_ARG (uint32_t, slen);
+              if (p_str)
+                {
+                  if (len + TIZ_LOG_ALIGN (slen + 1) > a_max)
+                    {
+                      return -1;
+                    }
+                  memcpy (ap_dst + len, p_str, slen);
+                  ap_dst[len + slen] = '\0';
+                  len += TIZ_LOG_ALIGN (slen + 1);
+                }
+            }
+            break;
+          default:
+            /* Floating point conversions */
+            if ('L' == spec.length)
+              {
+                TIZ_LOG_PUT_ARG (long double, va_arg (a_va, long double));
+              }
+            else
+              {
+                TIZ_LOG_PUT_ARG (double, va_arg (a_va, double));
+              }
+            break;
+        };
+    }
+
+  return (ssize_t) len;
+}
+
+#undef TIZ_LOG_PUT_ARG
+
+static size_t
+put_str (char * ap_dst, const char * ap_str, const bool a_keep_tail)
+{
+  size_t len = ap_str ? strlen (ap_str) : 0;
+  if (len > UINT8_MAX)
+    {
+      /* Keep the end of long file paths */
+      ap_str += a_keep_tail ? len - UINT8_MAX : 0;
+      len = UINT8_MAX;
+    }
+  if (len > 0)
+    {
+      memcpy (ap_dst, ap_str, len);
+    }
+  ap_dst[len] = '\0';
+  return len;
+}
+
+/* Serialise a log call into ap_rec, which must have room for
+   TIZ_LOG_REC_MAX bytes. The arguments are captured in binary form when
+   possible, otherwise the message is formatted here. */
+static size_t
+make_rec (char * ap_rec, tiz_log_cat_t * ap_cat, const char * ap_file,
+          int a_line, const char * ap_func, int a_priority,
+          const char * ap_cname, const char * ap_format, va_list a_va)
+{
+  tiz_log_rec_t * p_hdr = (tiz_log_rec_t *) ap_rec;
+  char * p = ap_rec + sizeof (tiz_log_rec_t);
+  const size_t fmt_len = strlen (ap_format);
+  ssize_t args_len = -1;
+  size_t len = 0;
+
+  p_hdr->flags = ap_cname ? TIZ_LOG_REC_CNAME : 0;
+  p_hdr->priority = a_priority;
+  p_hdr->line = a_line;
+  (void) gettimeofday (&(p_hdr->ts), NULL);
+  p_hdr->p_cat = ap_cat;
+  p_hdr->file_len = put_str (p, ap_file, true);
+  p += p_hdr->file_len + 1;
+  p_hdr->func_len = put_str (p, ap_func, false);
+  p += p_hdr->func_len + 1;
+  p_hdr->cname_len = put_str (p, ap_cname, false);
+  p += p_hdr->cname_len + 1;
+
+  len = (size_t) (p - ap_rec);
+  if (TIZ_LOG_ALIGN (len + fmt_len + 1) < TIZ_LOG_REC_MAX)
+    {
+      va_list va;
+      const size_t args_off = TIZ_LOG_ALIGN (len + fmt_len + 1);
+      va_copy (va, a_va);
+      args_len = put_args (ap_rec + args_off, TIZ_LOG_REC_MAX - args_off,
+                           ap_format, va);
+      va_end (va);
+      if (args_len >= 0)
+        {
+          memcpy (p, ap_format, fmt_len + 1);
+          p_hdr->fmt_len = (uint16_t) fmt_len;
+          p_hdr->args_len = (uint32_t) args_len;
+          len = args_off + args_len;
+        }
+    }
+
+  if (args_len < 0)
+    {
+      /* Format on the calling thread */
+      va_list va;
+      size_t n = 0;
+      *p = '\0';
+      va_copy (va, a_va);
+      (void) vsnprintf (p, TIZ_LOG_MSG_MAX, ap_format, va);
+      va_end (va);
+      n = strnlen (p, TIZ_LOG_MSG_MAX - 1);
+      p[n] = '\0';
+      p_hdr->flags |= TIZ_LOG_REC_TEXT;
+      p_hdr->fmt_len = (uint16_t) n;
+      p_hdr->args_len = 0;
+      len += n + 1;
+    }
+
+  len = TIZ_LOG_ALIGN (len);
+  p_hdr->size = (uint32_t) len;
+  return len;
+}
+
+/* Expand a record's format string with its captured arguments */
+static void
+format_rec (char * ap_dst, size_t a_max, const char * ap_format,
+            const char * ap_args)
+{
+  const char * p = ap_format;
+  const char * p_args = ap_args;
+  char * p_out = ap_dst;
+  size_t avail = a_max;
+  char spec_buf[TIZ_LOG_SPEC_MAX];
+
+#define TIZ_LOG_GET_ARG(type, var)                          \
+  type var;                                                 \
+  memcpy (&var, p_args, sizeof (type));                     \
+  p_args += TIZ_LOG_ALIGN (sizeof (type))
+
+#define TIZ_LOG_OUT(n)                                    \
+  do                                                      \
+    {                                                     \
+      const int rc_ = (n);                                \
+      size_t out_ = (rc_ < 0) ? 0 : (size_t) rc_;         \
+      out_ = (out_ >= avail) ? avail - 1 : out_;          \
+      p_out += out_;                                      \
+      avail -= out_;                                      \
+    }                                                     \
+  while (0)
+
+#define TIZ_LOG_FMT(value)                                                  \
+  do                                                                        \
+    {                                                                       \
+      int n_ = 0;                                                           \
+      if (spec.width_star && spec.prec_star)                                \
+        {                                                                   \
+          n_ = snprintf (p_out, avail, spec_buf, width, prec, value);       \
+        }                                                                   \
+      else if (spec.width_star)                                             \
+        {                                                                   \
+          n_ = snprintf (p_out, avail, spec_buf, width, value);             \
+        }                                                                   \
+      else if (spec.prec_star)                                              \
+        {                                                                   \
+          n_ = snprintf (p_out, avail, spec_buf, prec, value);              \
+        }                                                                   \
+      else                                                                  \
+        {                                                                   \
+          n_ = snprintf (p_out, avail, spec_buf, value);                    \
+        }                                                                   \
+      TIZ_LOG_OUT (n_);                                                     \
+    }                                                                       \
+  while (0)
+
+  assert (a_max > 0);
+  *p_out = '\0';
+
+  while (*p && avail > 1)
+    {
+      const char * p_pct = strchr (p, '%');
+      const size_t lit = p_pct ? (size_t) (p_pct - p) : strlen (p);
+      tiz_log_spec_t spec;
+      int width = 0;
+      int prec = 0;
+
+      /* Copy the literal text */
+      TIZ_LOG_OUT (snprintf (p_out, avail, "%.*s", (int) lit, p));
+      if (!p_pct)
+        {
+          break;
+        }
+
+      /* The spec was validated when the record was made */
+      (void) parse_spec (p_pct, &spec);
+      p = p_pct + spec.len;
+      memcpy (spec_buf, p_pct, spec.len);
+      spec_buf[spec.len] = '\0';
+
+      if ('%' == spec.conv)
+        {
+          TIZ_LOG_OUT (snprintf (p_out, avail, "%%"));
+          continue;
+        }
+
+      if (spec.width_star)
+        {
+          TIZ_LOG_GET_ARG (int, w);
+          width = w;
+        }
+      if (spec.prec_star)
+        {
+          TIZ_LOG_GET_ARG (int, pr);
+          prec = pr;
+        }
+
+      switch (spec.conv)
+        {
+          case 'd':
+          case 'i':
+          case 'o':
+          case 'u':
+          case 'x':
+          case 'X':
+            {
+              switch (spec.length)
+                {
+                  case 'l':
+                    {
+                      TIZ_LOG_GET_ARG (long, v);
+                      TIZ_LOG_FMT (v);
+                    }
+                    break;
+                  case 'q':
+                    {
+                      TIZ_LOG_GET_ARG (long long, v);
+                      TIZ_LOG_FMT (v);
+                    }
+                    break;
+                  case 'j':
+                    {
+                      TIZ_LOG_GET_ARG (intmax_t, v);
+                      TIZ_LOG_FMT (v);
+                    }
+                    break;
+                  case 'z':
+                    {
+                      TIZ_LOG_GET_ARG (size_t, v);
+                      TIZ_LOG_FMT (v);
+                    }
+                    break;
+                  case 't':
+                    {
+                      TIZ_LOG_GET_ARG (ptrdiff_t, v);
+                      TIZ_LOG_FMT (v);
+                    }
+                    break;
+                  default:
+                    {
+                      TIZ_LOG_GET_ARG (int, v);
+                      TIZ_LOG_FMT (v);
+                    }
+                    break;
+                };
+            }
+            break;
+          case 'c':
+            {
+              TIZ_LOG_GET_ARG (int, v);
+              TIZ_LOG_FMT (v);
+            }
+            break;
+          case 'p':
+            {
+              TIZ_LOG_GET_ARG (void *, v);
+              TIZ_LOG_FMT (v);
+            }
+            break;
+          case 's':
+            {
+              TIZ_LOG_GET_ARG (uint32_t, slen);
+              if (UINT32_MAX == slen)
+                {
+                  const char * v = NULL;
+                  TIZ_LOG_FMT (v);
+                }
+              else
+                {
+                  const char * v = p_args;
+                  p_args += TIZ_LOG_ALIGN (slen + 1);
+                  TIZ_LOG_FMT (v);
+                }
+            }
+            break;
+          default:
+            if ('L' == spec.length)
+              {
+                TIZ_LOG_GET_ARG (long double, v);
+                TIZ_LOG_FMT (v);
+              }
+            else
+              {
+                TIZ_LOG_GET_ARG (double, v);
+                TIZ_LOG_FMT (v);
+              }
+            break;
+        };
+    }
+
+#undef TIZ_LOG_FMT
+#undef TIZ_LOG_OUT
+#undef TIZ_LOG_GET_ARG
+}
+
+/*
+ * Writer thread
+ */
+
+static bool
+rings_have_data (void)
+{
+  tiz_log_ring_t * p_ring = __atomic_load_n (&gp_rings, __ATOMIC_ACQUIRE);
+  for (; p_ring; p_ring = p_ring->p_next)
+    {
+      if (__atomic_load_n (&(p_ring->tail), __ATOMIC_ACQUIRE) != p_ring->head)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+/* Return the next record of a ring, skipping padding, or NULL if the ring is
+   empty */
+static const tiz_log_rec_t *
+ring_peek (tiz_log_ring_t * ap_ring)
+{
+  const size_t tail = __atomic_load_n (&(ap_ring->tail), __ATOMIC_ACQUIRE);
+
+  while (ap_ring->head != tail)
+    {
+      const tiz_log_rec_t * p_rec
+        = (const tiz_log_rec_t *) (ap_ring->p_data
+                                   + (ap_ring->head
+                                      & (TIZ_LOG_RING_SIZE - 1)));
+      if (!(p_rec->flags & TIZ_LOG_REC_PAD))
+        {
+          return p_rec;
+        }
+      __atomic_store_n (&(ap_ring->head), ap_ring->head + p_rec->size,
+                        __ATOMIC_RELEASE);
+    }
+  return NULL;
+}
+
+static void
+emit_rec (const tiz_log_rec_t * ap_rec, const int a_pid, const int a_tid,
+          char * ap_msg, char * ap_cbuf)
+{
+  const char * p_file = (const char *) (ap_rec + 1);
+  const char * p_func = p_file + ap_rec->file_len + 1;
+  const char * p_cname = p_func + ap_rec->func_len + 1;
+  const char * p_fmt = p_cname + ap_rec->cname_len + 1;
+  const char * p_msg = p_fmt;
+
+  if (!(ap_rec->flags & TIZ_LOG_REC_TEXT))
+    {
+      const size_t args_off = TIZ_LOG_ALIGN (
+        (size_t) (p_fmt - (const char *) ap_rec) + ap_rec->fmt_len + 1);
+      format_rec (ap_msg, TIZ_LOG_MSG_MAX, p_fmt,
+                  (const char *) ap_rec + args_off);
+      p_msg = ap_msg;
+    }
+
+  if (!ap_rec->p_cat->p_cat)
+    {
+      return;
+    }
+
+  log_event (ap_rec->p_cat->p_cat, p_file, ap_rec->line, p_func,
+             ap_rec->priority,
+             (ap_rec->flags & TIZ_LOG_REC_CNAME) ? p_cname : NULL, ap_cbuf,
+             &(ap_rec->ts), a_pid, a_tid, p_msg);
+}
+
+/* Emit all the pending records, oldest first across threads. Returns the
+   number of records emitted. */
+static size_t
+drain_rings (const int a_pid, char * ap_msg, char * ap_cbuf)
+{
+  size_t count = 0;
+
+  for (;;)
+    {
+      tiz_log_ring_t * p_ring
+        = __atomic_load_n (&gp_rings, __ATOMIC_ACQUIRE);
+      tiz_log_ring_t * p_oldest = NULL;
+      const tiz_log_rec_t * p_oldest_rec = NULL;
+
+      for (; p_ring; p_ring = p_ring->p_next)
+        {
+          const tiz_log_rec_t * p_rec = ring_peek (p_ring);
+          if (p_rec
+              && (!p_oldest_rec || timercmp (&(p_rec->ts),
+                                             &(p_oldest_rec->ts), <)))
+            {
+              p_oldest = p_ring;
+              p_oldest_rec = p_rec;
+            }
+        }
+
+      if (!p_oldest)
+        {
+          break;
+        }
+
+      emit_rec (p_oldest_rec, a_pid, p_oldest->tid, ap_msg, ap_cbuf);
+      __atomic_store_n (&(p_oldest->head),
+                        p_oldest->head + p_oldest_rec->size,
+                        __ATOMIC_RELEASE);
+      ++count;
+    }
+
+  return count;
+}
+
+static void
+report_drops (const int a_pid, char * ap_cbuf)
+{
+  tiz_log_ring_t * p_ring = __atomic_load_n (&gp_rings, __ATOMIC_ACQUIRE);
+  for (; p_ring; p_ring = p_ring->p_next)
+    {
+      const uint32_t dropped
+        = __atomic_load_n (&(p_ring->dropped), __ATOMIC_RELAXED);
+      if (dropped != p_ring->dropped_reported)
+        {
+          char msg[128];
+          snprintf (msg, sizeof (msg),
+                    "Log ring full: dropped [%u] records from thread [%d]",
+                    dropped - p_ring->dropped_reported, p_ring->tid);
+          p_ring->dropped_reported = dropped;
+          log_event (log4c_category_get (TIZ_LOG_CATEGORY_NAME), __FILE__,
+                     __LINE__, __FUNCTION__, LOG4C_PRIORITY_WARN, NULL,
+                     ap_cbuf, NULL, a_pid, get_tid (), msg);
+        }
+    }
+}
+
+static void
+reap_rings (void)
+{
+  /* Don't wait for tiz_log_flush or a thread that is registering a ring */
+  if (0 == pthread_mutex_trylock (&g_rings_mutex))
+    {
+      tiz_log_ring_t ** pp_ring = &gp_rings;
+      while (*pp_ring)
+        {
+          tiz_log_ring_t * p_ring = *pp_ring;
+          if (__atomic_load_n (&(p_ring->orphaned), __ATOMIC_ACQUIRE)
+              && __atomic_load_n (&(p_ring->tail), __ATOMIC_ACQUIRE)
+                   == p_ring->head)
+            {
+              __atomic_store_n (pp_ring, p_ring->p_next, __ATOMIC_RELEASE);
+              ring_free (p_ring);
+            }
+          else
+            {
+              pp_ring = &(p_ring->p_next);
+            }
+        }
+      (void) pthread_mutex_unlock (&g_rings_mutex);
+    }
+}
+
+static void
+park_writer (void)
+{
+  const struct timespec ts = {TIZ_LOG_WRITER_PERIOD_MS / 1000,
+                              (TIZ_LOG_WRITER_PERIOD_MS % 1000) * 1000000};
+
+  __atomic_store_n (&g_writer_parked, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+  /* Re-check after announcing that we are about to sleep, so that a producer
+     that published before seeing the flag is not missed */
+  if (!rings_have_data ()
+      && ETIZLogWriterRunning
+           == __atomic_load_n (&g_writer_state, __ATOMIC_ACQUIRE))
+    {
+      (void) futex_wait (&g_writer_parked, 1, &ts);
+    }
+
+  __atomic_store_n (&g_writer_parked, 0, __ATOMIC_RELAXED);
+}
+
+static void *
+writer_thread_func (void * ap_arg)
+{
+  const int pid = getpid ();
+  char * p_msg = tiz_mem_alloc (TIZ_LOG_MSG_MAX);
+  char * p_cbuf = tiz_mem_alloc (TIZ_LOG_MSG_MAX);
+  uint64_t last_maint = now_millis ();
+  (void) ap_arg;
+
+  assert (p_msg);
+  assert (p_cbuf);
+
+  for (;;)
+    {
+      const size_t count = drain_rings (pid, p_msg, p_cbuf);
+      const uint64_t now = now_millis ();
+
+      if (now - last_maint >= TIZ_LOG_WRITER_PERIOD_MS)
+        {
+          refresh_cats ();
+          report_drops (pid, p_cbuf);
+          reap_rings ();
+          last_maint = now;
+        }
+
+      if (0 == count)
+        {
+          if (ETIZLogWriterStopping
+              == __atomic_load_n (&g_writer_state, __ATOMIC_ACQUIRE))
+            {
+              break;
+            }
+          park_writer ();
+        }
+    }
+
+  report_drops (pid, p_cbuf);
+  tiz_mem_free (p_msg);
+  tiz_mem_free (p_cbuf);
+  return NULL;
+}
+
+static bool
+start_writer (void)
+{
+  bool running = false;
+  (void) pthread_mutex_lock (&g_writer_mutex);
+  if (ETIZLogWriterIdle == g_writer_state)
+    {
+      __atomic_store_n (&g_writer_state, ETIZLogWriterRunning,
+                        __ATOMIC_RELEASE);
+      if (0 != pthread_create (&g_writer_thread, NULL, writer_thread_func,
+                               NULL))
+        {
+          __atomic_store_n (&g_writer_state, ETIZLogWriterDisabled,
+                            __ATOMIC_RELEASE);
+        }
+      else
+        {
+          (void) pthread_setname_np (g_writer_thread, "tizlogwriter");
+        }
+    }
+  running = (ETIZLogWriterRunning == g_writer_state);
+  (void) pthread_mutex_unlock (&g_writer_mutex);
+  return running;
+}
+
+static void
+stop_writer (const tiz_log_writer_state_t a_next_state)
+{
+  (void) pthread_mutex_lock (&g_writer_mutex);
+  if (ETIZLogWriterRunning == g_writer_state)
+    {
+      __atomic_store_n (&g_writer_state, ETIZLogWriterStopping,
+                        __ATOMIC_RELEASE);
+      __atomic_store_n (&g_writer_parked, 0, __ATOMIC_SEQ_CST);
+      futex_wake (&g_writer_parked, 1);
+      (void) pthread_join (g_writer_thread, NULL);
+    }
+  __atomic_store_n (&g_writer_state, a_next_state, __ATOMIC_RELEASE);
+  (void) pthread_mutex_unlock (&g_writer_mutex);
+}
+
+static void
+log_atexit (void)
+{
+  /* Drain the rings and log synchronously from now on */
+  stop_writer (ETIZLogWriterDisabled);
+}
+
+static void
+log_atfork_prepare (void)
+{
+  (void) pthread_mutex_lock (&g_writer_mutex);
+  (void) pthread_mutex_lock (&g_rings_mutex);
+  (void) pthread_mutex_lock (&g_cats_mutex);
+}
+
+static void
+log_atfork_parent (void)
+{
+  (void) pthread_mutex_unlock (&g_cats_mutex);
+  (void) pthread_mutex_unlock (&g_rings_mutex);
+  (void) pthread_mutex_unlock (&g_writer_mutex);
+}
+
+static void
+log_atfork_child (void)
+{
+  tiz_log_ring_t * p_ring = gp_rings;
+
+  (void) pthread_mutex_init (&g_cats_mutex, NULL);
+  (void) pthread_mutex_init (&g_rings_mutex, NULL);
+  (void) pthread_mutex_init (&g_writer_mutex, NULL);
+
+  /* The parent's records are its own business. The other threads don't
+     exist in the child, so their rings are released once the child's
+     writer runs. */
+  for (; p_ring; p_ring = p_ring->p_next)
+    {
+      p_ring->head = p_ring->tail;
+      p_ring->dropped_reported = p_ring->dropped;
+      p_ring->orphaned = (p_ring != tp_ring);
+    }
+  t_tid = 0;
+  if (tp_ring)
+    {
+      tp_ring->tid = get_tid ();
+    }
+
+  /* The writer thread didn't survive the fork; restart it on demand */
+  g_writer_parked = 0;
+  if (ETIZLogWriterRunning == g_writer_state)
+    {
+      g_writer_state = ETIZLogWriterIdle;
+    }
+}
+
+static void
+log_register_handlers (void)
+{
+  (void) atexit (log_atexit);
+  (void) pthread_atfork (log_atfork_prepare, log_atfork_parent,
+                         log_atfork_child);
+}
+
+static void
+log_sync (const log4c_category_t * ap_cat, const char * ap_file, int a_line,
+          const char * ap_func, int a_priority, const char * ap_cname,
+          char * ap_cbuf, const char * ap_format, va_list a_va)
+{
+  char * buffer = alloca (TIZ_LOG_MSG_MAX);
+  (void) vsnprintf (buffer, TIZ_LOG_MSG_MAX, ap_format, a_va);
+  log_event (ap_cat, ap_file, a_line, ap_func, a_priority, ap_cname, ap_cbuf,
+             NULL, getpid (), get_tid (), buffer);
+}
+
+static bool
+log_async (tiz_log_cat_t * ap_cat, const char * ap_file, int a_line,
+           const char * ap_func, int a_priority, const char * ap_cname,
+           const char * ap_format, va_list a_va)
+{
+  tiz_log_ring_t * p_ring = NULL;
+  char * p_rec = NULL;
+  size_t size = 0;
+
+  switch (__atomic_load_n (&g_writer_state, __ATOMIC_ACQUIRE))
+    {
+      case ETIZLogWriterRunning:
+        break;
+      case ETIZLogWriterIdle:
+        if (!start_writer ())
+          {
+            return false;
+          }
+        break;
+      default:
+        return false;
+    };
+
+  if (!(p_ring = get_ring ()))
+    {
+      return false;
+    }
+
+  p_rec = alloca (TIZ_LOG_REC_MAX);
+  size = make_rec (p_rec, ap_cat, ap_file, a_line, ap_func, a_priority,
+                   ap_cname, ap_format, a_va);
+  if (ring_put (p_ring, p_rec, size))
+    {
+      wake_writer ();
+    }
+  return true;
+}
+
 int
 tiz_log_init (void)
 {
 #ifndef WITHOUT_LOG4C
+  static pthread_once_t handlers_once = PTHREAD_ONCE_INIT;
+  int rc = 0;
   log_formatters_init ();
-  return log4c_init ();
+  rc = log4c_init ();
+  /* Categories seen before now were cached with the default priorities */
+  refresh_cats ();
+  (void) pthread_once (&handlers_once, log_register_handlers);
+  (void) pthread_mutex_lock (&g_writer_mutex);
+  if (ETIZLogWriterRunning != g_writer_state)
+    {
+      /* TIZONIA_LOG_SYNC keeps the cached category checks, but formats and
+         appends on the calling thread */
+      g_writer_state = getenv ("TIZONIA_LOG_SYNC") ? ETIZLogWriterDisabled
+                                                   : ETIZLogWriterIdle;
+    }
+  (void) pthread_mutex_unlock (&g_writer_mutex);
+  return rc;
 #else
   return 0;
 #endif
@@ -197,43 +1503,83 @@ int
 tiz_log_deinit (void)
 {
 #ifndef WITHOUT_LOG4C
+  stop_writer (ETIZLogWriterDisabled);
+  clear_cats ();
   return log4c_fini ();
 #else
   return 0;
 #endif
 }
 
+void
+tiz_log_flush (void)
+{
+#ifndef WITHOUT_LOG4C
+  tiz_log_ring_t * p_ring = NULL;
+  (void) pthread_mutex_lock (&g_rings_mutex);
+  for (p_ring = gp_rings; p_ring; p_ring = p_ring->p_next)
+    {
+      const size_t tail = __atomic_load_n (&(p_ring->tail), __ATOMIC_ACQUIRE);
+      while ((ssize_t) (tail
+                        - __atomic_load_n (&(p_ring->head), __ATOMIC_ACQUIRE))
+               > 0
+             && ETIZLogWriterRunning
+                  == __atomic_load_n (&g_writer_state, __ATOMIC_ACQUIRE))
+        {
+          const struct timespec ts = {0, 1000000};
+          wake_writer ();
+          (void) nanosleep (&ts, NULL);
+        }
+    }
+  (void) pthread_mutex_unlock (&g_rings_mutex);
+#endif
+}
+
 void
 tiz_log (const char * ap_file, int a_line, const char * ap_func,
          const char * ap_cat_name, int a_priority, const char * ap_cname,
          char * ap_cbuf, const char * ap_format, ...)
 {
 #ifndef WITHOUT_LOG4C
-  log4c_location_info_t locinfo;
-  user_locinfo_t user_locinfo;
+  tiz_log_cat_t * p_cat = get_cat (ap_cat_name);
+  const log4c_category_t * p_category = NULL;
+  va_list va;
 
-  const log4c_category_t * p_category = log4c_category_get (ap_cat_name);
-  if (log4c_category_is_priority_enabled (p_category, a_priority))
-    {
-      /* TODO: 4096 - this value should be obtained at config time */
-      char * buffer = alloca (4096);
-      user_locinfo.pid = getpid ();
-      user_locinfo.tid = syscall (SYS_gettid);
-      user_locinfo.cname = ap_cname;
-      user_locinfo.cbuf = ap_cbuf;
-      locinfo.loc_file = ap_file;
-      locinfo.loc_line = a_line;
-      locinfo.loc_function = ap_func;
-      /*          locinfo.loc_data = NULL; */
-      locinfo.loc_data = &user_locinfo;
+  if (ETIZLogWriterDisabled
+      == __atomic_load_n (&g_writer_state, __ATOMIC_RELAXED))
+    {
+      maybe_refresh_cats ();
+    }
 
-      va_list va;
-      va_start (va, ap_format);
-      vsprintf (buffer, ap_format, va);
-      va_end (va);
-      log4c_category_log_locinfo (p_category, &locinfo, a_priority, "%s",
-                                  buffer);
+  if (p_cat)
+    {
+      /* Fast path: no lookup by name, no locks */
+      if (a_priority > __atomic_load_n (&(p_cat->priority), __ATOMIC_RELAXED))
+        {
+          return;
+        }
+      p_category = p_cat->p_cat;
+    }
+
+  if (!p_category)
+    {
+      p_category = log4c_category_get (ap_cat_name);
+      if (!log4c_category_is_priority_enabled (p_category, a_priority))
+        {
+          return;
+        }
+      p_cat = NULL;
+    }
+
+  ap_format = ap_format ? ap_format : "";
+  va_start (va, ap_format);
+  if (!p_cat || !log_async (p_cat, ap_file, a_line, ap_func, a_priority,
+                            ap_cname, ap_format, va))
+    {
+      log_sync (p_category, ap_file, a_line, ap_func, a_priority, ap_cname,
+                ap_cbuf, ap_format, va);
     }
+  va_end (va);
 #else
 
   va_list va;
@@ -66,6 +66,10 @@ tiz_log_set_unique_rolling_file (const char * ap_logdir,
                                  const char * ap_file_prefix);
 int
 tiz_log_deinit (void);
+/* Block until the records logged so far by all threads have been handed to
+   log4c. Records are formatted and appended by a background thread. */
+void
+tiz_log_flush (void);
 void
 tiz_log (const char * __p_file, int __line, const char * __p_func,
          const char * __p_cat_name, int __priority,
@@ -361,6 +361,19 @@ extern "C" {
 #define ATTRIBUTE_NO_SANITIZE_ADDRESS
 #endif
 
+/* Cache line size and alignment, used to avoid false sharing in lock-free
+   data structures */
+
+#ifndef TIZ_CACHELINE_SIZE
+#define TIZ_CACHELINE_SIZE 64
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+#define TIZ_CACHELINE_ALIGNED __attribute__ ((aligned (TIZ_CACHELINE_SIZE)))
+#else
+#define TIZ_CACHELINE_ALIGNED
+#endif
+
 #ifdef __cplusplus
 }
 #endif
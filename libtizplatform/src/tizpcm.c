@@ -0,0 +1,832 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizpcm.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  PCM sample processing kernels
+ *
+ * Each kernel has a scalar version, which is the reference, and optional
+ * vector versions that process the bulk of the buffer and hand the tail over
+ * to the scalar one. The x86-64 vector versions are compiled with function
+ * target attributes, so the library itself doesn't need to be built with
+ * -mavx2; the CPU is probed once, at first use. Float to integer conversions
+ * clamp before rounding (minps/maxps semantics, also emulated in the scalar
+ * and NEON versions) so that all versions agree even on out-of-range input.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "tizplatform.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define TIZ_PCM_HAVE_SSE2
+#define TIZ_PCM_HAVE_AVX2
+#define TIZ_PCM_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TIZ_PCM_HAVE_NEON
+#endif
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.platform.pcm"
+#endif
+
+#define TIZ_PCM_S16_SCALE 32768.0f
+#define TIZ_PCM_S16_MAXF 32767.0f
+#define TIZ_PCM_S16_MINF -32768.0f
+
+typedef struct tiz_pcm_kernels tiz_pcm_kernels_t;
+struct tiz_pcm_kernels
+{
+  void (*pf_s16_gain) (int16_t *, size_t, float);
+  void (*pf_s16_to_float) (float *, const int16_t *, size_t);
+  void (*pf_float_to_s16) (int16_t *, const float *, size_t);
+  void (*pf_s16_bswap) (int16_t *, size_t);
+  void (*pf_s16_interleave2) (int16_t *, const int16_t *, const int16_t *,
+                              size_t);
+  void (*pf_s16_deinterleave2) (int16_t *, int16_t *, const int16_t *,
+                                size_t);
+  void (*pf_fixed_to_s16) (int16_t *, const int32_t *, size_t, unsigned int);
+};
+
+/*
+ * Scalar kernels
+ */
+
+static inline int16_t
+sat_s16 (const int32_t a_val)
+{
+  return a_val > INT16_MAX ? INT16_MAX : (a_val < INT16_MIN ? INT16_MIN : a_val);
+}
+
+static inline int16_t
+round_sat_s16 (float a_val)
+{
+  /* Same results as minps/maxps, NaNs included */
+  a_val = a_val < TIZ_PCM_S16_MAXF ? a_val : TIZ_PCM_S16_MAXF;
+  a_val = a_val > TIZ_PCM_S16_MINF ? a_val : TIZ_PCM_S16_MINF;
+  return (int16_t) lrintf (a_val);
+}
+
+static void
+scalar_s16_gain (int16_t * ap_samples, size_t a_nsamples, float a_gain)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      ap_samples[i] = round_sat_s16 ((float) ap_samples[i] * a_gain);
+    }
+}
+
+static void
+scalar_s16_to_float (float * ap_dst, const int16_t * ap_src, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      ap_dst[i] = (float) ap_src[i] * (1.0f / TIZ_PCM_S16_SCALE);
+    }
+}
+
+static void
+scalar_float_to_s16 (int16_t * ap_dst, const float * ap_src, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      ap_dst[i] = round_sat_s16 (ap_src[i] * TIZ_PCM_S16_SCALE);
+    }
+}
+
+static void
+scalar_s16_bswap (int16_t * ap_samples, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      const uint16_t s = (uint16_t) ap_samples[i];
+      ap_samples[i] = (int16_t) ((uint16_t) (s << 8) | (s >> 8));
+    }
+}
+
+static void
+scalar_s16_interleave2 (int16_t * ap_dst, const int16_t * ap_left,
+                        const int16_t * ap_right, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nframes; ++i)
+    {
+      ap_dst[2 * i] = ap_left[i];
+      ap_dst[2 * i + 1] = ap_right[i];
+    }
+}
+
+static void
+scalar_s16_deinterleave2 (int16_t * ap_left, int16_t * ap_right,
+                          const int16_t * ap_src, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nframes; ++i)
+    {
+      ap_left[i] = ap_src[2 * i];
+      ap_right[i] = ap_src[2 * i + 1];
+    }
+}
+
+static void
+scalar_fixed_to_s16 (int16_t * ap_dst, const int32_t * ap_src,
+                     size_t a_nsamples, unsigned int a_shift)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      ap_dst[i] = sat_s16 (ap_src[i] >> a_shift);
+    }
+}
+
+/*
+ * SSE2 kernels (x86-64 baseline)
+ */
+
+#ifdef TIZ_PCM_HAVE_SSE2
+
+static inline __m128
+sse2_clamp_s16 (const __m128 a_val)
+{
+  return _mm_max_ps (_mm_min_ps (a_val, _mm_set1_ps (TIZ_PCM_S16_MAXF)),
+                     _mm_set1_ps (TIZ_PCM_S16_MINF));
+}
+
+static inline __m128i
+sse2_round_pack_s16 (const __m128 a_lo, const __m128 a_hi)
+{
+  return _mm_packs_epi32 (_mm_cvtps_epi32 (sse2_clamp_s16 (a_lo)),
+                          _mm_cvtps_epi32 (sse2_clamp_s16 (a_hi)));
+}
+
+static inline __m128i
+sse2_widen_lo (const __m128i a_val)
+{
+  return _mm_srai_epi32 (_mm_unpacklo_epi16 (a_val, a_val), 16);
+}
+
+static inline __m128i
+sse2_widen_hi (const __m128i a_val)
+{
+  return _mm_srai_epi32 (_mm_unpackhi_epi16 (a_val, a_val), 16);
+}
+
+static void
+sse2_s16_gain (int16_t * ap_samples, size_t a_nsamples, float a_gain)
+{
+  const __m128 gain = _mm_set1_ps (a_gain);
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128 ((const __m128i *) (ap_samples + i));
+      const __m128 lo = _mm_mul_ps (_mm_cvtepi32_ps (sse2_widen_lo (v)), gain);
+      const __m128 hi = _mm_mul_ps (_mm_cvtepi32_ps (sse2_widen_hi (v)), gain);
+      _mm_storeu_si128 ((__m128i *) (ap_samples + i),
+                        sse2_round_pack_s16 (lo, hi));
+    }
+  scalar_s16_gain (ap_samples + i, a_nsamples - i, a_gain);
+}
+
+static void
+sse2_s16_to_float (float * ap_dst, const int16_t * ap_src, size_t a_nsamples)
+{
+  const __m128 scale = _mm_set1_ps (1.0f / TIZ_PCM_S16_SCALE);
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128 ((const __m128i *) (ap_src + i));
+      _mm_storeu_ps (ap_dst + i,
+                     _mm_mul_ps (_mm_cvtepi32_ps (sse2_widen_lo (v)), scale));
+      _mm_storeu_ps (ap_dst + i + 4,
+                     _mm_mul_ps (_mm_cvtepi32_ps (sse2_widen_hi (v)), scale));
+    }
+  scalar_s16_to_float (ap_dst + i, ap_src + i, a_nsamples - i);
+}
+
+static void
+sse2_float_to_s16 (int16_t * ap_dst, const float * ap_src, size_t a_nsamples)
+{
+  const __m128 scale = _mm_set1_ps (TIZ_PCM_S16_SCALE);
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128 lo = _mm_mul_ps (_mm_loadu_ps (ap_src + i), scale);
+      const __m128 hi = _mm_mul_ps (_mm_loadu_ps (ap_src + i + 4), scale);
+      _mm_storeu_si128 ((__m128i *) (ap_dst + i), sse2_round_pack_s16 (lo, hi));
+    }
+  scalar_float_to_s16 (ap_dst + i, ap_src + i, a_nsamples - i);
+}
+
+static void
+sse2_s16_bswap (int16_t * ap_samples, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128 ((const __m128i *) (ap_samples + i));
+      _mm_storeu_si128 ((__m128i *) (ap_samples + i),
+                        _mm_or_si128 (_mm_slli_epi16 (v, 8),
+                                      _mm_srli_epi16 (v, 8)));
+    }
+  scalar_s16_bswap (ap_samples + i, a_nsamples - i);
+}
+
+static void
+sse2_s16_interleave2 (int16_t * ap_dst, const int16_t * ap_left,
+                      const int16_t * ap_right, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nframes; i += 8)
+    {
+      const __m128i l = _mm_loadu_si128 ((const __m128i *) (ap_left + i));
+      const __m128i r = _mm_loadu_si128 ((const __m128i *) (ap_right + i));
+      _mm_storeu_si128 ((__m128i *) (ap_dst + 2 * i),
+                        _mm_unpacklo_epi16 (l, r));
+      _mm_storeu_si128 ((__m128i *) (ap_dst + 2 * i + 8),
+                        _mm_unpackhi_epi16 (l, r));
+    }
+  scalar_s16_interleave2 (ap_dst + 2 * i, ap_left + i, ap_right + i,
+                          a_nframes - i);
+}
+
+static void
+sse2_s16_deinterleave2 (int16_t * ap_left, int16_t * ap_right,
+                        const int16_t * ap_src, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nframes; i += 8)
+    {
+      /* Each 32-bit lane holds one frame: left in the low half */
+      const __m128i a = _mm_loadu_si128 ((const __m128i *) (ap_src + 2 * i));
+      const __m128i b
+        = _mm_loadu_si128 ((const __m128i *) (ap_src + 2 * i + 8));
+      const __m128i la = _mm_srai_epi32 (_mm_slli_epi32 (a, 16), 16);
+      const __m128i lb = _mm_srai_epi32 (_mm_slli_epi32 (b, 16), 16);
+      _mm_storeu_si128 ((__m128i *) (ap_left + i), _mm_packs_epi32 (la, lb));
+      _mm_storeu_si128 (
+        (__m128i *) (ap_right + i),
+        _mm_packs_epi32 (_mm_srai_epi32 (a, 16), _mm_srai_epi32 (b, 16)));
+    }
+  scalar_s16_deinterleave2 (ap_left + i, ap_right + i, ap_src + 2 * i,
+                            a_nframes - i);
+}
+
+static void
+sse2_fixed_to_s16 (int16_t * ap_dst, const int32_t * ap_src, size_t a_nsamples,
+                   unsigned int a_shift)
+{
+  const __m128i shift = _mm_cvtsi32_si128 ((int) a_shift);
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i lo = _mm_loadu_si128 ((const __m128i *) (ap_src + i));
+      const __m128i hi = _mm_loadu_si128 ((const __m128i *) (ap_src + i + 4));
+      _mm_storeu_si128 ((__m128i *) (ap_dst + i),
+                        _mm_packs_epi32 (_mm_sra_epi32 (lo, shift),
+                                         _mm_sra_epi32 (hi, shift)));
+    }
+  scalar_fixed_to_s16 (ap_dst + i, ap_src + i, a_nsamples - i, a_shift);
+}
+
+#endif /* TIZ_PCM_HAVE_SSE2 */
+
+/*
+ * AVX2 kernels (runtime-detected)
+ */
+
+#ifdef TIZ_PCM_HAVE_AVX2
+
+/* The 256-bit pack instructions work on each 128-bit lane separately; this
+   puts the four resulting quadwords back in order */
+#define AVX2_FIX_PACK_ORDER(v) _mm256_permute4x64_epi64 ((v), 0xD8)
+
+static inline TIZ_PCM_TARGET_AVX2 __m256
+avx2_clamp_s16 (const __m256 a_val)
+{
+  return _mm256_max_ps (_mm256_min_ps (a_val,
+                                       _mm256_set1_ps (TIZ_PCM_S16_MAXF)),
+                        _mm256_set1_ps (TIZ_PCM_S16_MINF));
+}
+
+static inline TIZ_PCM_TARGET_AVX2 __m256i
+avx2_round_pack_s16 (const __m256 a_lo, const __m256 a_hi)
+{
+  return AVX2_FIX_PACK_ORDER (
+    _mm256_packs_epi32 (_mm256_cvtps_epi32 (avx2_clamp_s16 (a_lo)),
+                        _mm256_cvtps_epi32 (avx2_clamp_s16 (a_hi))));
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_s16_gain (int16_t * ap_samples, size_t a_nsamples, float a_gain)
+{
+  const __m256 gain = _mm256_set1_ps (a_gain);
+  size_t i = 0;
+  for (i = 0; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m128i v0 = _mm_loadu_si128 ((const __m128i *) (ap_samples + i));
+      const __m128i v1
+        = _mm_loadu_si128 ((const __m128i *) (ap_samples + i + 8));
+      const __m256 lo
+        = _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_cvtepi16_epi32 (v0)), gain);
+      const __m256 hi
+        = _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_cvtepi16_epi32 (v1)), gain);
+      _mm256_storeu_si256 ((__m256i *) (ap_samples + i),
+                           avx2_round_pack_s16 (lo, hi));
+    }
+  scalar_s16_gain (ap_samples + i, a_nsamples - i, a_gain);
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_s16_to_float (float * ap_dst, const int16_t * ap_src, size_t a_nsamples)
+{
+  const __m256 scale = _mm256_set1_ps (1.0f / TIZ_PCM_S16_SCALE);
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128 ((const __m128i *) (ap_src + i));
+      _mm256_storeu_ps (
+        ap_dst + i,
+        _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_cvtepi16_epi32 (v)), scale));
+    }
+  scalar_s16_to_float (ap_dst + i, ap_src + i, a_nsamples - i);
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_float_to_s16 (int16_t * ap_dst, const float * ap_src, size_t a_nsamples)
+{
+  const __m256 scale = _mm256_set1_ps (TIZ_PCM_S16_SCALE);
+  size_t i = 0;
+  for (i = 0; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m256 lo = _mm256_mul_ps (_mm256_loadu_ps (ap_src + i), scale);
+      const __m256 hi = _mm256_mul_ps (_mm256_loadu_ps (ap_src + i + 8), scale);
+      _mm256_storeu_si256 ((__m256i *) (ap_dst + i),
+                           avx2_round_pack_s16 (lo, hi));
+    }
+  scalar_float_to_s16 (ap_dst + i, ap_src + i, a_nsamples - i);
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_s16_bswap (int16_t * ap_samples, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m256i v
+        = _mm256_loadu_si256 ((const __m256i *) (ap_samples + i));
+      _mm256_storeu_si256 ((__m256i *) (ap_samples + i),
+                           _mm256_or_si256 (_mm256_slli_epi16 (v, 8),
+                                            _mm256_srli_epi16 (v, 8)));
+    }
+  scalar_s16_bswap (ap_samples + i, a_nsamples - i);
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_s16_interleave2 (int16_t * ap_dst, const int16_t * ap_left,
+                      const int16_t * ap_right, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i + 16 <= a_nframes; i += 16)
+    {
+      const __m256i l = _mm256_loadu_si256 ((const __m256i *) (ap_left + i));
+      const __m256i r = _mm256_loadu_si256 ((const __m256i *) (ap_right + i));
+      /* Frames 0-3 and 8-11, then 4-7 and 12-15 */
+      const __m256i lo = _mm256_unpacklo_epi16 (l, r);
+      const __m256i hi = _mm256_unpackhi_epi16 (l, r);
+      _mm256_storeu_si256 ((__m256i *) (ap_dst + 2 * i),
+                           _mm256_permute2x128_si256 (lo, hi, 0x20));
+      _mm256_storeu_si256 ((__m256i *) (ap_dst + 2 * i + 16),
+                           _mm256_permute2x128_si256 (lo, hi, 0x31));
+    }
+  scalar_s16_interleave2 (ap_dst + 2 * i, ap_left + i, ap_right + i,
+                          a_nframes - i);
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_s16_deinterleave2 (int16_t * ap_left, int16_t * ap_right,
+                        const int16_t * ap_src, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i + 16 <= a_nframes; i += 16)
+    {
+      const __m256i a
+        = _mm256_loadu_si256 ((const __m256i *) (ap_src + 2 * i));
+      const __m256i b
+        = _mm256_loadu_si256 ((const __m256i *) (ap_src + 2 * i + 16));
+      const __m256i la = _mm256_srai_epi32 (_mm256_slli_epi32 (a, 16), 16);
+      const __m256i lb = _mm256_srai_epi32 (_mm256_slli_epi32 (b, 16), 16);
+      _mm256_storeu_si256 ((__m256i *) (ap_left + i),
+                           AVX2_FIX_PACK_ORDER (_mm256_packs_epi32 (la, lb)));
+      _mm256_storeu_si256 (
+        (__m256i *) (ap_right + i),
+        AVX2_FIX_PACK_ORDER (_mm256_packs_epi32 (_mm256_srai_epi32 (a, 16),
+                                                 _mm256_srai_epi32 (b, 16))));
+    }
+  scalar_s16_deinterleave2 (ap_left + i, ap_right + i, ap_src + 2 * i,
+                            a_nframes - i);
+}
+
+static TIZ_PCM_TARGET_AVX2 void
+avx2_fixed_to_s16 (int16_t * ap_dst, const int32_t * ap_src, size_t a_nsamples,
+                   unsigned int a_shift)
+{
+  const __m128i shift = _mm_cvtsi32_si128 ((int) a_shift);
+  size_t i = 0;
+  for (i = 0; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m256i lo = _mm256_loadu_si256 ((const __m256i *) (ap_src + i));
+      const __m256i hi
+        = _mm256_loadu_si256 ((const __m256i *) (ap_src + i + 8));
+      _mm256_storeu_si256 (
+        (__m256i *) (ap_dst + i),
+        AVX2_FIX_PACK_ORDER (_mm256_packs_epi32 (_mm256_sra_epi32 (lo, shift),
+                                                 _mm256_sra_epi32 (hi, shift))));
+    }
+  scalar_fixed_to_s16 (ap_dst + i, ap_src + i, a_nsamples - i, a_shift);
+}
+
+#endif /* TIZ_PCM_HAVE_AVX2 */
+
+/*
+ * NEON kernels (AArch64 baseline)
+ */
+
+#ifdef TIZ_PCM_HAVE_NEON
+
+static inline float32x4_t
+neon_clamp_s16 (float32x4_t a_val)
+{
+  const float32x4_t max = vdupq_n_f32 (TIZ_PCM_S16_MAXF);
+  const float32x4_t min = vdupq_n_f32 (TIZ_PCM_S16_MINF);
+  /* Compare and select rather than vminq/vmaxq, to treat NaNs like SSE */
+  a_val = vbslq_f32 (vcltq_f32 (a_val, max), a_val, max);
+  return vbslq_f32 (vcgtq_f32 (a_val, min), a_val, min);
+}
+
+static inline int16x8_t
+neon_round_pack_s16 (const float32x4_t a_lo, const float32x4_t a_hi)
+{
+  return vcombine_s16 (vqmovn_s32 (vcvtnq_s32_f32 (neon_clamp_s16 (a_lo))),
+                       vqmovn_s32 (vcvtnq_s32_f32 (neon_clamp_s16 (a_hi))));
+}
+
+static void
+neon_s16_gain (int16_t * ap_samples, size_t a_nsamples, float a_gain)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const int16x8_t v = vld1q_s16 (ap_samples + i);
+      const float32x4_t lo
+        = vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (v))), a_gain);
+      const float32x4_t hi
+        = vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (v))), a_gain);
+      vst1q_s16 (ap_samples + i, neon_round_pack_s16 (lo, hi));
+    }
+  scalar_s16_gain (ap_samples + i, a_nsamples - i, a_gain);
+}
+
+static void
+neon_s16_to_float (float * ap_dst, const int16_t * ap_src, size_t a_nsamples)
+{
+  const float scale = 1.0f / TIZ_PCM_S16_SCALE;
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const int16x8_t v = vld1q_s16 (ap_src + i);
+      vst1q_f32 (ap_dst + i,
+                 vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (v))),
+                              scale));
+      vst1q_f32 (ap_dst + i + 4,
+                 vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (v))),
+                              scale));
+    }
+  scalar_s16_to_float (ap_dst + i, ap_src + i, a_nsamples - i);
+}
+
+static void
+neon_float_to_s16 (int16_t * ap_dst, const float * ap_src, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const float32x4_t lo
+        = vmulq_n_f32 (vld1q_f32 (ap_src + i), TIZ_PCM_S16_SCALE);
+      const float32x4_t hi
+        = vmulq_n_f32 (vld1q_f32 (ap_src + i + 4), TIZ_PCM_S16_SCALE);
+      vst1q_s16 (ap_dst + i, neon_round_pack_s16 (lo, hi));
+    }
+  scalar_float_to_s16 (ap_dst + i, ap_src + i, a_nsamples - i);
+}
+
+static void
+neon_s16_bswap (int16_t * ap_samples, size_t a_nsamples)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const uint8x16_t v = vreinterpretq_u8_s16 (vld1q_s16 (ap_samples + i));
+      vst1q_s16 (ap_samples + i, vreinterpretq_s16_u8 (vrev16q_u8 (v)));
+    }
+  scalar_s16_bswap (ap_samples + i, a_nsamples - i);
+}
+
+static void
+neon_s16_interleave2 (int16_t * ap_dst, const int16_t * ap_left,
+                      const int16_t * ap_right, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nframes; i += 8)
+    {
+      int16x8x2_t v;
+      v.val[0] = vld1q_s16 (ap_left + i);
+      v.val[1] = vld1q_s16 (ap_right + i);
+      vst2q_s16 (ap_dst + 2 * i, v);
+    }
+  scalar_s16_interleave2 (ap_dst + 2 * i, ap_left + i, ap_right + i,
+                          a_nframes - i);
+}
+
+static void
+neon_s16_deinterleave2 (int16_t * ap_left, int16_t * ap_right,
+                        const int16_t * ap_src, size_t a_nframes)
+{
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nframes; i += 8)
+    {
+      const int16x8x2_t v = vld2q_s16 (ap_src + 2 * i);
+      vst1q_s16 (ap_left + i, v.val[0]);
+      vst1q_s16 (ap_right + i, v.val[1]);
+    }
+  scalar_s16_deinterleave2 (ap_left + i, ap_right + i, ap_src + 2 * i,
+                            a_nframes - i);
+}
+
+static void
+neon_fixed_to_s16 (int16_t * ap_dst, const int32_t * ap_src, size_t a_nsamples,
+                   unsigned int a_shift)
+{
+  /* A negative left shift is an arithmetic right shift */
+  const int32x4_t shift = vdupq_n_s32 (-(int32_t) a_shift);
+  size_t i = 0;
+  for (i = 0; i + 8 <= a_nsamples; i += 8)
+    {
+      const int32x4_t lo = vshlq_s32 (vld1q_s32 (ap_src + i), shift);
+      const int32x4_t hi = vshlq_s32 (vld1q_s32 (ap_src + i + 4), shift);
+      vst1q_s16 (ap_dst + i, vcombine_s16 (vqmovn_s32 (lo), vqmovn_s32 (hi)));
+    }
+  scalar_fixed_to_s16 (ap_dst + i, ap_src + i, a_nsamples - i, a_shift);
+}
+
+#endif /* TIZ_PCM_HAVE_NEON */
+
+static const tiz_pcm_kernels_t g_pcm_kernels[ETIZPcmIsaMax] = {
+  [ETIZPcmIsaScalar] = {scalar_s16_gain, scalar_s16_to_float,
+                        scalar_float_to_s16, scalar_s16_bswap,
+                        scalar_s16_interleave2, scalar_s16_deinterleave2,
+                        scalar_fixed_to_s16},
+#ifdef TIZ_PCM_HAVE_SSE2
+  [ETIZPcmIsaSse2] = {sse2_s16_gain, sse2_s16_to_float, sse2_float_to_s16,
+                      sse2_s16_bswap, sse2_s16_interleave2,
+                      sse2_s16_deinterleave2, sse2_fixed_to_s16},
+#endif
+#ifdef TIZ_PCM_HAVE_AVX2
+  [ETIZPcmIsaAvx2] = {avx2_s16_gain, avx2_s16_to_float, avx2_float_to_s16,
+                      avx2_s16_bswap, avx2_s16_interleave2,
+                      avx2_s16_deinterleave2, avx2_fixed_to_s16},
+#endif
+#ifdef TIZ_PCM_HAVE_NEON
+  [ETIZPcmIsaNeon] = {neon_s16_gain, neon_s16_to_float, neon_float_to_s16,
+                      neon_s16_bswap, neon_s16_interleave2,
+                      neon_s16_deinterleave2, neon_fixed_to_s16},
+#endif
+};
+
+static pthread_once_t g_pcm_once = PTHREAD_ONCE_INIT;
+static tiz_pcm_isa_t g_pcm_isa = ETIZPcmIsaScalar;
+
+static bool
+cpu_supports (const tiz_pcm_isa_t a_isa)
+{
+  switch (a_isa)
+    {
+      case ETIZPcmIsaScalar:
+        return true;
+#if defined(TIZ_PCM_HAVE_SSE2) || defined(TIZ_PCM_HAVE_AVX2)
+      case ETIZPcmIsaSse2:
+        __builtin_cpu_init ();
+        return __builtin_cpu_supports ("sse2");
+      case ETIZPcmIsaAvx2:
+        __builtin_cpu_init ();
+        return __builtin_cpu_supports ("avx2");
+#endif
+#ifdef TIZ_PCM_HAVE_NEON
+      case ETIZPcmIsaNeon:
+        return true;
+#endif
+      default:
+        return false;
+    };
+}
+
+static void
+select_best_isa (void)
+{
+  int isa = ETIZPcmIsaMax - 1;
+  while (isa > ETIZPcmIsaScalar && !tiz_pcm_isa_supported (isa))
+    {
+      --isa;
+    }
+  __atomic_store_n (&g_pcm_isa, (tiz_pcm_isa_t) isa, __ATOMIC_RELAXED);
+}
+
+static inline const tiz_pcm_kernels_t *
+kernels (void)
+{
+  (void) pthread_once (&g_pcm_once, select_best_isa);
+  return &g_pcm_kernels[__atomic_load_n (&g_pcm_isa, __ATOMIC_RELAXED)];
+}
+
+tiz_pcm_isa_t
+tiz_pcm_get_isa (void)
+{
+  (void) pthread_once (&g_pcm_once, select_best_isa);
+  return __atomic_load_n (&g_pcm_isa, __ATOMIC_RELAXED);
+}
+
+bool
+tiz_pcm_isa_supported (const tiz_pcm_isa_t a_isa)
+{
+  return (a_isa < ETIZPcmIsaMax && g_pcm_kernels[a_isa].pf_s16_gain
+          && cpu_supports (a_isa));
+}
+
+OMX_ERRORTYPE
+tiz_pcm_set_isa (const tiz_pcm_isa_t a_isa)
+{
+  (void) pthread_once (&g_pcm_once, select_best_isa);
+  if (!tiz_pcm_isa_supported (a_isa))
+    {
+      return OMX_ErrorUnsupportedSetting;
+    }
+  __atomic_store_n (&g_pcm_isa, a_isa, __ATOMIC_RELAXED);
+  TIZ_LOG (TIZ_PRIORITY_DEBUG, "PCM kernels : [%s]",
+           tiz_pcm_isa_to_str (a_isa));
+  return OMX_ErrorNone;
+}
+
+const char *
+tiz_pcm_isa_to_str (const tiz_pcm_isa_t a_isa)
+{
+  switch (a_isa)
+    {
+      case ETIZPcmIsaScalar:
+        return "scalar";
+      case ETIZPcmIsaSse2:
+        return "sse2";
+      case ETIZPcmIsaAvx2:
+        return "avx2";
+      case ETIZPcmIsaNeon:
+        return "neon";
+      default:
+        return "unknown";
+    };
+}
+
+void
+tiz_pcm_s16_gain (int16_t * ap_samples, const size_t a_nsamples,
+                  const float a_gain)
+{
+  assert (ap_samples || 0 == a_nsamples);
+  kernels ()->pf_s16_gain (ap_samples, a_nsamples, a_gain);
+}
+
+void
+tiz_pcm_s16_to_float (float * ap_dst, const int16_t * ap_src,
+                      const size_t a_nsamples)
+{
+  assert ((ap_dst && ap_src) || 0 == a_nsamples);
+  kernels ()->pf_s16_to_float (ap_dst, ap_src, a_nsamples);
+}
+
+void
+tiz_pcm_float_to_s16 (int16_t * ap_dst, const float * ap_src,
+                      const size_t a_nsamples)
+{
+  assert ((ap_dst && ap_src) || 0 == a_nsamples);
+  kernels ()->pf_float_to_s16 (ap_dst, ap_src, a_nsamples);
+}
+
+void
+tiz_pcm_s16_bswap (int16_t * ap_samples, const size_t a_nsamples)
+{
+  assert (ap_samples || 0 == a_nsamples);
+  kernels ()->pf_s16_bswap (ap_samples, a_nsamples);
+}
+
+void
+tiz_pcm_s16_interleave (int16_t * ap_dst, const int16_t * const * app_src,
+                        const unsigned int a_nchannels, const size_t a_nframes)
+{
+  assert (ap_dst);
+  assert (app_src);
+  assert (a_nchannels > 0);
+
+  if (2 == a_nchannels)
+    {
+      kernels ()->pf_s16_interleave2 (ap_dst, app_src[0], app_src[1],
+                                      a_nframes);
+    }
+  else if (1 == a_nchannels)
+    {
+      memcpy (ap_dst, app_src[0], a_nframes * sizeof (int16_t));
+    }
+  else
+    {
+      size_t i = 0;
+      unsigned int ch = 0;
+      for (i = 0; i < a_nframes; ++i)
+        {
+          for (ch = 0; ch < a_nchannels; ++ch)
+            {
+              *(ap_dst++) = app_src[ch][i];
+            }
+        }
+    }
+}
+
+void
+tiz_pcm_s16_deinterleave (int16_t * const * app_dst, const int16_t * ap_src,
+                          const unsigned int a_nchannels,
+                          const size_t a_nframes)
+{
+  assert (app_dst);
+  assert (ap_src);
+  assert (a_nchannels > 0);
+
+  if (2 == a_nchannels)
+    {
+      kernels ()->pf_s16_deinterleave2 (app_dst[0], app_dst[1], ap_src,
+                                        a_nframes);
+    }
+  else if (1 == a_nchannels)
+    {
+      memcpy (app_dst[0], ap_src, a_nframes * sizeof (int16_t));
+    }
+  else
+    {
+      size_t i = 0;
+      unsigned int ch = 0;
+      for (i = 0; i < a_nframes; ++i)
+        {
+          for (ch = 0; ch < a_nchannels; ++ch)
+            {
+              app_dst[ch][i] = *(ap_src++);
+            }
+        }
+    }
+}
+
+void
+tiz_pcm_fixed_to_s16 (int16_t * ap_dst, const int32_t * ap_src,
+                      const size_t a_nsamples, const unsigned int a_fracbits)
+{
+  assert ((ap_dst && ap_src) || 0 == a_nsamples);
+  assert (a_fracbits >= 15 && a_fracbits < 32);
+  kernels ()->pf_fixed_to_s16 (ap_dst, ap_src, a_nsamples, a_fracbits - 15);
+}
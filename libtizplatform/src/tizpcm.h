@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizpcm.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  PCM sample processing kernels
+ *
+ *
+ */
+
+#ifndef TIZPCM_H
+#define TIZPCM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tizpcm PCM sample processing kernels
+ *
+ * Sample format conversion and simple DSP routines shared by the audio
+ * decoders and renderers. The best implementation available on the running
+ * CPU (SSE2, AVX2 or NEON, with a scalar fallback) is selected the first time
+ * any of the kernels is used. All the implementations produce bit-identical
+ * results. Buffers need not be aligned.
+ *
+ * @ingroup libtizplatform
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OMX_Core.h>
+
+/**
+ * Instruction sets a kernel implementation may be based on.
+ * @ingroup tizpcm
+ */
+typedef enum tiz_pcm_isa {
+  ETIZPcmIsaScalar = 0,
+  ETIZPcmIsaSse2,
+  ETIZPcmIsaAvx2,
+  ETIZPcmIsaNeon,
+  ETIZPcmIsaMax
+} tiz_pcm_isa_t;
+
+/**
+ * Retrieve the instruction set of the kernels currently in use.
+ *
+ * @ingroup tizpcm
+ */
+tiz_pcm_isa_t
+tiz_pcm_get_isa (void);
+
+/**
+ * Find out whether a particular implementation can be used on this CPU.
+ *
+ * @ingroup tizpcm
+ */
+bool
+tiz_pcm_isa_supported (const tiz_pcm_isa_t a_isa);
+
+/**
+ * Override the automatic selection of kernels. This is process-wide and is
+ * mostly useful for tests and benchmarks.
+ *
+ * @ingroup tizpcm
+ *
+ * @return OMX_ErrorNone on success, OMX_ErrorUnsupportedSetting if the
+ * instruction set is not available on this CPU.
+ */
+OMX_ERRORTYPE
+tiz_pcm_set_isa (const tiz_pcm_isa_t a_isa);
+
+/**
+ * Return a human-readable name for an instruction set.
+ *
+ * @ingroup tizpcm
+ */
+const char *
+tiz_pcm_isa_to_str (const tiz_pcm_isa_t a_isa);
+
+/**
+ * Apply a linear gain to signed 16-bit samples, in place. Results are
+ * rounded to the nearest integer and saturated.
+ *
+ * @ingroup tizpcm
+ */
+void
+tiz_pcm_s16_gain (int16_t * ap_samples, const size_t a_nsamples,
+                  const float a_gain);
+
+/**
+ * Convert signed 16-bit samples to floats in the range [-1.0, 1.0).
+ *
+ * @ingroup tizpcm
+ */
+void
+tiz_pcm_s16_to_float (float * ap_dst, const int16_t * ap_src,
+                      const size_t a_nsamples);
+
+/**
+ * Convert float samples to signed 16-bit. Samples are scaled by 32768,
+ * rounded to the nearest integer and saturated.
+ *
+ * @ingroup tizpcm
+ */
+void
+tiz_pcm_float_to_s16 (int16_t * ap_dst, const float * ap_src,
+                      const size_t a_nsamples);
+
+/**
+ * Swap the byte order of 16-bit samples, in place.
+ *
+ * @ingroup tizpcm
+ */
+void
+tiz_pcm_s16_bswap (int16_t * ap_samples, const size_t a_nsamples);
+
+/**
+ * Interleave planar signed 16-bit channels.
+ *
+ * @ingroup tizpcm
+ *
+ * @param ap_dst The interleaved output (a_nchannels * a_nframes samples).
+ * @param app_src One pointer per channel. The same plane may be given for
+ * more than one channel.
+ * @param a_nchannels The number of channels.
+ * @param a_nframes The number of samples in each plane.
+ */
+void
+tiz_pcm_s16_interleave (int16_t * ap_dst, const int16_t * const * app_src,
+                        const unsigned int a_nchannels, const size_t a_nframes);
+
+/**
+ * De-interleave signed 16-bit samples into planar channels.
+ *
+ * @ingroup tizpcm
+ *
+ * @param app_dst One output plane per channel.
+ * @param ap_src The interleaved input (a_nchannels * a_nframes samples).
+ * @param a_nchannels The number of channels.
+ * @param a_nframes The number of samples in each plane.
+ */
+void
+tiz_pcm_s16_deinterleave (int16_t * const * app_dst, const int16_t * ap_src,
+                          const unsigned int a_nchannels,
+                          const size_t a_nframes);
+
+/**
+ * Convert fixed-point samples to signed 16-bit. The input is shifted right to
+ * keep 15 fractional bits and then saturated.
+ *
+ * @ingroup tizpcm
+ *
+ * @param a_fracbits The number of fractional bits of the input (at least 15).
+ */
+void
+tiz_pcm_fixed_to_s16 (int16_t * ap_dst, const int32_t * ap_src,
+                      const size_t a_nsamples, const unsigned int a_fracbits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZPCM_H */
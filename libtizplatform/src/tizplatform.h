@@ -40,8 +40,11 @@
 #include "tizlog.h"
 #include "tizmem.h"
 #include "tizqueue.h"
+#include "tizlfqueue.h"
+#include "tizspscring.h"
 #include "tizpqueue.h"
 #include "tizbuffer.h"
+#include "tizpcm.h"
 #include "tizvector.h"
 #include "tizsync.h"
 #include "tizthread.h"
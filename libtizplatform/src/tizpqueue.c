@@ -33,6 +33,7 @@
 #include "tizplatform.h"
 
 #include <assert.h>
+#include <stdint.h>
 #include <string.h>
 
 #ifdef TIZ_LOG_CATEGORY_NAME
@@ -40,32 +41,36 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.platform.pqueue"
 #endif
 
-#if 0
-static void
-_pq_dump_item (const char *ap_name, void    *ap_data,
-               OMX_S32  a_priority, void    *ap_cur,
-               void    *ap_prev, void *ap_next)
-{
-  TIZ_LOG (TIZ_PRIORITY_ERROR, "DUMP [%s]: ap_data[%p] a_priority[%d] "
-           "ap_cur[%p] ap_prev[%p] ap_next[%p]",
-           ap_name, ap_data, a_priority, ap_cur, ap_prev, ap_next);
-}
-#endif
+/* Number of buckets in the key index; must be a power of two */
+#define TIZ_PQUEUE_KEY_BUCKETS 64
 
 typedef struct tiz_pqueue_item tiz_pqueue_item_t;
 struct tiz_pqueue_item
 {
   void * p_data;
+  /*@null@ */ void * p_key;
   OMX_S32 priority;
+  /* Links within the item's priority group. p_next also links the free
+     list */
   tiz_pqueue_item_t * p_prev;
   tiz_pqueue_item_t * p_next;
+  /* Links within the item's key bucket, only used when p_key is set */
+  tiz_pqueue_item_t * p_kprev;
+  tiz_pqueue_item_t * p_knext;
 };
 
 struct tiz_pqueue
 {
-  /*@dependent@ */ tiz_pqueue_item_t ** pp_store;
-  /*@dependent@ */ /*@null@ */ tiz_pqueue_item_t * p_first;
-  /*@dependent@ */ /*@null@ */ tiz_pqueue_item_t * p_last;
+  /* One FIFO per priority group */
+  /*@dependent@ */ tiz_pqueue_item_t ** pp_first;
+  /*@dependent@ */ tiz_pqueue_item_t ** pp_last;
+  /* Bit n is set when priority group n is not empty */
+  uint32_t groups;
+  /* Key index */
+  tiz_pqueue_item_t ** pp_kfirst;
+  tiz_pqueue_item_t ** pp_klast;
+  /* Items no longer in use, recycled by the next send */
+  /*@null@ */ tiz_pqueue_item_t * p_free;
   OMX_S32 length;
   OMX_S32 max_prio;
   tiz_pq_cmp_f pf_cmp;
@@ -85,43 +90,136 @@ pqueue_free (tiz_soa_t * p_soa, void * ap_addr)
   p_soa ? tiz_soa_free (p_soa, ap_addr) : tiz_mem_free (ap_addr);
 }
 
-static inline void
-hook_before (tiz_pqueue_t * p_q, tiz_pqueue_item_t * p_cur,
-             tiz_pqueue_item_t * p_new)
+static inline size_t
+key_bucket (const void * ap_key)
 {
-  tiz_pqueue_item_t * p_tmp = p_cur->p_prev;
-  p_cur->p_prev = p_new;
-  p_new->p_next = p_cur;
-  if (p_tmp)
+  const uintptr_t key = (uintptr_t) ap_key;
+  /* The low bits of heap addresses carry little information */
+  return (size_t) ((key >> 4) ^ (key >> 10)) & (TIZ_PQUEUE_KEY_BUCKETS - 1);
+}
+
+static inline OMX_S32
+first_group (const tiz_pqueue_t * p_q)
+{
+  assert (p_q->groups);
+  return (OMX_S32) __builtin_ctz (p_q->groups);
+}
+
+static inline tiz_pqueue_item_t *
+get_item (tiz_pqueue_t * p_q)
+{
+  tiz_pqueue_item_t * p_item = p_q->p_free;
+  if (p_item)
     {
-      p_new->p_prev = p_tmp;
-      p_tmp->p_next = p_new;
+      p_q->p_free = p_item->p_next;
     }
   else
     {
-      p_q->p_first = p_new;
+      p_item = (tiz_pqueue_item_t *) pqueue_calloc (
+        p_q->p_soa, sizeof (tiz_pqueue_item_t));
     }
+  return p_item;
+}
+
+static inline void
+put_item (tiz_pqueue_t * p_q, tiz_pqueue_item_t * p_item)
+{
+  p_item->p_next = p_q->p_free;
+  p_q->p_free = p_item;
 }
 
 static inline void
 hook_last (tiz_pqueue_t * p_q, tiz_pqueue_item_t * p_new)
 {
-  tiz_pqueue_item_t * p_tmp = NULL;
+  const OMX_S32 prio = p_new->priority;
+  tiz_pqueue_item_t * p_tail = p_q->pp_last[prio];
 
-  assert (p_q);
+  p_new->p_next = NULL;
+  p_new->p_prev = p_tail;
+  if (p_tail)
+    {
+      p_tail->p_next = p_new;
+    }
+  else
+    {
+      p_q->pp_first[prio] = p_new;
+      p_q->groups |= (1u << prio);
+    }
+  p_q->pp_last[prio] = p_new;
+
+  p_new->p_knext = NULL;
+  p_new->p_kprev = NULL;
+  if (p_new->p_key)
+    {
+      const size_t bucket = key_bucket (p_new->p_key);
+      p_tail = p_q->pp_klast[bucket];
+      p_new->p_kprev = p_tail;
+      if (p_tail)
+        {
+          p_tail->p_knext = p_new;
+        }
+      else
+        {
+          p_q->pp_kfirst[bucket] = p_new;
+        }
+      p_q->pp_klast[bucket] = p_new;
+    }
+}
+
+static inline void
+unhook (tiz_pqueue_t * p_q, tiz_pqueue_item_t * p_cur)
+{
+  const OMX_S32 prio = p_cur->priority;
+
+  if (p_cur->p_prev)
+    {
+      p_cur->p_prev->p_next = p_cur->p_next;
+    }
+  else
+    {
+      p_q->pp_first[prio] = p_cur->p_next;
+    }
+
+  if (p_cur->p_next)
+    {
+      p_cur->p_next->p_prev = p_cur->p_prev;
+    }
+  else
+    {
+      p_q->pp_last[prio] = p_cur->p_prev;
+    }
 
-  if (p_q->p_last)
+  if (NULL == p_q->pp_first[prio])
     {
-      p_tmp = p_q->p_last;
-      p_tmp->p_next = p_new;
-      p_new->p_prev = p_tmp;
+      p_q->groups &= ~(1u << prio);
     }
 
-  p_q->p_last = p_new;
-  if (NULL == p_q->p_first)
+  if (p_cur->p_key)
     {
-      p_q->p_first = p_new;
+      const size_t bucket = key_bucket (p_cur->p_key);
+      if (p_cur->p_kprev)
+        {
+          p_cur->p_kprev->p_knext = p_cur->p_knext;
+        }
+      else
+        {
+          p_q->pp_kfirst[bucket] = p_cur->p_knext;
+        }
+
+      if (p_cur->p_knext)
+        {
+          p_cur->p_knext->p_kprev = p_cur->p_kprev;
+        }
+      else
+        {
+          p_q->pp_klast[bucket] = p_cur->p_kprev;
+        }
     }
+
+  p_q->length--;
+  assert (p_q->length >= 0);
+  assert (p_q->length > 0 ? p_q->groups : !p_q->groups);
+  put_item (p_q, p_cur);
 }
 
 OMX_ERRORTYPE
@@ -135,24 +233,35 @@ tiz_pqueue_init (tiz_pqueue_t ** pp_q, OMX_S32 a_max_prio,
   assert (a_max_prio >= 0);
   assert (a_pf_cmp != NULL);
 
+  if (a_max_prio < 0 || a_max_prio >= TIZ_PQUEUE_MAX_PRIORITIES)
+    {
+      return OMX_ErrorBadParameter;
+    }
+
   if (NULL
       == (p_q = (tiz_pqueue_t *) pqueue_calloc (ap_soa, sizeof (tiz_pqueue_t))))
     {
       return OMX_ErrorInsufficientResources;
     }
 
-  /* There is one pointer per priority category */
+  /* There are two pointers per priority group, the group's first and last
+     items, and two more per key bucket. These tables do not fit in a small
+     object, so they always come from the heap. */
   if (NULL
-      == (p_q->pp_store = (tiz_pqueue_item_t **) pqueue_calloc (
-            ap_soa, (size_t) (a_max_prio + 1) * sizeof (tiz_pqueue_item_t *))))
+      == (p_q->pp_first = (tiz_pqueue_item_t **) tiz_mem_calloc (
+            2 * ((size_t) (a_max_prio + 1) + TIZ_PQUEUE_KEY_BUCKETS),
+            sizeof (tiz_pqueue_item_t *))))
     {
       pqueue_free (ap_soa, p_q);
       p_q = NULL;
       return OMX_ErrorInsufficientResources;
     }
 
-  p_q->p_first = NULL;
-  p_q->p_last = NULL;
+  p_q->pp_last = p_q->pp_first + a_max_prio + 1;
+  p_q->pp_kfirst = p_q->pp_last + a_max_prio + 1;
+  p_q->pp_klast = p_q->pp_kfirst + TIZ_PQUEUE_KEY_BUCKETS;
+  p_q->groups = 0;
+  p_q->p_free = NULL;
   p_q->length = 0;
   p_q->max_prio = a_max_prio;
   p_q->pf_cmp = a_pf_cmp;
@@ -174,11 +283,17 @@ tiz_pqueue_destroy (tiz_pqueue_t * p_q)
 {
   if (p_q)
     {
-      assert (p_q->p_first == p_q->p_last);
-      assert (p_q->p_first == NULL);
+      assert (0 == p_q->groups);
       assert (p_q->length == 0);
 
-      pqueue_free (p_q->p_soa, p_q->pp_store);
+      while (p_q->p_free)
+        {
+          tiz_pqueue_item_t * p_next = p_q->p_free->p_next;
+          pqueue_free (p_q->p_soa, p_q->p_free);
+          p_q->p_free = p_next;
+        }
+
+      tiz_mem_free (p_q->pp_first);
       pqueue_free (p_q->p_soa, p_q);
     }
 }
@@ -186,51 +301,31 @@ tiz_pqueue_destroy (tiz_pqueue_t * p_q)
 OMX_ERRORTYPE
 tiz_pqueue_send (tiz_pqueue_t * p_q, void * ap_data, OMX_S32 a_priority)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  return tiz_pqueue_send_keyed (p_q, ap_data, a_priority, NULL);
+}
+
+OMX_ERRORTYPE
+tiz_pqueue_send_keyed (tiz_pqueue_t * p_q, void * ap_data, OMX_S32 a_priority,
+                       void * ap_key)
+{
   tiz_pqueue_item_t * p_new = NULL;
 
   assert (p_q);
   assert (a_priority >= 0);
   assert (a_priority <= p_q->max_prio);
 
-  if (NULL == (p_new = (tiz_pqueue_item_t *) pqueue_calloc (
-                 p_q->p_soa, sizeof (tiz_pqueue_item_t))))
+  if (NULL == (p_new = get_item (p_q)))
     {
-      rc = OMX_ErrorInsufficientResources;
+      return OMX_ErrorInsufficientResources;
     }
-  else
-    {
-      OMX_S32 next_prio = a_priority + 1;
-      /* Find the next priority upwards. This will make next_prio equal to next
-       * prio up or max+1 if none */
-      while ((next_prio <= p_q->max_prio) && (NULL == p_q->pp_store[next_prio]))
-        {
-          next_prio++;
-        }
 
-      if (NULL == p_q->pp_store[a_priority])
-        {
-          p_q->pp_store[a_priority] = p_new;
-        }
+  p_new->p_data = ap_data;
+  p_new->p_key = ap_key;
+  p_new->priority = a_priority;
+  hook_last (p_q, p_new);
+  p_q->length++;
 
-      if ((next_prio <= p_q->max_prio) && (p_q->pp_store[next_prio]))
-        {
-          hook_before (p_q, p_q->pp_store[next_prio], p_new);
-        }
-      else
-        {
-          hook_last (p_q, p_new);
-        }
-
-      p_new->p_data = ap_data;
-      p_new->priority = a_priority;
-      p_q->length++;
-
-      assert (p_q->p_first);
-      assert (p_q->p_last);
-    }
-
-  return rc;
+  return OMX_ErrorNone;
 }
 
 OMX_ERRORTYPE
@@ -241,197 +336,76 @@ tiz_pqueue_receive (tiz_pqueue_t * p_q, void ** app_data)
   assert (p_q);
   assert (app_data);
 
-  TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s], pq[%p] len[%d] fst [%p] lst [%p]",
-           p_q->name, p_q, p_q->length, p_q->p_first, p_q->p_last);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s], pq[%p] len[%d] groups [%08x]",
+           p_q->name, p_q, p_q->length, p_q->groups);
 
   if (0 >= p_q->length)
     {
-      assert (p_q->p_first == p_q->p_last);
+      assert (0 == p_q->groups);
       assert (0 == p_q->length);
       rc = OMX_ErrorNoMore;
     }
   else
     {
-      tiz_pqueue_item_t * p_cur = NULL;
-      tiz_pqueue_item_t * p_next = NULL;
-
-      p_cur = p_q->p_first;
+      tiz_pqueue_item_t * p_cur = p_q->pp_first[first_group (p_q)];
       assert (p_cur);
-      p_next = p_cur->p_next;
-      p_q->p_first = p_next;
-
-      if (p_next)
-        {
-          p_next->p_prev = NULL;
-        }
-      else
-        {
-          p_q->p_last = NULL;
-          assert (p_q->length == 1);
-        }
-
-      if (p_q->pp_store[p_cur->priority] == p_cur)
-        {
-          if ((p_next) && (p_next->priority == p_cur->priority))
-            {
-              p_q->pp_store[p_cur->priority] = p_next;
-            }
-          else
-            {
-              p_q->pp_store[p_cur->priority] = NULL;
-            }
-        }
-
-      p_q->length--;
       *app_data = p_cur->p_data;
-      pqueue_free (p_q->p_soa, p_cur);
-
-      assert (p_q->length >= 0);
-      assert (p_q->length > 0 ? (p_q->p_first && p_q->p_last) : 1);
+      unhook (p_q, p_cur);
     }
 
-  TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s], pq[%p] len[%d] fst [%p] lst [%p]",
-           p_q->name, p_q, p_q->length, p_q->p_first, p_q->p_last);
-
   return rc;
 }
 
 OMX_ERRORTYPE
 tiz_pqueue_remove (tiz_pqueue_t * p_q, void * ap_data)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNoMore;
-  tiz_pqueue_item_t * p_cur = NULL;
-  tiz_pqueue_item_t * p_next = NULL;
-  tiz_pqueue_item_t * p_prev = NULL;
+  uint32_t groups = 0;
 
   assert (p_q);
   assert (ap_data);
 
-  p_cur = p_q->p_first;
-  while (p_cur)
+  groups = p_q->groups;
+  while (groups)
     {
-      if (p_q->pf_cmp (p_cur->p_data, ap_data) == 0)
+      const OMX_S32 prio = (OMX_S32) __builtin_ctz (groups);
+      groups &= groups - 1;
+      if (OMX_ErrorNone == tiz_pqueue_removep (p_q, ap_data, prio))
         {
-          p_next = p_cur->p_next;
-          p_prev = p_cur->p_prev;
-
-          if (p_next)
-            {
-              p_next->p_prev = p_prev;
-            }
-
-          if (p_prev)
-            {
-              p_prev->p_next = p_next;
-            }
-
-          if (p_q->p_first == p_cur)
-            {
-              p_q->p_first = p_next;
-            }
-
-          if (p_q->p_last == p_cur)
-            {
-              p_q->p_last = p_prev;
-            }
-
-          if (p_q->pp_store[p_cur->priority] == p_cur)
-            {
-              if ((p_next) && (p_next->priority == p_cur->priority))
-                {
-                  p_q->pp_store[p_cur->priority] = p_next;
-                }
-              else
-                {
-                  p_q->pp_store[p_cur->priority] = NULL;
-                }
-            }
-
-          pqueue_free (p_q->p_soa, p_cur);
-          p_q->length--;
-          rc = OMX_ErrorNone;
-          /* DONE */
-          break;
+          return OMX_ErrorNone;
         }
-      p_cur = p_cur->p_next;
     }
 
-  return rc;
+  return OMX_ErrorNoMore;
 }
 
 OMX_ERRORTYPE
 tiz_pqueue_removep (tiz_pqueue_t * p_q, void * ap_data, OMX_S32 a_priority)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNoMore;
   tiz_pqueue_item_t * p_cur = NULL;
-  tiz_pqueue_item_t * p_next = NULL;
-  tiz_pqueue_item_t * p_prev = NULL;
 
   assert (p_q);
   assert (ap_data != NULL);
   assert (a_priority >= 0);
   assert (a_priority <= p_q->max_prio);
 
-  p_cur = p_q->pp_store[a_priority];
-  while (p_cur && p_cur->priority == a_priority)
+  for (p_cur = p_q->pp_first[a_priority]; p_cur; p_cur = p_cur->p_next)
     {
       if (p_q->pf_cmp (p_cur->p_data, ap_data) == 0)
         {
-          p_next = p_cur->p_next;
-          p_prev = p_cur->p_prev;
-
-          if (p_next)
-            {
-              p_next->p_prev = p_prev;
-            }
-
-          if (p_prev)
-            {
-              p_prev->p_next = p_next;
-            }
-
-          if (p_q->p_first == p_cur)
-            {
-              p_q->p_first = p_next;
-            }
-
-          if (p_q->p_last == p_cur)
-            {
-              p_q->p_last = p_prev;
-            }
-
-          if (p_q->pp_store[p_cur->priority] == p_cur)
-            {
-              if ((p_next) && (p_next->priority == p_cur->priority))
-                {
-                  p_q->pp_store[p_cur->priority] = p_next;
-                }
-              else
-                {
-                  p_q->pp_store[p_cur->priority] = NULL;
-                }
-            }
-
-          pqueue_free (p_q->p_soa, p_cur);
-          p_q->length--;
-          rc = OMX_ErrorNone;
-          /* DONE */
-          break;
+          unhook (p_q, p_cur);
+          return OMX_ErrorNone;
         }
-      p_cur = p_cur->p_next;
     }
 
-  return rc;
+  return OMX_ErrorNoMore;
 }
 
 OMX_S32
 tiz_pqueue_remove_func (tiz_pqueue_t * p_q, tiz_pq_func_f a_pf_func,
                         OMX_S32 a_data1, void * ap_data2)
 {
-  tiz_pqueue_item_t * p_cur = NULL;
-  tiz_pqueue_item_t * p_next = NULL;
-  tiz_pqueue_item_t * p_prev = NULL;
   OMX_S32 initial_item_count = 0;
+  OMX_S32 prio = 0;
 
   assert (p_q);
   assert (a_pf_func);
@@ -439,59 +413,58 @@ tiz_pqueue_remove_func (tiz_pqueue_t * p_q, tiz_pq_func_f a_pf_func,
 
   initial_item_count = p_q->length;
 
-  p_cur = p_q->p_first;
-  while (p_cur)
+  /* Visit the items in the order they would be received */
+  for (prio = 0; prio <= p_q->max_prio; ++prio)
     {
-      if (OMX_TRUE == a_pf_func (p_cur->p_data, a_data1, ap_data2))
+      tiz_pqueue_item_t * p_cur = NULL;
+
+      if (!(p_q->groups & (1u << prio)))
         {
-          p_next = p_cur->p_next;
-          p_prev = p_cur->p_prev;
+          continue;
+        }
 
-          if (p_next)
+      p_cur = p_q->pp_first[prio];
+      while (p_cur)
+        {
+          tiz_pqueue_item_t * p_next = p_cur->p_next;
+          if (OMX_TRUE == a_pf_func (p_cur->p_data, a_data1, ap_data2))
             {
-              p_next->p_prev = p_prev;
+              /* NOTE: We continue here to remove as many matching items as
+               * possible */
+              unhook (p_q, p_cur);
             }
+          p_cur = p_next;
+        }
+    }
 
-          if (p_prev)
-            {
-              p_prev->p_next = p_next;
-            }
+  return (initial_item_count - p_q->length);
+}
 
-          if (p_q->p_first == p_cur)
-            {
-              p_q->p_first = p_next;
-            }
+OMX_S32
+tiz_pqueue_remove_func_keyed (tiz_pqueue_t * p_q, void * ap_key,
+                              tiz_pq_func_f a_pf_func, OMX_S32 a_data1,
+                              void * ap_data2)
+{
+  tiz_pqueue_item_t * p_cur = NULL;
+  OMX_S32 initial_item_count = 0;
 
-          if (p_q->p_last == p_cur)
-            {
-              p_q->p_last = p_prev;
-            }
+  assert (p_q);
+  assert (ap_key);
+  assert (a_pf_func);
+  assert (ap_data2);
 
-          if (p_q->pp_store[p_cur->priority] == p_cur)
-            {
-              if ((p_next) && (p_next->priority == p_cur->priority))
-                {
-                  p_q->pp_store[p_cur->priority] = p_next;
-                }
-              else
-                {
-                  p_q->pp_store[p_cur->priority] = NULL;
-                }
-            }
+  initial_item_count = p_q->length;
 
-          {
-            tiz_pqueue_item_t * p_to_delete = p_cur;
-            p_cur = p_cur->p_next;
-            pqueue_free (p_q->p_soa, p_to_delete);
-            p_q->length--;
-            /* NOTE: We continue here to remove as many matching items as
-             * possible */
-          }
-        }
-      else
+  p_cur = p_q->pp_kfirst[key_bucket (ap_key)];
+  while (p_cur)
+    {
+      tiz_pqueue_item_t * p_next = p_cur->p_knext;
+      if (ap_key == p_cur->p_key
+          && OMX_TRUE == a_pf_func (p_cur->p_data, a_data1, ap_data2))
         {
-          p_cur = p_cur->p_next;
+          unhook (p_q, p_cur);
         }
+      p_cur = p_next;
     }
 
   return (initial_item_count - p_q->length);
@@ -507,13 +480,12 @@ tiz_pqueue_first (tiz_pqueue_t * p_q, void ** app_data)
 
   if (0 >= p_q->length)
     {
-      assert (p_q->p_first == p_q->p_last);
+      assert (0 == p_q->groups);
       rc = OMX_ErrorNoMore;
     }
   else
     {
-      assert (p_q->p_first);
-      *app_data = p_q->p_first->p_data;
+      *app_data = p_q->pp_first[first_group (p_q)]->p_data;
     }
 
   return rc;
@@ -529,19 +501,22 @@ tiz_pqueue_length (const tiz_pqueue_t * p_q)
 OMX_S32
 tiz_pqueue_dump (tiz_pqueue_t * p_q, tiz_pq_dump_item_f a_pf_dump)
 {
-  tiz_pqueue_item_t * p_current = NULL;
   OMX_S32 count = 0;
+  OMX_S32 prio = 0;
 
   assert (p_q);
   assert (a_pf_dump);
 
-  p_current = p_q->p_first;
-  while (p_current)
+  for (prio = 0; prio <= p_q->max_prio; ++prio)
     {
-      a_pf_dump (p_q->name, p_current->p_data, p_current->priority, p_current,
-                 p_current->p_prev, p_current->p_next);
-      p_current = p_current->p_next;
-      count++;
+      tiz_pqueue_item_t * p_current = p_q->pp_first[prio];
+      while (p_current)
+        {
+          a_pf_dump (p_q->name, p_current->p_data, p_current->priority,
+                     p_current, p_current->p_prev, p_current->p_next);
+          p_current = p_current->p_next;
+          count++;
+        }
     }
 
   return count;
@@ -39,6 +39,13 @@ extern "C" {
  * Non-synchronized priority queue. External synchronisation is required in
  * case it needs to be accessed safely from multiple threads.
  *
+ * Each priority group is a FIFO of its own and a bitmap tracks the non-empty
+ * groups, so sending and receiving take constant time regardless of the
+ * number of items or groups. Queue nodes are recycled: once the queue has
+ * reached its high-water mark, no more memory is allocated. Items may
+ * optionally be sent with a key (e.g. a buffer header), which allows removing
+ * them without scanning the whole queue (see tiz_pqueue_remove_func_keyed).
+ *
  * @ingroup libtizplatform
  */
 
@@ -103,6 +110,13 @@ typedef void (*tiz_pq_dump_item_f) (const char * ap_name, void * ap_data,
                                     void * ap_next, void * ap_prev);
 
 #define TIZ_PQUEUE_MAX_NAME_LEN 20
+
+/**
+ * The maximum number of priority groups supported by a queue.
+ * @ingroup tizpqueue
+ */
+#define TIZ_PQUEUE_MAX_PRIORITIES 32
+
 /**
  * Initialize a new empty priority queue with up to a_max_prio + 1 different
  * priorities (i.e. priority groups [0..a_max_prio]). 0 is the highest
@@ -125,7 +139,9 @@ typedef void (*tiz_pq_dump_item_f) (const char * ap_name, void * ap_data,
  * @ap_name A string of up to TIZ_PQUEUE_MAX_NAME_LEN characters that can be
  * used during debugging to identify this queue
  *
- * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise
+ * @return OMX_ErrorNone if success, OMX_ErrorBadParameter if a_max_prio is
+ * not less than TIZ_PQUEUE_MAX_PRIORITIES, OMX_ErrorInsufficientResources
+ * otherwise
  */
 OMX_ERRORTYPE
 tiz_pqueue_init (tiz_pqueue_t ** app_pq, OMX_S32 a_max_prio,
@@ -157,6 +173,23 @@ tiz_pqueue_destroy (/*@null@ */ tiz_pqueue_t * ap_pq);
 OMX_ERRORTYPE
 tiz_pqueue_send (tiz_pqueue_t * ap_pq, void * ap_data, OMX_S32 a_prio);
 
+/**
+ * Add an item to the end of the priority group a_prio, and index it under
+ * ap_key so that it can later be found with tiz_pqueue_remove_func_keyed.
+ * Several items may share the same key.
+ *
+ * @ingroup tizpqueue
+ *
+ * @param ap_key The lookup key, or NULL if the item does not need to be
+ * indexed (this is equivalent to tiz_pqueue_send)
+ *
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise
+ *
+ */
+OMX_ERRORTYPE
+tiz_pqueue_send_keyed (tiz_pqueue_t * ap_pq, void * ap_data, OMX_S32 a_prio,
+                       /*@null@ */ void * ap_key);
+
 /**
  * Receive the first item from the queue. The item received is no longer in
  * the queue.
@@ -205,6 +238,19 @@ OMX_S32
 tiz_pqueue_remove_func (tiz_pqueue_t * ap_pq, tiz_pq_func_f apf_func,
                         OMX_S32 a_data1, void * ap_data2);
 
+/**
+ * Remove from the queue all the items that were sent with key ap_key (see
+ * tiz_pqueue_send_keyed) and that are matched by the comparison function
+ * apf_func. Only the items indexed under ap_key are visited.
+ *
+ * @ingroup tizpqueue
+ * @return The number of items removed from the queue.
+ */
+OMX_S32
+tiz_pqueue_remove_func_keyed (tiz_pqueue_t * ap_pq, void * ap_key,
+                              tiz_pq_func_f apf_func, OMX_S32 a_data1,
+                              void * ap_data2);
+
 /**
  * Return a reference to the first item in the queue.
  *
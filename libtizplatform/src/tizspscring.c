@@ -0,0 +1,263 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizspscring.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Single-producer/single-consumer byte ring
+ *
+ * Head and tail are free-running byte counters; only the producer writes the
+ * tail and only the consumer writes the head, so no read-modify-write is
+ * needed on the data path. The 'wakeup pending' flag is the only word both
+ * sides modify. The producer raises it after publishing the new tail and the
+ * consumer lowers it before reading the tail, which guarantees that data
+ * written after the consumer's last look at the ring always raises a fresh
+ * notification.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "tizplatform.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.platform.spscring"
+#endif
+
+struct tiz_spscring
+{
+  /* Written by the producer only */
+  size_t tail TIZ_CACHELINE_ALIGNED;
+  /* Written by the consumer only */
+  size_t head TIZ_CACHELINE_ALIGNED;
+  /* Raised by the producer, lowered by the consumer */
+  int32_t wakeup_pending TIZ_CACHELINE_ALIGNED;
+  /* Read-only after init */
+  uint8_t * p_data TIZ_CACHELINE_ALIGNED;
+  size_t mask;
+  size_t capacity;
+};
+
+static inline void
+copy_in (tiz_spscring_t * ap_ring, size_t a_pos, const uint8_t * ap_src,
+         size_t a_nbytes)
+{
+  const size_t offset = a_pos & ap_ring->mask;
+  const size_t first = MIN (a_nbytes, ap_ring->capacity - offset);
+  memcpy (ap_ring->p_data + offset, ap_src, first);
+  if (a_nbytes > first)
+    {
+      memcpy (ap_ring->p_data, ap_src + first, a_nbytes - first);
+    }
+}
+
+static inline void
+copy_out (const tiz_spscring_t * ap_ring, size_t a_pos, uint8_t * ap_dst,
+          size_t a_nbytes)
+{
+  const size_t offset = a_pos & ap_ring->mask;
+  const size_t first = MIN (a_nbytes, ap_ring->capacity - offset);
+  memcpy (ap_dst, ap_ring->p_data + offset, first);
+  if (a_nbytes > first)
+    {
+      memcpy (ap_dst + first, ap_ring->p_data, a_nbytes - first);
+    }
+}
+
+OMX_ERRORTYPE
+tiz_spscring_init (tiz_spscring_ptr_t * app_ring, size_t a_capacity)
+{
+  tiz_spscring_t * p_ring = NULL;
+  size_t nbytes = 2;
+
+  assert (app_ring);
+  assert (a_capacity > 0);
+
+  while (nbytes < a_capacity)
+    {
+      nbytes <<= 1;
+    }
+
+  if (0 != posix_memalign ((void **) &p_ring, TIZ_CACHELINE_SIZE,
+                           sizeof (tiz_spscring_t)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "[OMX_ErrorInsufficientResources] : "
+               "Could not instantiate ring struct.");
+      return OMX_ErrorInsufficientResources;
+    }
+  tiz_mem_set (p_ring, 0, sizeof (tiz_spscring_t));
+
+  if (!(p_ring->p_data = (uint8_t *) tiz_mem_alloc (nbytes)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "[OMX_ErrorInsufficientResources] : "
+               "Could not allocate [%zu] ring bytes.",
+               nbytes);
+      tiz_mem_free (p_ring);
+      return OMX_ErrorInsufficientResources;
+    }
+
+  p_ring->mask = nbytes - 1;
+  p_ring->capacity = nbytes;
+  *app_ring = p_ring;
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "ring [%p] capacity [%zu] (requested [%zu])",
+           p_ring, p_ring->capacity, a_capacity);
+
+  return OMX_ErrorNone;
+}
+
+void
+tiz_spscring_destroy (tiz_spscring_t * ap_ring)
+{
+  if (ap_ring)
+    {
+      tiz_mem_free (ap_ring->p_data);
+      ap_ring->p_data = NULL;
+      tiz_mem_free (ap_ring);
+    }
+}
+
+size_t
+tiz_spscring_write (tiz_spscring_t * ap_ring, const void * ap_data,
+                    size_t a_nbytes, bool * ap_wakeup)
+{
+  size_t tail = 0;
+  size_t head = 0;
+
+  assert (ap_ring);
+  assert (ap_data || 0 == a_nbytes);
+
+  if (ap_wakeup)
+    {
+      *ap_wakeup = false;
+    }
+
+  tail = ap_ring->tail;
+  head = __atomic_load_n (&(ap_ring->head), __ATOMIC_ACQUIRE);
+  if (0 == a_nbytes || ap_ring->capacity - (tail - head) < a_nbytes)
+    {
+      return 0;
+    }
+
+  copy_in (ap_ring, tail, (const uint8_t *) ap_data, a_nbytes);
+
+  /* Publish the bytes, then raise the flag. Both are sequentially consistent
+     so that they pair with the lowering of the flag and the reading of the
+     tail in the consumer. */
+  __atomic_store_n (&(ap_ring->tail), tail + a_nbytes, __ATOMIC_SEQ_CST);
+  if (0 == __atomic_exchange_n (&(ap_ring->wakeup_pending), 1,
+                                __ATOMIC_SEQ_CST)
+      && ap_wakeup)
+    {
+      *ap_wakeup = true;
+    }
+
+  return a_nbytes;
+}
+
+size_t
+tiz_spscring_space (const tiz_spscring_t * ap_ring)
+{
+  assert (ap_ring);
+  return ap_ring->capacity
+         - (ap_ring->tail
+            - __atomic_load_n (&(ap_ring->head), __ATOMIC_ACQUIRE));
+}
+
+bool
+tiz_spscring_ack_wakeup (tiz_spscring_t * ap_ring)
+{
+  assert (ap_ring);
+  return (0 != __atomic_exchange_n (&(ap_ring->wakeup_pending), 0,
+                                    __ATOMIC_SEQ_CST));
+}
+
+size_t
+tiz_spscring_available (const tiz_spscring_t * ap_ring)
+{
+  assert (ap_ring);
+  return __atomic_load_n (&(ap_ring->tail), __ATOMIC_SEQ_CST) - ap_ring->head;
+}
+
+size_t
+tiz_spscring_peek (const tiz_spscring_t * ap_ring, const void ** app_data)
+{
+  size_t offset = 0;
+  size_t avail = 0;
+
+  assert (ap_ring);
+  assert (app_data);
+
+  avail = tiz_spscring_available (ap_ring);
+  offset = ap_ring->head & ap_ring->mask;
+  *app_data = ap_ring->p_data + offset;
+  return MIN (avail, ap_ring->capacity - offset);
+}
+
+void
+tiz_spscring_advance (tiz_spscring_t * ap_ring, size_t a_nbytes)
+{
+  assert (ap_ring);
+  assert (a_nbytes <= tiz_spscring_available (ap_ring));
+  __atomic_store_n (&(ap_ring->head), ap_ring->head + a_nbytes,
+                    __ATOMIC_RELEASE);
+}
+
+size_t
+tiz_spscring_read (tiz_spscring_t * ap_ring, void * ap_data, size_t a_nbytes)
+{
+  size_t nbytes = 0;
+
+  assert (ap_ring);
+  assert (ap_data || 0 == a_nbytes);
+
+  nbytes = MIN (a_nbytes, tiz_spscring_available (ap_ring));
+  if (nbytes > 0)
+    {
+      copy_out (ap_ring, ap_ring->head, (uint8_t *) ap_data, nbytes);
+      tiz_spscring_advance (ap_ring, nbytes);
+    }
+  return nbytes;
+}
+
+void
+tiz_spscring_clear (tiz_spscring_t * ap_ring)
+{
+  assert (ap_ring);
+  __atomic_store_n (&(ap_ring->head),
+                    __atomic_load_n (&(ap_ring->tail), __ATOMIC_ACQUIRE),
+                    __ATOMIC_RELEASE);
+}
+
+size_t
+tiz_spscring_capacity (const tiz_spscring_t * ap_ring)
+{
+  assert (ap_ring);
+  return ap_ring->capacity;
+}
@@ -0,0 +1,186 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizspscring.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Single-producer/single-consumer byte ring
+ *
+ *
+ */
+
+#ifndef TIZSPSCRING_H
+#define TIZSPSCRING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tizspscring Single-producer/single-consumer byte ring
+ *
+ * Bounded, lock-free byte FIFO for exactly one producer thread and one
+ * consumer thread. The storage is allocated once, at init time. Besides the
+ * data, the ring carries a 'wakeup pending' flag that lets the producer find
+ * out when the consumer needs to be notified: a notification is only
+ * requested for the first write after the consumer has acknowledged the
+ * previous one, so any number of writes result in at most one outstanding
+ * notification.
+ *
+ * @ingroup libtizplatform
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+
+/**
+ * SPSC ring opaque structure.
+ * @ingroup tizspscring
+ */
+typedef struct tiz_spscring tiz_spscring_t;
+typedef /*@null@ */ tiz_spscring_t * tiz_spscring_ptr_t;
+
+/**
+ * Initialize a new empty ring.
+ *
+ * @ingroup tizspscring
+ *
+ * @param app_ring A ring opaque handle to be initialised.
+ *
+ * @param a_capacity Number of bytes that can be stored in the ring. It is
+ * rounded up to the next power of two.
+ *
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_spscring_init (/*@out@*/ tiz_spscring_ptr_t * app_ring, size_t a_capacity);
+
+/**
+ * Destroy a ring. If ap_ring is NULL, no operation is performed.
+ *
+ * @ingroup tizspscring
+ *
+ */
+void
+tiz_spscring_destroy (/*@null@ */ tiz_spscring_t * ap_ring);
+
+/**
+ * Producer side. Copy a_nbytes into the ring. The write is all-or-nothing: if
+ * there is not enough space for the whole chunk, nothing is written.
+ *
+ * @ingroup tizspscring
+ *
+ * @param ap_wakeup Set to true when this write has raised the 'wakeup
+ * pending' flag, i.e. when the caller must notify the consumer. May be NULL.
+ *
+ * @return The number of bytes written, either a_nbytes or 0.
+ */
+size_t
+tiz_spscring_write (tiz_spscring_t * ap_ring, const void * ap_data,
+                    size_t a_nbytes, /*@null@ */ bool * ap_wakeup);
+
+/**
+ * Producer side. Retrieve the number of bytes that can currently be written.
+ *
+ * @ingroup tizspscring
+ *
+ */
+size_t
+tiz_spscring_space (const tiz_spscring_t * ap_ring);
+
+/**
+ * Consumer side. Clear the 'wakeup pending' flag. This must be done before
+ * draining the ring, so that data written afterwards requests a new
+ * notification.
+ *
+ * @ingroup tizspscring
+ *
+ * @return The previous value of the flag.
+ */
+bool
+tiz_spscring_ack_wakeup (tiz_spscring_t * ap_ring);
+
+/**
+ * Consumer side. Retrieve the number of bytes that can currently be read.
+ *
+ * @ingroup tizspscring
+ *
+ */
+size_t
+tiz_spscring_available (const tiz_spscring_t * ap_ring);
+
+/**
+ * Consumer side. Obtain a pointer to the largest contiguous chunk of readable
+ * bytes, without consuming them. Because the ring wraps around, this may be
+ * less than tiz_spscring_available.
+ *
+ * @ingroup tizspscring
+ *
+ * @return The number of bytes in the chunk.
+ */
+size_t
+tiz_spscring_peek (const tiz_spscring_t * ap_ring, const void ** app_data);
+
+/**
+ * Consumer side. Consume a_nbytes, previously obtained with
+ * tiz_spscring_peek.
+ *
+ * @ingroup tizspscring
+ *
+ */
+void
+tiz_spscring_advance (tiz_spscring_t * ap_ring, size_t a_nbytes);
+
+/**
+ * Consumer side. Copy up to a_nbytes out of the ring.
+ *
+ * @ingroup tizspscring
+ *
+ * @return The number of bytes read.
+ */
+size_t
+tiz_spscring_read (tiz_spscring_t * ap_ring, void * ap_data, size_t a_nbytes);
+
+/**
+ * Consumer side. Discard all the bytes currently stored in the ring.
+ *
+ * @ingroup tizspscring
+ *
+ */
+void
+tiz_spscring_clear (tiz_spscring_t * ap_ring);
+
+/**
+ * Retrieve the number of bytes the ring can hold.
+ *
+ * @ingroup tizspscring
+ *
+ */
+size_t
+tiz_spscring_capacity (const tiz_spscring_t * ap_ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZSPSCRING_H */
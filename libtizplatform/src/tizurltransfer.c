@@ -32,6 +32,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -200,6 +201,7 @@ struct tiz_urltrans
   int internal_buffer_size_initial_;
   CURL * p_curl_;        /* curl easy */
   CURLM * p_curl_multi_; /* curl multi */
+  CURLSH * p_curl_share_; /* process-wide curl share, not owned */
   struct curl_slist * p_http_ok_aliases_;
   struct curl_slist * p_http_headers_;
   httpsrc_curl_state_id_t curl_state_;
@@ -208,6 +210,159 @@ struct tiz_urltrans
   bool handshake_error_found;
 };
 
+/* The transfer engine is shared by all the url transfer objects in the
+ * process. It owns libcurl's global state and a curl share handle that holds
+ * the DNS cache and the TLS session cache, so that name lookups and TLS
+ * handshakes done for one transfer are re-used by the next, even across
+ * components. */
+typedef struct tiz_urltrans_engine tiz_urltrans_engine_t;
+struct tiz_urltrans_engine
+{
+  pthread_mutex_t mutex; /* protects refs and p_share */
+  unsigned int refs;
+  CURLSH * p_share;
+  pthread_mutex_t locks[CURL_LOCK_DATA_LAST];
+};
+
+static pthread_once_t g_engine_once = PTHREAD_ONCE_INIT;
+static tiz_urltrans_engine_t g_engine;
+
+static void
+init_engine (void)
+{
+  int i = 0;
+  (void) pthread_mutex_init (&(g_engine.mutex), NULL);
+  for (i = 0; i < CURL_LOCK_DATA_LAST; ++i)
+    {
+      (void) pthread_mutex_init (&(g_engine.locks[i]), NULL);
+    }
+  g_engine.refs = 0;
+  g_engine.p_share = NULL;
+}
+
+/* The share handle is used from the threads of all the components that have
+ * a transfer object; libcurl serialises access to each type of shared data
+ * with these callbacks */
+static void
+engine_lock_cback (CURL * p_curl, curl_lock_data data, curl_lock_access access,
+                   void * userptr)
+{
+  tiz_urltrans_engine_t * p_engine = userptr;
+  assert (p_engine);
+  assert (data < CURL_LOCK_DATA_LAST);
+  (void) pthread_mutex_lock (&(p_engine->locks[data]));
+}
+
+static void
+engine_unlock_cback (CURL * p_curl, curl_lock_data data, void * userptr)
+{
+  tiz_urltrans_engine_t * p_engine = userptr;
+  assert (p_engine);
+  assert (data < CURL_LOCK_DATA_LAST);
+  (void) pthread_mutex_unlock (&(p_engine->locks[data]));
+}
+
+static CURLSH *
+create_engine_share (tiz_urltrans_engine_t * ap_engine)
+{
+  CURLSH * p_share = NULL;
+  CURLSHcode shrc = CURLSHE_OK;
+
+  assert (ap_engine);
+
+  if (!(p_share = curl_share_init ()))
+    {
+      return NULL;
+    }
+
+  if (CURLSHE_OK
+        != (shrc = curl_share_setopt (p_share, CURLSHOPT_LOCKFUNC,
+                                      engine_lock_cback))
+      || CURLSHE_OK
+           != (shrc = curl_share_setopt (p_share, CURLSHOPT_UNLOCKFUNC,
+                                         engine_unlock_cback))
+      || CURLSHE_OK
+           != (shrc = curl_share_setopt (p_share, CURLSHOPT_USERDATA,
+                                         ap_engine))
+      || CURLSHE_OK
+           != (shrc = curl_share_setopt (p_share, CURLSHOPT_SHARE,
+                                         CURL_LOCK_DATA_DNS)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "error while using curl share (%s)",
+               curl_share_strerror (shrc));
+      curl_share_cleanup (p_share);
+      return NULL;
+    }
+
+  /* TLS session re-use is not supported by all TLS backends; the transfers
+   * will simply do a full handshake in that case */
+  if (CURLSHE_OK
+      != (shrc = curl_share_setopt (p_share, CURLSHOPT_SHARE,
+                                    CURL_LOCK_DATA_SSL_SESSION)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "TLS sessions not shared (%s)",
+               curl_share_strerror (shrc));
+    }
+
+  return p_share;
+}
+
+static OMX_ERRORTYPE
+acquire_engine (CURLSH ** app_share)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  tiz_urltrans_engine_t * p_engine = &g_engine;
+
+  assert (app_share);
+
+  (void) pthread_once (&g_engine_once, init_engine);
+  (void) pthread_mutex_lock (&(p_engine->mutex));
+
+  if (0 == p_engine->refs)
+    {
+      assert (!p_engine->p_share);
+      /* curl_global_init is not thread-safe; only the engine calls it */
+      if (CURLE_OK != curl_global_init (CURL_GLOBAL_ALL))
+        {
+          rc = OMX_ErrorInsufficientResources;
+        }
+      else if (!(p_engine->p_share = create_engine_share (p_engine)))
+        {
+          curl_global_cleanup ();
+          rc = OMX_ErrorInsufficientResources;
+        }
+    }
+
+  if (OMX_ErrorNone == rc)
+    {
+      p_engine->refs++;
+      *app_share = p_engine->p_share;
+    }
+
+  (void) pthread_mutex_unlock (&(p_engine->mutex));
+  return rc;
+}
+
+static void
+release_engine (CURLSH * ap_share)
+{
+  tiz_urltrans_engine_t * p_engine = &g_engine;
+
+  assert (ap_share);
+
+  (void) pthread_mutex_lock (&(p_engine->mutex));
+  assert (p_engine->refs > 0);
+  assert (ap_share == p_engine->p_share);
+  if (0 == --p_engine->refs)
+    {
+      /* All the easy handles using the share are gone by now */
+      (void) curl_share_cleanup (p_engine->p_share);
+      p_engine->p_share = NULL;
+      curl_global_cleanup ();
+    }
+  (void) pthread_mutex_unlock (&(p_engine->mutex));
+}
+
 /*@observer@*/ const char *
 httpsrc_curl_state_to_str (const httpsrc_curl_state_id_t a_state)
 {
@@ -920,12 +1075,20 @@ curl_timer_cback (CURLM * multi, long timeout_ms, void * userp)
 static OMX_ERRORTYPE
 allocate_curl_global_resources (tiz_urltrans_t * ap_trans)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
-  bail_on_curl_error (curl_global_init (CURL_GLOBAL_ALL));
-  /* All well */
-  rc = OMX_ErrorNone;
-end:
-  return rc;
+  assert (ap_trans);
+  assert (!ap_trans->p_curl_share_);
+  return acquire_engine (&(ap_trans->p_curl_share_));
+}
+
+static void
+destroy_curl_global_resources (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  if (ap_trans->p_curl_share_)
+    {
+      release_engine (ap_trans->p_curl_share_);
+      ap_trans->p_curl_share_ = NULL;
+    }
 }
 
 static OMX_ERRORTYPE
@@ -1008,6 +1171,9 @@ allocate_curl_resources (tiz_urltrans_t * ap_trans)
 
   /* Init the curl easy handle */
   tiz_check_null_ret_oom ((ap_trans->p_curl_ = curl_easy_init ()));
+  /* Use the process-wide DNS and TLS session caches */
+  bail_on_curl_error (curl_easy_setopt (ap_trans->p_curl_, CURLOPT_SHARE,
+                                        ap_trans->p_curl_share_));
   /* Now init the curl multi handle */
   bail_on_oom ((ap_trans->p_curl_multi_ = curl_multi_init ()));
   /* this is to ask libcurl to accept ICY OK headers*/
@@ -1099,6 +1265,7 @@ tiz_urltrans_init (tiz_urltrans_ptr_t * app_trans, void * ap_parent,
           p_trans->internal_buffer_size_initial_ = 0;
           p_trans->p_curl_ = NULL;
           p_trans->p_curl_multi_ = NULL;
+          p_trans->p_curl_share_ = NULL;
           p_trans->p_http_ok_aliases_ = NULL;
           p_trans->p_http_headers_ = NULL;
           p_trans->curl_state_ = ECurlStateStopped;
@@ -1135,7 +1302,7 @@ tiz_urltrans_destroy (tiz_urltrans_t * ap_trans)
       destroy_temp_data_store (ap_trans);
       destroy_events (ap_trans);
       destroy_curl_resources (ap_trans);
-      curl_global_cleanup ();
+      destroy_curl_global_resources (ap_trans);
     }
 }
 
@@ -0,0 +1,146 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_buffer.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tests for the buffer API implementation
+ *
+ *
+ */
+
+#define CHECK_BUFFER_CHUNK_SIZE 1000
+
+static void
+check_buffer_fill_chunk (unsigned char * ap_chunk, const size_t a_len,
+                         const unsigned int a_seed)
+{
+  size_t i = 0;
+  for (i = 0; i < a_len; ++i)
+    {
+      ap_chunk[i] = (unsigned char) ((a_seed + i) & 0xff);
+    }
+}
+
+START_TEST (test_buffer_push_get_advance)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  tiz_buffer_t * p_buf = NULL;
+  unsigned char chunk[CHECK_BUFFER_CHUNK_SIZE];
+  unsigned int pushed = 0;
+  unsigned int consumed = 0;
+  int i = 0;
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "test_buffer_push_get_advance");
+
+  error = tiz_buffer_init (&p_buf, 4096);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (tiz_buffer_available (p_buf) != 0);
+
+  /* Push more data than the initial size, consuming less than what's pushed,
+     so that the store needs to be compacted and re-allocated */
+  for (i = 0; i < 50; ++i)
+    {
+      int j = 0;
+      unsigned char * p_data = NULL;
+      check_buffer_fill_chunk (chunk, sizeof (chunk), pushed);
+      fail_if (tiz_buffer_push (p_buf, chunk, sizeof (chunk))
+               != sizeof (chunk));
+      pushed += sizeof (chunk);
+
+      p_data = tiz_buffer_get (p_buf);
+      for (j = 0; j < 700; ++j)
+        {
+          fail_if (p_data[j] != (unsigned char) ((consumed + j) & 0xff));
+        }
+      fail_if (tiz_buffer_advance (p_buf, 700) != 700);
+      consumed += 700;
+      fail_if (tiz_buffer_available (p_buf) != (int) (pushed - consumed));
+    }
+
+  tiz_buffer_clear (p_buf);
+  fail_if (tiz_buffer_available (p_buf) != 0);
+
+  tiz_buffer_destroy (p_buf);
+}
+END_TEST
+
+START_TEST (test_buffer_ring_wrap_around)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  tiz_buffer_t * p_buf = NULL;
+  unsigned char chunk[CHECK_BUFFER_CHUNK_SIZE];
+  unsigned int pushed = 0;
+  unsigned int consumed = 0;
+  int capacity = 0;
+  int i = 0;
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "test_buffer_ring_wrap_around");
+
+  error = tiz_buffer_init_ring (&p_buf, 5000);
+  fail_if (error != OMX_ErrorNone);
+
+  /* Ring buffers can't be seekable */
+  fail_if (tiz_buffer_seek_mode (p_buf, TIZ_BUFFER_SEEKABLE) != -1);
+  fail_if (tiz_buffer_seek (p_buf, 0, TIZ_BUFFER_SEEK_SET) != -1);
+
+  /* The capacity is fixed; find out what it is by filling the ring */
+  do
+    {
+      check_buffer_fill_chunk (chunk, sizeof (chunk), pushed);
+      capacity = tiz_buffer_push (p_buf, chunk, sizeof (chunk));
+      pushed += capacity;
+    }
+  while (capacity == sizeof (chunk));
+  capacity = tiz_buffer_available (p_buf);
+  fail_if (capacity < 5000);
+  fail_if (tiz_buffer_push (p_buf, chunk, 1) != 0);
+
+  /* Keep the ring nearly full while data goes around it many times; every
+     read must see contiguous data */
+  for (i = 0; i < 200; ++i)
+    {
+      int j = 0;
+      int avail = 0;
+      unsigned char * p_data = tiz_buffer_get (p_buf);
+      avail = tiz_buffer_available (p_buf);
+      for (j = 0; j < avail; ++j)
+        {
+          fail_if (p_data[j] != (unsigned char) ((consumed + j) & 0xff));
+        }
+      fail_if (tiz_buffer_advance (p_buf, 777) != 777);
+      consumed += 777;
+
+      check_buffer_fill_chunk (chunk, sizeof (chunk), pushed);
+      pushed += tiz_buffer_push (p_buf, chunk, sizeof (chunk));
+      fail_if (tiz_buffer_available (p_buf) != (int) (pushed - consumed));
+      fail_if (tiz_buffer_available (p_buf) > capacity);
+    }
+
+  tiz_buffer_destroy (p_buf);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
@@ -0,0 +1,216 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_lfqueue.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Lock-free queue API unit tests and throughput benchmark
+ *
+ *
+ */
+
+#include <time.h>
+
+#define LFQUEUE_TEST_PRODUCERS 4
+#define LFQUEUE_TEST_MSGS_PER_PRODUCER 200000
+#define LFQUEUE_TEST_CAPACITY 30
+
+typedef struct lfqueue_bench lfqueue_bench_t;
+struct lfqueue_bench
+{
+  tiz_queue_t * p_queue;
+  tiz_lfqueue_t * p_lfqueue;
+  OMX_U32 id;
+};
+
+static double
+lfqueue_now_secs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void *
+lfqueue_producer_thread (void * ap_arg)
+{
+  lfqueue_bench_t * p_bench = ap_arg;
+  uintptr_t i = 0;
+  for (i = 1; i <= LFQUEUE_TEST_MSGS_PER_PRODUCER; ++i)
+    {
+      /* Encode producer id and sequence number in the item pointer */
+      OMX_PTR p_item
+        = (OMX_PTR) (((uintptr_t) p_bench->id << 24) | (uintptr_t) i);
+      if (p_bench->p_lfqueue)
+        {
+          (void) tiz_lfqueue_send (p_bench->p_lfqueue, p_item);
+        }
+      else
+        {
+          (void) tiz_queue_send (p_bench->p_queue, p_item);
+        }
+    }
+  return NULL;
+}
+
+static double
+lfqueue_run_bench (tiz_queue_t * ap_queue, tiz_lfqueue_t * ap_lfqueue)
+{
+  tiz_thread_t threads[LFQUEUE_TEST_PRODUCERS];
+  lfqueue_bench_t bench[LFQUEUE_TEST_PRODUCERS];
+  uintptr_t last_seq[LFQUEUE_TEST_PRODUCERS];
+  const OMX_U32 total = LFQUEUE_TEST_PRODUCERS * LFQUEUE_TEST_MSGS_PER_PRODUCER;
+  OMX_PTR p_received = NULL;
+  double start = 0;
+  double elapsed = 0;
+  OMX_U32 i = 0;
+
+  start = lfqueue_now_secs ();
+
+  for (i = 0; i < LFQUEUE_TEST_PRODUCERS; ++i)
+    {
+      bench[i].p_queue = ap_queue;
+      bench[i].p_lfqueue = ap_lfqueue;
+      bench[i].id = i;
+      last_seq[i] = 0;
+      fail_if (OMX_ErrorNone != tiz_thread_create (&threads[i], 0, 0,
+                                                   lfqueue_producer_thread,
+                                                   &bench[i]));
+    }
+
+  for (i = 0; i < total; ++i)
+    {
+      uintptr_t id = 0;
+      uintptr_t seq = 0;
+      if (ap_lfqueue)
+        {
+          fail_if (OMX_ErrorNone
+                   != tiz_lfqueue_receive (ap_lfqueue, &p_received));
+        }
+      else
+        {
+          fail_if (OMX_ErrorNone != tiz_queue_receive (ap_queue, &p_received));
+        }
+      id = ((uintptr_t) p_received) >> 24;
+      seq = ((uintptr_t) p_received) & 0xFFFFFF;
+      fail_if (id >= LFQUEUE_TEST_PRODUCERS);
+      /* Per-producer FIFO order must be preserved */
+      fail_if (seq != last_seq[id] + 1);
+      last_seq[id] = seq;
+    }
+
+  for (i = 0; i < LFQUEUE_TEST_PRODUCERS; ++i)
+    {
+      OMX_PTR p_result = NULL;
+      tiz_thread_join (&threads[i], &p_result);
+    }
+
+  elapsed = lfqueue_now_secs () - start;
+  return elapsed > 0 ? total / elapsed : 0;
+}
+
+START_TEST (test_lfqueue_init_and_destroy)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  tiz_lfqueue_t * p_queue = NULL;
+
+  error = tiz_lfqueue_init (&p_queue, 10);
+
+  fail_if (error != OMX_ErrorNone);
+  /* Capacity is rounded up to a power of two */
+  fail_if (16 != tiz_lfqueue_capacity (p_queue));
+  fail_if (0 != tiz_lfqueue_length (p_queue));
+
+  tiz_lfqueue_destroy (p_queue);
+}
+END_TEST
+
+START_TEST (test_lfqueue_send_and_receive)
+{
+  OMX_U32 i;
+  OMX_PTR p_received = NULL;
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  int * p_item = NULL;
+  tiz_lfqueue_t * p_queue = NULL;
+
+  error = tiz_lfqueue_init (&p_queue, 16);
+
+  fail_if (error != OMX_ErrorNone);
+
+  for (i = 0; i < 16; i++)
+    {
+      p_item = (int *) tiz_mem_alloc (sizeof (int));
+      fail_if (p_item == NULL);
+      *p_item = i;
+      error = tiz_lfqueue_send (p_queue, p_item);
+      fail_if (error != OMX_ErrorNone);
+    }
+
+  fail_if (16 != tiz_lfqueue_length (p_queue));
+
+  for (i = 0; i < 16; i++)
+    {
+      error = tiz_lfqueue_receive (p_queue, &p_received);
+      fail_if (error != OMX_ErrorNone);
+      fail_if (p_received == NULL);
+      p_item = (int *) p_received;
+      fail_if (*p_item != i);
+      tiz_mem_free (p_received);
+    }
+
+  /* The queue is now empty, a timed receive must time out */
+  error = tiz_lfqueue_timed_receive (p_queue, &p_received, 10);
+  fail_if (error != OMX_ErrorTimeout);
+
+  tiz_lfqueue_destroy (p_queue);
+}
+END_TEST
+
+START_TEST (test_lfqueue_throughput)
+{
+  tiz_queue_t * p_queue = NULL;
+  tiz_lfqueue_t * p_lfqueue = NULL;
+  double queue_rate = 0;
+  double lfqueue_rate = 0;
+
+  fail_if (OMX_ErrorNone != tiz_queue_init (&p_queue, LFQUEUE_TEST_CAPACITY));
+  fail_if (OMX_ErrorNone
+           != tiz_lfqueue_init (&p_lfqueue, LFQUEUE_TEST_CAPACITY));
+
+  queue_rate = lfqueue_run_bench (p_queue, NULL);
+  lfqueue_rate = lfqueue_run_bench (NULL, p_lfqueue);
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "[%d] producers - tiz_queue [%.0f] msgs/sec - "
+           "tiz_lfqueue [%.0f] msgs/sec (x%.2f)",
+           LFQUEUE_TEST_PRODUCERS, queue_rate, lfqueue_rate,
+           queue_rate > 0 ? lfqueue_rate / queue_rate : 0);
+
+  tiz_queue_destroy (p_queue);
+  tiz_lfqueue_destroy (p_lfqueue);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
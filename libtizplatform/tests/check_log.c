@@ -0,0 +1,126 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_log.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Logging API unit tests and call overhead benchmark
+ *
+ *
+ */
+
+#include <time.h>
+#include <pthread.h>
+
+#define LOG_TEST_THREADS 4
+#define LOG_TEST_MSGS_PER_THREAD 20000
+
+static double
+log_now_secs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void *
+log_producer_thread (void * ap_arg)
+{
+  uintptr_t id = (uintptr_t) ap_arg;
+  int i = 0;
+  for (i = 0; i < LOG_TEST_MSGS_PER_THREAD; ++i)
+    {
+      /* A mix of conversions that are captured in binary form and some that
+         have to be formatted by the calling thread */
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "thread [%u] msg [%d] [%s] [%.*s] [%5.2f]",
+               (unsigned int) id, i, "string arg", 3, "precision", i / 3.0);
+      if (0 == (i % 1000))
+        {
+          int n = 0;
+          TIZ_LOG (TIZ_PRIORITY_TRACE, "thread [%1$u] %2$s%3$n",
+                   (unsigned int) id, "positional", &n);
+        }
+    }
+  return NULL;
+}
+
+START_TEST (test_log_concurrent_producers_and_flush)
+{
+  pthread_t threads[LOG_TEST_THREADS];
+  uintptr_t i = 0;
+
+  for (i = 0; i < LOG_TEST_THREADS; ++i)
+    {
+      fail_if (0 != pthread_create (&threads[i], NULL, log_producer_thread,
+                                    (void *) i));
+    }
+
+  for (i = 0; i < LOG_TEST_THREADS; ++i)
+    {
+      fail_if (0 != pthread_join (threads[i], NULL));
+    }
+
+  /* The producer threads are gone; their records must still be written out
+     and their rings released */
+  tiz_log_flush ();
+
+  TIZ_LOG (TIZ_PRIORITY_NOTICE, "[%d] threads logged [%d] messages each",
+           LOG_TEST_THREADS, LOG_TEST_MSGS_PER_THREAD);
+  tiz_log_flush ();
+}
+END_TEST
+
+START_TEST (test_log_call_overhead)
+{
+  const int count = LOG_TEST_MSGS_PER_THREAD;
+  double start = 0;
+  double enabled_ns = 0;
+  double disabled_ns = 0;
+  int i = 0;
+
+  start = log_now_secs ();
+  for (i = 0; i < count; ++i)
+    {
+      tiz_log (__FILE__, __LINE__, __FUNCTION__, "tiz.platform.check.disabled",
+               TIZ_PRIORITY_TRACE + 100, NULL, NULL, "disabled [%d]", i);
+    }
+  disabled_ns = (log_now_secs () - start) * 1e9 / count;
+
+  start = log_now_secs ();
+  for (i = 0; i < count; ++i)
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "enabled [%d] [%s] [%f]", i, "string arg",
+               i * 0.5);
+    }
+  enabled_ns = (log_now_secs () - start) * 1e9 / count;
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "tiz_log : disabled [%.0f] ns/call - enabled [%.0f] ns/call "
+           "(caller thread)",
+           disabled_ns, enabled_ns);
+  tiz_log_flush ();
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
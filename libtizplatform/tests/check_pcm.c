@@ -0,0 +1,357 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_pcm.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  PCM kernels unit tests and throughput benchmark
+ *
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+/* Longest buffer used in the comparisons; odd so that every implementation
+   also runs its scalar tail */
+#define PCM_TEST_MAX_SAMPLES 4099
+#define PCM_TEST_BENCH_SAMPLES (64 * 1024)
+#define PCM_TEST_BENCH_ROUNDS 200
+
+static uint32_t g_pcm_test_seed = 1;
+
+static uint32_t
+pcm_test_rand (void)
+{
+  g_pcm_test_seed = g_pcm_test_seed * 1103515245u + 12345u;
+  return g_pcm_test_seed;
+}
+
+static void
+pcm_test_fill_s16 (int16_t * ap_buf, const size_t a_len)
+{
+  size_t i = 0;
+  for (i = 0; i < a_len; ++i)
+    {
+      ap_buf[i] = (int16_t) (pcm_test_rand () >> 16);
+    }
+  /* Make sure the extremes are always exercised */
+  if (a_len > 2)
+    {
+      ap_buf[0] = INT16_MIN;
+      ap_buf[1] = INT16_MAX;
+    }
+}
+
+static void
+pcm_test_fill_float (float * ap_buf, const size_t a_len)
+{
+  size_t i = 0;
+  for (i = 0; i < a_len; ++i)
+    {
+      /* Roughly [-1.5, 1.5], so that some samples need clipping */
+      ap_buf[i] = ((int32_t) pcm_test_rand ()) / 1431655765.0f;
+    }
+  if (a_len > 6)
+    {
+      ap_buf[0] = 1.0f;
+      ap_buf[1] = -1.0f;
+      ap_buf[2] = 0.5f / 32768.0f; /* a tie */
+      ap_buf[3] = 1e30f;
+      ap_buf[4] = -1e30f;
+      ap_buf[5] = NAN;
+    }
+}
+
+static void
+pcm_test_fill_fixed (int32_t * ap_buf, const size_t a_len)
+{
+  size_t i = 0;
+  for (i = 0; i < a_len; ++i)
+    {
+      /* Fixed-point 4.28, up to +/- 8.0 */
+      ap_buf[i] = (int32_t) pcm_test_rand ();
+    }
+  if (a_len > 3)
+    {
+      ap_buf[0] = INT32_MIN;
+      ap_buf[1] = INT32_MAX;
+      ap_buf[2] = -(1 << 28);
+    }
+}
+
+/* Run one kernel on the same input with the scalar and the a_isa
+   implementations and compare the outputs */
+static bool
+pcm_test_compare (const tiz_pcm_isa_t a_isa, const size_t a_len,
+                  const size_t a_misalign, const int a_kernel)
+{
+  static int16_t in16[PCM_TEST_MAX_SAMPLES * 2 + 1];
+  static int16_t ref16[PCM_TEST_MAX_SAMPLES * 2 + 1];
+  static int16_t out16[PCM_TEST_MAX_SAMPLES * 2 + 1];
+  static int16_t ref16b[PCM_TEST_MAX_SAMPLES + 1];
+  static int16_t out16b[PCM_TEST_MAX_SAMPLES + 1];
+  static float inf[PCM_TEST_MAX_SAMPLES + 1];
+  static float reff[PCM_TEST_MAX_SAMPLES + 1];
+  static float outf[PCM_TEST_MAX_SAMPLES + 1];
+  static int32_t in32[PCM_TEST_MAX_SAMPLES + 1];
+  bool same = false;
+  int pass = 0;
+
+  pcm_test_fill_s16 (in16, PCM_TEST_MAX_SAMPLES * 2 + 1);
+  pcm_test_fill_float (inf, PCM_TEST_MAX_SAMPLES + 1);
+  pcm_test_fill_fixed (in32, PCM_TEST_MAX_SAMPLES + 1);
+
+  for (pass = 0; pass < 2; ++pass)
+    {
+      int16_t * p_out16 = (0 == pass ? ref16 : out16) + a_misalign;
+      int16_t * p_out16b = (0 == pass ? ref16b : out16b) + a_misalign;
+      float * p_outf = (0 == pass ? reff : outf) + a_misalign;
+      fail_if (OMX_ErrorNone
+               != tiz_pcm_set_isa (0 == pass ? ETIZPcmIsaScalar : a_isa));
+      switch (a_kernel)
+        {
+          case 0:
+            memcpy (p_out16, in16 + a_misalign, a_len * sizeof (int16_t));
+            tiz_pcm_s16_gain (p_out16, a_len, 3.1f);
+            break;
+          case 1:
+            tiz_pcm_s16_to_float (p_outf, in16 + a_misalign, a_len);
+            break;
+          case 2:
+            tiz_pcm_float_to_s16 (p_out16, inf + a_misalign, a_len);
+            break;
+          case 3:
+            memcpy (p_out16, in16 + a_misalign, a_len * sizeof (int16_t));
+            tiz_pcm_s16_bswap (p_out16, a_len);
+            break;
+          case 4:
+            {
+              const int16_t * planes[2]
+                = {in16 + a_misalign, in16 + PCM_TEST_MAX_SAMPLES};
+              tiz_pcm_s16_interleave (p_out16, planes, 2, a_len);
+            }
+            break;
+          case 5:
+            {
+              int16_t * planes[2] = {p_out16, p_out16b};
+              tiz_pcm_s16_deinterleave (planes, in16 + a_misalign, 2, a_len);
+            }
+            break;
+          case 6:
+            tiz_pcm_fixed_to_s16 (p_out16, in32 + a_misalign, a_len, 28);
+            break;
+          default:
+            assert (0);
+            break;
+        };
+    }
+
+  switch (a_kernel)
+    {
+      case 1:
+        same = (0 == memcmp (reff + a_misalign, outf + a_misalign,
+                             a_len * sizeof (float)));
+        break;
+      case 4:
+        same = (0 == memcmp (ref16 + a_misalign, out16 + a_misalign,
+                             a_len * 2 * sizeof (int16_t)));
+        break;
+      case 5:
+        same = (0 == memcmp (ref16 + a_misalign, out16 + a_misalign,
+                             a_len * sizeof (int16_t)))
+               && (0 == memcmp (ref16b + a_misalign, out16b + a_misalign,
+                                a_len * sizeof (int16_t)));
+        break;
+      default:
+        same = (0 == memcmp (ref16 + a_misalign, out16 + a_misalign,
+                             a_len * sizeof (int16_t)));
+        break;
+    };
+  return same;
+}
+
+static double
+pcm_test_now_secs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+START_TEST (test_pcm_scalar_reference)
+{
+  const tiz_pcm_isa_t isa = tiz_pcm_get_isa ();
+  const float in_f[] = {1.0f, -1.0f, 0.5f, 2.0f, -2.0f, 0.0f};
+  const int16_t expected_f[] = {32767, -32768, 16384, 32767, -32768, 0};
+  const int32_t in_fixed[] = {1 << 28, -(1 << 28), 1 << 27, -(1 << 27), 0};
+  const int16_t expected_fixed[] = {32767, -32768, 16384, -16384, 0};
+  const int16_t l[] = {1, 4}, c[] = {2, 5}, r[] = {3, 6};
+  const int16_t * planes[] = {l, c, r};
+  int16_t ilv[6];
+  int16_t out[6];
+  float outf[2];
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "test_pcm_scalar_reference");
+
+  fail_if (!tiz_pcm_isa_supported (ETIZPcmIsaScalar));
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (ETIZPcmIsaScalar));
+
+  tiz_pcm_float_to_s16 (out, in_f, 6);
+  fail_if (0 != memcmp (out, expected_f, sizeof (expected_f)));
+
+  tiz_pcm_fixed_to_s16 (out, in_fixed, 5, 28);
+  fail_if (0 != memcmp (out, expected_fixed, sizeof (expected_fixed)));
+
+  out[0] = 0x1234;
+  tiz_pcm_s16_bswap (out, 1);
+  fail_if (0x3412 != out[0]);
+
+  out[0] = 1000;
+  out[1] = -30000;
+  tiz_pcm_s16_gain (out, 2, 2.0f);
+  fail_if (2000 != out[0] || -32768 != out[1]);
+
+  out[0] = -32768;
+  out[1] = 16384;
+  tiz_pcm_s16_to_float (outf, out, 2);
+  fail_if (-1.0f != outf[0] || 0.5f != outf[1]);
+
+  tiz_pcm_s16_interleave (ilv, planes, 3, 2);
+  fail_if (1 != ilv[0] || 2 != ilv[1] || 3 != ilv[2] || 4 != ilv[3]
+           || 5 != ilv[4] || 6 != ilv[5]);
+
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (isa));
+}
+END_TEST
+
+START_TEST (test_pcm_simd_matches_scalar)
+{
+  const tiz_pcm_isa_t isa = tiz_pcm_get_isa ();
+  int i = 0;
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "test_pcm_simd_matches_scalar");
+
+  for (i = ETIZPcmIsaScalar + 1; i < ETIZPcmIsaMax; ++i)
+    {
+      int kernel = 0;
+      if (!tiz_pcm_isa_supported (i))
+        {
+          TIZ_LOG (TIZ_PRIORITY_TRACE, "pcm: [%s] not available",
+                   tiz_pcm_isa_to_str (i));
+          continue;
+        }
+      for (kernel = 0; kernel < 7; ++kernel)
+        {
+          size_t len = 0;
+          for (len = 0; len <= PCM_TEST_MAX_SAMPLES;
+               len += (len < 70 ? 1 : 1009))
+            {
+              fail_if (!pcm_test_compare (i, len, 0, kernel));
+              fail_if (!pcm_test_compare (i, len, 1, kernel));
+            }
+        }
+    }
+
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (isa));
+}
+END_TEST
+
+START_TEST (test_pcm_throughput)
+{
+  const tiz_pcm_isa_t isa = tiz_pcm_get_isa ();
+  int16_t * p_s16 = NULL;
+  int16_t * p_left = NULL;
+  int16_t * p_right = NULL;
+  float * p_float = NULL;
+  int32_t * p_fixed = NULL;
+  double scalar_rate = 0;
+  int i = 0;
+
+  p_s16 = tiz_mem_alloc (PCM_TEST_BENCH_SAMPLES * sizeof (int16_t));
+  p_left = tiz_mem_alloc (PCM_TEST_BENCH_SAMPLES / 2 * sizeof (int16_t));
+  p_right = tiz_mem_alloc (PCM_TEST_BENCH_SAMPLES / 2 * sizeof (int16_t));
+  p_float = tiz_mem_alloc (PCM_TEST_BENCH_SAMPLES * sizeof (float));
+  p_fixed = tiz_mem_alloc (PCM_TEST_BENCH_SAMPLES * sizeof (int32_t));
+  fail_if (!p_s16 || !p_left || !p_right || !p_float || !p_fixed);
+
+  pcm_test_fill_s16 (p_s16, PCM_TEST_BENCH_SAMPLES);
+  pcm_test_fill_fixed (p_fixed, PCM_TEST_BENCH_SAMPLES);
+
+  for (i = ETIZPcmIsaScalar; i < ETIZPcmIsaMax; ++i)
+    {
+      double start = 0;
+      double elapsed = 0;
+      double rate = 0;
+      int round = 0;
+      if (!tiz_pcm_isa_supported (i))
+        {
+          continue;
+        }
+      fail_if (OMX_ErrorNone != tiz_pcm_set_isa (i));
+
+      /* One pass of every kernel, roughly what a decoder and a renderer do
+         to each sample */
+      start = pcm_test_now_secs ();
+      for (round = 0; round < PCM_TEST_BENCH_ROUNDS; ++round)
+        {
+          int16_t * planes[2] = {p_left, p_right};
+          tiz_pcm_fixed_to_s16 (p_s16, p_fixed, PCM_TEST_BENCH_SAMPLES, 28);
+          tiz_pcm_s16_deinterleave (planes, p_s16, 2,
+                                    PCM_TEST_BENCH_SAMPLES / 2);
+          tiz_pcm_s16_interleave (p_s16, (const int16_t * const *) planes, 2,
+                                  PCM_TEST_BENCH_SAMPLES / 2);
+          tiz_pcm_s16_to_float (p_float, p_s16, PCM_TEST_BENCH_SAMPLES);
+          tiz_pcm_float_to_s16 (p_s16, p_float, PCM_TEST_BENCH_SAMPLES);
+          tiz_pcm_s16_gain (p_s16, PCM_TEST_BENCH_SAMPLES, 0.7f);
+          tiz_pcm_s16_bswap (p_s16, PCM_TEST_BENCH_SAMPLES);
+        }
+      elapsed = pcm_test_now_secs () - start;
+      rate = elapsed > 0
+               ? (double) PCM_TEST_BENCH_SAMPLES * PCM_TEST_BENCH_ROUNDS
+                   / elapsed / 1e6
+               : 0;
+      if (ETIZPcmIsaScalar == i)
+        {
+          scalar_rate = rate;
+        }
+
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "tiz_pcm [%s] [%.1f] Msamples/sec (x%.2f)",
+               tiz_pcm_isa_to_str (i), rate,
+               scalar_rate > 0 ? rate / scalar_rate : 0);
+    }
+
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (isa));
+
+  tiz_mem_free (p_s16);
+  tiz_mem_free (p_left);
+  tiz_mem_free (p_right);
+  tiz_mem_free (p_float);
+  tiz_mem_free (p_fixed);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
@@ -26,6 +26,14 @@
  *
  */
 
+#include <time.h>
+
+/* Same number of priority groups as a servant's queue */
+#define PQUEUE_TEST_GROUPS 5
+#define PQUEUE_BENCH_QUEUED 256
+#define PQUEUE_BENCH_MSGS 2000000
+#define PQUEUE_BENCH_REMOVALS 20000
+
 static void
 pqueue_dump_item (const char *ap_str, OMX_PTR ap_data, OMX_S32 a_priority,
                   OMX_PTR ap_cur, OMX_PTR ap_next, OMX_PTR ap_prev)
@@ -452,6 +460,238 @@ START_TEST (test_pqueue_removep)
 }
 END_TEST
 
+typedef struct pqueue_test_item pqueue_test_item_t;
+struct pqueue_test_item
+{
+  int value;
+  /* Stands for the buffer header a servant message refers to */
+  void * p_key;
+};
+
+static OMX_BOOL
+pqueue_match_value (OMX_PTR ap_elem, OMX_S32 a_data1, OMX_PTR ap_data2)
+{
+  const pqueue_test_item_t * p_item = ap_elem;
+  return (p_item->value % 2 == a_data1) ? OMX_TRUE : OMX_FALSE;
+}
+
+static OMX_BOOL
+pqueue_match_key (OMX_PTR ap_elem, OMX_S32 a_data1, OMX_PTR ap_data2)
+{
+  const pqueue_test_item_t * p_item = ap_elem;
+  return (p_item->p_key == ap_data2) ? OMX_TRUE : OMX_FALSE;
+}
+
+static double
+pqueue_now_secs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+START_TEST (test_pqueue_send_and_receive_interleaved_groups)
+{
+  pqueue_test_item_t items[PQUEUE_TEST_GROUPS * 4];
+  tiz_pqueue_t * p_queue = NULL;
+  OMX_PTR p_received = NULL;
+  int last[PQUEUE_TEST_GROUPS];
+  int prev_prio = 0;
+  int i = 0;
+
+  fail_if (OMX_ErrorBadParameter
+           != tiz_pqueue_init (&p_queue, TIZ_PQUEUE_MAX_PRIORITIES,
+                               &pqueue_cmp, NULL, "tizkrn"));
+
+  fail_if (OMX_ErrorNone != tiz_pqueue_init (&p_queue, PQUEUE_TEST_GROUPS - 1,
+                                             &pqueue_cmp, NULL, "tizkrn"));
+
+  /* Groups are visited in a scattered order, so that every send lands in
+     between non-empty groups */
+  for (i = 0; i < PQUEUE_TEST_GROUPS * 4; i++)
+    {
+      items[i].value = i;
+      items[i].p_key = NULL;
+      fail_if (OMX_ErrorNone
+               != tiz_pqueue_send (p_queue, &items[i],
+                                   (i * 3) % PQUEUE_TEST_GROUPS));
+    }
+
+  fail_if (PQUEUE_TEST_GROUPS * 4 != tiz_pqueue_length (p_queue));
+  fail_if (PQUEUE_TEST_GROUPS * 4
+           != tiz_pqueue_dump (p_queue, &pqueue_dump_item));
+
+  for (i = 0; i < PQUEUE_TEST_GROUPS; i++)
+    {
+      last[i] = -1;
+    }
+
+  /* Priority order across groups, FIFO order within each group */
+  for (i = 0; i < PQUEUE_TEST_GROUPS * 4; i++)
+    {
+      pqueue_test_item_t * p_item = NULL;
+      int prio = 0;
+      fail_if (OMX_ErrorNone != tiz_pqueue_first (p_queue, &p_received));
+      p_item = p_received;
+      fail_if (OMX_ErrorNone != tiz_pqueue_receive (p_queue, &p_received));
+      fail_if (p_item != p_received);
+      prio = (p_item->value * 3) % PQUEUE_TEST_GROUPS;
+      fail_if (prio < prev_prio);
+      fail_if (p_item->value <= last[prio]);
+      last[prio] = p_item->value;
+      prev_prio = prio;
+    }
+
+  fail_if (OMX_ErrorNoMore != tiz_pqueue_receive (p_queue, &p_received));
+  tiz_pqueue_destroy (p_queue);
+}
+END_TEST
+
+START_TEST (test_pqueue_remove_func_keyed)
+{
+  pqueue_test_item_t items[PQUEUE_TEST_GROUPS * 4];
+  int keys[2];
+  tiz_pqueue_t * p_queue = NULL;
+  OMX_PTR p_received = NULL;
+  int i = 0;
+
+  fail_if (OMX_ErrorNone != tiz_pqueue_init (&p_queue, PQUEUE_TEST_GROUPS - 1,
+                                             &pqueue_cmp, NULL, "tizprc"));
+
+  /* Even items are keyed with keys[0], odd items with keys[1]; the first
+     four items are not indexed */
+  for (i = 0; i < PQUEUE_TEST_GROUPS * 4; i++)
+    {
+      items[i].value = i;
+      items[i].p_key = i < 4 ? NULL : &keys[i % 2];
+      fail_if (OMX_ErrorNone
+               != tiz_pqueue_send_keyed (p_queue, &items[i],
+                                         i % PQUEUE_TEST_GROUPS,
+                                         items[i].p_key));
+    }
+
+  /* Only the indexed items are visited */
+  fail_if ((PQUEUE_TEST_GROUPS * 4 - 4) / 2
+           != tiz_pqueue_remove_func_keyed (p_queue, &keys[0],
+                                            &pqueue_match_key, 0, &keys[0]));
+  fail_if (0 != tiz_pqueue_remove_func_keyed (p_queue, &keys[0],
+                                              &pqueue_match_key, 0,
+                                              &keys[0]));
+  fail_if (PQUEUE_TEST_GROUPS * 4 - (PQUEUE_TEST_GROUPS * 4 - 4) / 2
+           != tiz_pqueue_length (p_queue));
+
+  /* The unkeyed removal path still sees every item */
+  fail_if (2 != tiz_pqueue_remove_func (p_queue, &pqueue_match_value, 0,
+                                        &keys[0]));
+
+  /* Only the odd items are left, in the right order */
+  i = 0;
+  while (OMX_ErrorNone == tiz_pqueue_receive (p_queue, &p_received))
+    {
+      pqueue_test_item_t * p_item = p_received;
+      fail_if (1 != p_item->value % 2);
+      ++i;
+    }
+  fail_if (PQUEUE_TEST_GROUPS * 2 != i);
+
+  tiz_pqueue_destroy (p_queue);
+}
+END_TEST
+
+START_TEST (test_pqueue_benchmark)
+{
+  pqueue_test_item_t * p_items = NULL;
+  tiz_pqueue_t * p_queue = NULL;
+  tiz_soa_t * p_soa = NULL;
+  OMX_PTR p_received = NULL;
+  double start = 0;
+  double send_receive_secs = 0;
+  double scan_secs = 0;
+  double keyed_secs = 0;
+  int i = 0;
+
+  p_items = tiz_mem_calloc (PQUEUE_BENCH_QUEUED, sizeof (pqueue_test_item_t));
+  fail_if (NULL == p_items);
+  for (i = 0; i < PQUEUE_BENCH_QUEUED; i++)
+    {
+      p_items[i].value = i;
+      p_items[i].p_key = &p_items[i];
+    }
+
+  /* Same set-up as a servant's queue */
+  fail_if (OMX_ErrorNone != tiz_soa_init (&p_soa));
+  fail_if (OMX_ErrorNone != tiz_pqueue_init (&p_queue, PQUEUE_TEST_GROUPS - 1,
+                                             &pqueue_cmp, p_soa, "tizbench"));
+
+  for (i = 0; i < PQUEUE_BENCH_QUEUED; i++)
+    {
+      fail_if (OMX_ErrorNone
+               != tiz_pqueue_send_keyed (p_queue, &p_items[i],
+                                         i % PQUEUE_TEST_GROUPS,
+                                         p_items[i].p_key));
+    }
+
+  /* Steady-state dispatch: receive one message, send another one */
+  start = pqueue_now_secs ();
+  for (i = 0; i < PQUEUE_BENCH_MSGS; i++)
+    {
+      pqueue_test_item_t * p_item = NULL;
+      fail_if (OMX_ErrorNone != tiz_pqueue_receive (p_queue, &p_received));
+      p_item = p_received;
+      fail_if (OMX_ErrorNone
+               != tiz_pqueue_send_keyed (p_queue, p_item,
+                                         (i * 3) % PQUEUE_TEST_GROUPS,
+                                         p_item->p_key));
+    }
+  send_receive_secs = pqueue_now_secs () - start;
+
+  /* Removal of a single header's message, e.g. on a port flush: full scan */
+  start = pqueue_now_secs ();
+  for (i = 0; i < PQUEUE_BENCH_REMOVALS; i++)
+    {
+      pqueue_test_item_t * p_item = &p_items[i % PQUEUE_BENCH_QUEUED];
+      fail_if (1 != tiz_pqueue_remove_func (p_queue, &pqueue_match_key, 0,
+                                            p_item->p_key));
+      fail_if (OMX_ErrorNone
+               != tiz_pqueue_send_keyed (p_queue, p_item,
+                                         i % PQUEUE_TEST_GROUPS,
+                                         p_item->p_key));
+    }
+  scan_secs = pqueue_now_secs () - start;
+
+  /* Same removals, through the key index */
+  start = pqueue_now_secs ();
+  for (i = 0; i < PQUEUE_BENCH_REMOVALS; i++)
+    {
+      pqueue_test_item_t * p_item = &p_items[i % PQUEUE_BENCH_QUEUED];
+      fail_if (1 != tiz_pqueue_remove_func_keyed (p_queue, p_item->p_key,
+                                                  &pqueue_match_key, 0,
+                                                  p_item->p_key));
+      fail_if (OMX_ErrorNone
+               != tiz_pqueue_send_keyed (p_queue, p_item,
+                                         i % PQUEUE_TEST_GROUPS,
+                                         p_item->p_key));
+    }
+  keyed_secs = pqueue_now_secs () - start;
+
+  fail_if (PQUEUE_BENCH_QUEUED != tiz_pqueue_length (p_queue));
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "tiz_pqueue : [%d] queued, send+receive [%.1f] ns, "
+           "remove (scan) [%.1f] ns, remove (keyed) [%.1f] ns",
+           PQUEUE_BENCH_QUEUED, send_receive_secs * 1e9 / PQUEUE_BENCH_MSGS,
+           scan_secs * 1e9 / PQUEUE_BENCH_REMOVALS,
+           keyed_secs * 1e9 / PQUEUE_BENCH_REMOVALS);
+
+  while (OMX_ErrorNone == tiz_pqueue_receive (p_queue, &p_received))
+    {
+    }
+  tiz_pqueue_destroy (p_queue);
+  tiz_soa_destroy (p_soa);
+  tiz_mem_free (p_items);
+}
+END_TEST
+
 /* Local Variables: */
 /* c-default-style: gnu */
 /* fill-column: 79 */
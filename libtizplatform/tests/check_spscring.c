@@ -0,0 +1,217 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_spscring.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  SPSC byte ring unit tests
+ *
+ *
+ */
+
+#include <sched.h>
+
+#define SPSCRING_TEST_CAPACITY (16 * 1024)
+#define SPSCRING_TEST_CHUNKS 200000
+#define SPSCRING_TEST_MAX_CHUNK 1500
+
+typedef struct spscring_test_producer spscring_test_producer_t;
+struct spscring_test_producer
+{
+  tiz_spscring_t * p_ring;
+  tiz_sem_t wakeup;
+  int writes;
+  int wakeups;
+};
+
+static void *
+spscring_producer_thread (void * ap_arg)
+{
+  spscring_test_producer_t * p_prod = ap_arg;
+  uint8_t chunk[SPSCRING_TEST_MAX_CHUNK];
+  uint8_t next = 0;
+  int i = 0;
+
+  for (i = 0; i < SPSCRING_TEST_CHUNKS; ++i)
+    {
+      /* Chunks of varying sizes, so that they often straddle the end of the
+         ring */
+      const size_t len = 1 + ((size_t) i * 7919) % SPSCRING_TEST_MAX_CHUNK;
+      bool wakeup = false;
+      size_t j = 0;
+      for (j = 0; j < len; ++j)
+        {
+          chunk[j] = next++;
+        }
+      while (0 == tiz_spscring_write (p_prod->p_ring, chunk, len, &wakeup))
+        {
+          /* Full; this is what a real producer would report as backpressure */
+          sched_yield ();
+        }
+      ++p_prod->writes;
+      if (wakeup)
+        {
+          ++p_prod->wakeups;
+          tiz_sem_post (&(p_prod->wakeup));
+        }
+    }
+
+  /* One last notification to make the consumer notice the end of the run */
+  tiz_sem_post (&(p_prod->wakeup));
+  return NULL;
+}
+
+START_TEST (test_spscring_init_and_destroy)
+{
+  tiz_spscring_t * p_ring = NULL;
+
+  fail_if (OMX_ErrorNone != tiz_spscring_init (&p_ring, 1000));
+  /* Capacity is rounded up to a power of two */
+  fail_if (1024 != tiz_spscring_capacity (p_ring));
+  fail_if (0 != tiz_spscring_available (p_ring));
+  fail_if (1024 != tiz_spscring_space (p_ring));
+  fail_if (tiz_spscring_ack_wakeup (p_ring));
+
+  tiz_spscring_destroy (p_ring);
+}
+END_TEST
+
+START_TEST (test_spscring_write_and_read)
+{
+  tiz_spscring_t * p_ring = NULL;
+  uint8_t in[48];
+  uint8_t out[48];
+  const void * p_chunk = NULL;
+  bool wakeup = false;
+  size_t i = 0;
+
+  for (i = 0; i < sizeof (in); ++i)
+    {
+      in[i] = (uint8_t) i;
+    }
+
+  fail_if (OMX_ErrorNone != tiz_spscring_init (&p_ring, 64));
+
+  /* The first write requests a notification, the next ones are coalesced */
+  fail_if (40 != tiz_spscring_write (p_ring, in, 40, &wakeup));
+  fail_if (!wakeup);
+  fail_if (20 != tiz_spscring_write (p_ring, in, 20, &wakeup));
+  fail_if (wakeup);
+
+  /* Writes are all-or-nothing */
+  fail_if (0 != tiz_spscring_write (p_ring, in, 8, &wakeup));
+  fail_if (wakeup);
+  fail_if (4 != tiz_spscring_space (p_ring));
+
+  fail_if (!tiz_spscring_ack_wakeup (p_ring));
+  fail_if (tiz_spscring_ack_wakeup (p_ring));
+
+  fail_if (40 != tiz_spscring_read (p_ring, out, 40));
+  fail_if (0 != memcmp (in, out, 40));
+
+  /* This write wraps around the end of the storage */
+  fail_if (30 != tiz_spscring_write (p_ring, in, 30, &wakeup));
+  fail_if (!wakeup);
+  fail_if (50 != tiz_spscring_available (p_ring));
+
+  /* peek only returns the contiguous part */
+  fail_if (24 != tiz_spscring_peek (p_ring, &p_chunk));
+  fail_if (0 != memcmp (p_chunk, in, 20));
+  fail_if (0 != memcmp ((const uint8_t *) p_chunk + 20, in, 4));
+  tiz_spscring_advance (p_ring, 24);
+
+  fail_if (26 != tiz_spscring_read (p_ring, out, sizeof (out)));
+  fail_if (0 != memcmp (out, in + 4, 26));
+
+  fail_if (30 != tiz_spscring_write (p_ring, in, 30, NULL));
+  tiz_spscring_clear (p_ring);
+  fail_if (0 != tiz_spscring_available (p_ring));
+  fail_if (64 != tiz_spscring_space (p_ring));
+
+  tiz_spscring_destroy (p_ring);
+}
+END_TEST
+
+START_TEST (test_spscring_producer_thread)
+{
+  spscring_test_producer_t prod;
+  tiz_thread_t thread;
+  uint8_t buf[4096];
+  uint8_t expected = 0;
+  size_t total = 0;
+  size_t nbytes = 0;
+  size_t i = 0;
+  int notifications = 0;
+  OMX_PTR p_result = NULL;
+
+  for (i = 0; i < SPSCRING_TEST_CHUNKS; ++i)
+    {
+      total += 1 + (i * 7919) % SPSCRING_TEST_MAX_CHUNK;
+    }
+
+  tiz_mem_set (&prod, 0, sizeof (prod));
+  fail_if (OMX_ErrorNone
+           != tiz_spscring_init (&prod.p_ring, SPSCRING_TEST_CAPACITY));
+  fail_if (OMX_ErrorNone != tiz_sem_init (&prod.wakeup, 0));
+  fail_if (OMX_ErrorNone != tiz_thread_create (&thread, 0, 0,
+                                               spscring_producer_thread,
+                                               &prod));
+
+  while (nbytes < total)
+    {
+      size_t n = 0;
+      /* Sleep until the producer asks for attention, as a component's
+         servant would do with a pluggable event */
+      fail_if (OMX_ErrorNone != tiz_sem_wait (&prod.wakeup));
+      ++notifications;
+      (void) tiz_spscring_ack_wakeup (prod.p_ring);
+      while ((n = tiz_spscring_read (prod.p_ring, buf, sizeof (buf))) > 0)
+        {
+          for (i = 0; i < n; ++i)
+            {
+              fail_if (buf[i] != expected);
+              ++expected;
+            }
+          nbytes += n;
+        }
+    }
+
+  tiz_thread_join (&thread, &p_result);
+
+  fail_if (nbytes != total);
+  fail_if (SPSCRING_TEST_CHUNKS != prod.writes);
+  /* Notifications are coalesced */
+  fail_if (prod.wakeups > prod.writes);
+  fail_if (notifications > prod.wakeups + 1);
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "tiz_spscring : [%d] writes, [%d] wakeups",
+           prod.writes, prod.wakeups);
+
+  tiz_sem_destroy (&prod.wakeup);
+  tiz_spscring_destroy (prod.p_ring);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
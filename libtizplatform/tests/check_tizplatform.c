@@ -44,6 +44,8 @@
 #include "./check_sem.c"
 #include "./check_mutex.c"
 #include "./check_queue.c"
+#include "./check_lfqueue.c"
+#include "./check_spscring.c"
 #include "./check_pqueue.c"
 #include "./check_vector.c"
 #include "./check_rc.c"
@@ -51,8 +53,16 @@
 #include "./check_event.c"
 #include "./check_http_parser.c"
 #include "./check_map.c"
+#include "./check_buffer.c"
+#include "./check_pcm.c"
+#include "./check_log.c"
 
 #define EVENT_API_TEST_TIMEOUT 100
+#define LFQUEUE_BENCH_TEST_TIMEOUT 100
+#define SPSCRING_TEST_TIMEOUT 100
+#define PQUEUE_BENCH_TEST_TIMEOUT 100
+#define PCM_BENCH_TEST_TIMEOUT 100
+#define LOG_TEST_TIMEOUT 100
 
 Suite *
 platform_mem_suite (void)
@@ -108,6 +118,40 @@ platform_queue_suite (void)
   return s;
 }
 
+Suite *
+platform_lfqueue_suite (void)
+{
+  TCase *tc_lfqueue = NULL;
+  Suite *s = suite_create ("Lock-free FIFO queue");
+
+  /* lock-free queue API test case */
+  tc_lfqueue = tcase_create ("lfqueue");
+  tcase_set_timeout (tc_lfqueue, LFQUEUE_BENCH_TEST_TIMEOUT);
+  tcase_add_test (tc_lfqueue, test_lfqueue_init_and_destroy);
+  tcase_add_test (tc_lfqueue, test_lfqueue_send_and_receive);
+  tcase_add_test (tc_lfqueue, test_lfqueue_throughput);
+  suite_add_tcase (s, tc_lfqueue);
+
+  return s;
+}
+
+Suite *
+platform_spscring_suite (void)
+{
+  TCase *tc_spscring = NULL;
+  Suite *s = suite_create ("SPSC byte ring");
+
+  /* SPSC ring API test cases */
+  tc_spscring = tcase_create ("spscring");
+  tcase_set_timeout (tc_spscring, SPSCRING_TEST_TIMEOUT);
+  tcase_add_test (tc_spscring, test_spscring_init_and_destroy);
+  tcase_add_test (tc_spscring, test_spscring_write_and_read);
+  tcase_add_test (tc_spscring, test_spscring_producer_thread);
+  suite_add_tcase (s, tc_spscring);
+
+  return s;
+}
+
 Suite *
 platform_pqueue_suite (void)
 {
@@ -116,6 +160,7 @@ platform_pqueue_suite (void)
 
   /* pqueue API test case */
   tc_pqueue = tcase_create ("priority queue");
+  tcase_set_timeout (tc_pqueue, PQUEUE_BENCH_TEST_TIMEOUT);
   tcase_add_test (tc_pqueue, test_pqueue_init_and_destroy);
   tcase_add_test (tc_pqueue, test_pqueue_send_and_receive_one_group);
   tcase_add_test (tc_pqueue, test_pqueue_send_and_receive_two_groups);
@@ -123,6 +168,9 @@ platform_pqueue_suite (void)
   tcase_add_test (tc_pqueue, test_pqueue_first);
   tcase_add_test (tc_pqueue, test_pqueue_remove);
   tcase_add_test (tc_pqueue, test_pqueue_removep);
+  tcase_add_test (tc_pqueue, test_pqueue_send_and_receive_interleaved_groups);
+  tcase_add_test (tc_pqueue, test_pqueue_remove_func_keyed);
+  tcase_add_test (tc_pqueue, test_pqueue_benchmark);
   suite_add_tcase (s, tc_pqueue);
 
   return s;
@@ -227,6 +275,54 @@ platform_map_suite (void)
 
 }
 
+Suite *
+platform_buffer_suite (void)
+{
+  TCase *tc_buffer = NULL;
+  Suite *s = suite_create ("Data buffer APIs");
+
+  /* buffer API test cases */
+  tc_buffer = tcase_create ("buffer");
+  tcase_add_test (tc_buffer, test_buffer_push_get_advance);
+  tcase_add_test (tc_buffer, test_buffer_ring_wrap_around);
+  suite_add_tcase (s, tc_buffer);
+
+  return s;
+}
+
+Suite *
+platform_pcm_suite (void)
+{
+  TCase *tc_pcm = NULL;
+  Suite *s = suite_create ("PCM kernels");
+
+  /* PCM kernels test cases */
+  tc_pcm = tcase_create ("pcm");
+  tcase_set_timeout (tc_pcm, PCM_BENCH_TEST_TIMEOUT);
+  tcase_add_test (tc_pcm, test_pcm_scalar_reference);
+  tcase_add_test (tc_pcm, test_pcm_simd_matches_scalar);
+  tcase_add_test (tc_pcm, test_pcm_throughput);
+  suite_add_tcase (s, tc_pcm);
+
+  return s;
+}
+
+Suite *
+platform_log_suite (void)
+{
+  TCase *tc_log = NULL;
+  Suite *s = suite_create ("Logging");
+
+  /* logging API test cases */
+  tc_log = tcase_create ("log");
+  tcase_set_timeout (tc_log, LOG_TEST_TIMEOUT);
+  tcase_add_test (tc_log, test_log_concurrent_producers_and_flush);
+  tcase_add_test (tc_log, test_log_call_overhead);
+  suite_add_tcase (s, tc_log);
+
+  return s;
+}
+
 int
 main (void)
 {
@@ -240,12 +336,17 @@ main (void)
   sr = srunner_create (platform_mem_suite ());
   srunner_add_suite (sr, platform_sync_suite ());
   srunner_add_suite (sr, platform_queue_suite ());
+  srunner_add_suite (sr, platform_lfqueue_suite ());
+  srunner_add_suite (sr, platform_spscring_suite ());
   srunner_add_suite (sr, platform_pqueue_suite ());
   srunner_add_suite (sr, platform_vector_suite ());
   srunner_add_suite (sr, platform_rcfile_suite ());
   srunner_add_suite (sr, platform_soa_suite ());
   srunner_add_suite (sr, platform_http_parser_suite ());
   srunner_add_suite (sr, platform_map_suite ());
+  srunner_add_suite (sr, platform_buffer_suite ());
+  srunner_add_suite (sr, platform_pcm_suite ());
+  srunner_add_suite (sr, platform_log_suite ());
 /*   srunner_add_suite (sr, platform_event_suite ()); */
   srunner_run_all (sr, CK_VERBOSE);
   number_failed = srunner_ntests_failed (sr);
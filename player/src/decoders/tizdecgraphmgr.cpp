@@ -34,6 +34,7 @@
 #include <tizplatform.h>
 
 #include "tizgraphmgrcaps.hpp"
+#include "tizgraphutil.hpp"
 #include "tizdecgraphmgr.hpp"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
@@ -93,3 +94,8 @@ graphmgr::decodemgrops::decodemgrops (mgr *p_mgr,
   : tiz::graphmgr::ops (p_mgr, playlist, termination_cback)
 {
 }
+
+bool graphmgr::decodemgrops::is_prewarming_enabled () const
+{
+  return tiz::graph::util::is_graph_prewarming_enabled ();
+}
@@ -62,6 +62,9 @@ namespace tiz
     public:
       decodemgrops (mgr *p_mgr, const tizplaylist_ptr_t &playlist,
                     const termination_callback_t &termination_cback);
+
+    protected:
+      bool is_prewarming_enabled () const;
     };
   }  // namespace graphmgr
 }  // namespace tiz
@@ -94,6 +94,10 @@ graph::graph::graph (const std::string &graph_name)
     thread_ (0),
     mutex_ (),
     sem_ (),
+    settled_sem_ (),
+    prepared_ (false),
+    unloaded_ (false),
+    failed_ (false),
     p_queue_ (NULL),
     p_ev_timer_ (NULL),
     p_progress_(NULL)
@@ -160,6 +164,59 @@ graph::graph::execute (const tizgraphconfig_ptr_t config)
   return post_cmd (new tiz::graph::cmd (tiz::graph::execute_evt (config)));
 }
 
+/**
+ * Take a loaded graph to OMX_StateIdle using @a config, without starting
+ * playback. The graph stays there until execute() (a plain Idle->Executing
+ * transition) or unload() is called.
+ */
+OMX_ERRORTYPE
+graph::graph::prepare (const tizgraphconfig_ptr_t config)
+{
+  return post_cmd (new tiz::graph::cmd (tiz::graph::prepare_evt (config)));
+}
+
+/**
+ * Block until a graph that was asked to prepare() has either reached
+ * OMX_StateIdle (returns true), or has been torn down or failed to load or
+ * prepare (returns false).
+ */
+bool graph::graph::wait_prepared ()
+{
+  bool prepared = false;
+  bool settled = false;
+  while (!settled)
+  {
+    static_cast< void >(tiz_mutex_lock (&mutex_));
+    prepared = prepared_;
+    settled = prepared_ || unloaded_ || failed_;
+    static_cast< void >(tiz_mutex_unlock (&mutex_));
+    if (!settled)
+    {
+      static_cast< void >(tiz_sem_wait (&settled_sem_));
+    }
+  }
+  return prepared;
+}
+
+/**
+ * Block until the graph's components have been destroyed, or until the graph
+ * has failed and will not make any further progress.
+ */
+void graph::graph::wait_unloaded ()
+{
+  bool unloaded = false;
+  while (!unloaded)
+  {
+    static_cast< void >(tiz_mutex_lock (&mutex_));
+    unloaded = unloaded_ || failed_;
+    static_cast< void >(tiz_mutex_unlock (&mutex_));
+    if (!unloaded)
+    {
+      static_cast< void >(tiz_sem_wait (&settled_sem_));
+    }
+  }
+}
+
 OMX_ERRORTYPE
 graph::graph::pause ()
 {
@@ -316,6 +373,22 @@ void graph::graph::graph_execd ()
   }
 }
 
+void graph::graph::graph_prepared ()
+{
+  static_cast< void >(tiz_mutex_lock (&mutex_));
+  prepared_ = true;
+  static_cast< void >(tiz_mutex_unlock (&mutex_));
+  static_cast< void >(tiz_sem_post (&settled_sem_));
+}
+
+void graph::graph::graph_failed ()
+{
+  static_cast< void >(tiz_mutex_lock (&mutex_));
+  failed_ = true;
+  static_cast< void >(tiz_mutex_unlock (&mutex_));
+  static_cast< void >(tiz_sem_post (&settled_sem_));
+}
+
 void graph::graph::graph_stopped ()
 {
   if (p_mgr_)
@@ -358,6 +431,12 @@ void graph::graph::graph_volume (const int volume)
 
 void graph::graph::graph_unloaded ()
 {
+  static_cast< void >(tiz_mutex_lock (&mutex_));
+  prepared_ = false;
+  unloaded_ = true;
+  static_cast< void >(tiz_mutex_unlock (&mutex_));
+  static_cast< void >(tiz_sem_post (&settled_sem_));
+
   if (p_mgr_)
   {
     p_mgr_->graph_unloaded ();
@@ -375,6 +454,8 @@ void graph::graph::graph_end_of_play ()
 void graph::graph::graph_error (const OMX_ERRORTYPE error,
                                 const std::string &msg)
 {
+  // Release anyone waiting on a pre-warmed graph; it will not get any further.
+  graph_failed ();
   if (p_mgr_)
   {
     p_mgr_->graph_error (error, msg);
@@ -450,6 +531,7 @@ graph::graph::init_cmd_queue ()
 {
   tiz_check_omx_ret_oom (tiz_mutex_init (&mutex_));
   tiz_check_omx_ret_oom (tiz_sem_init (&sem_, 0));
+  tiz_check_omx_ret_oom (tiz_sem_init (&settled_sem_, 0));
   tiz_check_omx_ret_oom (tiz_queue_init (&p_queue_, TIZ_GRAPH_QUEUE_MAX_ITEMS));
   tiz_check_omx_ret_oom (tiz_event_timer_init (
       &p_ev_timer_, this, tiz::graph::graph::timer_cback, NULL));
@@ -460,6 +542,7 @@ void graph::graph::deinit_cmd_queue ()
 {
   tiz_mutex_destroy (&mutex_);
   tiz_sem_destroy (&sem_);
+  tiz_sem_destroy (&settled_sem_);
   tiz_queue_destroy (p_queue_);
   p_queue_ = NULL;
 }
@@ -73,6 +73,9 @@ namespace tiz
                           = tizgraphconfig_ptr_t ());
       OMX_ERRORTYPE execute (const tizgraphconfig_ptr_t config
                              = tizgraphconfig_ptr_t ());
+      OMX_ERRORTYPE prepare (const tizgraphconfig_ptr_t config);
+      bool wait_prepared ();
+      void wait_unloaded ();
       OMX_ERRORTYPE pause ();
       OMX_ERRORTYPE seek ();
       OMX_ERRORTYPE skip (const int jump);
@@ -96,6 +99,8 @@ namespace tiz
     protected:
       void graph_loaded ();
       void graph_execd ();
+      void graph_prepared ();
+      void graph_failed ();
       void graph_stopped ();
       void graph_paused ();
       void graph_resumed ();
@@ -128,6 +133,10 @@ namespace tiz
       tiz_thread_t thread_;
       tiz_mutex_t mutex_;
       tiz_sem_t sem_;
+      tiz_sem_t settled_sem_;
+      bool prepared_;
+      bool unloaded_;
+      bool failed_;
       tiz_queue_t *p_queue_;
       tiz_event_timer *p_ev_timer_;
       progress_display *p_progress_;
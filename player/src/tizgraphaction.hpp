@@ -167,6 +167,19 @@ namespace tiz
       }
     };
 
+    struct do_ack_prepared
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_ack_prepared ();
+        }
+      }
+    };
+
     struct do_store_config
     {
       template < class FSM, class EVT, class SourceState, class TargetState >
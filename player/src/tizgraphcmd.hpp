@@ -108,6 +108,7 @@ namespace tiz
                                                      else INJECT_EVENT (graph_reconfigured_evt)
                                                        else INJECT_EVENT (tunnel_reconfigured_evt)
                                                          else INJECT_EVENT (timer_evt)
+                                                         else INJECT_EVENT (prepare_evt)
                                                          else
                                                            {
                                                              assert (0);
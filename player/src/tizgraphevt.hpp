@@ -57,6 +57,17 @@ namespace tiz
       const tizgraphconfig_ptr_t config_;
     };
 
+    // Takes a loaded graph as far as OMX_StateIdle and leaves it there, ready
+    // for a later execute_evt.
+    struct prepare_evt
+    {
+      prepare_evt (const tizgraphconfig_ptr_t config = tizgraphconfig_ptr_t ())
+        : config_ (config)
+      {
+      }
+      const tizgraphconfig_ptr_t config_;
+    };
+
     // Make this state convertible from any state (this event exits a
     // sub-machine)
     struct configured_evt
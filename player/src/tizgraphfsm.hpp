@@ -80,6 +80,7 @@ namespace tiz
                                                "exe2idle",
                                                "idle",
                                                "idle2loaded",
+                                               "prepared",
                                                "AllOk",
                                                "unloaded"};
 
@@ -180,6 +181,10 @@ namespace tiz
                                                                                                                              do_loaded2idle > >                                                    >,
           //    +-----------------+----------------------------+--------------------------+----------------------------+--------------------------------------+----------------------------------------+
           boost::msm::front::Row < config2idle                 , omx_trans_evt            , idle2exe                   , do_idle2exe                      , is_trans_complete                      >,
+          boost::msm::front::Row < config2idle                 , omx_trans_evt            , conf_exit                  , boost::msm::front::none              , boost::msm::front::euml::And_<
+                                                                                                                                                                  is_trans_complete,
+                                                                                                                                                                  is_destination_state <
+                                                                                                                                                                    OMX_StateIdle > >  >,
           //    +-----------------+----------------------------+--------------------------+----------------------------+--------------------------------------+----------------------------------------+
           boost::msm::front::Row < idle2exe                    , omx_trans_evt            , conf_exit                  , boost::msm::front::none              , is_trans_complete                      >
           //    +-----------------+----------------------------+--------------------------+----------------------------+--------------------------------------+----------------------------------------+
@@ -292,6 +297,10 @@ namespace tiz
                                                                                                do_ack_loaded> >                           >,
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
         boost::msm::front::Row < loaded      , execute_evt     , configuring             , do_store_config         , last_op_succeeded    >,
+        boost::msm::front::Row < loaded      , prepare_evt     , configuring             , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_store_config,
+                                                                                               do_record_destination < OMX_StateIdle > > >, last_op_succeeded >,
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
         boost::msm::front::Row < configuring , omx_err_evt     , unloaded                , boost::msm::front::ActionSequence_<
                                                                                              boost::mpl::vector<
@@ -299,6 +308,16 @@ namespace tiz
                                                                                                do_error,
                                                                                                do_tear_down_tunnels,
                                                                                                do_destroy_graph> > , is_fatal_error       >,
+        boost::msm::front::Row < configuring , omx_err_evt     , unloaded                , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_record_fatal_error,
+                                                                                               do_error,
+                                                                                               do_tear_down_tunnels,
+                                                                                               do_destroy_graph> > , boost::msm::front::euml::And_<
+                                                                                                                       boost::msm::front::euml::Not_<
+                                                                                                                         is_fatal_error >,
+                                                                                                                       is_destination_state <
+                                                                                                                         OMX_StateIdle > > >,
         boost::msm::front::Row < configuring
                                  ::exit_pt
                                  <configuring_
@@ -307,6 +326,15 @@ namespace tiz
                                                                                                do_retrieve_metadata,
                                                                                                do_ack_execd,
                                                                                                do_start_progress_display> >               >,
+        boost::msm::front::Row < configuring
+                                 ::exit_pt
+                                 <configuring_
+                                  ::conf_exit>, configured_evt , prepared                , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_record_destination <
+                                                                                                 OMX_StateMax >,
+                                                                                               do_ack_prepared> > , is_destination_state <
+                                                                                                                      OMX_StateIdle >      >,
         boost::msm::front::Row < configuring
                                  ::exit_pt
                                  <configuring_
@@ -408,6 +436,15 @@ namespace tiz
                                                                                                do_tear_down_tunnels,
                                                                                                do_destroy_graph> > , is_trans_complete    >,
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
+        boost::msm::front::Row < prepared    , execute_evt     , executing               , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_store_config,
+                                                                                               do_retrieve_metadata,
+                                                                                               do_ack_execd,
+                                                                                               do_idle2exe,
+                                                                                               do_start_progress_display> >                        >,
+        boost::msm::front::Row < prepared    , unload_evt      , idle2loaded             , do_idle2loaded                             >,
+        //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
         boost::msm::front::Row < AllOk       , err_evt         , unloaded                , do_error                                       >
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
         > {};
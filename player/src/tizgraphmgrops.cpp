@@ -60,6 +60,9 @@ graphmgr::ops::ops (graphmgr::mgr *p_mgr, const tizplaylist_ptr_t &playlist,
     graph_config_ (),
     graph_registry_ (),
     p_managed_graph_ (),
+    prewarmed_graph_ (),
+    prewarmed_playlist_ (),
+    prewarmed_uris_ (),
     termination_cback_ (termination_cback),
     error_code_ (OMX_ErrorNone),
     error_msg_ ()
@@ -73,6 +76,8 @@ graphmgr::ops::~ops ()
 
 void graphmgr::ops::deinit ()
 {
+  discard_prewarmed_graph ();
+
   tizgraph_ptr_map_t::iterator registry_end = graph_registry_.end ();
 
   for (tizgraph_ptr_map_t::iterator it = graph_registry_.begin ();
@@ -134,7 +139,13 @@ void graphmgr::ops::do_load ()
 {
   next_playlist_ = find_next_sub_list ();
 
-  if (next_playlist_)
+  if (next_playlist_ && adopt_prewarmed_graph ())
+  {
+    // The graph is already sitting in OMX_StateIdle; tell the fsm it is loaded
+    // so that do_execute follows as usual.
+    p_mgr_->graph_loaded ();
+  }
+  else if (next_playlist_)
   {
     tizgraph_ptr_t g_ptr;
     do
@@ -191,6 +202,7 @@ void graphmgr::ops::do_execute ()
     GMGR_OPS_BAIL_IF_ERROR (p_managed_graph_,
                             p_managed_graph_->execute (graph_config_),
                             "Unable to execute the graph.");
+    prewarm_next_graph ();
   }
   else
   {
@@ -378,3 +390,113 @@ tizplaylist_ptr_t graphmgr::ops::find_next_sub_list () const
 
   return next_lst;
 }
+
+bool graphmgr::ops::is_prewarming_enabled () const
+{
+  // Only graphs that understand tiz::graph::prepare_evt may be pre-warmed.
+  return false;
+}
+
+void graphmgr::ops::prewarm_next_graph ()
+{
+  assert (playlist_);
+
+  if (prewarmed_graph_ || !is_prewarming_enabled ()
+      || playlist_->single_format ())
+  {
+    return;
+  }
+
+  // Peek at the sub-playlist that follows the current one, on a copy so that
+  // the position in the main playlist is left untouched.
+  tiz::playlist peek_lst (*playlist_);
+  tizplaylist_ptr_t next_lst = boost::make_shared< tiz::playlist >(
+      peek_lst.obtain_next_sub_playlist (tiz::playlist::DirUp));
+  if (!next_lst || next_lst->empty ())
+  {
+    return;
+  }
+
+  const std::string &uri = next_lst->get_uri_list ()[0];
+  const std::string encoding (tiz::graph::factory::coding_type (uri));
+  if (graph_registry_.find (encoding) != graph_registry_.end ())
+  {
+    // Same encoding as the graph currently in use; nothing to gain.
+    return;
+  }
+
+  tizgraph_ptr_t g_ptr = tiz::graph::factory::create_graph (uri);
+  if (g_ptr && OMX_ErrorNone == g_ptr->init ())
+  {
+    // No manager is set on this graph until it is adopted, so none of its
+    // notifications reach the fsm while the current graph is playing.
+    next_lst->set_loop_playback (false);
+    tizgraphconfig_ptr_t config
+        = boost::make_shared< tiz::graph::config >(next_lst);
+    static_cast< void >(g_ptr->load ());
+    static_cast< void >(g_ptr->prepare (config));
+
+    prewarmed_graph_ = g_ptr;
+    prewarmed_playlist_ = next_lst;
+    prewarmed_uris_ = next_lst->get_uri_list ();
+    TIZ_LOG (TIZ_PRIORITY_NOTICE, "Pre-warming [%s] graph for [%s]",
+             encoding.c_str (), uri.c_str ());
+  }
+}
+
+bool graphmgr::ops::adopt_prewarmed_graph ()
+{
+  bool adopted = false;
+
+  assert (next_playlist_);
+
+  if (prewarmed_graph_ && next_playlist_->current_index () == 0
+      && next_playlist_->get_uri_list () == prewarmed_uris_
+      && prewarmed_graph_->wait_prepared ())
+  {
+    const std::string encoding (
+        tiz::graph::factory::coding_type (prewarmed_uris_[0]));
+    if (graph_registry_.insert (std::make_pair (encoding, prewarmed_graph_))
+            .second)
+    {
+      // The graph's configuration refers to the pre-warmed playlist object,
+      // so that is the one to keep track of from now on.
+      prewarmed_graph_->set_manager (p_mgr_);
+      p_managed_graph_ = prewarmed_graph_;
+      next_playlist_ = prewarmed_playlist_;
+      prewarmed_graph_.reset ();
+      prewarmed_playlist_.reset ();
+      prewarmed_uris_.clear ();
+      adopted = true;
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "Adopted pre-warmed [%s] graph",
+               encoding.c_str ());
+    }
+  }
+
+  if (!adopted)
+  {
+    // Either nothing was pre-warmed or the prediction was wrong (e.g. the
+    // user skipped backwards).
+    discard_prewarmed_graph ();
+  }
+
+  return adopted;
+}
+
+void graphmgr::ops::discard_prewarmed_graph ()
+{
+  if (prewarmed_graph_)
+  {
+    // A graph that failed to load or prepare has already gone as far as it
+    // will; only a prepared one needs to be unloaded before deinit.
+    if (prewarmed_graph_->wait_prepared ())
+    {
+      prewarmed_graph_->unload ();
+      prewarmed_graph_->wait_unloaded ();
+    }
+    prewarmed_graph_->deinit ();
+    prewarmed_graph_.reset ();
+    prewarmed_playlist_.reset ();
+    prewarmed_uris_.clear ();
+  }
+}
@@ -117,6 +117,12 @@ namespace tiz
 
     protected:
       virtual tizgraph_ptr_t get_graph (const std::string &uri);
+      virtual bool is_prewarming_enabled () const;
+
+    private:
+      void prewarm_next_graph ();
+      bool adopt_prewarmed_graph ();
+      void discard_prewarmed_graph ();
 
     protected:
       mgr *p_mgr_;              // Not owned
@@ -125,6 +131,9 @@ namespace tiz
       tizgraphconfig_ptr_t graph_config_;
       tizgraph_ptr_map_t graph_registry_;
       tizgraph_ptr_t p_managed_graph_;
+      tizgraph_ptr_t prewarmed_graph_;
+      tizplaylist_ptr_t prewarmed_playlist_;
+      uri_lst_t prewarmed_uris_;
       termination_callback_t termination_cback_;
       OMX_ERRORTYPE error_code_;
       std::string error_msg_;
@@ -149,6 +149,12 @@ void graph::ops::do_ack_loaded ()
   {
     p_graph_->graph_loaded ();
   }
+  else if (p_graph_)
+  {
+    // A later prepare_evt is blocked by last_op_succeeded; let a caller of
+    // wait_prepared know that this graph will never get to OMX_StateIdle.
+    p_graph_->graph_failed ();
+  }
 }
 
 void graph::ops::do_store_config (const tizgraphconfig_ptr_t &config)
@@ -309,6 +315,14 @@ void graph::ops::do_ack_execd ()
   }
 }
 
+void graph::ops::do_ack_prepared ()
+{
+  if (last_op_succeeded () && p_graph_)
+  {
+    p_graph_->graph_prepared ();
+  }
+}
+
 void graph::ops::do_ack_stopped ()
 {
   if (last_op_succeeded () && p_graph_)
@@ -119,6 +119,7 @@ namespace tiz
       virtual void do_idle2exe_comp (const int comp_id);
       virtual void do_idle2exe_tunnel (const int tunnel_id);
       virtual void do_ack_execd ();
+      virtual void do_ack_prepared ();
       virtual void do_ack_stopped ();
       virtual void do_ack_paused ();
       virtual void do_ack_resumed ();
@@ -187,6 +187,20 @@ namespace tiz
       }
     };
 
+    // A graph that was taken to OMX_StateIdle ahead of time (see
+    // prepare_evt); only an execute_evt or an unload_evt will move it on.
+    struct prepared : public boost::msm::front::state<>
+    {
+      template < class Event, class FSM >
+      void on_entry (Event const &evt, FSM &fsm) {G_STATE_LOG ();}
+      template < class Event, class FSM >
+      void on_exit (Event const &evt, FSM &fsm) {G_STATE_LOG ();}
+      OMX_STATETYPE target_omx_state () const
+      {
+        return OMX_StateIdle;
+      }
+    };
+
     struct idle2loaded : public boost::msm::front::state<>
     {
       template < class Event, class FSM >
@@ -1072,6 +1072,23 @@ bool graph::util::is_mpris_enabled ()
   return is_enabled;
 }
 
+bool graph::util::is_graph_prewarming_enabled ()
+{
+  bool is_enabled = false;
+  const char *p_prewarming_enabled
+      = tiz_rcfile_get_value ("tizonia", "graph-prewarming-enabled");
+  if (p_prewarming_enabled)
+  {
+    std::string prewarming_enabled_str;
+    prewarming_enabled_str.assign (p_prewarming_enabled);
+    if (prewarming_enabled_str.compare ("true") == 0)
+    {
+      is_enabled = true;
+    }
+  }
+  return is_enabled;
+}
+
 void graph::util::copy_omx_string (
     OMX_U8 *p_dest, const std::string &omx_string,
     const size_t max_length /*  = OMX_MAX_STRINGNAME_SIZE */
@@ -238,6 +238,8 @@ namespace tiz
 
       static bool is_mpris_enabled ();
 
+      static bool is_graph_prewarming_enabled ();
+
       static void copy_omx_string (OMX_U8 *p_dest,
                                    const std::string &omx_string,
                                    const size_t max_length
@@ -64,6 +64,7 @@
 #include "tizgraphmgr.hpp"
 #include "tizgraphtypes.hpp"
 #include "tizomxutil.hpp"
+#include "tizprobecache.hpp"
 #include <decoders/tizdecgraphmgr.hpp>
 #include <httpclnt/tizhttpclntmgr.hpp>
 #include <httpserv/tizhttpservconfig.hpp>
@@ -747,6 +748,9 @@ tiz::playapp::decode_local ()
   assert (playlist);
   playlist->print_info ();
 
+  // Probe the rest of the playlist in the background
+  tiz::probecache::prefetch (file_list);
+
   // Instantiate the decode manager
   tiz::graphmgr::mgr_ptr_t p_mgr
       = boost::make_shared< tiz::graphmgr::decodemgr > ();
@@ -762,6 +766,8 @@ tiz::playapp::decode_local ()
   p_mgr->quit ();
   p_mgr->deinit ();
 
+  tiz::probecache::shutdown ();
+
   return rc;
 }
 
@@ -830,6 +836,9 @@ tiz::playapp::serve_stream ()
   assert (playlist);
   playlist->print_info ();
 
+  // Probe the rest of the playlist in the background
+  tiz::probecache::prefetch (file_list);
+
   // Here we'll only process one encoding, that is mp3... so enable loop
   // playback to ensure that the graph does not stop to get back to the
   // manager at the end of the playlist.
@@ -855,6 +864,8 @@ tiz::playapp::serve_stream ()
   p_mgr->quit ();
   p_mgr->deinit ();
 
+  tiz::probecache::shutdown ();
+
   return rc;
 }
 
@@ -43,6 +43,7 @@
 
 #include <tizplatform.h>
 
+#include "tizprobecache.hpp"
 #include "tizprobe.hpp"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
@@ -102,40 +103,29 @@ namespace  // unnamed
   }
 
   void obtain_stream_title_and_genre (MediaInfoLib::MediaInfo &mi,
-                                      const bool quiet,
-                                      std::string &stream_title,
-                                      std::string &stream_genre)
+                                      tiz::probecache::entry &info)
   {
     std::string artist (
         mi_stream_general_info_to_std_string (mi, L"Performer"));
     std::string title (mi_stream_general_info_to_std_string (mi, L"Track"));
     std::string album (mi_stream_general_info_to_std_string (mi, L"Album"));
     std::string genre (mi_stream_general_info_to_std_string (mi, L"Genre"));
-    std::string full_track_name (
-        mi_stream_general_info_to_std_string (mi, L"CompleteName"));
 
-    stream_title.assign (artist);
+    info.stream_name_.assign (
+        mi_stream_general_info_to_std_string (mi, L"CompleteName"));
+    info.stream_title_.assign (artist);
     if (!album.empty ())
     {
-      stream_title.append (" - ");
-      stream_title.append (album);
+      info.stream_title_.append (" - ");
+      info.stream_title_.append (album);
     }
 
     if (!title.empty ())
     {
-      stream_title.append (" - ");
-      stream_title.append (title);
-    }
-    stream_genre.assign (genre);
-
-    if (!quiet)
-    {
-      if (stream_title.empty ())
-      {
-        stream_title.assign (full_track_name);
-      }
-      boost::replace_all (stream_title, "_", " ");
+      info.stream_title_.append (" - ");
+      info.stream_title_.append (title);
     }
+    info.stream_genre_.assign (genre);
   }
 
   OMX_AUDIO_CODINGTYPE obtain_codec_id (MediaInfoLib::MediaInfo &mi)
@@ -188,32 +178,30 @@ namespace  // unnamed
   }
 
   void obtain_stream_properties (MediaInfoLib::MediaInfo &mi,
-                                 OMX_U32 &samplerate, OMX_U32 &bitrate,
-                                 OMX_U32 &nchannels, OMX_U32 &bitdepth,
-                                 OMX_ENDIANTYPE &endianness,
-                                 OMX_NUMERICALDATATYPE &sign,
-                                 bool &stream_is_cbr)
+                                 tiz::probecache::entry &info)
   {
-    mi_stream_audio_info_to_unsigned (mi, L"SamplingRate", samplerate);
-    mi_stream_audio_info_to_unsigned (mi, L"BitRate", bitrate);
-    mi_stream_audio_info_to_unsigned (mi, L"Channel(s)", nchannels);
-    mi_stream_audio_info_to_unsigned (mi, L"BitDepth", bitdepth);
+    mi_stream_audio_info_to_unsigned (mi, L"SamplingRate", info.samplerate_);
+    mi_stream_audio_info_to_unsigned (mi, L"BitRate", info.bitrate_);
+    mi_stream_audio_info_to_unsigned (mi, L"Channel(s)", info.nchannels_);
+    mi_stream_audio_info_to_unsigned (mi, L"BitDepth", info.bitdepth_);
 
     std::string en (
         mi_stream_audio_info_to_std_string (mi, L"Format_Settings_Endianness"));
-    endianness = en.empty () ? endianness
-                             : (en.compare ("Little") == 0 ? OMX_EndianLittle
-                                                           : OMX_EndianBig);
+    info.endianness_
+        = en.empty () ? info.endianness_
+                      : (en.compare ("Little") == 0 ? OMX_EndianLittle
+                                                    : OMX_EndianBig);
 
     std::string s (
         mi_stream_audio_info_to_std_string (mi, L"Format_Settings_Sign"));
-    sign = s.empty () ? sign
-                      : (s.compare ("Signed") == 0 ? OMX_NumericalDataSigned
-                                                   : OMX_NumericalDataUnsigned);
+    info.sign_ = s.empty () ? info.sign_
+                            : (s.compare ("Signed") == 0
+                                   ? OMX_NumericalDataSigned
+                                   : OMX_NumericalDataUnsigned);
 
     std::string cbr_or_vbr (
         mi_stream_general_info_to_std_string (mi, L"OverallBitRate_Mode"));
-    stream_is_cbr = (cbr_or_vbr.compare ("CBR") == 0);
+    info.stream_is_cbr_ = (cbr_or_vbr.compare ("CBR") == 0);
   }
 
   OMX_MEDIACONTAINER_FORMATTYPE obtain_container_format (
@@ -235,6 +223,31 @@ namespace  // unnamed
     }
     return container_format;
   }
+
+  std::string tag_to_std_string (const TagLib::String &str)
+  {
+    return str.stripWhiteSpace ().to8Bit ();
+  }
+
+  void obtain_meta_data (const std::string &uri, tiz::probecache::entry &info)
+  {
+    TagLib::FileRef meta_file (uri.c_str ());
+    if (!meta_file.isNull () && meta_file.tag ())
+    {
+      TagLib::Tag *tag = meta_file.tag ();
+      info.title_ = tag_to_std_string (tag->title ());
+      info.artist_ = tag_to_std_string (tag->artist ());
+      info.album_ = tag_to_std_string (tag->album ());
+      info.comment_ = tag_to_std_string (tag->comment ());
+      info.genre_ = tag_to_std_string (tag->genre ());
+      info.year_ = tag->year ();
+      info.track_ = tag->track ();
+    }
+    if (!meta_file.isNull () && meta_file.audioProperties ())
+    {
+      info.length_ = meta_file.audioProperties ()->length ();
+    }
+  }
 }
 
 tiz::probe::probe (const std::string &uri, const bool quiet)
@@ -252,11 +265,17 @@ tiz::probe::probe (const std::string &uri, const bool quiet)
     vorbistype_ (),
     aactype_ (),
     vp8type_ (),
-    meta_file_ (uri.c_str ()),
+    info_ (),
+    info_valid_ (tiz::probecache::lookup (uri, info_)),
     stream_title_ (),
     stream_genre_ (),
     stream_is_cbr_ (false)
 {
+  if (!info_valid_)
+  {
+    obtain_meta_data (uri_, info_);
+  }
+
   // Defaults are the same as in the standard pcm renderer
   pcmtype_.nSize = sizeof(OMX_AUDIO_PARAM_PCMMODETYPE);
   pcmtype_.nVersion.nVersion = OMX_VERSION;
@@ -407,80 +426,102 @@ tiz::probe::get_container_type ()
 
 void tiz::probe::probe_stream ()
 {
-  MediaInfoLib::MediaInfo mi;
-
-  if (open_media (uri_, mi))
+  if (!info_valid_)
   {
-    OMX_U32 samplerate = 48000;
-    OMX_U32 bitrate = 0;
-    OMX_U32 nchannels = 2;
-    OMX_U32 bitdepth = 16;
-    OMX_ENDIANTYPE endianness = OMX_EndianLittle;
-    OMX_NUMERICALDATATYPE sign = OMX_NumericalDataSigned;
+    MediaInfoLib::MediaInfo mi;
+    if (!open_media (uri_, mi))
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to open media file : %s",
+               uri_.c_str ());
+      return;
+    }
 
     // Get an idea of the container format
-    container_type_ = obtain_container_format (mi);
+    info_.container_type_ = obtain_container_format (mi);
 
     // Get the codec type
-    const OMX_AUDIO_CODINGTYPE codec_id = obtain_codec_id (mi);
+    info_.codec_id_ = obtain_codec_id (mi);
 
     // Get the stream title and genre
-    obtain_stream_title_and_genre (mi, quiet_, stream_title_, stream_genre_);
-
-    TIZ_PRINTF_DBG_RED ("uri [%s] codec_id [%0x]\n", uri_.c_str (), codec_id);
+    obtain_stream_title_and_genre (mi, info_);
 
     // Grab the sample rate, bitrate, num channels, and sample format (when
     // available), and cbr flag
-    obtain_stream_properties (mi, samplerate, bitrate, nchannels, bitdepth,
-                              endianness, sign, stream_is_cbr_);
+    obtain_stream_properties (mi, info_);
 
-    if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingMP2)
-    {
-      set_mp2_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                          sign);
-    }
-    else if (codec_id == OMX_AUDIO_CodingMP3)
-    {
-      set_mp3_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                          sign);
-    }
-    else if (codec_id == OMX_AUDIO_CodingAAC)
-    {
-      set_aac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                          sign);
-    }
-    else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingFLAC)
-    {
-      set_flac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                           sign);
-    }
-    else if (codec_id == OMX_AUDIO_CodingVORBIS)
-    {
-      set_vorbis_codec_info (samplerate, bitrate, nchannels, bitdepth,
-                             endianness, sign);
-    }
-    else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingOPUS)
-    {
-      set_opus_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                           sign);
-    }
-    else if (is_pcm_codec (codec_id))
+    mi.Close ();
+
+    info_valid_ = true;
+    tiz::probecache::store (uri_, info_);
+  }
+
+  const OMX_U32 samplerate = info_.samplerate_;
+  const OMX_U32 bitrate = info_.bitrate_;
+  const OMX_U32 nchannels = info_.nchannels_;
+  const OMX_U32 bitdepth = info_.bitdepth_;
+  const OMX_ENDIANTYPE endianness
+      = static_cast< OMX_ENDIANTYPE >(info_.endianness_);
+  const OMX_NUMERICALDATATYPE sign
+      = static_cast< OMX_NUMERICALDATATYPE >(info_.sign_);
+  const OMX_AUDIO_CODINGTYPE codec_id
+      = static_cast< OMX_AUDIO_CODINGTYPE >(info_.codec_id_);
+
+  container_type_
+      = static_cast< OMX_MEDIACONTAINER_FORMATTYPE >(info_.container_type_);
+  stream_is_cbr_ = info_.stream_is_cbr_;
+  stream_genre_ = info_.stream_genre_;
+  stream_title_ = info_.stream_title_;
+  if (!quiet_)
+  {
+    if (stream_title_.empty ())
     {
-      domain_ = OMX_PortDomainAudio;
-      audio_coding_type_
-          = static_cast< OMX_AUDIO_CODINGTYPE >(OMX_AUDIO_CodingPCM);
-      pcmtype_.nSamplingRate = samplerate;
-      pcmtype_.nChannels = nchannels;
-      pcmtype_.nBitPerSample = bitdepth;
-      pcmtype_.eEndian = endianness;
-      pcmtype_.eNumData = sign;
+      stream_title_.assign (info_.stream_name_);
     }
+    boost::replace_all (stream_title_, "_", " ");
+  }
 
-    mi.Close ();
+  TIZ_PRINTF_DBG_RED ("uri [%s] codec_id [%0x]\n", uri_.c_str (), codec_id);
+
+  if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingMP2)
+  {
+    set_mp2_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                        sign);
+  }
+  else if (codec_id == OMX_AUDIO_CodingMP3)
+  {
+    set_mp3_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                        sign);
+  }
+  else if (codec_id == OMX_AUDIO_CodingAAC)
+  {
+    set_aac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                        sign);
+  }
+  else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingFLAC)
+  {
+    set_flac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                         sign);
+  }
+  else if (codec_id == OMX_AUDIO_CodingVORBIS)
+  {
+    set_vorbis_codec_info (samplerate, bitrate, nchannels, bitdepth,
+                           endianness, sign);
+  }
+  else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingOPUS)
+  {
+    set_opus_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                         sign);
   }
-  else
+  else if (is_pcm_codec (codec_id))
   {
-    TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to open media file : %s", uri_.c_str());
+    domain_ = OMX_PortDomainAudio;
+    audio_coding_type_
+        = static_cast< OMX_AUDIO_CODINGTYPE >(OMX_AUDIO_CodingPCM);
+    pcmtype_.nSamplingRate = samplerate;
+    pcmtype_.nChannels = nchannels;
+    pcmtype_.nBitPerSample = bitdepth;
+    pcmtype_.eEndian = endianness;
+    pcmtype_.eNumData = sign;
   }
 }
 
@@ -751,76 +792,49 @@ bool tiz::probe::is_cbr_stream ()
   return stream_is_cbr_;
 }
 
-std::string tiz::probe::retrieve_meta_data_str (
-    TagLib::String (TagLib::Tag::*TagFunction)() const) const
-{
-  assert (TagFunction);
-  if (!meta_file_.isNull () && meta_file_.tag ())
-  {
-    TagLib::Tag *tag = meta_file_.tag ();
-    return (tag->*TagFunction)().stripWhiteSpace ().to8Bit ();
-  }
-  return std::string ();
-}
-
-unsigned int tiz::probe::retrieve_meta_data_uint (
-    TagLib::uint (TagLib::Tag::*TagFunction)() const) const
-{
-  assert (TagFunction);
-  if (!meta_file_.isNull () && meta_file_.tag ())
-  {
-    TagLib::Tag *tag = meta_file_.tag ();
-    return (tag->*TagFunction)();
-  }
-  return 0;
-}
-
 std::string tiz::probe::title () const
 {
-  return retrieve_meta_data_str (&TagLib::Tag::title);
+  return info_.title_;
 }
 
 std::string tiz::probe::artist () const
 {
-  return retrieve_meta_data_str (&TagLib::Tag::artist);
+  return info_.artist_;
 }
 
 std::string tiz::probe::album () const
 {
-  return retrieve_meta_data_str (&TagLib::Tag::album);
+  return info_.album_;
 }
 
 std::string tiz::probe::year () const
 {
-  return boost::lexical_cast< std::string >(
-      retrieve_meta_data_uint (&TagLib::Tag::year));
+  return boost::lexical_cast< std::string >(info_.year_);
 }
 
 std::string tiz::probe::comment () const
 {
-  return retrieve_meta_data_str (&TagLib::Tag::comment);
+  return info_.comment_;
 }
 
 std::string tiz::probe::track () const
 {
-  return boost::lexical_cast< std::string >(
-      retrieve_meta_data_uint (&TagLib::Tag::track));
+  return boost::lexical_cast< std::string >(info_.track_);
 }
 
 std::string tiz::probe::genre () const
 {
-  return retrieve_meta_data_str (&TagLib::Tag::genre);
+  return info_.genre_;
 }
 
 std::string tiz::probe::stream_length () const
 {
   std::string length_str;
 
-  if (!meta_file_.isNull () && meta_file_.audioProperties ())
+  if (info_.length_ >= 0)
   {
-    TagLib::AudioProperties *properties = meta_file_.audioProperties ();
-    int seconds = properties->length () % 60;
-    int minutes = (properties->length () - seconds) / 60;
+    int seconds = info_.length_ % 60;
+    int minutes = (info_.length_ - seconds) / 60;
     int hours = 0;
     if (minutes >= 60)
     {
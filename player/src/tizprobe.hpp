@@ -41,6 +41,8 @@
 #include <OMX_Video.h>
 #include <OMX_TizoniaExt.h>
 
+#include "tizprobecache.hpp"
+
 namespace tiz
 {
   class probe
@@ -116,10 +118,6 @@ namespace tiz
                                 const OMX_U32 nchannels, const OMX_U32 bitdepth,
                                 const OMX_ENDIANTYPE endianness,
                                 const OMX_NUMERICALDATATYPE sign);
-    std::string retrieve_meta_data_str (
-        TagLib::String (TagLib::Tag::*TagFunction)() const) const;
-    unsigned int retrieve_meta_data_uint (
-        TagLib::uint (TagLib::Tag::*TagFunction)() const) const;
 
   private:
     std::string uri_;
@@ -137,7 +135,8 @@ namespace tiz
     OMX_AUDIO_PARAM_VORBISTYPE vorbistype_;
     OMX_AUDIO_PARAM_AACPROFILETYPE aactype_;
     OMX_VIDEO_PARAM_VP8TYPE vp8type_;
-    TagLib::FileRef meta_file_;
+    probecache::entry info_;
+    bool info_valid_;
     std::string stream_title_;
     std::string stream_genre_;
     bool stream_is_cbr_;
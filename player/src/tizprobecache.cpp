@@ -0,0 +1,442 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizprobecache.cpp
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Cache of stream probing results
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include <tizplatform.h>
+
+#include "tizprobe.hpp"
+#include "tizprobecache.hpp"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.play.probecache"
+#endif
+
+#define PROBE_CACHE_MAGIC "tizonia-probe-cache 1"
+#define PROBE_CACHE_MAX_THREADS 4
+
+/*
+ * Format (tab-separated, one file per line; tabs, newlines and backslashes in
+ * strings are escaped):
+ *   tizonia-probe-cache 1
+ *   <path> <size> <mtime-sec> <mtime-nsec> <container> <codec> <samplerate>
+ *     <bitrate> <channels> <bitdepth> <endianness> <sign> <cbr> <year>
+ *     <track> <length> <stream title> <stream name> <stream genre> <title>
+ *     <artist> <album> <comment> <genre>
+ */
+
+namespace  // unnamed
+{
+  struct cache_record
+  {
+    unsigned long long size_;
+    unsigned long long mtime_sec_;
+    unsigned long long mtime_nsec_;
+    tiz::probecache::entry entry_;
+  };
+
+  typedef std::map< std::string, cache_record > cache_map_t;
+
+  boost::mutex cache_mutex;
+  cache_map_t cache_map;
+  bool cache_loaded = false;
+  bool cache_dirty = false;
+
+  boost::mutex prefetch_mutex;
+  boost::thread_group prefetch_threads;
+  uri_lst_t prefetch_uris;
+  std::size_t prefetch_next = 0;
+  bool prefetch_stop = false;
+
+  std::string cache_path ()
+  {
+    std::string path;
+    const char *p_path = tiz_rcfile_get_value ("tizonia", "probe-cache");
+    if (p_path)
+    {
+      path.assign (p_path);
+    }
+    return path;
+  }
+
+  bool stat_regular_file (const std::string &path, cache_record &rec)
+  {
+    struct stat st;
+    if (0 == stat (path.c_str (), &st) && S_ISREG (st.st_mode))
+    {
+      rec.size_ = static_cast< unsigned long long >(st.st_size);
+      rec.mtime_sec_ = static_cast< unsigned long long >(st.st_mtim.tv_sec);
+      rec.mtime_nsec_ = static_cast< unsigned long long >(st.st_mtim.tv_nsec);
+      return true;
+    }
+    return false;
+  }
+
+  std::string escape (const std::string &str)
+  {
+    std::string out;
+    out.reserve (str.size ());
+    for (std::string::const_iterator it = str.begin (); it != str.end (); ++it)
+    {
+      switch (*it)
+      {
+        case '\\':
+          out.append ("\\\\");
+          break;
+        case '\t':
+          out.append ("\\t");
+          break;
+        case '\n':
+          out.append ("\\n");
+          break;
+        default:
+          out.push_back (*it);
+          break;
+      };
+    }
+    return out;
+  }
+
+  std::string unescape (const std::string &str)
+  {
+    std::string out;
+    out.reserve (str.size ());
+    for (std::string::const_iterator it = str.begin (); it != str.end (); ++it)
+    {
+      if ('\\' == *it && (it + 1) != str.end ())
+      {
+        ++it;
+        out.push_back ('t' == *it ? '\t' : ('n' == *it ? '\n' : *it));
+      }
+      else
+      {
+        out.push_back (*it);
+      }
+    }
+    return out;
+  }
+
+  void split_line (const std::string &line, std::vector< std::string > &fields)
+  {
+    std::string::size_type start = 0;
+    std::string::size_type pos = 0;
+    fields.clear ();
+    while ((pos = line.find ('\t', start)) != std::string::npos)
+    {
+      fields.push_back (unescape (line.substr (start, pos - start)));
+      start = pos + 1;
+    }
+    fields.push_back (unescape (line.substr (start)));
+  }
+
+  template < typename T >
+  bool parse_field (const std::string &field, T &value)
+  {
+    std::istringstream iss (field);
+    iss >> value;
+    return !iss.fail ();
+  }
+
+  bool parse_record (const std::vector< std::string > &f, std::string &path,
+                     cache_record &rec)
+  {
+    tiz::probecache::entry &e = rec.entry_;
+    if (f.size () != 24)
+    {
+      return false;
+    }
+    path = f[0];
+    e.stream_title_ = f[16];
+    e.stream_name_ = f[17];
+    e.stream_genre_ = f[18];
+    e.title_ = f[19];
+    e.artist_ = f[20];
+    e.album_ = f[21];
+    e.comment_ = f[22];
+    e.genre_ = f[23];
+    return parse_field (f[1], rec.size_) && parse_field (f[2], rec.mtime_sec_)
+           && parse_field (f[3], rec.mtime_nsec_)
+           && parse_field (f[4], e.container_type_)
+           && parse_field (f[5], e.codec_id_)
+           && parse_field (f[6], e.samplerate_)
+           && parse_field (f[7], e.bitrate_)
+           && parse_field (f[8], e.nchannels_)
+           && parse_field (f[9], e.bitdepth_)
+           && parse_field (f[10], e.endianness_)
+           && parse_field (f[11], e.sign_)
+           && parse_field (f[12], e.stream_is_cbr_)
+           && parse_field (f[13], e.year_) && parse_field (f[14], e.track_)
+           && parse_field (f[15], e.length_);
+  }
+
+  void write_record (std::ostream &os, const std::string &path,
+                     const cache_record &rec)
+  {
+    const tiz::probecache::entry &e = rec.entry_;
+    os << escape (path) << '\t' << rec.size_ << '\t' << rec.mtime_sec_ << '\t'
+       << rec.mtime_nsec_ << '\t' << e.container_type_ << '\t' << e.codec_id_
+       << '\t' << e.samplerate_ << '\t' << e.bitrate_ << '\t' << e.nchannels_
+       << '\t' << e.bitdepth_ << '\t' << e.endianness_ << '\t' << e.sign_
+       << '\t' << e.stream_is_cbr_ << '\t' << e.year_ << '\t' << e.track_
+       << '\t' << e.length_ << '\t' << escape (e.stream_title_) << '\t'
+       << escape (e.stream_name_) << '\t' << escape (e.stream_genre_) << '\t'
+       << escape (e.title_) << '\t' << escape (e.artist_) << '\t'
+       << escape (e.album_) << '\t' << escape (e.comment_) << '\t'
+       << escape (e.genre_) << '\n';
+  }
+
+  // Must be called with cache_mutex held.
+  void load_cache ()
+  {
+    if (cache_loaded)
+    {
+      return;
+    }
+    cache_loaded = true;
+
+    const std::string path (cache_path ());
+    if (path.empty ())
+    {
+      return;
+    }
+
+    std::ifstream ifs (path.c_str ());
+    std::string line;
+    if (!std::getline (ifs, line) || line.compare (PROBE_CACHE_MAGIC) != 0)
+    {
+      return;
+    }
+
+    std::vector< std::string > fields;
+    while (std::getline (ifs, line))
+    {
+      std::string file_path;
+      cache_record rec;
+      split_line (line, fields);
+      if (parse_record (fields, file_path, rec))
+      {
+        cache_map[file_path] = rec;
+      }
+    }
+    TIZ_LOG (TIZ_PRIORITY_TRACE, "Loaded [%d] entries from [%s]",
+             cache_map.size (), path.c_str ());
+  }
+
+  // Must be called with cache_mutex held.
+  void save_cache ()
+  {
+    const std::string path (cache_path ());
+    if (!cache_dirty || path.empty ())
+    {
+      return;
+    }
+
+    const std::string tmp_path (path + ".tmp");
+    try
+    {
+      boost::filesystem::path parent (
+          boost::filesystem::path (path).parent_path ());
+      if (!parent.empty ())
+      {
+        boost::filesystem::create_directories (parent);
+      }
+    }
+    catch (std::exception const &e)
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "[%s]", e.what ());
+      return;
+    }
+
+    std::ofstream ofs (tmp_path.c_str (), std::ios::out | std::ios::trunc);
+    ofs << PROBE_CACHE_MAGIC << '\n';
+    for (cache_map_t::const_iterator it = cache_map.begin ();
+         it != cache_map.end (); ++it)
+    {
+      write_record (ofs, it->first, it->second);
+    }
+    ofs.close ();
+
+    if (ofs.fail () || 0 != rename (tmp_path.c_str (), path.c_str ()))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to write [%s]", path.c_str ());
+      (void)unlink (tmp_path.c_str ());
+      return;
+    }
+    cache_dirty = false;
+  }
+
+  void prefetch_thread_func ()
+  {
+    for (;;)
+    {
+      std::string uri;
+      {
+        boost::mutex::scoped_lock lock (prefetch_mutex);
+        if (prefetch_stop || prefetch_next >= prefetch_uris.size ())
+        {
+          break;
+        }
+        uri = prefetch_uris[prefetch_next++];
+      }
+
+      tiz::probecache::entry e;
+      if (!tiz::probecache::lookup (uri, e))
+      {
+        // Probing stores the result in the cache
+        tiz::probe p (uri, /* quiet = */ true);
+        (void)p.get_omx_domain ();
+      }
+    }
+  }
+}
+
+tiz::probecache::entry::entry ()
+  : container_type_ (OMX_FORMATMax),
+    codec_id_ (OMX_AUDIO_CodingUnused),
+    samplerate_ (48000),
+    bitrate_ (0),
+    nchannels_ (2),
+    bitdepth_ (16),
+    endianness_ (OMX_EndianLittle),
+    sign_ (OMX_NumericalDataSigned),
+    stream_is_cbr_ (false),
+    stream_title_ (),
+    stream_name_ (),
+    stream_genre_ (),
+    title_ (),
+    artist_ (),
+    album_ (),
+    comment_ (),
+    genre_ (),
+    year_ (0),
+    track_ (0),
+    length_ (-1)
+{
+}
+
+bool tiz::probecache::lookup (const std::string &path, entry &result)
+{
+  cache_record current;
+  if (!stat_regular_file (path, current))
+  {
+    return false;
+  }
+
+  boost::mutex::scoped_lock lock (cache_mutex);
+  load_cache ();
+  cache_map_t::const_iterator it = cache_map.find (path);
+  if (it != cache_map.end () && it->second.size_ == current.size_
+      && it->second.mtime_sec_ == current.mtime_sec_
+      && it->second.mtime_nsec_ == current.mtime_nsec_)
+  {
+    result = it->second.entry_;
+    return true;
+  }
+  return false;
+}
+
+void tiz::probecache::store (const std::string &path, const entry &value)
+{
+  cache_record rec;
+  if (!stat_regular_file (path, rec))
+  {
+    return;
+  }
+  rec.entry_ = value;
+
+  boost::mutex::scoped_lock lock (cache_mutex);
+  load_cache ();
+  cache_map[path] = rec;
+  cache_dirty = true;
+}
+
+void tiz::probecache::prefetch (const uri_lst_t &uris)
+{
+  boost::mutex::scoped_lock lock (prefetch_mutex);
+  if (prefetch_next < prefetch_uris.size () || prefetch_stop)
+  {
+    // Already busy, or shutting down
+    return;
+  }
+
+  prefetch_uris = uris;
+  prefetch_next = 0;
+
+  // Probing is mostly waiting on the disk, so use a couple of threads even
+  // on a single cpu
+  long ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+  std::size_t nthreads = ncpus > 2 ? static_cast< std::size_t >(ncpus) : 2;
+  if (nthreads > PROBE_CACHE_MAX_THREADS)
+  {
+    nthreads = PROBE_CACHE_MAX_THREADS;
+  }
+  if (nthreads > uris.size ())
+  {
+    nthreads = uris.size ();
+  }
+
+  try
+  {
+    for (std::size_t i = 0; i < nthreads; ++i)
+    {
+      prefetch_threads.create_thread (prefetch_thread_func);
+    }
+  }
+  catch (std::exception const &e)
+  {
+    TIZ_LOG (TIZ_PRIORITY_ERROR, "[%s]", e.what ());
+  }
+}
+
+void tiz::probecache::shutdown ()
+{
+  {
+    boost::mutex::scoped_lock lock (prefetch_mutex);
+    prefetch_stop = true;
+  }
+  prefetch_threads.join_all ();
+
+  boost::mutex::scoped_lock lock (cache_mutex);
+  save_cache ();
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizprobecache.hpp
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Cache of stream probing results
+ *
+ *
+ */
+
+#ifndef TIZPROBECACHE_HPP
+#define TIZPROBECACHE_HPP
+
+#include <string>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+
+#include "tizgraphtypes.hpp"
+
+namespace tiz
+{
+  /**
+   *  @class probecache
+   *  @brief Process-wide cache of what tiz::probe finds out about local files.
+   *
+   *  Entries are keyed by path and remain valid only while the file's size
+   *  and modification time stay the same. The cache is read from, and written
+   *  back to, the file configured with 'probe-cache' in the [tizonia] section
+   *  of tizonia.conf.
+   */
+  class probecache
+  {
+  public:
+    /**
+     * The raw stream properties and tags of a file, i.e. everything that
+     * tiz::probe otherwise obtains from MediaInfoLib and TagLib.
+     */
+    struct entry
+    {
+      entry ();
+
+      int container_type_;
+      int codec_id_;
+      OMX_U32 samplerate_;
+      OMX_U32 bitrate_;
+      OMX_U32 nchannels_;
+      OMX_U32 bitdepth_;
+      int endianness_;
+      int sign_;
+      bool stream_is_cbr_;
+      std::string stream_title_;
+      std::string stream_name_;
+      std::string stream_genre_;
+      std::string title_;
+      std::string artist_;
+      std::string album_;
+      std::string comment_;
+      std::string genre_;
+      unsigned int year_;
+      unsigned int track_;
+      int length_;  // in seconds, -1 if unknown
+    };
+
+  public:
+    static bool lookup (const std::string &path, entry &result);
+    static void store (const std::string &path, const entry &value);
+
+    /**
+     * Probe, in the background and using several threads, every file in @a
+     * uris that is not in the cache yet.
+     */
+    static void prefetch (const uri_lst_t &uris);
+
+    /**
+     * Stop any background probing and save the cache to disk.
+     */
+    static void shutdown ();
+  };
+}  // namespace tiz
+
+#endif  // TIZPROBECACHE_HPP
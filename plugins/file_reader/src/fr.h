@@ -47,6 +47,8 @@ extern "C" {
 #define ARATELIA_FILE_READER_PORT_NONCONTIGUOUS OMX_FALSE
 #define ARATELIA_FILE_READER_PORT_ALIGNMENT 0
 #define ARATELIA_FILE_READER_PORT_SUPPLIERPREF OMX_BufferSupplyInput
+/* Amount of data the kernel is asked to read ahead of the consumer */
+#define ARATELIA_FILE_READER_READAHEAD_WINDOW (1024 * 1024)
 
 #ifdef __cplusplus
 }
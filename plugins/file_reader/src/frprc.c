@@ -35,6 +35,11 @@
 #include <errno.h>
 #include <limits.h>
 #include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <OMX_Core.h>
 
@@ -55,15 +60,138 @@
 static OMX_ERRORTYPE
 fr_prc_deallocate_resources (void *);
 
+static inline void
+unmap_file (fr_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  if (ap_prc->p_map_)
+    {
+      (void) munmap (ap_prc->p_map_, ap_prc->size_);
+      ap_prc->p_map_ = NULL;
+    }
+}
+
 static inline void
 close_file (fr_prc_t * ap_prc)
 {
   assert (ap_prc);
+  unmap_file (ap_prc);
   if (ap_prc->p_file_)
     {
       fclose (ap_prc->p_file_);
       ap_prc->p_file_ = NULL;
     }
+  ap_prc->size_ = 0;
+  ap_prc->offset_ = 0;
+  ap_prc->readahead_end_ = 0;
+}
+
+static bool
+mmap_configured (void)
+{
+  /* stdio is the default. Memory-mapped i/o may be enabled in the config
+     file, but only for files that won't be truncated while being read */
+  const char * p_io_mode
+    = tiz_rcfile_get_value (TIZ_RCFILE_PLUGINS_DATA_SECTION,
+                            "OMX.Aratelia.file_reader.binary.io_mode");
+  return (p_io_mode && 0 == strncmp (p_io_mode, "mmap", 4));
+}
+
+static void
+map_file (fr_prc_t * ap_prc)
+{
+  void * p_map = NULL;
+
+  assert (ap_prc);
+  assert (ap_prc->p_file_);
+  assert (!ap_prc->p_map_);
+  assert (ap_prc->size_ > 0);
+
+  p_map = mmap (NULL, ap_prc->size_, PROT_READ, MAP_PRIVATE,
+                fileno (ap_prc->p_file_), 0);
+  if (MAP_FAILED == p_map)
+    {
+      TIZ_NOTICE (handleOf (ap_prc), "mmap failed (%s); using stdio",
+                  strerror (errno));
+      return;
+    }
+
+  (void) madvise (p_map, ap_prc->size_, MADV_SEQUENTIAL);
+  ap_prc->p_map_ = p_map;
+  TIZ_TRACE (handleOf (ap_prc), "Mapped [%zu] bytes", ap_prc->size_);
+}
+
+static OMX_ERRORTYPE
+open_file (fr_prc_t * ap_prc, const char * ap_path, const bool a_use_mmap)
+{
+  struct stat st;
+
+  assert (ap_prc);
+  assert (ap_path);
+  assert (!ap_prc->p_file_);
+
+  if (!(ap_prc->p_file_ = fopen (ap_path, "r")))
+    {
+      TIZ_ERROR (handleOf (ap_prc), "Error opening file from URI (%s)",
+                 strerror (errno));
+      return OMX_ErrorInsufficientResources;
+    }
+
+  ap_prc->size_ = 0;
+  ap_prc->offset_ = 0;
+  ap_prc->readahead_end_ = 0;
+
+  /* Pipes, devices and empty files are just read, without read-ahead
+     hints */
+  if (0 == fstat (fileno (ap_prc->p_file_), &st) && S_ISREG (st.st_mode)
+      && st.st_size > 0 && (uintmax_t) st.st_size <= SIZE_MAX)
+    {
+      ap_prc->size_ = (size_t) st.st_size;
+      (void) posix_fadvise (fileno (ap_prc->p_file_), 0, 0,
+                            POSIX_FADV_SEQUENTIAL);
+      if (a_use_mmap)
+        {
+          map_file (ap_prc);
+        }
+    }
+
+  return OMX_ErrorNone;
+}
+
+static void
+read_ahead (fr_prc_t * ap_prc)
+{
+  const size_t window = ARATELIA_FILE_READER_READAHEAD_WINDOW;
+  assert (ap_prc);
+
+  /* Ask the kernel to start fetching the next window of data once the
+     consumer has gone past half of the current one, so that reads (or page
+     faults) are mostly served from the page cache without blocking on i/o */
+  if (ap_prc->readahead_end_ < ap_prc->size_
+      && ap_prc->offset_ + window / 2 >= ap_prc->readahead_end_)
+    {
+      const size_t page_mask = (size_t) sysconf (_SC_PAGESIZE) - 1;
+      size_t start = ap_prc->offset_ & ~page_mask;
+      size_t end = ap_prc->offset_ + window;
+      if (ap_prc->readahead_end_ > start)
+        {
+          start = ap_prc->readahead_end_ & ~page_mask;
+        }
+      if (end > ap_prc->size_)
+        {
+          end = ap_prc->size_;
+        }
+      if (ap_prc->p_map_)
+        {
+          (void) madvise (ap_prc->p_map_ + start, end - start, MADV_WILLNEED);
+        }
+      else
+        {
+          (void) posix_fadvise (fileno (ap_prc->p_file_), (off_t) start,
+                                (off_t) (end - start), POSIX_FADV_WILLNEED);
+        }
+      ap_prc->readahead_end_ = end;
+    }
 }
 
 static inline void
@@ -80,9 +208,16 @@ reset_stream_parameters (fr_prc_t * ap_prc)
   assert (ap_prc);
   ap_prc->counter_ = 0;
   ap_prc->eos_ = false;
+  ap_prc->offset_ = 0;
+  ap_prc->readahead_end_ = 0;
   if (ap_prc->p_file_)
     {
-      rewind (ap_prc->p_file_);
+      if (!ap_prc->p_map_)
+        {
+          rewind (ap_prc->p_file_);
+        }
+      /* Prime the first window */
+      read_ahead (ap_prc);
     }
 }
 
@@ -129,6 +264,49 @@ obtain_uri (fr_prc_t * ap_prc)
   return rc;
 }
 
+static bool
+map_is_valid (fr_prc_t * ap_prc)
+{
+  struct stat st;
+  assert (ap_prc);
+  assert (ap_prc->p_map_);
+  /* Touching a page of the mapping that is past the end of the file raises
+     SIGBUS; make sure that the file hasn't been truncated */
+  return (0 == fstat (fileno (ap_prc->p_file_), &st)
+          && (uintmax_t) st.st_size >= ap_prc->size_);
+}
+
+static size_t
+copy_from_map (fr_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * p_hdr)
+{
+  size_t bytes_read = 0;
+  assert (ap_prc);
+  assert (ap_prc->p_map_);
+
+  bytes_read = ap_prc->size_ - ap_prc->offset_;
+  if (bytes_read > p_hdr->nAllocLen)
+    {
+      bytes_read = p_hdr->nAllocLen;
+    }
+  memcpy (p_hdr->pBuffer, ap_prc->p_map_ + ap_prc->offset_, bytes_read);
+  ap_prc->offset_ += bytes_read;
+  read_ahead (ap_prc);
+  return bytes_read;
+}
+
+static size_t
+read_from_file (fr_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * p_hdr)
+{
+  size_t bytes_read = 0;
+  assert (ap_prc);
+  assert (ap_prc->p_file_);
+
+  bytes_read = fread (p_hdr->pBuffer, 1, p_hdr->nAllocLen, ap_prc->p_file_);
+  ap_prc->offset_ += bytes_read;
+  read_ahead (ap_prc);
+  return bytes_read;
+}
+
 static OMX_ERRORTYPE
 read_into_buffer (const void * ap_obj, OMX_BUFFERHEADERTYPE * p_hdr)
 {
@@ -138,10 +316,32 @@ read_into_buffer (const void * ap_obj, OMX_BUFFERHEADERTYPE * p_hdr)
   if (p_prc->p_file_ && !(p_prc->eos_))
     {
       int bytes_read = 0;
-      if (!(bytes_read
-            = fread (p_hdr->pBuffer, 1, p_hdr->nAllocLen, p_prc->p_file_)))
+
+      if (p_prc->p_map_ && !map_is_valid (p_prc))
         {
-          if (feof (p_prc->p_file_))
+          TIZ_WARN (handleOf (p_prc),
+                    "File truncated while mapped; continuing with stdio");
+          unmap_file (p_prc);
+          if (0 != fseeko (p_prc->p_file_, (off_t) p_prc->offset_, SEEK_SET))
+            {
+              TIZ_ERROR (handleOf (p_prc), "Unable to seek (%s)",
+                         strerror (errno));
+              return OMX_ErrorInsufficientResources;
+            }
+        }
+
+      if (p_prc->p_map_)
+        {
+          bytes_read = copy_from_map (p_prc, p_hdr);
+        }
+      else
+        {
+          bytes_read = read_from_file (p_prc, p_hdr);
+        }
+
+      if (!bytes_read)
+        {
+          if (p_prc->p_map_ || feof (p_prc->p_file_))
             {
               TIZ_NOTICE (
                 handleOf (p_prc),
@@ -179,6 +379,10 @@ fr_prc_ctor (void * ap_obj, va_list * app)
   fr_prc_t * p_prc = super_ctor (typeOf (ap_obj, "frprc"), ap_obj, app);
   assert (p_prc);
   p_prc->p_file_ = NULL;
+  p_prc->p_map_ = NULL;
+  p_prc->size_ = 0;
+  p_prc->offset_ = 0;
+  p_prc->readahead_end_ = 0;
   p_prc->p_uri_param_ = NULL;
   reset_stream_parameters (p_prc);
   return p_prc;
@@ -204,17 +408,8 @@ fr_prc_allocate_resources (void * ap_obj, OMX_U32 TIZ_UNUSED (a_pid))
   assert (NULL == p_prc->p_file_);
 
   tiz_check_omx (obtain_uri (p_prc));
-
-  if ((p_prc->p_file_
-       = fopen ((const char *) p_prc->p_uri_param_->contentURI, "r"))
-      == 0)
-    {
-      TIZ_ERROR (handleOf (p_prc), "Error opening file from URI (%s)",
-                 strerror (errno));
-      return OMX_ErrorInsufficientResources;
-    }
-
-  return OMX_ErrorNone;
+  return open_file (p_prc, (const char *) p_prc->p_uri_param_->contentURI,
+                    mmap_configured ());
 }
 
 static OMX_ERRORTYPE
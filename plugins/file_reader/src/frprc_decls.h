@@ -34,6 +34,7 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <tizprc_decls.h>
 
@@ -43,6 +44,14 @@ struct fr_prc
   /* Object */
   const tiz_prc_t _;
   FILE * p_file_;
+  /* When the file is memory-mapped, data is copied from here instead of read
+     from p_file_ */
+  OMX_U8 * p_map_;
+  /* Size of a regular file when it was opened (0 for pipes, devices, etc) */
+  size_t size_;
+  /* Current read position, and end of the data requested from the kernel */
+  size_t offset_;
+  size_t readahead_end_;
   OMX_PARAM_CONTENTURITYPE * p_uri_param_;
   OMX_U32 counter_;
   bool eos_;
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_frprc.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Binary file reader's stdio and mmap i/o unit tests
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <check.h>
+
+#include <tizobject_decls.h>
+
+/* The processor is included here (rather than linked) so that the tests can
+ * drive its i/o functions directly */
+#include "frprc.c"
+
+#define FRPRC_TEST_TIMEOUT 60
+#define FRPRC_TEST_FILE "/tmp/check_frprc.bin"
+/* A few read-ahead windows, and not a multiple of the buffer sizes */
+#define FRPRC_TEST_FILE_SIZE (3 * ARATELIA_FILE_READER_READAHEAD_WINDOW + 123)
+#define FRPRC_TEST_PATTERN_PERIOD 251
+
+/* Just enough of an object for handleOf to work */
+static char g_cname[2 * OMX_MAX_STRINGNAME_SIZE];
+static OMX_COMPONENTTYPE g_hdl;
+static tiz_class_t g_class;
+static fr_prc_t g_prc;
+static OMX_U8 * gp_buffer = NULL;
+
+static void
+setup_prc (void)
+{
+  FILE * p_file = NULL;
+  size_t i = 0;
+
+  tiz_mem_set (g_cname, 0, sizeof (g_cname));
+  strncpy (g_cname, "OMX.Aratelia.file_reader.binary",
+           OMX_MAX_STRINGNAME_SIZE);
+  tiz_mem_set (&g_hdl, 0, sizeof (g_hdl));
+  g_hdl.pComponentPrivate = g_cname;
+  tiz_mem_set (&g_class, 0, sizeof (g_class));
+  g_class.hdl = &g_hdl;
+  tiz_mem_set (&g_prc, 0, sizeof (g_prc));
+  *((const tiz_class_t **) &g_prc) = &g_class;
+
+  gp_buffer = tiz_mem_alloc (FRPRC_TEST_FILE_SIZE);
+  fail_if (NULL == gp_buffer);
+  for (i = 0; i < FRPRC_TEST_FILE_SIZE; ++i)
+    {
+      gp_buffer[i] = (OMX_U8) (i % FRPRC_TEST_PATTERN_PERIOD);
+    }
+
+  fail_if (NULL == (p_file = fopen (FRPRC_TEST_FILE, "w")));
+  fail_if (1 != fwrite (gp_buffer, FRPRC_TEST_FILE_SIZE, 1, p_file));
+  fail_if (0 != fclose (p_file));
+}
+
+static void
+teardown_prc (void)
+{
+  close_file (&g_prc);
+  tiz_mem_free (gp_buffer);
+  gp_buffer = NULL;
+  unlink (FRPRC_TEST_FILE);
+}
+
+/* Reads the file until EOS, checking the data against the original. Returns
+ * the number of bytes read. */
+static size_t
+read_to_eos (fr_prc_t * ap_prc, const OMX_U32 a_alloc_len)
+{
+  OMX_BUFFERHEADERTYPE hdr;
+  OMX_U8 * p_data = tiz_mem_alloc (a_alloc_len);
+  size_t total = 0;
+
+  fail_if (NULL == p_data);
+  tiz_mem_set (&hdr, 0, sizeof (hdr));
+  hdr.pBuffer = p_data;
+  hdr.nAllocLen = a_alloc_len;
+
+  while (!(hdr.nFlags & OMX_BUFFERFLAG_EOS))
+    {
+      hdr.nFilledLen = 0;
+      fail_if (OMX_ErrorNone != read_into_buffer (ap_prc, &hdr));
+      fail_if (hdr.nFilledLen > a_alloc_len);
+      fail_if (total + hdr.nFilledLen > FRPRC_TEST_FILE_SIZE);
+      fail_if (0 != memcmp (p_data, gp_buffer + total, hdr.nFilledLen));
+      fail_if (0 == hdr.nFilledLen && !(hdr.nFlags & OMX_BUFFERFLAG_EOS));
+      total += hdr.nFilledLen;
+    }
+
+  fail_if (!ap_prc->eos_);
+  fail_if (total != ap_prc->counter_);
+  tiz_mem_free (p_data);
+  return total;
+}
+
+static void
+check_io_mode (const bool a_use_mmap)
+{
+  const OMX_U32 alloc_lens[] = { 4096, 8191, 65536 };
+  size_t i = 0;
+
+  fail_if (OMX_ErrorNone != open_file (&g_prc, FRPRC_TEST_FILE, a_use_mmap));
+  fail_if (a_use_mmap != (NULL != g_prc.p_map_));
+  fail_if (FRPRC_TEST_FILE_SIZE != g_prc.size_);
+
+  /* Every transfer starts again from the beginning of the file */
+  for (i = 0; i < sizeof (alloc_lens) / sizeof (alloc_lens[0]); ++i)
+    {
+      reset_stream_parameters (&g_prc);
+      fail_if (0 == g_prc.readahead_end_);
+      fail_if (FRPRC_TEST_FILE_SIZE != read_to_eos (&g_prc, alloc_lens[i]));
+      /* The kernel has been asked to read ahead all the way to the end */
+      fail_if (FRPRC_TEST_FILE_SIZE != g_prc.readahead_end_);
+    }
+
+  close_file (&g_prc);
+  fail_if (NULL != g_prc.p_file_);
+  fail_if (NULL != g_prc.p_map_);
+}
+
+START_TEST (test_frprc_stdio)
+{
+  check_io_mode (false);
+}
+END_TEST
+
+START_TEST (test_frprc_mmap)
+{
+  check_io_mode (true);
+}
+END_TEST
+
+START_TEST (test_frprc_mmap_truncated)
+{
+  const size_t new_size = FRPRC_TEST_FILE_SIZE / 2 + 17;
+  OMX_BUFFERHEADERTYPE hdr;
+  OMX_U8 data[4096];
+  size_t total = 0;
+
+  fail_if (OMX_ErrorNone != open_file (&g_prc, FRPRC_TEST_FILE, true));
+  fail_if (NULL == g_prc.p_map_);
+  reset_stream_parameters (&g_prc);
+
+  tiz_mem_set (&hdr, 0, sizeof (hdr));
+  hdr.pBuffer = data;
+  hdr.nAllocLen = sizeof (data);
+  while (total < FRPRC_TEST_FILE_SIZE / 4)
+    {
+      fail_if (OMX_ErrorNone != read_into_buffer (&g_prc, &hdr));
+      total += hdr.nFilledLen;
+    }
+
+  /* Reading past the new end of the file through the mapping would raise
+     SIGBUS; the reader must notice and carry on with stdio */
+  fail_if (0 != truncate (FRPRC_TEST_FILE, new_size));
+  while (!(hdr.nFlags & OMX_BUFFERFLAG_EOS))
+    {
+      hdr.nFilledLen = 0;
+      fail_if (OMX_ErrorNone != read_into_buffer (&g_prc, &hdr));
+      fail_if (0 != memcmp (data, gp_buffer + total, hdr.nFilledLen));
+      total += hdr.nFilledLen;
+    }
+
+  fail_if (NULL != g_prc.p_map_);
+  fail_if (new_size != total);
+}
+END_TEST
+
+START_TEST (test_frprc_non_regular_file)
+{
+  OMX_BUFFERHEADERTYPE hdr;
+  OMX_U8 data[64];
+
+  /* Devices are never mapped, and get no read-ahead hints */
+  fail_if (OMX_ErrorNone != open_file (&g_prc, "/dev/null", true));
+  fail_if (NULL != g_prc.p_map_);
+  fail_if (0 != g_prc.size_);
+  reset_stream_parameters (&g_prc);
+  fail_if (0 != g_prc.readahead_end_);
+
+  tiz_mem_set (&hdr, 0, sizeof (hdr));
+  hdr.pBuffer = data;
+  hdr.nAllocLen = sizeof (data);
+  fail_if (OMX_ErrorNone != read_into_buffer (&g_prc, &hdr));
+  fail_if (0 != hdr.nFilledLen);
+  fail_if (!(hdr.nFlags & OMX_BUFFERFLAG_EOS));
+}
+END_TEST
+
+Suite *
+frprc_suite (void)
+{
+  TCase * tc_io;
+  Suite * s = suite_create ("file_reader");
+
+  /* test case */
+  tc_io = tcase_create ("stdio and mmap i/o");
+  tcase_set_timeout (tc_io, FRPRC_TEST_TIMEOUT);
+  tcase_add_checked_fixture (tc_io, setup_prc, teardown_prc);
+  tcase_add_test (tc_io, test_frprc_stdio);
+  tcase_add_test (tc_io, test_frprc_mmap);
+  tcase_add_test (tc_io, test_frprc_mmap_truncated);
+  tcase_add_test (tc_io, test_frprc_non_regular_file);
+  suite_add_tcase (s, tc_io);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed = 0;
+  SRunner * sr = srunner_create (frprc_suite ());
+  srunner_set_log (sr, "-");
+  srunner_run_all (sr, CK_VERBOSE);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
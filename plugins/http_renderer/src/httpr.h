@@ -58,6 +58,11 @@ extern "C" {
 #define ICE_MAX_BURST_SIZE 4200    /* Not used for now */
 #define ICE_LISTENER_BUF_SIZE \
   (ICE_MAX_BURST_SIZE + OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE)
+#define ICE_MIN_RING_SIZE (512 * 1024) /* Must be a power of two */
+#define ICE_MAX_LISTENER_OVERRUNS 3
+#define ICE_MAX_IOVECS 8
+#define ICE_ZEROCOPY_MIN_BYTES (16 * 1024)
+#define ICE_MAX_ZEROCOPY_SENDS 64
 
 #define ICE_SOCK_ERROR (int) -1
 
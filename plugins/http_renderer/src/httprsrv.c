@@ -23,9 +23,10 @@
  *
  * @brief Tizonia - HTTP renderer's networking functions
  *
- * NOTE: This is work in progress!!!!
- *
- * TODO: Better flow control
+ * The encoded stream is copied once into a ring that is shared by all the
+ * connected listeners. Each listener reads from the ring at its own pace;
+ * listeners that fall too far behind skip ahead, and are dropped if they keep
+ * falling behind.
  *
  */
 
@@ -46,6 +47,7 @@
 #include <errno.h>
 #include <time.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 
 #include <tizplatform.h>
 #include <tizutils.h>
@@ -60,6 +62,13 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.http_renderer.prc.net"
 #endif
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#include <linux/errqueue.h>
+#define HTTPR_ZEROCOPY_ENABLED
+#else
+#define MSG_ZEROCOPY 0
+#endif
+
 #ifdef INET6_ADDRSTRLEN
 #define ICE_RENDERER_MAX_ADDR_LEN INET6_ADDRSTRLEN
 #else
@@ -70,6 +79,8 @@ typedef struct httpr_connection httpr_connection_t;
 typedef struct httpr_listener httpr_listener_t;
 typedef struct httpr_listener_buffer httpr_listener_buffer_t;
 typedef struct httpr_mount httpr_mount_t;
+typedef struct httpr_ring httpr_ring_t;
+typedef struct httpr_iov httpr_iov_t;
 
 struct httpr_listener_buffer
 {
@@ -79,6 +90,30 @@ struct httpr_listener_buffer
   char * p_data;
 };
 
+/* The encoded stream is stored once, in a ring shared by all listeners. 'head'
+ * is the total number of bytes ever written to the ring; each listener keeps
+ * its own read position in the same units, so the bytes still available to a
+ * listener are 'head - pos', and the listener has been overrun if 'pos' falls
+ * behind 'head - size'. */
+struct httpr_ring
+{
+  OMX_U8 * p_data;
+  size_t size; /* Always a power of two */
+  uint64_t head;
+};
+
+/* The io vectors of a single sendmsg call */
+struct httpr_iov
+{
+  struct iovec vec[ICE_MAX_IOVECS];
+  int count;
+  size_t total;
+  int metadata_idx;      /* Index of the metadata block, or -1 */
+  bool new_metadata;     /* The metadata block was prepared for this send */
+  uint64_t next_metadata; /* The listener's state before the block was */
+  bool metadata_delivered; /* prepared, in case it needs to be undone */
+};
+
 struct httpr_mount
 {
   OMX_U8 mount_name[OMX_MAX_STRINGNAME_SIZE];
@@ -106,7 +141,6 @@ struct httpr_connection
   char * p_ip;
   unsigned short port;
   tiz_event_io_t * p_ev_io;
-  tiz_event_timer_t * p_ev_timer;
 };
 
 struct httpr_listener
@@ -115,12 +149,20 @@ struct httpr_listener
   httpr_connection_t * p_con;
   int respcode;
   long intro_offset;
-  unsigned long pos;
+  uint64_t pos;           /* Read position in the server's ring */
+  uint64_t next_metadata; /* Value of 'sent_total' at which the next ICY
+                             metadata block is due (0: no metadata) */
+  OMX_U32 overruns;
   httpr_listener_buffer_t buf;
   tiz_http_parser_t * p_parser;
   bool need_response;
-  bool timer_started;
+  bool blocked; /* Waiting for the socket to become writable */
   bool want_metadata;
+  bool failed; /* To be removed at the next opportunity */
+  bool zerocopy; /* MSG_ZEROCOPY may be used on this socket */
+  uint32_t zc_next; /* Id that the kernel will give to the next zerocopy send */
+  uint32_t zc_done; /* All the zerocopy sends before this one have completed */
+  uint64_t zc_pos[ICE_MAX_ZEROCOPY_SENDS]; /* Ring position of each send */
 };
 
 struct httpr_server
@@ -129,9 +171,11 @@ struct httpr_server
   int lstn_sockfd;
   char * p_ip;
   tiz_event_io_t * p_srv_ev_io;
-  OMX_U32 max_clients; /* In future, more than one will be allowed;
-                          only one allowed at the moment. */
+  OMX_U32 max_clients;
   tiz_map_t * p_lstnrs;
+  httpr_ring_t ring;
+  tiz_event_timer_t * p_ev_timer;
+  bool timer_started;
   OMX_BUFFERHEADERTYPE * p_hdr;
   httpr_srv_release_buffer_f pf_release_buf;
   httpr_srv_acquire_buffer_f pf_acquire_buf;
@@ -216,15 +260,71 @@ srv_get_listeners_count (const httpr_server_t * ap_server)
   return rc;
 }
 
-static httpr_listener_t *
-srv_get_first_listener (const httpr_server_t * ap_server)
+static inline OMX_U32
+srv_get_max_clients (const httpr_server_t * ap_server)
 {
-  httpr_listener_t * p_lstnr = NULL;
-  if (srv_get_listeners_count (ap_server) > 0)
+  OMX_U32 max_clients = ap_server->max_clients;
+  /* The mountpoint may restrict the server's limit further */
+  if (ap_server->mountpoint.max_clients > 0
+      && ap_server->mountpoint.max_clients < max_clients)
     {
-      p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, 0);
+      max_clients = ap_server->mountpoint.max_clients;
     }
-  return p_lstnr;
+  return max_clients;
+}
+
+static inline uint64_t
+srv_ring_tail (const httpr_ring_t * ap_ring)
+{
+  return ap_ring->head > ap_ring->size ? ap_ring->head - ap_ring->size : 0;
+}
+
+static inline size_t
+srv_ring_used (const httpr_ring_t * ap_ring)
+{
+  return (size_t) (ap_ring->head - srv_ring_tail (ap_ring));
+}
+
+static void
+srv_ring_write (httpr_ring_t * ap_ring, const OMX_U8 * ap_data, size_t a_len)
+{
+  assert (ap_ring);
+  assert (ap_ring->p_data);
+  assert (ap_data);
+
+  while (a_len > 0)
+    {
+      const size_t offset = ap_ring->head & (ap_ring->size - 1);
+      const size_t chunk = MIN (a_len, ap_ring->size - offset);
+      memcpy (ap_ring->p_data + offset, ap_data, chunk);
+      ap_ring->head += chunk;
+      ap_data += chunk;
+      a_len -= chunk;
+    }
+}
+
+static OMX_ERRORTYPE
+srv_ring_alloc (httpr_ring_t * ap_ring, const size_t a_min_size)
+{
+  size_t size = ICE_MIN_RING_SIZE;
+
+  assert (ap_ring);
+
+  while (size < a_min_size)
+    {
+      size <<= 1;
+    }
+
+  if (size > ap_ring->size)
+    {
+      OMX_U8 * p_data = tiz_mem_alloc (size);
+      tiz_check_null_ret_oom (p_data);
+      tiz_mem_free (ap_ring->p_data);
+      ap_ring->p_data = p_data;
+      ap_ring->size = size;
+    }
+  ap_ring->head = 0;
+  return OMX_ErrorNone;
 }
 
 static int
@@ -256,6 +356,16 @@ srv_set_nolinger (const int sock)
                      sizeof (struct linger));
 }
 
+static inline int
+srv_set_abortive_close (const int sock)
+{
+  struct linger lin = {1, 0};
+  errno = 0;
+  /* close will reset the connection, and discard any data still queued */
+  return setsockopt (sock, SOL_SOCKET, SO_LINGER, (void *) &lin,
+                     sizeof (struct linger));
+}
+
 static inline int
 srv_set_nodelay (const int sock)
 {
@@ -473,35 +583,41 @@ srv_stop_listener_io_watcher (httpr_listener_t * ap_lstnr)
                                   ap_lstnr->p_con->p_ev_io);
 }
 
+static void
+srv_block_listener (httpr_listener_t * ap_lstnr)
+{
+  assert (ap_lstnr);
+  /* The listener will be serviced again when its socket becomes writable */
+  ap_lstnr->blocked = true;
+  (void) srv_start_listener_io_watcher (ap_lstnr);
+}
+
+/* A single timer paces all the listeners: on every tick, each listener is
+ * allowed to send another 'burst_size' bytes. */
 static OMX_ERRORTYPE
-srv_start_listener_timer_watcher (httpr_listener_t * ap_lstnr,
-                                  const double a_wait_time)
+srv_start_timer_watcher (httpr_server_t * ap_server)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
-  assert (ap_lstnr);
-  if (!ap_lstnr->timer_started)
+  assert (ap_server);
+  if (!ap_server->timer_started)
     {
-      assert (ap_lstnr->p_server);
-      assert (ap_lstnr->p_con);
       tiz_check_omx (tiz_srv_timer_watcher_start (
-        ap_lstnr->p_server->p_parent, ap_lstnr->p_con->p_ev_timer, a_wait_time,
-        a_wait_time));
-      ap_lstnr->timer_started = true;
+        ap_server->p_parent, ap_server->p_ev_timer, ap_server->wait_time,
+        ap_server->wait_time));
+      ap_server->timer_started = true;
     }
   return rc;
 }
 
 static void
-srv_stop_listener_timer_watcher (httpr_listener_t * ap_lstnr)
+srv_stop_timer_watcher (httpr_server_t * ap_server)
 {
-  assert (ap_lstnr);
-  if (ap_lstnr->timer_started)
+  assert (ap_server);
+  if (ap_server->timer_started)
     {
-      assert (ap_lstnr->p_server);
-      assert (ap_lstnr->p_con);
-      (void) tiz_srv_timer_watcher_stop (ap_lstnr->p_server->p_parent,
-                                         ap_lstnr->p_con->p_ev_timer);
-      ap_lstnr->timer_started = false;
+      (void) tiz_srv_timer_watcher_stop (ap_server->p_parent,
+                                         ap_server->p_ev_timer);
+      ap_server->timer_started = false;
     }
 }
 
@@ -519,8 +635,6 @@ srv_destroy_connection (httpr_connection_t * ap_con)
       assert (ap_con->p_lstnr && ap_con->p_lstnr->p_server);
       tiz_srv_io_watcher_destroy (ap_con->p_lstnr->p_server->p_parent,
                                   ap_con->p_ev_io);
-      tiz_srv_timer_watcher_destroy (ap_con->p_lstnr->p_server->p_parent,
-                                     ap_con->p_ev_timer);
       tiz_mem_free (ap_con);
     }
 }
@@ -530,7 +644,6 @@ srv_destroy_listener (httpr_listener_t * ap_lstnr)
 {
   if (ap_lstnr)
     {
-      srv_stop_listener_timer_watcher (ap_lstnr);
       if (ap_lstnr->p_parser)
         {
           tiz_http_parser_destroy (ap_lstnr->p_parser);
@@ -562,6 +675,11 @@ srv_remove_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
   /* NOTE: No need to call srv_destroy_listener as this has been called already
    * by
    * the map's listeners_map_free_func */
+
+  if (0 == srv_get_listeners_count (ap_server))
+    {
+      srv_stop_timer_watcher (ap_server);
+    }
 }
 
 static httpr_connection_t *
@@ -593,7 +711,6 @@ srv_create_connection (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
   p_con->p_ip = ap_ip;
   p_con->port = ap_port;
   p_con->p_ev_io = NULL;
-  p_con->p_ev_timer = NULL;
 
   /* We are interested in knowing when a listener socket is available for
    * writing */
@@ -601,9 +718,6 @@ srv_create_connection (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
                                 p_con->sockfd, TIZ_EVENT_WRITE, true);
   goto_end_on_omx_error (rc, p_hdl, "Unable to init the client's io event");
 
-  rc = tiz_srv_timer_watcher_init (ap_server->p_parent, &(p_con->p_ev_timer));
-  goto_end_on_omx_error (rc, p_hdl, "Unable to init the client's timer event");
-
 end:
   if (OMX_ErrorNone != rc)
     {
@@ -614,6 +728,29 @@ end:
   return p_con;
 }
 
+static inline uint32_t
+srv_get_zerocopy_pending (const httpr_listener_t * ap_lstnr)
+{
+  return ap_lstnr->zc_next - ap_lstnr->zc_done;
+}
+
+static void
+srv_enable_zerocopy (httpr_listener_t * ap_lstnr)
+{
+  assert (ap_lstnr);
+  assert (ap_lstnr->p_con);
+#ifdef HTTPR_ZEROCOPY_ENABLED
+  {
+    int one = 1;
+    ap_lstnr->zerocopy
+      = (0 == setsockopt (ap_lstnr->p_con->sockfd, SOL_SOCKET, SO_ZEROCOPY,
+                          (void *) &one, sizeof (one)));
+  }
+#else
+  ap_lstnr->zerocopy = false;
+#endif
+}
+
 static OMX_ERRORTYPE
 srv_create_listener (httpr_server_t * ap_server, httpr_listener_t ** app_lstnr,
                      const int a_connected_sockfd, char * ap_ip,
@@ -645,13 +782,19 @@ srv_create_listener (httpr_server_t * ap_server, httpr_listener_t ** app_lstnr,
   p_lstnr->respcode = 200;
   p_lstnr->intro_offset = 0;
   p_lstnr->pos = 0;
+  p_lstnr->next_metadata = 0;
+  p_lstnr->overruns = 0;
   p_lstnr->buf.len = ICE_LISTENER_BUF_SIZE;
   p_lstnr->buf.metadata_offset = 0;
   p_lstnr->buf.metadata_bytes = 0;
   p_lstnr->p_parser = NULL;
   p_lstnr->need_response = true;
-  p_lstnr->timer_started = false;
+  p_lstnr->blocked = false;
   p_lstnr->want_metadata = false;
+  p_lstnr->failed = false;
+  p_lstnr->zerocopy = false;
+  p_lstnr->zc_next = 0;
+  p_lstnr->zc_done = 0;
 
   p_lstnr->buf.p_data = (char *) tiz_mem_alloc (ICE_LISTENER_BUF_SIZE);
   rc = p_lstnr->buf.p_data ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
@@ -669,6 +812,8 @@ srv_create_listener (httpr_server_t * ap_server, httpr_listener_t ** app_lstnr,
   rc = sockrc < 0 ? OMX_ErrorInsufficientResources : OMX_ErrorNone;
   goto_end_on_socket_error (sockrc, p_hdl, strerror (errno));
 
+  srv_enable_zerocopy (p_lstnr);
+
   rc = OMX_ErrorNone;
 
 end:
@@ -741,6 +886,11 @@ srv_build_http_negative_response (char * ap_buf, size_t len, int status,
           statusmsg = "Internal Server Error";
         }
         break;
+      case 503:
+        {
+          statusmsg = "Service Unavailable";
+        }
+        break;
       default:
         {
           statusmsg = "(unknown status code)";
@@ -927,8 +1077,9 @@ srv_handle_listeners_request (httpr_server_t * ap_server,
   assert (ap_lstnr->p_con);
   assert (ap_lstnr->p_parser);
 
-  some_error = (srv_get_listeners_count (ap_server) > ap_server->max_clients);
-  bail_on_request_error (some_error, 400, "Client limit reached");
+  some_error
+    = (srv_get_listeners_count (ap_server) > srv_get_max_clients (ap_server));
+  bail_on_request_error (some_error, 503, "Client limit reached");
 
   /*   some_error */
   /*       = (ap_lstnr->p_con->con_time + ICE_DEFAULT_HEADER_TIMEOUT <= time
@@ -990,117 +1141,219 @@ end:
   return rc;
 }
 
-static OMX_S32
-srv_remove_existing_listener (OMX_PTR ap_key, OMX_PTR ap_value, OMX_PTR ap_arg)
+static void
+srv_attach_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
 {
-  httpr_server_t * p_server = ap_arg;
-  httpr_listener_t * p_lstnr = NULL;
-
-  assert (p_server);
-  assert (ap_key);
-  assert (ap_value);
+  const httpr_ring_t * p_ring = NULL;
+  httpr_connection_t * p_con = NULL;
+  uint64_t burst = 0;
 
-  p_lstnr = (httpr_listener_t *) ap_value;
+  assert (ap_server);
+  assert (ap_lstnr);
+  assert (ap_lstnr->p_con);
 
-  srv_remove_listener (p_server, p_lstnr);
+  p_ring = &ap_server->ring;
+  p_con = ap_lstnr->p_con;
 
-  return 0;
+  /* Serve the initial burst from the data that is already in the ring, if
+   * any, so that the new listener doesn't need to pull the encoder ahead of
+   * the other listeners. */
+  if (p_con->initial_burst_bytes > 0)
+    {
+      burst = MIN ((uint64_t) p_con->initial_burst_bytes,
+                   (uint64_t) srv_ring_used (p_ring));
+    }
+  ap_lstnr->pos = p_ring->head - burst;
+  ap_lstnr->next_metadata
+    = (ap_lstnr->want_metadata && ap_server->mountpoint.metadata_period > 0)
+        ? ap_server->mountpoint.metadata_period
+        : 0;
 }
 
-inline static void
-srv_release_empty_buffer (httpr_server_t * ap_server,
-                          httpr_listener_t * ap_lstnr,
-                          OMX_BUFFERHEADERTYPE ** app_hdr)
+/* Reads the kernel's completion notifications for this listener's zerocopy
+ * sends from the socket's error queue */
+static void
+srv_reap_zerocopy (httpr_listener_t * ap_lstnr)
 {
-  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
-
-  assert (ap_server);
   assert (ap_lstnr);
-  assert (app_hdr);
+  assert (ap_lstnr->p_con);
+#ifdef HTTPR_ZEROCOPY_ENABLED
+  while (srv_get_zerocopy_pending (ap_lstnr) > 0)
+    {
+      char control[128];
+      struct msghdr msg;
+      struct cmsghdr * p_cm = NULL;
 
-  p_hdr = *app_hdr;
+      tiz_mem_set (&msg, 0, sizeof (msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof (control);
 
-  ap_lstnr->pos = 0;
-  p_hdr->nFilledLen = 0;
-  ap_server->pf_release_buf (p_hdr, ap_server->p_arg);
-  *app_hdr = NULL;
-  ap_server->p_hdr = NULL;
+      if (recvmsg (ap_lstnr->p_con->sockfd, &msg, MSG_ERRQUEUE) < 0)
+        {
+          /* Nothing else in the queue */
+          break;
+        }
+
+      for (p_cm = CMSG_FIRSTHDR (&msg); p_cm; p_cm = CMSG_NXTHDR (&msg, p_cm))
+        {
+          const struct sock_extended_err * p_err
+            = (const struct sock_extended_err *) CMSG_DATA (p_cm);
+          if (!((IPPROTO_IP == p_cm->cmsg_level
+                 && IP_RECVERR == p_cm->cmsg_type)
+                || (IPPROTO_IPV6 == p_cm->cmsg_level
+                    && IPV6_RECVERR == p_cm->cmsg_type))
+              || 0 != p_err->ee_errno
+              || SO_EE_ORIGIN_ZEROCOPY != p_err->ee_origin)
+            {
+              continue;
+            }
+
+          /* Each notification covers the range of sends [ee_info, ee_data] */
+          if ((int32_t) (p_err->ee_data + 1 - ap_lstnr->zc_done) > 0)
+            {
+              ap_lstnr->zc_done = p_err->ee_data + 1;
+            }
+
+          if (p_err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+            {
+              /* The kernel had to copy the data anyway (e.g. the loopback
+               * device); zerocopy only adds overhead on this socket */
+              ap_lstnr->zerocopy = false;
+            }
+        }
+    }
+#endif
 }
 
-static bool
-srv_is_listener_ready (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+/* The kernel reads the data of a zerocopy send straight from the ring until
+ * the send completes. A listener with a send still pending when that part of
+ * the ring is about to be overwritten has not acknowledged anything for a
+ * whole ring's worth of audio, and its connection is reset. */
+static OMX_ERRORTYPE
+srv_drop_zerocopy_laggards (httpr_server_t * ap_server,
+                            httpr_listener_t * ap_current,
+                            const uint64_t a_new_head)
 {
-  bool lstnr_ready = true;
-  OMX_HANDLETYPE p_hdl = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  const httpr_ring_t * p_ring = NULL;
+  OMX_S32 i = 0;
+
   assert (ap_server);
-  assert (ap_lstnr);
-  p_hdl = handleOf (ap_server->p_parent);
 
-  if (ap_lstnr->need_response)
+  p_ring = &ap_server->ring;
+
+  if (a_new_head <= p_ring->size)
     {
-      OMX_ERRORTYPE rc = OMX_ErrorNone;
-      if (OMX_ErrorNone
-          != (rc = srv_handle_listeners_request (ap_server, ap_lstnr)))
+      return OMX_ErrorNone;
+    }
+
+  for (i = 0; i < srv_get_listeners_count (ap_server); ++i)
+    {
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+
+      if (0 == srv_get_zerocopy_pending (p_lstnr) || p_lstnr->failed)
         {
-          if (OMX_ErrorNotReady == rc)
-            {
-              TIZ_ERROR (p_hdl, "no data yet lets wait some time ");
-              (void) srv_start_listener_io_watcher (ap_lstnr);
-            }
-          else
+          continue;
+        }
+
+      srv_reap_zerocopy (p_lstnr);
+
+      if (srv_get_zerocopy_pending (p_lstnr) > 0
+          && p_lstnr->zc_pos[p_lstnr->zc_done % ICE_MAX_ZEROCOPY_SENDS]
+               < a_new_head - p_ring->size)
+        {
+          TIZ_NOTICE (handleOf (ap_server->p_parent),
+                      "Client [%s:%u] has [%u] zerocopy sends pending - "
+                      "dropping",
+                      p_lstnr->p_con->p_ip, p_lstnr->p_con->port,
+                      srv_get_zerocopy_pending (p_lstnr));
+          /* Make sure that close discards anything still queued */
+          (void) srv_set_abortive_close (p_lstnr->p_con->sockfd);
+          /* Listeners are removed later, as the caller may be iterating
+           * over the listeners map */
+          p_lstnr->failed = true;
+          if (p_lstnr == ap_current)
             {
-              TIZ_ERROR (p_hdl,
-                         "[%s] : while handling the "
-                         "listener's initial request. Will remove the listener",
-                         tiz_err_to_str (rc));
-              srv_remove_listener (ap_server, ap_lstnr);
+              rc = OMX_ErrorNoMore;
             }
-          lstnr_ready = false;
         }
     }
-  return lstnr_ready;
+
+  return rc;
 }
 
-static inline bool
-srv_is_time_to_send_metadata (httpr_server_t * ap_server,
-                              httpr_listener_t * ap_lstnr)
+static void
+srv_remove_failed_listeners (httpr_server_t * ap_server)
 {
-  if (ap_lstnr->p_con->sent_total == 0)
+  OMX_S32 i = 0;
+  assert (ap_server);
+  for (i = srv_get_listeners_count (ap_server) - 1; i >= 0; --i)
+    {
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+      if (p_lstnr->failed)
+        {
+          srv_remove_listener (ap_server, p_lstnr);
+        }
+    }
+}
+
+static OMX_ERRORTYPE
+srv_fill_ring (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
+
+  assert (ap_server);
+
+  if (NULL == (p_hdr = ap_server->pf_acquire_buf (ap_server->p_arg)))
     {
-      return false;
+      /* no more buffers available at the moment */
+      ap_server->need_more_data = true;
+      return OMX_ErrorNotReady;
     }
 
-  if (((ap_lstnr->p_con->sent_total + ap_server->burst_size)
-       % ap_server->mountpoint.metadata_period)
-      <= ap_server->burst_size)
+  ap_server->need_more_data = false;
+  ap_server->p_hdr = p_hdr;
+
+  /* The whole buffer is copied into the ring, and returned straight away.
+   * The encoder never waits for a particular listener. */
+  if (p_hdr->pBuffer && p_hdr->nFilledLen > 0)
     {
-      return true;
+      rc = srv_drop_zerocopy_laggards (ap_server, ap_lstnr,
+                                       ap_server->ring.head
+                                         + p_hdr->nFilledLen);
+      srv_ring_write (&ap_server->ring, p_hdr->pBuffer + p_hdr->nOffset,
+                      p_hdr->nFilledLen);
     }
 
-  return false;
+  p_hdr->nFilledLen = 0;
+  ap_server->pf_release_buf (p_hdr, ap_server->p_arg);
+  ap_server->p_hdr = NULL;
+
+  return rc;
 }
 
 static inline size_t
-srv_get_metadata_offset (const httpr_server_t * ap_server,
+srv_get_burst_allowance (const httpr_server_t * ap_server,
                          const httpr_listener_t * ap_lstnr)
 {
-  size_t offset = 0;
-  if (ap_lstnr->p_con->sent_total != 0)
+  const httpr_connection_t * p_con = ap_lstnr->p_con;
+  if (p_con->initial_burst_bytes > 0)
     {
-      offset = (ap_server->mountpoint.metadata_period
-                * ((ap_lstnr->p_con->sent_total + ap_server->burst_size)
-                   / ap_server->mountpoint.metadata_period))
-               - ap_lstnr->p_con->sent_total;
+      return p_con->initial_burst_bytes;
     }
-
-  return offset;
+  return (p_con->burst_bytes < ap_server->burst_size
+            ? ap_server->burst_size - p_con->burst_bytes
+            : 0);
 }
 
 static inline size_t
 srv_get_metadata_length (const httpr_server_t * ap_server,
                          const httpr_listener_t * ap_lstnr)
 {
-  if (ap_lstnr->p_con->sent_total == 0 || ap_lstnr->p_con->metadata_delivered)
+  if (ap_lstnr->p_con->metadata_delivered)
     {
       return 0;
     }
@@ -1110,149 +1363,237 @@ srv_get_metadata_length (const httpr_server_t * ap_server,
 }
 
 static void
-srv_arrange_metadata (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
-                      OMX_U8 ** app_buffer, size_t * ap_len)
+srv_prepare_metadata (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
 {
-  size_t len = 0;
   httpr_listener_buffer_t * p_lstnr_buf = NULL;
+  size_t metadata_len = 0;
+  size_t metadata_byte = 0;
 
   assert (ap_server);
   assert (ap_lstnr);
-  assert (app_buffer);
-  assert (ap_len);
 
-  len = *ap_len;
   p_lstnr_buf = &ap_lstnr->buf;
-
-  if (0 == len || !ap_lstnr->want_metadata
-      || 0 == ap_server->mountpoint.metadata_period
-      || !srv_is_time_to_send_metadata (ap_server, ap_lstnr))
+  metadata_len = srv_get_metadata_length (ap_server, ap_lstnr);
+
+  /* The metadata block is a length byte (in units of 16 bytes), followed by
+   * the zero-padded stream title. The title is only sent once; after that,
+   * empty blocks are sent until the title changes. */
+  metadata_byte = (metadata_len + 15) / 16;
+  p_lstnr_buf->metadata_bytes = (metadata_byte * 16) + 1;
+  p_lstnr_buf->metadata_offset = 0;
+  assert (p_lstnr_buf->metadata_bytes <= ICE_LISTENER_BUF_SIZE);
+
+  tiz_mem_set (p_lstnr_buf->p_data, 0, p_lstnr_buf->metadata_bytes);
+  p_lstnr_buf->p_data[0] = (char) metadata_byte;
+  if (metadata_len > 0)
     {
-      /* p_lstnr_buf->metadata_bytes = 0; */
-      return;
+      memcpy (p_lstnr_buf->p_data + 1, ap_server->mountpoint.stream_title,
+              metadata_len);
+      ap_lstnr->p_con->metadata_delivered = true;
     }
 
-  {
-    OMX_U8 * p_buffer = *app_buffer;
-    size_t metadata_offset = srv_get_metadata_offset (ap_server, ap_lstnr);
+  ap_lstnr->next_metadata += ap_server->mountpoint.metadata_period;
+}
 
-    if (metadata_offset < len && 0 == p_lstnr_buf->metadata_bytes)
-      {
-        OMX_U8 * p_dest = NULL;
-        OMX_U8 * p_src = NULL;
-        size_t metadata_len = srv_get_metadata_length (ap_server, ap_lstnr);
-        size_t metadata_total = 0;
-        size_t metadata_byte = 0;
-
-        if (metadata_len > 0)
-          {
-            metadata_byte = metadata_len / 16;
-            if (metadata_len % 16)
-              {
-                metadata_byte++;
-              }
-          }
-        else
-          {
-            metadata_byte = 0;
-          }
-
-        metadata_total = (metadata_byte * 16) + 1;
-        p_dest = p_buffer + metadata_offset + metadata_total;
-        p_src = p_buffer + metadata_offset;
-
-        /* Move content to make space for the metadata */
-        memmove (p_dest, p_src, len - metadata_offset);
-
-        p_lstnr_buf->metadata_bytes += metadata_total;
-        p_lstnr_buf->metadata_offset += metadata_offset;
-
-        if (metadata_len)
-          {
-            snprintf ((char *) p_src, metadata_total, "%c%s",
-                      (int) metadata_byte,
-                      (char *) ap_server->mountpoint.stream_title);
-            ap_lstnr->p_con->metadata_delivered = true;
-          }
-        else
-          {
-            p_src[0] = metadata_byte;
-          }
-
-        len += metadata_total;
-        p_lstnr_buf->len = len;
-
-        *ap_len = len;
-        *app_buffer = p_buffer;
-      }
-  }
+static inline void
+srv_add_iov (httpr_iov_t * ap_iov, void * ap_base, const size_t a_len,
+             const bool a_is_metadata)
+{
+  assert (ap_iov->count < ICE_MAX_IOVECS);
+  if (a_is_metadata)
+    {
+      ap_iov->metadata_idx = ap_iov->count;
+    }
+  ap_iov->vec[ap_iov->count].iov_base = ap_base;
+  ap_iov->vec[ap_iov->count].iov_len = a_len;
+  ap_iov->count++;
+  ap_iov->total += a_len;
 }
 
+/* Gathers everything that can be sent to a listener in one go: any pending
+ * ICY metadata, followed by ring data up to the listener's allowance, with a
+ * new metadata block at the next interval boundary. Nothing is copied, the
+ * io vectors point straight into the ring and the listener's metadata
+ * buffer. */
 static void
-srv_arrange_data (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
-                  OMX_U8 ** app_buffer, size_t * ap_len)
+srv_gather (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
+            size_t a_allowance, httpr_iov_t * ap_iov)
 {
-  OMX_U8 * p_buffer = NULL;
-  size_t len = 0;
-  httpr_listener_buffer_t * p_lstnr_buf = NULL;
-  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
+  const httpr_ring_t * p_ring = NULL;
+  httpr_listener_buffer_t * p_buf = NULL;
+  httpr_connection_t * p_con = NULL;
+  uint64_t pos = 0;
+  uint64_t sent = 0;
+  bool ring_only = false;
 
   assert (ap_server);
   assert (ap_lstnr);
-  assert (app_buffer);
-  assert (ap_len);
+  assert (ap_iov);
 
-  p_lstnr_buf = &ap_lstnr->buf;
-  p_hdr = ap_server->p_hdr;
+  p_ring = &ap_server->ring;
+  p_buf = &ap_lstnr->buf;
+  p_con = ap_lstnr->p_con;
+  pos = ap_lstnr->pos;
+  sent = p_con->sent_total;
+
+  ap_iov->count = 0;
+  ap_iov->total = 0;
+  ap_iov->metadata_idx = -1;
+  ap_iov->new_metadata = false;
+
+  /* Large bursts are sent with MSG_ZEROCOPY when possible. The metadata
+   * buffer is rewritten at every interval, so it can't be part of those; in
+   * that case, metadata and ring data go in separate sends. */
+  ring_only = (ap_lstnr->zerocopy && a_allowance >= ICE_ZEROCOPY_MIN_BYTES);
 
-  if (p_hdr && p_hdr->pBuffer && p_hdr->nFilledLen > 0)
+  if (p_buf->metadata_bytes > 0)
     {
-      int to_copy = 0;
-      if (ap_server->burst_size > p_lstnr_buf->len)
+      srv_add_iov (ap_iov, p_buf->p_data + p_buf->metadata_offset,
+                   p_buf->metadata_bytes, true);
+      if (ring_only)
         {
-          to_copy = ap_server->burst_size - p_lstnr_buf->len;
+          return;
+        }
+    }
+
+  while (a_allowance > 0 && pos < p_ring->head
+         && ap_iov->count < ICE_MAX_IOVECS)
+    {
+      size_t len = 0;
+
+      if (ap_lstnr->next_metadata > 0 && sent == ap_lstnr->next_metadata)
+        {
+          if (ap_iov->metadata_idx >= 0 || (ring_only && ap_iov->count > 0))
+            {
+              /* There is only one metadata buffer per listener */
+              break;
+            }
+          /* Keep what's needed to undo this if the block isn't sent */
+          ap_iov->next_metadata = ap_lstnr->next_metadata;
+          ap_iov->metadata_delivered = p_con->metadata_delivered;
+          ap_iov->new_metadata = true;
+          srv_prepare_metadata (ap_server, ap_lstnr);
+          srv_add_iov (ap_iov, p_buf->p_data, p_buf->metadata_bytes, true);
+          if (ring_only)
+            {
+              break;
+            }
+          continue;
         }
-      if (to_copy > p_hdr->nFilledLen)
+
+      len = MIN ((uint64_t) a_allowance, p_ring->head - pos);
+      len = MIN (len, p_ring->size - (pos & (p_ring->size - 1)));
+      if (ap_lstnr->next_metadata > 0)
         {
-          to_copy = p_hdr->nFilledLen;
+          len = MIN ((uint64_t) len, ap_lstnr->next_metadata - sent);
         }
-      memcpy (p_lstnr_buf->p_data + p_lstnr_buf->len,
-              p_hdr->pBuffer + p_hdr->nOffset, to_copy);
-      p_lstnr_buf->len += to_copy;
-      p_hdr->nFilledLen -= to_copy;
-      p_hdr->nOffset += to_copy;
+
+      srv_add_iov (ap_iov, p_ring->p_data + (pos & (p_ring->size - 1)), len,
+                   false);
+      pos += len;
+      sent += len;
+      a_allowance -= len;
     }
+}
 
-  p_buffer = (OMX_U8 *) p_lstnr_buf->p_data;
-  len = p_lstnr_buf->len;
+/* Updates the listener's state with the number of bytes that the socket has
+ * accepted out of the gathered io vectors */
+static void
+srv_account (httpr_listener_t * ap_lstnr, const httpr_iov_t * ap_iov,
+             size_t a_bytes)
+{
+  httpr_listener_buffer_t * p_buf = NULL;
+  httpr_connection_t * p_con = NULL;
+  int i = 0;
 
-  srv_arrange_metadata (ap_server, ap_lstnr, &p_buffer, &len);
+  assert (ap_lstnr);
+  assert (ap_iov);
 
-  *ap_len = len;
-  *app_buffer = p_buffer;
+  p_buf = &ap_lstnr->buf;
+  p_con = ap_lstnr->p_con;
+
+  for (i = 0; i < ap_iov->count; ++i)
+    {
+      const size_t taken = MIN (a_bytes, ap_iov->vec[i].iov_len);
+      a_bytes -= taken;
+
+      if (i == ap_iov->metadata_idx)
+        {
+          if (0 == taken && ap_iov->new_metadata)
+            {
+              /* The block has not been started; it will be prepared again
+               * when the listener reaches the interval boundary */
+              p_buf->metadata_bytes = 0;
+              ap_lstnr->next_metadata = ap_iov->next_metadata;
+              p_con->metadata_delivered = ap_iov->metadata_delivered;
+            }
+          else
+            {
+              p_buf->metadata_offset += taken;
+              p_buf->metadata_bytes -= taken;
+            }
+          continue;
+        }
+
+      ap_lstnr->pos += taken;
+      p_con->sent_total += taken;
+      p_con->sent_last += taken;
+      p_con->burst_bytes += taken;
+      if (p_con->initial_burst_bytes > 0)
+        {
+          p_con->initial_burst_bytes -= taken;
+        }
+      else if (p_con->con_time == 0 && taken > 0)
+        {
+          p_con->con_time = time (NULL);
+        }
+    }
+}
+
+static inline bool
+srv_may_use_zerocopy (const httpr_listener_t * ap_lstnr,
+                      const httpr_iov_t * ap_iov)
+{
+  return (ap_lstnr->zerocopy && ap_iov->metadata_idx < 0
+          && ap_iov->total >= ICE_ZEROCOPY_MIN_BYTES
+          && srv_get_zerocopy_pending (ap_lstnr) < ICE_MAX_ZEROCOPY_SENDS);
 }
 
 static OMX_ERRORTYPE
 srv_write_to_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
-                       const void * ap_buffer, const size_t a_buf_len,
-                       int * a_bytes_written)
+                       httpr_iov_t * ap_iov)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
-  int bytes = 0;
+  ssize_t bytes = 0;
   httpr_connection_t * p_con = NULL;
   int sock = ICE_SOCK_ERROR;
+  struct msghdr msg;
+  bool zerocopy = false;
 
   assert (ap_server);
   assert (ap_lstnr);
-  assert (ap_buffer);
-  assert (a_bytes_written);
+  assert (ap_iov);
+  assert (ap_iov->count > 0);
 
   p_con = ap_lstnr->p_con;
   sock = p_con->sockfd;
-  *a_bytes_written = 0;
+
+  tiz_mem_set (&msg, 0, sizeof (msg));
+  msg.msg_iov = ap_iov->vec;
+  msg.msg_iovlen = ap_iov->count;
+
+  zerocopy = srv_may_use_zerocopy (ap_lstnr, ap_iov);
+
   errno = 0;
+  bytes = sendmsg (sock, &msg, MSG_NOSIGNAL | (zerocopy ? MSG_ZEROCOPY : 0));
 
-  bytes = send (sock, (const void *) ap_buffer, a_buf_len, MSG_NOSIGNAL);
+  if (bytes < 0 && zerocopy && ENOBUFS == errno)
+    {
+      /* Out of memory for zerocopy notifications; copy the data this time */
+      zerocopy = false;
+      errno = 0;
+      bytes = sendmsg (sock, &msg, MSG_NOSIGNAL);
+    }
 
   if (bytes < 0)
     {
@@ -1269,139 +1610,197 @@ srv_write_to_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
           TIZ_PRINTF_DBG_RED (
             "Recoverable error while writing to the socket"
             "(re-starting io watcher)\n");
-          (void) srv_start_listener_io_watcher (ap_lstnr);
-          srv_stop_listener_timer_watcher (ap_lstnr);
+          srv_block_listener (ap_lstnr);
           rc = OMX_ErrorNotReady;
         }
     }
   else
     {
-      *a_bytes_written = bytes;
+      if (zerocopy && bytes > 0)
+        {
+          /* The kernel numbers the zerocopy sends on each socket; remember
+           * where in the ring this one starts */
+          ap_lstnr->zc_pos[ap_lstnr->zc_next % ICE_MAX_ZEROCOPY_SENDS]
+            = ap_lstnr->pos;
+          ap_lstnr->zc_next++;
+        }
+
+      srv_account (ap_lstnr, ap_iov, bytes);
+
+      if (bytes < ap_iov->total)
+        {
+          /* The socket's send buffer is full */
+          srv_block_listener (ap_lstnr);
+          rc = OMX_ErrorNotReady;
+        }
     }
   return rc;
 }
 
 static OMX_ERRORTYPE
-srv_write_omx_buffer (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+srv_handle_overrun (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+{
+  const httpr_ring_t * p_ring = NULL;
+  uint64_t resume_pos = 0;
+
+  assert (ap_server);
+  assert (ap_lstnr);
+
+  p_ring = &ap_server->ring;
+
+  if (++ap_lstnr->overruns > ICE_MAX_LISTENER_OVERRUNS)
+    {
+      TIZ_NOTICE (handleOf (ap_server->p_parent),
+                  "Client [%s:%u] is too slow (overrun [%u] times) - dropping",
+                  ap_lstnr->p_con->p_ip, ap_lstnr->p_con->port,
+                  ap_lstnr->overruns - 1);
+      return OMX_ErrorNoMore;
+    }
+
+  /* Skip the data that this listener has lost, and resume a quarter of the
+   * ring behind the live edge, to give the listener some room to catch up */
+  resume_pos = p_ring->head - MIN ((uint64_t) srv_ring_used (p_ring),
+                                   (uint64_t) (p_ring->size / 4));
+
+  TIZ_NOTICE (handleOf (ap_server->p_parent),
+              "Client [%s:%u] overrun - skipping [%llu] bytes",
+              ap_lstnr->p_con->p_ip, ap_lstnr->p_con->port,
+              (unsigned long long) (resume_pos - ap_lstnr->pos));
+
+  ap_lstnr->pos = resume_pos;
+  return OMX_ErrorNone;
+}
+
+/* Sends data from the ring to one listener, until the listener's burst
+ * allowance is used up, its socket can't take any more data, or the encoder
+ * has nothing else to offer. Returns OMX_ErrorNoMore when the listener needs
+ * to be removed. */
+static OMX_ERRORTYPE
+srv_serve_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   httpr_connection_t * p_con = NULL;
-  int sock = ICE_SOCK_ERROR;
+  httpr_ring_t * p_ring = NULL;
+  httpr_iov_t iov;
 
   assert (ap_server);
   assert (ap_lstnr);
   assert (ap_lstnr->p_con);
 
   p_con = ap_lstnr->p_con;
-  sock = p_con->sockfd;
+  p_ring = &ap_server->ring;
 
-  p_con->sent_last = 0;
+  if (ap_lstnr->failed)
+    {
+      return OMX_ErrorNoMore;
+    }
 
-  if (!srv_is_valid_socket (sock))
+  if (!srv_is_valid_socket (p_con->sockfd))
     {
       TIZ_WARN (handleOf (ap_server->p_parent),
                 "Will destroy listener "
                 "(Invalid listener socket fd [%d])",
-                sock);
+                p_con->sockfd);
       /* The socket is not valid anymore. The listener will be removed. */
-      rc = OMX_ErrorNoMore;
+      return OMX_ErrorNoMore;
     }
-  else
+
+  if (srv_get_zerocopy_pending (ap_lstnr) > 0)
     {
-      httpr_listener_buffer_t * p_lstnr_buf = &ap_lstnr->buf;
-      OMX_U8 * p_buffer = NULL;
-      size_t len = 0;
-      int bytes = 0;
+      srv_reap_zerocopy (ap_lstnr);
+    }
 
-      /* Obtain a pointer to the data and the amount of data to be written */
-      srv_arrange_data (ap_server, ap_lstnr, &p_buffer, &len);
+  p_con->sent_last = 0;
 
-      if (len > 0)
+  while (OMX_ErrorNone == rc)
+    {
+      if (ap_lstnr->pos < srv_ring_tail (p_ring))
         {
-          int metadata_sent = 0;
-          tiz_check_omx (
-            srv_write_to_listener (ap_server, ap_lstnr, p_buffer, len, &bytes));
-          assert (bytes >= 0);
+          rc = srv_handle_overrun (ap_server, ap_lstnr);
+          continue;
+        }
 
-          p_lstnr_buf->len
-            = bytes > p_lstnr_buf->len ? 0 : (p_lstnr_buf->len - bytes);
+      srv_gather (ap_server, ap_lstnr,
+                  srv_get_burst_allowance (ap_server, ap_lstnr), &iov);
 
-          if (p_lstnr_buf->len > 0)
+      if (iov.count > 0)
+        {
+          rc = srv_write_to_listener (ap_server, ap_lstnr, &iov);
+        }
+      else if (ap_lstnr->pos == p_ring->head
+               && srv_get_burst_allowance (ap_server, ap_lstnr) > 0)
+        {
+          /* This listener is at the live edge; the ring needs more data */
+          rc = srv_fill_ring (ap_server, ap_lstnr);
+          if (OMX_ErrorNotReady == rc)
             {
-              memmove (p_lstnr_buf->p_data, p_lstnr_buf->p_data + bytes,
-                       p_lstnr_buf->len);
+              rc = OMX_ErrorNone;
+              break;
             }
+        }
+      else
+        {
+          /* Burst allowance used up */
+          break;
+        }
+    }
 
-          if (bytes > p_lstnr_buf->metadata_offset)
-            {
-              metadata_sent = MIN ((bytes - p_lstnr_buf->metadata_offset),
-                                   p_lstnr_buf->metadata_bytes);
-            }
+  TIZ_PRINTF_DBG_BLU (
+    "fd [%d] total [%lld] last [%d] burst [%d] lag [%lld] rc [%s]\n",
+    p_con->sockfd, p_con->sent_total, p_con->sent_last, p_con->burst_bytes,
+    p_ring->head - ap_lstnr->pos, tiz_err_to_str (rc));
 
-          if (p_con->initial_burst_bytes > 0)
-            {
-              p_con->initial_burst_bytes -= (bytes - metadata_sent);
-            }
-          else
-            {
-              if (p_con->con_time == 0)
-                {
-                  p_con->con_time = time (NULL);
-                }
-            }
+  return rc;
+}
 
-          p_con->sent_total += (bytes - metadata_sent);
-          p_con->sent_last = (bytes - metadata_sent);
-          p_con->burst_bytes += (bytes - metadata_sent);
-
-          {
-            time_t t = time (NULL);
-            double d = difftime (t, p_con->con_time);
-            uint64_t rate = d ? p_con->sent_total / (uint64_t) d : 0;
-            TIZ_PRINTF_DBG_BLU (
-              "total [%lld] last [%d] burst [%d] time [%f] rate [%lld] "
-              "server burst [%d] bytes [%d]\n",
-              p_con->sent_total, p_con->sent_last, p_con->burst_bytes, d, rate,
-              ap_server->burst_size, bytes);
-          }
-
-          TIZ_PRINTF_DBG_GRN (
-            "metadata_bytes [%u] < metadata_offset [%u] metadata_sent [%u]\n",
-            p_lstnr_buf->metadata_bytes, p_lstnr_buf->metadata_offset,
-            metadata_sent);
-
-          p_lstnr_buf->metadata_bytes -= metadata_sent;
-          if (p_lstnr_buf->metadata_offset > 0 && p_lstnr_buf->metadata_bytes)
-            {
-              p_lstnr_buf->metadata_offset -= ((unsigned int) bytes);
-            }
-          else
-            {
-              p_lstnr_buf->metadata_offset = 0;
-            }
+static void
+srv_write_to_client (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+{
+  assert (ap_server);
+  assert (ap_lstnr);
+  if (OMX_ErrorNoMore == srv_serve_listener (ap_server, ap_lstnr))
+    {
+      srv_remove_listener (ap_server, ap_lstnr);
+    }
+}
 
-          if (bytes < len)
+static bool
+srv_is_listener_ready (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+{
+  bool lstnr_ready = true;
+  OMX_HANDLETYPE p_hdl = NULL;
+  assert (ap_server);
+  assert (ap_lstnr);
+  p_hdl = handleOf (ap_server->p_parent);
+
+  if (ap_lstnr->need_response)
+    {
+      OMX_ERRORTYPE rc = OMX_ErrorNone;
+      if (OMX_ErrorNone
+          != (rc = srv_handle_listeners_request (ap_server, ap_lstnr)))
+        {
+          if (OMX_ErrorNotReady == rc)
             {
-              TIZ_PRINTF_DBG_RED (
-                "NEED TO STOP bytes [%d] < len [%u] p_lstnr_buf->len [%u]\n",
-                bytes, len, p_lstnr_buf->len);
+              TIZ_ERROR (p_hdl, "no data yet lets wait some time ");
               (void) srv_start_listener_io_watcher (ap_lstnr);
-              srv_stop_listener_timer_watcher (ap_lstnr);
-              rc = OMX_ErrorNotReady;
             }
           else
             {
-              if ((p_con->initial_burst_bytes <= 0)
-                  && (p_con->burst_bytes >= ap_server->burst_size))
-                {
-                  rc = srv_start_listener_timer_watcher (ap_lstnr,
-                                                         ap_server->wait_time);
-                }
+              TIZ_ERROR (p_hdl,
+                         "[%s] : while handling the "
+                         "listener's initial request. Will remove the listener",
+                         tiz_err_to_str (rc));
+              srv_remove_listener (ap_server, ap_lstnr);
             }
+          lstnr_ready = false;
+        }
+      else
+        {
+          srv_attach_listener (ap_server, ap_lstnr);
+          (void) srv_start_timer_watcher (ap_server);
         }
     }
-
-  return rc;
+  return lstnr_ready;
 }
 
 static OMX_ERRORTYPE
@@ -1418,14 +1817,6 @@ srv_accept_connection (httpr_server_t * ap_server)
   assert (ap_server);
   p_hdl = handleOf (ap_server->p_parent);
 
-  if (srv_get_listeners_count (ap_server) > 0)
-    {
-      /* This is a simple solution to prevent more than one connection at
-       * a time. One day this could be a multi-client renderer */
-      tiz_map_for_each (ap_server->p_lstnrs, srv_remove_existing_listener,
-                        ap_server);
-    }
-
   if ((p_ip = (char *) tiz_mem_alloc (ICE_RENDERER_MAX_ADDR_LEN)))
     {
       unsigned short port = 0;
@@ -1486,8 +1877,9 @@ end:
     }
   else
     {
-      TIZ_NOTICE (p_hdl, "Client [%s:%u] fd [%d] now connected", p_con->p_ip,
-                  p_con->port, p_con->sockfd);
+      TIZ_NOTICE (p_hdl, "Client [%s:%u] fd [%d] now connected - [%d] clients",
+                  p_con->p_ip, p_con->port, p_con->sockfd,
+                  srv_get_listeners_count (ap_server));
 
       TIZ_PRINTF_DBG_RED ("Client connected [%s:%u]\n", p_con->p_ip,
                           p_con->port);
@@ -1509,12 +1901,9 @@ end:
 }
 
 static OMX_ERRORTYPE
-srv_write (httpr_server_t * ap_server)
+srv_write (httpr_server_t * ap_server, const bool a_new_period)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
-  httpr_listener_t * p_lstnr = NULL;
-  httpr_connection_t * p_con = NULL;
+  OMX_S32 i = 0;
 
   assert (ap_server);
 
@@ -1523,83 +1912,82 @@ srv_write (httpr_server_t * ap_server)
       return OMX_ErrorNoMore;
     }
 
-  /* Until support for multiple listeners gets implemented, there will only be
-     one listener in the map */
-  p_lstnr = srv_get_first_listener (ap_server);
-  assert (p_lstnr);
-  p_con = p_lstnr->p_con;
-  assert (p_con);
-
-  srv_stop_listener_io_watcher (p_lstnr);
-  if (!srv_is_listener_ready (ap_server, p_lstnr))
+  /* Iterate backwards, so that removing a listener doesn't change the
+     position of the listeners that are still to be visited */
+  for (i = srv_get_listeners_count (ap_server) - 1; i >= 0; --i)
     {
-      return OMX_ErrorNotReady;
-    }
-
-  srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+      assert (p_lstnr->p_con);
 
-  if (p_con->initial_burst_bytes <= 0)
-    {
-      p_con->burst_bytes = 0;
-    }
+      if (p_lstnr->need_response)
+        {
+          continue;
+        }
 
-  while (1)
-    {
-      if (NULL == p_hdr)
+      /* Listeners waiting on their sockets are handled on io events, but
+       * those that stop reading altogether must still be detected here */
+      if (p_lstnr->blocked)
         {
-          if (NULL == (p_hdr = ap_server->pf_acquire_buf (ap_server->p_arg)))
+          if (p_lstnr->pos < srv_ring_tail (&ap_server->ring)
+              && OMX_ErrorNoMore == srv_handle_overrun (ap_server, p_lstnr))
             {
-              /* no more buffers available at the moment */
-              ap_server->need_more_data = true;
-              srv_stop_listener_timer_watcher (p_lstnr);
-              rc = OMX_ErrorNone;
-              break;
+              srv_remove_listener (ap_server, p_lstnr);
             }
-          ap_server->need_more_data = false;
-          ap_server->p_hdr = p_hdr;
+          continue;
         }
 
-      rc = srv_write_omx_buffer (ap_server, p_lstnr);
-
-      if (OMX_ErrorNoMore == rc)
+      if (a_new_period && p_lstnr->p_con->initial_burst_bytes <= 0)
         {
-          srv_remove_listener (ap_server, p_lstnr);
-          break;
+          p_lstnr->p_con->burst_bytes = 0;
         }
 
-      if (OMX_ErrorNotReady == rc
-          || ((p_con->initial_burst_bytes <= 0)
-              && (p_con->burst_bytes >= ap_server->burst_size)))
-        {
-          rc = OMX_ErrorNotReady;
-          break;
-        }
+      srv_write_to_client (ap_server, p_lstnr);
+    }
 
-      /*       if (p_lstnr->pos == ap_server->p_hdr->nFilledLen) */
-      if (0 == ap_server->p_hdr->nFilledLen)
-        {
-          /* Buffer emptied */
-          (void) srv_release_empty_buffer (ap_server, p_lstnr, &p_hdr);
-        }
-    };
+  srv_remove_failed_listeners (ap_server);
 
-  return rc;
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+srv_stream_to_client (httpr_server_t * ap_server, const int a_fd)
+{
+  httpr_listener_t * p_lstnr = NULL;
+  int fd = a_fd;
+
+  assert (ap_server);
+
+  if (NULL
+      == (p_lstnr = tiz_map_find (ap_server->p_lstnrs, (OMX_PTR) &fd)))
+    {
+      /* The listener has been removed already */
+      return OMX_ErrorNone;
+    }
+
+  srv_stop_listener_io_watcher (p_lstnr);
+  p_lstnr->blocked = false;
+
+  if (srv_is_listener_ready (ap_server, p_lstnr))
+    {
+      srv_write_to_client (ap_server, p_lstnr);
+      srv_remove_failed_listeners (ap_server);
+    }
+
+  return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-srv_stream_to_client (httpr_server_t * ap_server)
+srv_stream_to_clients (httpr_server_t * ap_server, const bool a_new_period)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (ap_server);
 
-  rc = srv_write (ap_server);
+  rc = srv_write (ap_server, a_new_period);
   switch (rc)
     {
       case OMX_ErrorNone:
       case OMX_ErrorNoMore:
-      /* Socket not ready, send buffer is full, or the burst limit has been
-         reached */
-      case OMX_ErrorNotReady:
         {
           /* No connected clients just yet */
           rc = OMX_ErrorNone;
@@ -1645,6 +2033,9 @@ httpr_srv_destroy (httpr_server_t * ap_server)
           tiz_map_clear (ap_server->p_lstnrs);
           tiz_map_destroy (ap_server->p_lstnrs);
         }
+      tiz_srv_timer_watcher_destroy (ap_server->p_parent,
+                                     ap_server->p_ev_timer);
+      tiz_mem_free (ap_server->ring.p_data);
       tiz_mem_free (ap_server);
     }
 }
@@ -1675,6 +2066,11 @@ httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
   p_server->p_srv_ev_io = NULL;
   p_server->max_clients = a_max_clients;
   p_server->p_lstnrs = NULL;
+  p_server->ring.p_data = NULL;
+  p_server->ring.size = 0;
+  p_server->ring.head = 0;
+  p_server->p_ev_timer = NULL;
+  p_server->timer_started = false;
   p_server->p_hdr = NULL;
   p_server->pf_release_buf = a_pf_release_buf;
   p_server->pf_acquire_buf = a_pf_acquire_buf;
@@ -1694,7 +2090,7 @@ httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
   tiz_mem_set (&(p_server->mountpoint), 0, sizeof (httpr_mount_t));
   p_server->mountpoint.metadata_period = ICE_DEFAULT_METADATA_INTERVAL;
   p_server->mountpoint.initial_burst_size = ICE_INITIAL_BURST_SIZE;
-  p_server->mountpoint.max_clients = 1;
+  p_server->mountpoint.max_clients = a_max_clients;
 
   if (a_address)
     {
@@ -1718,6 +2114,11 @@ httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
   goto_end_on_omx_error (rc, handleOf (ap_parent),
                          "Unable to alloc the server's io event");
 
+  rc = tiz_srv_timer_watcher_init (p_server->p_parent,
+                                   &(p_server->p_ev_timer));
+  goto_end_on_omx_error (rc, handleOf (ap_parent),
+                         "Unable to alloc the server's timer event");
+
   /* All good so far */
   all_ok = true;
 
@@ -1744,6 +2145,11 @@ httpr_srv_start (httpr_server_t * ap_server)
   assert (ap_server);
   p_hdl = handleOf (ap_server->p_parent);
 
+  /* The ring must be able to hold several initial bursts */
+  rc = srv_ring_alloc (&(ap_server->ring),
+                       4 * ap_server->mountpoint.initial_burst_size);
+  goto_end_on_omx_error (rc, p_hdl, "Unable to alloc the stream ring");
+
   errno = 0;
   listen_rc = listen (ap_server->lstn_sockfd, ICE_LISTEN_QUEUE);
   goto_end_on_socket_error (listen_rc, p_hdl, strerror (errno));
@@ -1769,20 +2175,15 @@ end:
 OMX_ERRORTYPE
 httpr_srv_stop (httpr_server_t * ap_server)
 {
-  httpr_listener_t * p_lstnr = NULL;
   assert (ap_server);
   (void) srv_stop_server_io_watcher (ap_server);
-  if (ap_server->p_lstnrs)
+  srv_stop_timer_watcher (ap_server);
+  while (srv_get_listeners_count (ap_server) > 0)
     {
-      /* Until support for multiple listeners gets implemented, there will only
-         be one listener in the map */
-      p_lstnr = srv_get_first_listener (ap_server);
-      if (p_lstnr)
-        {
-          srv_stop_listener_io_watcher (p_lstnr);
-          srv_stop_listener_timer_watcher (p_lstnr);
-          srv_remove_listener (ap_server, p_lstnr);
-        }
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, 0);
+      assert (p_lstnr);
+      srv_stop_listener_io_watcher (p_lstnr);
+      srv_remove_listener (ap_server, p_lstnr);
     }
   ap_server->running = false;
   ap_server->need_more_data = false;
@@ -1821,12 +2222,11 @@ httpr_srv_set_mp3_settings (httpr_server_t * ap_server, const OMX_U32 a_bitrate,
 
   ap_server->wait_time = (1 / ap_server->pkts_per_sec);
 
-  if (srv_get_listeners_count (ap_server) > 0)
+  if (ap_server->timer_started)
     {
-      httpr_listener_t * p_lstnr = srv_get_first_listener (ap_server);
-      assert (p_lstnr);
-      srv_stop_listener_timer_watcher (p_lstnr);
-      srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
+      /* Restart the pacing timer with the new period */
+      srv_stop_timer_watcher (ap_server);
+      (void) srv_start_timer_watcher (ap_server);
     }
 
   TIZ_PRINTF_DBG_MAG (
@@ -1904,17 +2304,18 @@ httpr_srv_set_stream_title (httpr_server_t * ap_server,
            OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE);
   p_mount->stream_title[OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE - 1] = '\0';
 
-  if (srv_get_listeners_count (ap_server) > 0)
-    {
-      httpr_listener_t * p_lstnr = srv_get_first_listener (ap_server);
-      assert (p_lstnr);
-      assert (p_lstnr->p_con);
-      p_lstnr->p_con->metadata_delivered = false;
-      p_lstnr->p_con->initial_burst_bytes
-        = ap_server->mountpoint.initial_burst_size * 0.1;
-      srv_stop_listener_timer_watcher (p_lstnr);
-      srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
-    }
+  {
+    OMX_S32 i = 0;
+    for (i = 0; i < srv_get_listeners_count (ap_server); ++i)
+      {
+        httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+        assert (p_lstnr);
+        assert (p_lstnr->p_con);
+        p_lstnr->p_con->metadata_delivered = false;
+        p_lstnr->p_con->initial_burst_bytes
+          = ap_server->mountpoint.initial_burst_size * 0.1;
+      }
+  }
 }
 
 OMX_ERRORTYPE
@@ -1922,7 +2323,7 @@ httpr_srv_buffer_event (httpr_server_t * ap_server)
 {
   assert (ap_server);
   return ((ap_server->running && ap_server->need_more_data)
-            ? srv_stream_to_client (ap_server)
+            ? srv_stream_to_clients (ap_server, false)
             : OMX_ErrorNone);
 }
 
@@ -1944,8 +2345,8 @@ httpr_srv_io_event (httpr_server_t * ap_server, const int a_fd)
         }
       else
         {
-          /* The client socket is ready */
-          rc = srv_stream_to_client (ap_server);
+          /* A client socket is ready */
+          rc = srv_stream_to_client (ap_server, a_fd);
         }
     }
   return rc;
@@ -1955,5 +2356,6 @@ OMX_ERRORTYPE
 httpr_srv_timer_event (httpr_server_t * ap_server)
 {
   assert (ap_server);
-  return ap_server->running ? srv_stream_to_client (ap_server) : OMX_ErrorNone;
+  return ap_server->running ? srv_stream_to_clients (ap_server, true)
+                            : OMX_ErrorNone;
 }
@@ -0,0 +1,633 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_httprsrv.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  HTTP renderer's streaming server unit tests
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <check.h>
+
+/* The server is included here (rather than linked) so that the tests can
+ * look into the listeners' state */
+#include "httprsrv.c"
+
+#define HTTPRSRV_TEST_TIMEOUT 60
+#define HTTPRSRV_TEST_PORT_BASE 18010
+#define HTTPRSRV_TEST_FAST_CLIENTS 3
+#define HTTPRSRV_TEST_MAX_WATCHERS 16
+#define HTTPRSRV_TEST_MAX_TICKS 20000
+#define HTTPRSRV_TEST_BUFFER_SIZE (32 * 1024)
+/* Stream bytes follow a pattern that the clients can check */
+#define HTTPRSRV_TEST_PATTERN_PERIOD 251
+
+/*                                                                */
+/* Minimal stand-ins for the libtizonia services used by the server */
+/*                                                                */
+
+typedef struct check_watcher check_watcher_t;
+struct check_watcher
+{
+  bool in_use;
+  bool active;
+  int fd;
+  short events;
+};
+
+static check_watcher_t g_watchers[HTTPRSRV_TEST_MAX_WATCHERS];
+static int g_timer = 0;
+static bool g_timer_active = false;
+static char g_cname[2 * OMX_MAX_STRINGNAME_SIZE];
+static OMX_COMPONENTTYPE g_hdl;
+static int g_parent = 0;
+
+const OMX_HANDLETYPE
+handleOf (const void * ap_obj)
+{
+  return (OMX_HANDLETYPE) &g_hdl;
+}
+
+OMX_ERRORTYPE
+tiz_srv_io_watcher_init (void * ap_obj, tiz_event_io_t ** app_ev_io, int a_fd,
+                         tiz_event_io_event_t a_event, bool only_once)
+{
+  int i = 0;
+  for (i = 0; i < HTTPRSRV_TEST_MAX_WATCHERS; ++i)
+    {
+      if (!g_watchers[i].in_use)
+        {
+          g_watchers[i].in_use = true;
+          g_watchers[i].active = false;
+          g_watchers[i].fd = a_fd;
+          g_watchers[i].events
+            = (TIZ_EVENT_READ == a_event ? POLLIN : POLLOUT);
+          *app_ev_io = (tiz_event_io_t *) &g_watchers[i];
+          return OMX_ErrorNone;
+        }
+    }
+  return OMX_ErrorInsufficientResources;
+}
+
+OMX_ERRORTYPE
+tiz_srv_io_watcher_start (void * ap_obj, tiz_event_io_t * ap_ev_io)
+{
+  ((check_watcher_t *) ap_ev_io)->active = true;
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+tiz_srv_io_watcher_stop (void * ap_obj, tiz_event_io_t * ap_ev_io)
+{
+  ((check_watcher_t *) ap_ev_io)->active = false;
+  return OMX_ErrorNone;
+}
+
+void
+tiz_srv_io_watcher_destroy (void * ap_obj, tiz_event_io_t * ap_ev_io)
+{
+  if (ap_ev_io)
+    {
+      tiz_mem_set (ap_ev_io, 0, sizeof (check_watcher_t));
+    }
+}
+
+OMX_ERRORTYPE
+tiz_srv_timer_watcher_init (void * ap_obj, tiz_event_timer_t ** app_ev_timer)
+{
+  *app_ev_timer = (tiz_event_timer_t *) &g_timer;
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+tiz_srv_timer_watcher_start (void * ap_obj, tiz_event_timer_t * ap_ev_timer,
+                             const double a_after, const double a_repeat)
+{
+  g_timer_active = true;
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+tiz_srv_timer_watcher_stop (void * ap_obj, tiz_event_timer_t * ap_ev_timer)
+{
+  g_timer_active = false;
+  return OMX_ErrorNone;
+}
+
+void
+tiz_srv_timer_watcher_destroy (void * ap_obj, tiz_event_timer_t * ap_ev_timer)
+{
+  g_timer_active = false;
+}
+
+/*                     */
+/* The encoder's side  */
+/*                     */
+
+static OMX_U8 g_buffer[HTTPRSRV_TEST_BUFFER_SIZE];
+static OMX_BUFFERHEADERTYPE g_hdr;
+static uint64_t g_produced = 0;
+static bool g_hdr_out = false;
+
+static OMX_BUFFERHEADERTYPE *
+acquire_buffer (OMX_PTR ap_arg)
+{
+  OMX_U32 i = 0;
+  fail_if (g_hdr_out);
+  for (i = 0; i < HTTPRSRV_TEST_BUFFER_SIZE; ++i)
+    {
+      g_buffer[i] = (OMX_U8) ((g_produced + i) % HTTPRSRV_TEST_PATTERN_PERIOD);
+    }
+  g_produced += HTTPRSRV_TEST_BUFFER_SIZE;
+  g_hdr.pBuffer = g_buffer;
+  g_hdr.nOffset = 0;
+  g_hdr.nFilledLen = HTTPRSRV_TEST_BUFFER_SIZE;
+  g_hdr.nAllocLen = HTTPRSRV_TEST_BUFFER_SIZE;
+  g_hdr_out = true;
+  return &g_hdr;
+}
+
+static void
+release_buffer (OMX_BUFFERHEADERTYPE * ap_hdr, OMX_PTR ap_arg)
+{
+  fail_if (ap_hdr != &g_hdr);
+  g_hdr_out = false;
+}
+
+/*                */
+/* The listeners  */
+/*                */
+
+typedef struct check_client check_client_t;
+struct check_client
+{
+  int fd;
+  unsigned short port;
+  bool got_response;
+  bool synced;
+  int expected;
+  uint64_t received;
+  bool closed;
+  int errors;
+  char hdr[1024];
+  size_t hdr_len;
+};
+
+static void
+setup_server (void)
+{
+  tiz_mem_set (g_watchers, 0, sizeof (g_watchers));
+  g_timer_active = false;
+  tiz_mem_set (&g_hdl, 0, sizeof (g_hdl));
+  tiz_mem_set (g_cname, 0, sizeof (g_cname));
+  strncpy (g_cname, "OMX.Aratelia.audio_renderer.http", OMX_MAX_STRINGNAME_SIZE);
+  g_hdl.pComponentPrivate = g_cname;
+  g_produced = 0;
+  g_hdr_out = false;
+}
+
+static httpr_server_t *
+start_server (const OMX_U32 a_port)
+{
+  httpr_server_t * p_server = NULL;
+  fail_if (OMX_ErrorNone
+           != httpr_srv_init (&p_server, &g_parent, "127.0.0.1", a_port, 10,
+                              release_buffer, acquire_buffer, NULL));
+  fail_if (NULL == p_server);
+  httpr_srv_set_mp3_settings (p_server, 128000, 2, 44100);
+  fail_if (OMX_ErrorNone != httpr_srv_start (p_server));
+  return p_server;
+}
+
+static void
+connect_client (check_client_t * ap_client, const OMX_U32 a_port,
+                const int a_rcvbuf)
+{
+  static const char request[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  struct sockaddr_in sa;
+  socklen_t slen = sizeof (sa);
+
+  tiz_mem_set (ap_client, 0, sizeof (check_client_t));
+  ap_client->fd = socket (AF_INET, SOCK_STREAM, 0);
+  fail_if (ap_client->fd < 0);
+
+  if (a_rcvbuf > 0)
+    {
+      /* Must be set before connecting, as it determines the window */
+      fail_if (0 != setsockopt (ap_client->fd, SOL_SOCKET, SO_RCVBUF,
+                                &a_rcvbuf, sizeof (a_rcvbuf)));
+    }
+
+  tiz_mem_set (&sa, 0, sizeof (sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons (a_port);
+  sa.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  fail_if (0 != connect (ap_client->fd, (struct sockaddr *) &sa, sizeof (sa)));
+  fail_if (0 != getsockname (ap_client->fd, (struct sockaddr *) &sa, &slen));
+  ap_client->port = ntohs (sa.sin_port);
+
+  fail_if ((ssize_t) strlen (request)
+           != send (ap_client->fd, request, strlen (request), MSG_NOSIGNAL));
+  fail_if (0 != srv_set_non_blocking (ap_client->fd));
+}
+
+/* Checks that the stream continues the byte pattern, without gaps */
+static void
+check_stream (check_client_t * ap_client, const OMX_U8 * ap_data,
+              const size_t a_len)
+{
+  size_t i = 0;
+  for (i = 0; i < a_len; ++i)
+    {
+      if (!ap_client->synced)
+        {
+          ap_client->synced = true;
+        }
+      else if (ap_data[i] != ap_client->expected)
+        {
+          ap_client->errors++;
+        }
+      ap_client->expected = (ap_data[i] + 1) % HTTPRSRV_TEST_PATTERN_PERIOD;
+    }
+  ap_client->received += a_len;
+}
+
+static void
+drain_client (check_client_t * ap_client)
+{
+  OMX_U8 data[64 * 1024];
+  ssize_t nread = 0;
+
+  while (!ap_client->closed
+         && (nread = recv (ap_client->fd, data, sizeof (data), 0)) != 0)
+    {
+      size_t offset = 0;
+      if (nread < 0)
+        {
+          ap_client->closed = (EAGAIN != errno && EWOULDBLOCK != errno);
+          break;
+        }
+
+      while (!ap_client->got_response && offset < (size_t) nread)
+        {
+          /* Skip the http response, up to the first empty line */
+          if (ap_client->hdr_len < sizeof (ap_client->hdr) - 1)
+            {
+              ap_client->hdr[ap_client->hdr_len++] = data[offset];
+              ap_client->hdr[ap_client->hdr_len] = '\0';
+            }
+          offset++;
+          ap_client->got_response
+            = (NULL != strstr (ap_client->hdr, "\r\n\r\n"));
+        }
+
+      check_stream (ap_client, data + offset, nread - offset);
+    }
+
+  if (0 == nread)
+    {
+      ap_client->closed = true;
+    }
+}
+
+/* Dispatches the io events of the watchers that the server has started, the
+ * same way the servant would */
+static void
+dispatch_io_events (httpr_server_t * ap_server)
+{
+  struct pollfd fds[HTTPRSRV_TEST_MAX_WATCHERS];
+  int idx[HTTPRSRV_TEST_MAX_WATCHERS];
+  int nfds = 0;
+  int i = 0;
+
+  for (i = 0; i < HTTPRSRV_TEST_MAX_WATCHERS; ++i)
+    {
+      if (g_watchers[i].in_use && g_watchers[i].active)
+        {
+          fds[nfds].fd = g_watchers[i].fd;
+          fds[nfds].events = g_watchers[i].events;
+          fds[nfds].revents = 0;
+          idx[nfds++] = i;
+        }
+    }
+
+  if (nfds > 0 && poll (fds, nfds, 0) > 0)
+    {
+      for (i = 0; i < nfds; ++i)
+        {
+          check_watcher_t * p_watcher = &g_watchers[idx[i]];
+          if (0 != fds[i].revents && p_watcher->in_use && p_watcher->active
+              && p_watcher->fd == fds[i].fd)
+            {
+              /* The watchers are one-shot */
+              p_watcher->active = false;
+              fail_if (OMX_ErrorNone
+                       != httpr_srv_io_event (ap_server, fds[i].fd));
+            }
+        }
+    }
+}
+
+static httpr_listener_t *
+find_listener (httpr_server_t * ap_server, const unsigned short a_port)
+{
+  OMX_S32 i = 0;
+  for (i = 0; i < srv_get_listeners_count (ap_server); ++i)
+    {
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      if (p_lstnr->p_con->port == a_port)
+        {
+          return p_lstnr;
+        }
+    }
+  return NULL;
+}
+
+/* Dispatches io events until all the clients have been sent their http
+ * response. Zerocopy is turned off for the new listeners when not wanted. */
+static void
+wait_for_listeners (httpr_server_t * ap_server, check_client_t * ap_clients,
+                    const int a_nclients, const bool a_zerocopy)
+{
+  int tick = 0;
+  int i = 0;
+  bool all_attached = false;
+
+  for (tick = 0; tick < HTTPRSRV_TEST_MAX_TICKS && !all_attached; ++tick)
+    {
+      dispatch_io_events (ap_server);
+      all_attached = true;
+      for (i = 0; i < a_nclients; ++i)
+        {
+          httpr_listener_t * p_lstnr
+            = find_listener (ap_server, ap_clients[i].port);
+          if (p_lstnr && p_lstnr->need_response && !a_zerocopy)
+            {
+              p_lstnr->zerocopy = false;
+            }
+          all_attached &= (p_lstnr && !p_lstnr->need_response);
+        }
+    }
+  fail_if (!all_attached);
+  fail_if (!g_timer_active);
+}
+
+/* Runs the server's timer until the slow client's listener is removed. The
+ * other clients read everything they are sent. */
+static void
+stream_until_dropped (httpr_server_t * ap_server, check_client_t * ap_clients,
+                      const int a_nfast, const check_client_t * ap_slow,
+                      OMX_U32 * ap_slow_overruns)
+{
+  bool slow_dropped = false;
+  int tick = 0;
+  int i = 0;
+
+  for (tick = 0; tick < HTTPRSRV_TEST_MAX_TICKS && !slow_dropped; ++tick)
+    {
+      httpr_listener_t * p_lstnr = NULL;
+
+      fail_if (OMX_ErrorNone != httpr_srv_timer_event (ap_server));
+      for (i = 0; i < a_nfast; ++i)
+        {
+          drain_client (&ap_clients[i]);
+        }
+      dispatch_io_events (ap_server);
+
+      if ((p_lstnr = find_listener (ap_server, ap_slow->port)))
+        {
+          *ap_slow_overruns = p_lstnr->overruns;
+        }
+      else
+        {
+          slow_dropped = true;
+        }
+    }
+
+  fail_if (!slow_dropped);
+  fail_if (a_nfast != srv_get_listeners_count (ap_server));
+}
+
+/* The clients that keep reading must have received a continuous stream */
+static void
+check_fast_clients (httpr_server_t * ap_server, check_client_t * ap_clients,
+                    const int a_nfast)
+{
+  int i = 0;
+  for (i = 0; i < a_nfast; ++i)
+    {
+      httpr_listener_t * p_lstnr = find_listener (ap_server, ap_clients[i].port);
+      fail_if (NULL == p_lstnr);
+      fail_if (0 != p_lstnr->overruns);
+      fail_if (!ap_clients[i].got_response);
+      fail_if (ap_clients[i].closed);
+      fail_if (0 != ap_clients[i].errors);
+      fail_if (ap_clients[i].received <= ap_server->ring.size);
+    }
+}
+
+static void
+wait_for_close (check_client_t * ap_client)
+{
+  const int flags = fcntl (ap_client->fd, F_GETFL, 0);
+  fail_if (0 != fcntl (ap_client->fd, F_SETFL, flags & ~O_NONBLOCK));
+  while (!ap_client->closed)
+    {
+      drain_client (ap_client);
+    }
+}
+
+static void
+stop_server (httpr_server_t * ap_server, check_client_t * ap_clients,
+             const int a_nclients)
+{
+  int i = 0;
+  fail_if (OMX_ErrorNone != httpr_srv_stop (ap_server));
+  fail_if (0 != srv_get_listeners_count (ap_server));
+  fail_if (g_timer_active);
+  httpr_srv_destroy (ap_server);
+  fail_if (g_hdr_out);
+  for (i = 0; i < a_nclients; ++i)
+    {
+      close (ap_clients[i].fd);
+    }
+}
+
+/*        */
+/* Tests  */
+/*        */
+
+START_TEST (test_httprsrv_slow_listener_overrun)
+{
+  const OMX_U32 port = HTTPRSRV_TEST_PORT_BASE;
+  check_client_t clients[HTTPRSRV_TEST_FAST_CLIENTS + 1];
+  check_client_t * p_slow = &clients[HTTPRSRV_TEST_FAST_CLIENTS];
+  httpr_server_t * p_server = NULL;
+  OMX_U32 slow_overruns = 0;
+  int i = 0;
+
+  p_server = start_server (port);
+
+  for (i = 0; i < HTTPRSRV_TEST_FAST_CLIENTS; ++i)
+    {
+      connect_client (&clients[i], port, 0);
+    }
+  /* The slow listener never reads from its socket */
+  connect_client (p_slow, port, 4096);
+
+  /* Without zerocopy sends, which would get the slow listener dropped as
+   * soon as the ring wraps (see test_httprsrv_zerocopy_reaping) */
+  wait_for_listeners (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS + 1,
+                      false);
+  fail_if (HTTPRSRV_TEST_FAST_CLIENTS + 1
+           != srv_get_listeners_count (p_server));
+
+  stream_until_dropped (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS, p_slow,
+                        &slow_overruns);
+
+  /* The slow listener has been resynced several times before being dropped,
+   * and meanwhile the others have kept up with the ring */
+  fail_if (ICE_MAX_LISTENER_OVERRUNS != slow_overruns);
+  check_fast_clients (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS);
+  wait_for_close (p_slow);
+
+  stop_server (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS + 1);
+}
+END_TEST
+
+START_TEST (test_httprsrv_zerocopy_reaping)
+{
+  const OMX_U32 port = HTTPRSRV_TEST_PORT_BASE + 1;
+  check_client_t clients[HTTPRSRV_TEST_FAST_CLIENTS + 1];
+  check_client_t * p_slow = &clients[HTTPRSRV_TEST_FAST_CLIENTS];
+  httpr_server_t * p_server = NULL;
+  bool zerocopy_enabled = false;
+  OMX_U32 slow_overruns = 0;
+  int tick = 0;
+  int i = 0;
+
+  p_server = start_server (port);
+
+  for (i = 0; i < HTTPRSRV_TEST_FAST_CLIENTS; ++i)
+    {
+      connect_client (&clients[i], port, 0);
+    }
+  connect_client (p_slow, port, 4096);
+
+  wait_for_listeners (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS + 1, true);
+
+  /* The initial bursts are large enough to go out as zerocopy sends, if the
+   * kernel supports them */
+  for (i = 0; i < HTTPRSRV_TEST_FAST_CLIENTS + 1; ++i)
+    {
+      httpr_listener_t * p_lstnr = find_listener (p_server, clients[i].port);
+      fail_if (NULL == p_lstnr);
+      zerocopy_enabled |= (p_lstnr->zc_next > 0);
+      fail_if (p_lstnr->zc_next > 0 && !p_lstnr->zerocopy);
+    }
+
+  stream_until_dropped (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS, p_slow,
+                        &slow_overruns);
+
+  if (zerocopy_enabled)
+    {
+      /* The slow listener's first zerocopy send never completed, and the
+       * listener was dropped before the ring could overwrite that data */
+      fail_if (0 != slow_overruns);
+    }
+
+  /* The other listeners carry on past the next ring wrap, and the
+   * completions of their sends get reaped */
+  for (tick = 0; tick < HTTPRSRV_TEST_MAX_TICKS; ++tick)
+    {
+      bool all_reaped = true;
+      fail_if (OMX_ErrorNone != httpr_srv_timer_event (p_server));
+      for (i = 0; i < HTTPRSRV_TEST_FAST_CLIENTS; ++i)
+        {
+          httpr_listener_t * p_lstnr
+            = find_listener (p_server, clients[i].port);
+          fail_if (NULL == p_lstnr);
+          drain_client (&clients[i]);
+          srv_reap_zerocopy (p_lstnr);
+          all_reaped &= (0 == srv_get_zerocopy_pending (p_lstnr));
+        }
+      dispatch_io_events (p_server);
+      if (all_reaped && p_server->ring.head > 2 * p_server->ring.size)
+        {
+          break;
+        }
+    }
+  fail_if (HTTPRSRV_TEST_MAX_TICKS == tick);
+
+  check_fast_clients (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS);
+  wait_for_close (p_slow);
+
+  stop_server (p_server, clients, HTTPRSRV_TEST_FAST_CLIENTS + 1);
+}
+END_TEST
+
+Suite *
+httprsrv_suite (void)
+{
+  TCase * tc_srv;
+  Suite * s = suite_create ("http_renderer");
+
+  /* test case */
+  tc_srv = tcase_create ("Streaming server listeners");
+  tcase_set_timeout (tc_srv, HTTPRSRV_TEST_TIMEOUT);
+  tcase_add_checked_fixture (tc_srv, setup_server, NULL);
+  tcase_add_test (tc_srv, test_httprsrv_slow_listener_overrun);
+  tcase_add_test (tc_srv, test_httprsrv_zerocopy_reaping);
+  suite_add_tcase (s, tc_srv);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed = 0;
+  SRunner * sr = srunner_create (httprsrv_suite ());
+  srunner_set_log (sr, "-");
+  srunner_run_all (sr, CK_VERBOSE);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
@@ -31,6 +31,7 @@
 #endif
 
 #include <assert.h>
+#include <endian.h>
 #include <limits.h>
 #include <string.h>
 
@@ -79,6 +80,55 @@ deinit_mad_decoder (mp3d_prc_t * ap_prc)
   mad_stream_finish (&ap_prc->stream_);
 }
 
+static OMX_ERRORTYPE
+release_output_batch (mp3d_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  if (ap_prc->nout_batch_ > 0)
+    {
+      TIZ_TRACE (handleOf (ap_prc), "Releasing [%d] output HEADERS",
+                 ap_prc->nout_batch_);
+      tiz_check_omx (tiz_krn_release_buffers (
+        tiz_get_krn (handleOf (ap_prc)), ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX,
+        ap_prc->p_out_batch_, ap_prc->nout_batch_));
+      ap_prc->nout_batch_ = 0;
+    }
+  return OMX_ErrorNone;
+}
+
+/* Completed output headers are held back and released in batches, so that
+   a tunnelled peer is woken up once per batch rather than once per header. */
+static OMX_ERRORTYPE
+batch_output_header (mp3d_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  assert (ap_prc->p_outhdr_);
+  assert (ap_prc->nout_batch_ < OUTPUT_BATCH_SIZE);
+
+  if (ap_prc->eos_)
+    {
+      /* EOS has been received and all the input data has been consumed
+       * already, so its time to propagate the EOS flag */
+      ap_prc->p_outhdr_->nFlags |= OMX_BUFFERFLAG_EOS;
+      ap_prc->eos_ = false;
+    }
+  TIZ_TRACE (handleOf (ap_prc),
+             "Batching output HEADER [%p] nFilledLen [%d] nAllocLen [%d]",
+             ap_prc->p_outhdr_, ap_prc->p_outhdr_->nFilledLen,
+             ap_prc->p_outhdr_->nAllocLen);
+  ap_prc->p_out_batch_[ap_prc->nout_batch_++] = ap_prc->p_outhdr_;
+  ap_prc->p_outhdr_ = NULL;
+
+  if (OUTPUT_BATCH_SIZE == ap_prc->nout_batch_
+      || (ap_prc->p_out_batch_[ap_prc->nout_batch_ - 1]->nFlags
+          & OMX_BUFFERFLAG_EOS)
+           != 0)
+    {
+      return release_output_batch (ap_prc);
+    }
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 release_headers (const void * ap_obj, OMX_U32 a_pid)
 {
@@ -109,23 +159,9 @@ release_headers (const void * ap_obj, OMX_U32 a_pid)
     {
       if (p_obj->p_outhdr_)
         {
-          if (p_obj->eos_)
-            {
-              /* EOS has been received and all the input data has been consumed
-               * already, so its time to propagate the EOS flag */
-              p_obj->p_outhdr_->nFlags |= OMX_BUFFERFLAG_EOS;
-              p_obj->eos_ = false;
-            }
-          TIZ_TRACE (
-            handleOf (p_obj),
-            "Releasing output HEADER [%p] nFilledLen [%d] nAllocLen [%d]",
-            p_obj->p_outhdr_, p_obj->p_outhdr_->nFilledLen,
-            p_obj->p_outhdr_->nAllocLen);
-          tiz_check_omx (tiz_krn_release_buffer (
-            tiz_get_krn (handleOf (ap_obj)),
-            ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX, p_obj->p_outhdr_));
-          p_obj->p_outhdr_ = NULL;
+          tiz_check_omx (batch_output_header (p_obj));
         }
+      tiz_check_omx (release_output_batch (p_obj));
     }
   return OMX_ErrorNone;
 }
@@ -280,46 +316,6 @@ store_stream_metadata (mp3d_prc_t * ap_prc, struct mad_header * Header)
              Emphasis, Header->samplerate);
 }
 
-static signed short
-mad_fixed_to_sshort (mad_fixed_t fixed)
-{
-  /* A fixed point number is formed of the following bit pattern:
-   *
-   * SWWWFFFFFFFFFFFFFFFFFFFFFFFFFFFF
-   * MSB                          LSB
-   * S ==> Sign (0 is positive, 1 is negative)
-   * W ==> Whole part bits
-   * F ==> Fractional part bits
-   *
-   * This pattern contains MAD_F_FRACBITS fractional bits, one
-   * should alway use this macro when working on the bits of a fixed
-   * point number. It is not guaranteed to be constant over the
-   * different platforms supported by libmad.
-   *
-   * The signed short value is formed, after clipping, by the least
-   * significant whole part bit, followed by the 15 most significant
-   * fractional part bits. Warning: this is a quick and dirty way to
-   * compute the 16-bit number, madplay includes much better
-   * algorithms.
-   */
-
-  /* Clipping */
-  if (fixed >= MAD_F_ONE)
-    {
-      return (SHRT_MAX);
-    }
-
-  if (fixed <= -MAD_F_ONE)
-    {
-      return (-SHRT_MAX);
-    }
-
-  /* Conversion. */
-  fixed = fixed >> (MAD_F_FRACBITS - 15);
-
-  return (signed short) fixed;
-}
-
 static size_t
 read_from_omx_buffer (const mp3d_prc_t * ap_prc, void * ap_dst, size_t bytes,
                       OMX_BUFFERHEADERTYPE * ap_hdr)
@@ -385,65 +381,80 @@ static int
 synthesize_samples (const void * ap_obj, int next_sample)
 {
   mp3d_prc_t * p_prc = (mp3d_prc_t *) ap_obj;
-  const unsigned char * p_bufend
-    = p_prc->p_outhdr_->pBuffer + p_prc->p_outhdr_->nAllocLen;
-  unsigned char * p_output
-    = p_prc->p_outhdr_->pBuffer + p_prc->p_outhdr_->nFilledLen;
-  bool buffer_full = (p_bufend == p_output);
-  int i;
-
-  for (i = next_sample; i < p_prc->synth_.pcm.length && !buffer_full; i++)
+  const struct mad_pcm * p_pcm = &(p_prc->synth_.pcm);
+  /* Enough for one granule of each channel */
+  int16_t left[sizeof (p_pcm->samples[0]) / sizeof (mad_fixed_t)];
+  int16_t right[sizeof (p_pcm->samples[1]) / sizeof (mad_fixed_t)];
+  /* If the decoded stream is monophonic then the right output channel is the
+   * same as the left one. */
+  const int16_t * planes[2]
+    = {left, MAD_NCHANNELS (&p_prc->frame_.header) == 2 ? right : left};
+  bool buffer_full
+    = (p_prc->p_outhdr_->nAllocLen - p_prc->p_outhdr_->nFilledLen < 4);
+  int i = next_sample;
+
+  while (i < p_pcm->length && !buffer_full)
     {
-      signed short sample;
-
-      /* Left channel */
-      sample = mad_fixed_to_sshort (p_prc->synth_.pcm.samples[0][i]);
-      *(p_output++) = sample >> 8;
-      *(p_output++) = sample & 0xff;
-
-      /* Right channel. If the decoded stream is monophonic then
-       * the right output channel is the same as the left one.
-       */
-      if (MAD_NCHANNELS (&p_prc->frame_.header) == 2)
+      OMX_BUFFERHEADERTYPE * p_hdr = p_prc->p_outhdr_;
+      const OMX_U32 early_release_len
+        = (OMX_U32) (ARATELIA_MP3_DECODER_PORT_MIN_OUTPUT_BUF_SIZE * .2);
+      size_t nframes = MIN ((size_t) (p_pcm->length - i),
+                            (p_hdr->nAllocLen - p_hdr->nFilledLen) / 4);
+      int16_t * p_output = (int16_t *) (p_hdr->pBuffer + p_hdr->nFilledLen);
+
+      if (p_prc->frame_count_ < 5)
         {
-          sample = mad_fixed_to_sshort (p_prc->synth_.pcm.samples[1][i]);
+          /* Stop at the point where the buffer is released early (see
+             below) */
+          nframes = MIN (nframes,
+                         p_hdr->nFilledLen < early_release_len
+                           ? (early_release_len - p_hdr->nFilledLen + 3) / 4
+                           : 1);
         }
-      *(p_output++) = sample >> 8;
-      *(p_output++) = sample & 0xff;
 
-      p_prc->p_outhdr_->nFilledLen += 4;
-
-      if (p_prc->frame_.header.samplerate != p_prc->pcmmode_.nSamplingRate
-          || p_prc->pcmmode_.nChannels < 2)
+      if (nframes > 0)
         {
-          /* We're outputting two channels, also for mono streams.
-           */
-          const OMX_U32 nchannels = 2;
-          TIZ_PRINTF_DBG_GRN ("samplerate [%d] NCHANNELS [%d] channels [%d].",
-                              p_prc->frame_.header.samplerate,
-                              MAD_NCHANNELS (&p_prc->frame_.header),
-                              p_prc->synth_.pcm.channels);
-          store_stream_metadata (p_prc, &(p_prc->frame_.header));
-          (void) update_pcm_mode (p_prc, p_prc->synth_.pcm.samplerate,
-                                  nchannels);
+          tiz_pcm_fixed_to_s16 (left, &(p_pcm->samples[0][i]), nframes,
+                                MAD_F_FRACBITS);
+          if (planes[1] == right)
+            {
+              tiz_pcm_fixed_to_s16 (right, &(p_pcm->samples[1][i]), nframes,
+                                    MAD_F_FRACBITS);
+            }
+          tiz_pcm_s16_interleave (p_output, planes, 2, nframes);
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+          /* NOTE: output of this decoder is currently Big Endian */
+          tiz_pcm_s16_bswap (p_output, nframes * 2);
+#endif
+          p_hdr->nFilledLen += nframes * 4;
+          i += nframes;
+
+          if (p_prc->frame_.header.samplerate != p_prc->pcmmode_.nSamplingRate
+              || p_prc->pcmmode_.nChannels < 2)
+            {
+              /* We're outputting two channels, also for mono streams.
+               */
+              const OMX_U32 nchannels = 2;
+              TIZ_PRINTF_DBG_GRN (
+                "samplerate [%d] NCHANNELS [%d] channels [%d].",
+                p_prc->frame_.header.samplerate,
+                MAD_NCHANNELS (&p_prc->frame_.header), p_pcm->channels);
+              store_stream_metadata (p_prc, &(p_prc->frame_.header));
+              (void) update_pcm_mode (p_prc, p_pcm->samplerate, nchannels);
+            }
         }
 
       /* release the output buffer if it is full, or if we are at the early stages
          of the decoding */
-      if (p_output == p_bufend)
+      if (p_hdr->nAllocLen - p_hdr->nFilledLen < 4)
         {
-          p_output = p_prc->p_outhdr_->pBuffer;
-          p_prc->p_outhdr_->nFilledLen = p_prc->p_outhdr_->nAllocLen;
-          (void) release_headers (p_prc,
-                                  ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX);
+          p_hdr->nFilledLen = p_hdr->nAllocLen;
+          (void) batch_output_header (p_prc);
           buffer_full = true;
         }
       else if (p_prc->frame_count_ < 5
-               && p_prc->p_outhdr_->nFilledLen
-                    >= (int) (ARATELIA_MP3_DECODER_PORT_MIN_OUTPUT_BUF_SIZE
-                              * .2))
+               && p_hdr->nFilledLen >= early_release_len)
         {
-          p_output = p_prc->p_outhdr_->pBuffer;
           (void) release_headers (p_prc,
                                   ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX);
           buffer_full = true;
@@ -451,7 +462,7 @@ synthesize_samples (const void * ap_obj, int next_sample)
     }
 
   /* Return the sample index if there are more samples to process */
-  if (i < p_prc->synth_.pcm.length)
+  if (i < p_pcm->length)
     {
       return i;
     }
@@ -710,6 +721,7 @@ mp3d_proc_ctor (void * ap_obj, va_list * app)
   p_obj->frame_count_ = 0;
   p_obj->p_inhdr_ = 0;
   p_obj->p_outhdr_ = 0;
+  p_obj->nout_batch_ = 0;
   p_obj->next_synth_sample_ = 0;
   p_obj->eos_ = false;
   p_obj->in_port_disabled_ = false;
@@ -847,7 +859,9 @@ mp3d_proc_buffers_ready (const void * ap_obj)
         release_headers (p_obj, ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX));
     }
 
-  return OMX_ErrorNone;
+  /* No more output headers can be produced for now; release whatever is still
+     pending in the output batch */
+  return release_output_batch (p_obj);
 }
 
 static OMX_ERRORTYPE
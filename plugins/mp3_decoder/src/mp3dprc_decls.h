@@ -42,6 +42,7 @@ extern "C" {
 
 #define INPUT_BUFFER_SIZE (5 * 8192)
 #define OUTPUT_BUFFER_SIZE 8192 /* Must be an integer multiple of 4. */
+#define OUTPUT_BATCH_SIZE 4 /* Max output headers released in one go. */
 
 typedef struct mp3d_prc mp3d_prc_t;
 struct mp3d_prc
@@ -58,6 +59,8 @@ struct mp3d_prc
   unsigned char in_buff_[INPUT_BUFFER_SIZE + MAD_BUFFER_GUARD];
   OMX_BUFFERHEADERTYPE * p_inhdr_;
   OMX_BUFFERHEADERTYPE * p_outhdr_;
+  OMX_BUFFERHEADERTYPE * p_out_batch_[OUTPUT_BATCH_SIZE];
+  OMX_U32 nout_batch_;
   int next_synth_sample_;
   bool eos_;
   bool in_port_disabled_;
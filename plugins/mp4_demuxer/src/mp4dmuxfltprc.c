@@ -44,6 +44,7 @@
 #include <tizscheduler.h>
 
 #include "mp4dmux.h"
+#include "mp4dmuxio.h"
 #include "mp4dmuxfltprc.h"
 #include "mp4dmuxfltprc_decls.h"
 
@@ -52,8 +53,6 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.mp4_demuxer.filter.prc"
 #endif
 
-static mp4dmuxflt_prc_t * gp_prc = NULL;
-
 #define FILE_SIZE 7747480
 #define MP4V2_INT_MAX_FAILED_ATTEMPTS 20
 
@@ -89,6 +88,8 @@ get_mp4_hdr (mp4dmuxflt_prc_t * ap_prc)
                                     ARATELIA_MP4_DEMUXER_FILTER_PORT_0_INDEX);
 }
 
+/* mp4v2's log callback is process-wide, so its messages can't be attributed
+   to a particular demuxer instance */
 static void
 mp4_log_cback (MP4LogLevel loglevel, const char * fmt, va_list ap)
 {
@@ -112,53 +113,44 @@ mp4_log_cback (MP4LogLevel loglevel, const char * fmt, va_list ap)
     {
     case MP4_LOG_ERROR:
       {
-        TIZ_ERROR(handleOf(gp_prc), "%s", buffer);
+        TIZ_LOG (TIZ_PRIORITY_ERROR, "%s", buffer);
       }
       break;
     case MP4_LOG_INFO:
       {
-        TIZ_NOTICE(handleOf(gp_prc), "%s", buffer);
+        TIZ_LOG (TIZ_PRIORITY_NOTICE, "%s", buffer);
       }
       break;
     case MP4_LOG_WARNING:
       {
-        TIZ_DEBUG(handleOf(gp_prc), "%s", buffer);
+        TIZ_LOG (TIZ_PRIORITY_DEBUG, "%s", buffer);
       }
       break;
     default:
       {
-        TIZ_TRACE(handleOf(gp_prc), "%s", buffer);
+        TIZ_LOG (TIZ_PRIORITY_TRACE, "%s", buffer);
       }
       break;
     };
 }
 
-static void *
-mp4_open_cback (const char * name, MP4FileMode mode)
-{
-  TIZ_TRACE(handleOf(gp_prc), "file name [%s]", name);
-  return gp_prc;
-}
-
 static int
-mp4_seek_cback (void * ap_handle, int64_t pos)
+mp4_seek_cback (void * ap_arg, int64_t pos)
 {
-  mp4dmuxflt_prc_t * p_prc = ap_handle;
-  assert (gp_prc == ap_handle);
+  mp4dmuxflt_prc_t * p_prc = ap_arg;
   assert (p_prc);
-  TIZ_TRACE(handleOf(gp_prc), "pos [%lld]", pos);
+  TIZ_TRACE (handleOf (p_prc), "pos [%lld]", pos);
   (void)tiz_buffer_seek (p_prc->p_mp4_store_, pos, TIZ_BUFFER_SEEK_SET);
   return 0;
 }
 
 static int
-mp4_read_cback (void * ap_handle, void * ap_buffer, int64_t a_size,
-                int64_t * ap_nin, int64_t a_maxChunkSize)
+mp4_read_cback (void * ap_arg, void * ap_buffer, int64_t a_size,
+                int64_t * ap_nin)
 {
-  mp4dmuxflt_prc_t * p_prc = ap_handle;
+  mp4dmuxflt_prc_t * p_prc = ap_arg;
   int retval = -1;
 
-  assert (gp_prc == ap_handle);
   assert (p_prc);
   assert (ap_buffer);
   assert (ap_nin);
@@ -195,28 +187,6 @@ mp4_read_cback (void * ap_handle, void * ap_buffer, int64_t a_size,
   return retval;
 }
 
-static int
-mp4_write_cback (void * handle, const void * buffer, int64_t size, int64_t * nout,
-           int64_t maxChunkSize)
-{
-  TIZ_TRACE(handleOf(gp_prc), "");
-  return 0;
-}
-
-static int
-mp4_close_cback (void * handle)
-{
-  TIZ_TRACE(handleOf(gp_prc), "");
-  return 0;
-}
-
-/* static int64_t */
-/* mp4_get_size (void * handle) */
-/* { */
-/*   TIZ_TRACE(handleOf(gp_prc), "FILE_SIZE"); */
-/*   return FILE_SIZE; */
-/* } */
-
 static void
 propagate_eos_if_required (mp4dmuxflt_prc_t * ap_prc,
                            OMX_BUFFERHEADERTYPE * ap_out_hdr)
@@ -659,13 +629,10 @@ alloc_mp4v2 (mp4dmuxflt_prc_t * ap_prc)
   TIZ_TRACE(handleOf(ap_prc), "");
   if (!MP4_IS_VALID_FILE_HANDLE (ap_prc->mp4v2_hdl_))
     {
-/*       const MP4FileProvider provider */
-/*         = {mp4_open_cback, mp4_seek_cback, mp4_read_cback, mp4_write_cback, */
-/*            mp4_close_cback, mp4_get_size}; */
-      const MP4FileProvider provider
-        = {mp4_open_cback, mp4_seek_cback, mp4_read_cback, mp4_write_cback,
-           mp4_close_cback};
-      ap_prc->mp4v2_hdl_ = MP4ReadProvider ("Tizonia", &provider);
+      ap_prc->io_.p_arg = ap_prc;
+      ap_prc->io_.pf_seek = mp4_seek_cback;
+      ap_prc->io_.pf_read = mp4_read_cback;
+      ap_prc->mp4v2_hdl_ = mp4dmux_io_read (&(ap_prc->io_));
       TIZ_TRACE(handleOf(ap_prc), "MP4ReadProvider");
       if (!MP4_IS_VALID_FILE_HANDLE (ap_prc->mp4v2_hdl_))
         {
@@ -975,6 +942,9 @@ mp4dmuxflt_prc_ctor (void * ap_prc, va_list * app)
     = super_ctor (typeOf (ap_prc, "mp4dmuxfltprc"), ap_prc, app);
   assert (p_prc);
   p_prc->mp4v2_hdl_ = MP4_INVALID_FILE_HANDLE;
+  p_prc->io_.p_arg = NULL;
+  p_prc->io_.pf_seek = NULL;
+  p_prc->io_.pf_read = NULL;
   p_prc->mp4v2_inited_ = false;
   p_prc->mp4v2_duration_ = 0;
   p_prc->p_mp4_store_ = NULL;
@@ -984,7 +954,6 @@ mp4dmuxflt_prc_ctor (void * ap_prc, va_list * app)
   p_prc->p_vid_header_lengths_ = NULL;
   reset_stream_parameters (p_prc);
   MP4SetLogCallback(mp4_log_cback);
-  gp_prc = ap_prc;
   return p_prc;
 }
 
@@ -992,7 +961,6 @@ static void *
 mp4dmuxflt_prc_dtor (void * ap_obj)
 {
   (void) mp4dmuxflt_prc_deallocate_resources (ap_obj);
-  gp_prc = NULL;
   return super_dtor (typeOf (ap_obj, "mp4dmuxfltprc"), ap_obj);
 }
 
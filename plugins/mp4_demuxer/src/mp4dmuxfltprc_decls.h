@@ -44,6 +44,7 @@ extern "C" {
 #include <tizfilterprc_decls.h>
 
 #include "mp4info.h"
+#include "mp4dmuxio.h"
 
 typedef struct mp4dmuxflt_prc mp4dmuxflt_prc_t;
 struct mp4dmuxflt_prc
@@ -51,6 +52,7 @@ struct mp4dmuxflt_prc
   /* Object */
   const tiz_filter_prc_t _;
   MP4FileHandle mp4v2_hdl_;
+  mp4dmux_io_t io_;
   bool mp4v2_inited_;
   uint64_t mp4v2_duration_;
   mp4_track_type_t track_type_;
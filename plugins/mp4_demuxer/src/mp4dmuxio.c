@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   mp4dmuxio.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia - Per-instance mp4v2 file provider
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "mp4dmuxio.h"
+
+#define MP4DMUX_IO_NAME_PREFIX "tizonia-mp4dmux:"
+#define MP4DMUX_IO_NAME_MAX_LEN 64
+
+static void *
+io_open_cback (const char * name, MP4FileMode mode)
+{
+  void * p_io = NULL;
+  assert (name);
+  if (FILEMODE_READ != mode
+      || 1 != sscanf (name, MP4DMUX_IO_NAME_PREFIX "%p", &p_io))
+    {
+      return NULL;
+    }
+  return p_io;
+}
+
+static int
+io_seek_cback (void * ap_handle, int64_t pos)
+{
+  mp4dmux_io_t * p_io = ap_handle;
+  assert (p_io);
+  assert (p_io->pf_seek);
+  return p_io->pf_seek (p_io->p_arg, pos);
+}
+
+static int
+io_read_cback (void * ap_handle, void * ap_buffer, int64_t a_size,
+               int64_t * ap_nin, int64_t a_maxChunkSize)
+{
+  mp4dmux_io_t * p_io = ap_handle;
+  assert (p_io);
+  assert (p_io->pf_read);
+  return p_io->pf_read (p_io->p_arg, ap_buffer, a_size, ap_nin);
+}
+
+static int
+io_write_cback (void * ap_handle, const void * ap_buffer, int64_t a_size,
+                int64_t * ap_nout, int64_t a_maxChunkSize)
+{
+  /* Read-only */
+  return 1;
+}
+
+static int
+io_close_cback (void * ap_handle)
+{
+  /* Nothing to do; ap_handle is owned by the client */
+  return 0;
+}
+
+MP4FileHandle
+mp4dmux_io_read (mp4dmux_io_t * ap_io)
+{
+  const MP4FileProvider provider = {io_open_cback, io_seek_cback,
+                                    io_read_cback, io_write_cback,
+                                    io_close_cback};
+  char name[MP4DMUX_IO_NAME_MAX_LEN];
+
+  assert (ap_io);
+  assert (ap_io->pf_seek);
+  assert (ap_io->pf_read);
+
+  snprintf (name, sizeof (name), MP4DMUX_IO_NAME_PREFIX "%p", (void *) ap_io);
+  return MP4ReadProvider (name, &provider);
+}
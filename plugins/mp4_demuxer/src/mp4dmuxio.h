@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   mp4dmuxio.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia - Per-instance mp4v2 file provider
+ *
+ *
+ */
+
+#ifndef MP4DMUXIO_H
+#define MP4DMUXIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <mp4v2/mp4v2.h>
+
+/**
+ * Re-positions the input stream.
+ *
+ * @param ap_arg The client data.
+ * @param a_pos The new position, from the start of the stream.
+ * @return 0 on success, non-zero on error.
+ */
+typedef int (*mp4dmux_io_seek_f) (void * ap_arg, int64_t a_pos);
+
+/**
+ * Reads data from the input stream.
+ *
+ * @param ap_arg The client data.
+ * @param ap_buf The destination buffer.
+ * @param a_size The number of bytes requested.
+ * @param ap_nin The number of bytes actually read.
+ * @return 0 on success, non-zero on error (or if not enough data is
+ * available).
+ */
+typedef int (*mp4dmux_io_read_f) (void * ap_arg, void * ap_buf,
+                                  int64_t a_size, int64_t * ap_nin);
+
+typedef struct mp4dmux_io mp4dmux_io_t;
+struct mp4dmux_io
+{
+  void * p_arg;
+  mp4dmux_io_seek_f pf_seek;
+  mp4dmux_io_read_f pf_read;
+};
+
+/**
+ * Opens an mp4 stream for reading, using the io callbacks in ap_io.
+ *
+ * mp4v2's file providers do not have a client data argument. The address of
+ * ap_io is passed to the provider's open function encoded in the file name,
+ * so that any number of streams can be read concurrently, each one with its
+ * own callbacks. ap_io must remain valid until the handle is closed with
+ * MP4Close.
+ *
+ * @param ap_io The io callbacks and client data.
+ * @return A valid mp4v2 file handle, or MP4_INVALID_FILE_HANDLE on error.
+ */
+MP4FileHandle
+mp4dmux_io_read (mp4dmux_io_t * ap_io);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MP4DMUXIO_H */
@@ -0,0 +1,337 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_mp4dmuxio.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  MP4 demuxer's per-instance file provider unit tests
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <check.h>
+
+#include "mp4dmuxio.h"
+
+#define MP4DMUXIO_TEST_TIMEOUT 60
+#define MP4DMUXIO_TEST_INSTANCES 8
+#define MP4DMUXIO_TEST_SAMPLES 200
+#define MP4DMUXIO_TEST_SAMPLE_SIZE 300
+
+/* One in-memory mp4 stream per demuxer instance */
+typedef struct check_stream check_stream_t;
+struct check_stream
+{
+  int id;
+  unsigned char * p_data;
+  int64_t len;
+  int64_t pos;
+  mp4dmux_io_t io;
+  MP4FileHandle hdl;
+  MP4TrackId track;
+  int errors;
+};
+
+static check_stream_t g_streams[MP4DMUXIO_TEST_INSTANCES];
+
+static void
+fill_sample (unsigned char * ap_sample, const int a_stream_id,
+             const int a_sample_id)
+{
+  int i = 0;
+  for (i = 0; i < MP4DMUXIO_TEST_SAMPLE_SIZE; ++i)
+    {
+      ap_sample[i] = (unsigned char) ((a_stream_id * 31 + a_sample_id + i)
+                                      & 0xff);
+    }
+}
+
+static bool
+create_test_file (const int a_stream_id, const char * ap_path)
+{
+  unsigned char sample[MP4DMUXIO_TEST_SAMPLE_SIZE];
+  MP4FileHandle hdl = MP4_INVALID_FILE_HANDLE;
+  MP4TrackId track = MP4_INVALID_TRACK_ID;
+  int i = 0;
+  bool rc = true;
+
+  hdl = MP4Create (ap_path, 0);
+  if (!MP4_IS_VALID_FILE_HANDLE (hdl))
+    {
+      return false;
+    }
+
+  MP4SetTimeScale (hdl, 44100);
+  track = MP4AddAudioTrack (hdl, 44100, 1024, MP4_MPEG4_AUDIO_TYPE);
+  rc = (MP4_INVALID_TRACK_ID != track);
+
+  for (i = 1; rc && i <= MP4DMUXIO_TEST_SAMPLES; ++i)
+    {
+      fill_sample (sample, a_stream_id, i);
+      rc = MP4WriteSample (hdl, track, sample, sizeof (sample),
+                           MP4_INVALID_DURATION, 0, true);
+    }
+
+  MP4Close (hdl, 0);
+  return rc;
+}
+
+static bool
+load_test_file (check_stream_t * ap_stream, const char * ap_path)
+{
+  FILE * p_file = NULL;
+  bool rc = false;
+
+  if ((p_file = fopen (ap_path, "rb")))
+    {
+      fseek (p_file, 0, SEEK_END);
+      ap_stream->len = ftell (p_file);
+      fseek (p_file, 0, SEEK_SET);
+      ap_stream->p_data = malloc (ap_stream->len);
+      rc = (ap_stream->p_data
+            && 1 == fread (ap_stream->p_data, ap_stream->len, 1, p_file));
+      fclose (p_file);
+    }
+  return rc;
+}
+
+static int
+stream_seek (void * ap_arg, int64_t a_pos)
+{
+  check_stream_t * p_stream = ap_arg;
+  if (a_pos < 0 || a_pos > p_stream->len)
+    {
+      return 1;
+    }
+  p_stream->pos = a_pos;
+  return 0;
+}
+
+static int
+stream_read (void * ap_arg, void * ap_buf, int64_t a_size, int64_t * ap_nin)
+{
+  check_stream_t * p_stream = ap_arg;
+  *ap_nin = 0;
+  if (p_stream->pos + a_size > p_stream->len)
+    {
+      return 1;
+    }
+  memcpy (ap_buf, p_stream->p_data + p_stream->pos, a_size);
+  p_stream->pos += a_size;
+  *ap_nin = a_size;
+  /* Give the other instances a chance to run in between reads */
+  sched_yield ();
+  return 0;
+}
+
+static void
+setup_streams (void)
+{
+  int i = 0;
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      char path[64];
+      check_stream_t * p_stream = &g_streams[i];
+      memset (p_stream, 0, sizeof (check_stream_t));
+      p_stream->id = i;
+      p_stream->io.p_arg = p_stream;
+      p_stream->io.pf_seek = stream_seek;
+      p_stream->io.pf_read = stream_read;
+      p_stream->hdl = MP4_INVALID_FILE_HANDLE;
+
+      snprintf (path, sizeof (path), "check_mp4dmuxio_%d.mp4", i);
+      ck_assert (create_test_file (i, path));
+      ck_assert (load_test_file (p_stream, path));
+      (void) remove (path);
+    }
+}
+
+static void
+teardown_streams (void)
+{
+  int i = 0;
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      if (MP4_IS_VALID_FILE_HANDLE (g_streams[i].hdl))
+        {
+          MP4Close (g_streams[i].hdl, 0);
+        }
+      free (g_streams[i].p_data);
+      g_streams[i].p_data = NULL;
+    }
+}
+
+static void
+open_stream (check_stream_t * ap_stream)
+{
+  ap_stream->hdl = mp4dmux_io_read (&(ap_stream->io));
+  if (MP4_IS_VALID_FILE_HANDLE (ap_stream->hdl))
+    {
+      ap_stream->track
+        = MP4FindTrackId (ap_stream->hdl, 0, MP4_AUDIO_TRACK_TYPE, 0);
+    }
+}
+
+static void
+read_and_verify_sample (check_stream_t * ap_stream, const MP4SampleId a_sid)
+{
+  unsigned char expected[MP4DMUXIO_TEST_SAMPLE_SIZE];
+  uint8_t * p_bytes = NULL;
+  uint32_t nbytes = 0;
+
+  if (!MP4ReadSample (ap_stream->hdl, ap_stream->track, a_sid, &p_bytes,
+                      &nbytes, NULL, NULL, NULL, NULL))
+    {
+      ap_stream->errors++;
+      return;
+    }
+
+  fill_sample (expected, ap_stream->id, a_sid);
+  if (nbytes != sizeof (expected) || memcmp (p_bytes, expected, nbytes))
+    {
+      /* The data came from another instance's stream */
+      ap_stream->errors++;
+    }
+  MP4Free (p_bytes);
+}
+
+START_TEST (test_mp4dmuxio_interleaved_instances)
+{
+  MP4SampleId sid = 0;
+  int i = 0;
+
+  /* All the instances are open at the same time... */
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      open_stream (&g_streams[i]);
+      ck_assert (MP4_IS_VALID_FILE_HANDLE (g_streams[i].hdl));
+      ck_assert (MP4_INVALID_TRACK_ID != g_streams[i].track);
+      ck_assert (MP4DMUXIO_TEST_SAMPLES
+                 == MP4GetTrackNumberOfSamples (g_streams[i].hdl,
+                                                g_streams[i].track));
+    }
+
+  /* ...and their reads are interleaved */
+  for (sid = 1; sid <= MP4DMUXIO_TEST_SAMPLES; ++sid)
+    {
+      for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+        {
+          const int idx = (i + sid) % MP4DMUXIO_TEST_INSTANCES;
+          read_and_verify_sample (&g_streams[idx], sid);
+        }
+    }
+
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      ck_assert_int_eq (g_streams[i].errors, 0);
+    }
+}
+END_TEST
+
+static void *
+stream_thread_func (void * ap_arg)
+{
+  check_stream_t * p_stream = ap_arg;
+  MP4SampleId sid = 0;
+
+  open_stream (p_stream);
+  if (!MP4_IS_VALID_FILE_HANDLE (p_stream->hdl)
+      || MP4_INVALID_TRACK_ID == p_stream->track)
+    {
+      p_stream->errors++;
+      return NULL;
+    }
+
+  /* Read the samples in reverse order, to force seeks on every read */
+  for (sid = MP4DMUXIO_TEST_SAMPLES; sid >= 1; --sid)
+    {
+      read_and_verify_sample (p_stream, sid);
+    }
+  return NULL;
+}
+
+START_TEST (test_mp4dmuxio_concurrent_instances)
+{
+  pthread_t threads[MP4DMUXIO_TEST_INSTANCES];
+  int i = 0;
+
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      ck_assert (0 == pthread_create (&threads[i], NULL, stream_thread_func,
+                                      &g_streams[i]));
+    }
+
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      pthread_join (threads[i], NULL);
+    }
+
+  for (i = 0; i < MP4DMUXIO_TEST_INSTANCES; ++i)
+    {
+      ck_assert_int_eq (g_streams[i].errors, 0);
+    }
+}
+END_TEST
+
+Suite *
+mp4dmuxio_suite (void)
+{
+  TCase * tc_io;
+  Suite * s = suite_create ("mp4_demuxer");
+
+  /* test case */
+  tc_io = tcase_create ("Per-instance mp4v2 file provider");
+  tcase_set_timeout (tc_io, MP4DMUXIO_TEST_TIMEOUT);
+  tcase_add_checked_fixture (tc_io, setup_streams, teardown_streams);
+  tcase_add_test (tc_io, test_mp4dmuxio_interleaved_instances);
+  tcase_add_test (tc_io, test_mp4dmuxio_concurrent_instances);
+  suite_add_tcase (s, tc_io);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed = 0;
+  SRunner * sr = srunner_create (mp4dmuxio_suite ());
+  srunner_set_log (sr, "-");
+  srunner_run_all (sr, CK_VERBOSE);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
@@ -307,6 +307,8 @@ dealloc_data_stores (/*@special@ */ oggdmux_prc_t * ap_prc)
   ap_prc->vid_store_size_ = 0;
   ap_prc->aud_store_offset_ = 0;
   ap_prc->vid_store_offset_ = 0;
+  ap_prc->aud_store_pos_ = 0;
+  ap_prc->vid_store_pos_ = 0;
 }
 
 static inline OMX_U8 **
@@ -346,6 +348,19 @@ get_store_offset_ptr (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid)
   return p_offset;
 }
 
+static inline OMX_U32 *
+get_store_pos_ptr (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid)
+{
+  OMX_U32 * p_pos = NULL;
+  assert (ap_prc);
+  assert (a_pid <= ARATELIA_OGG_DEMUXER_VIDEO_PORT_BASE_INDEX);
+  p_pos = a_pid == ARATELIA_OGG_DEMUXER_AUDIO_PORT_BASE_INDEX
+            ? &(ap_prc->aud_store_pos_)
+            : &(ap_prc->vid_store_pos_);
+  assert (p_pos);
+  return p_pos;
+}
+
 static inline bool *
 get_port_disabled_ptr (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid)
 {
@@ -391,6 +406,7 @@ store_data (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid, const OMX_U8 * ap_data,
 {
   OMX_U8 ** pp_store = NULL;
   OMX_U32 * p_offset = NULL;
+  OMX_U32 * p_pos = NULL;
   OMX_U32 * p_size = NULL;
   OMX_U32 nbytes_to_copy = 0;
   OMX_U32 nbytes_avail = 0;
@@ -402,13 +418,26 @@ store_data (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid, const OMX_U8 * ap_data,
   pp_store = get_store_ptr (ap_prc, a_pid);
   p_size = get_store_size_ptr (ap_prc, a_pid);
   p_offset = get_store_offset_ptr (ap_prc, a_pid);
+  p_pos = get_store_pos_ptr (ap_prc, a_pid);
 
   assert (pp_store && *pp_store);
   assert (p_size);
   assert (p_offset);
+  assert (p_pos);
+  assert (*p_pos <= *p_offset);
 
   nbytes_avail = *p_size - *p_offset;
 
+  if (a_nbytes > nbytes_avail && *p_pos > 0)
+    {
+      /* Reclaim the space already drained by dump_temp_store before growing
+       * the store. This is the only place where stored data is moved. */
+      *p_offset -= *p_pos;
+      memmove (*pp_store, *pp_store + *p_pos, *p_offset);
+      *p_pos = 0;
+      nbytes_avail = *p_size - *p_offset;
+    }
+
   if (a_nbytes > nbytes_avail)
     {
       /* need to re-alloc */
@@ -430,7 +459,7 @@ store_data (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid, const OMX_U8 * ap_data,
   *p_offset += nbytes_to_copy;
 
   TIZ_TRACE (handleOf (ap_prc), "pid [%d]: bytes currently stored [%d]", a_pid,
-             *p_offset);
+             *p_offset - *p_pos);
 
   return a_nbytes - nbytes_to_copy;
 }
@@ -441,6 +470,7 @@ dump_temp_store (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid,
 {
   OMX_U8 * p_store = NULL;
   OMX_U32 * p_offset = NULL;
+  OMX_U32 * p_pos = NULL;
   OMX_U32 nbytes_to_copy = 0;
   OMX_U32 nbytes_avail = 0;
 
@@ -450,30 +480,37 @@ dump_temp_store (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid,
 
   p_store = *(get_store_ptr (ap_prc, a_pid));
   p_offset = get_store_offset_ptr (ap_prc, a_pid);
+  p_pos = get_store_pos_ptr (ap_prc, a_pid);
 
   assert (p_store);
   assert (p_offset);
+  assert (p_pos);
+  assert (*p_pos <= *p_offset);
   assert (ap_hdr->nAllocLen >= ap_hdr->nFilledLen);
 
   nbytes_avail = ap_hdr->nAllocLen - ap_hdr->nFilledLen;
-  nbytes_to_copy = MIN (*p_offset, nbytes_avail);
+  nbytes_to_copy = MIN (*p_offset - *p_pos, nbytes_avail);
 
   if (nbytes_to_copy > 0)
     {
-      memcpy (ap_hdr->pBuffer + ap_hdr->nFilledLen, p_store, nbytes_to_copy);
+      /* Drain from the read position; the remaining bytes stay where they
+         are until store_data needs the space back */
+      memcpy (ap_hdr->pBuffer + ap_hdr->nFilledLen, p_store + *p_pos,
+              nbytes_to_copy);
       ap_hdr->nFilledLen += nbytes_to_copy;
-      *p_offset -= nbytes_to_copy;
-      if (*p_offset > 0)
+      *p_pos += nbytes_to_copy;
+      if (*p_pos == *p_offset)
         {
-          memmove (p_store, p_store + nbytes_to_copy, *p_offset);
+          *p_offset = 0;
+          *p_pos = 0;
         }
       TIZ_TRACE (handleOf (ap_prc),
                  "HEADER [%p] pid [%d] nFilledLen [%d] "
-                 "offset [%d]",
-                 ap_hdr, a_pid, ap_hdr->nFilledLen, *p_offset);
+                 "offset [%d] pos [%d]",
+                 ap_hdr, a_pid, ap_hdr->nFilledLen, *p_offset, *p_pos);
     }
 
-  return *p_offset;
+  return *p_offset - *p_pos;
 }
 
 static OMX_U32
@@ -587,9 +624,11 @@ flush_temp_store (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid)
 {
   OMX_BUFFERHEADERTYPE * p_hdr = NULL;
   OMX_U32 * p_offset = get_store_offset_ptr (ap_prc, a_pid);
-  OMX_U32 ds_offset = *p_offset;
+  OMX_U32 * p_pos = get_store_pos_ptr (ap_prc, a_pid);
+  OMX_U32 ds_offset = 0;
 
   assert (p_offset);
+  assert (p_pos);
 
   if (0 == *p_offset)
     {
@@ -597,6 +636,9 @@ flush_temp_store (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid)
       return 0;
     }
 
+  /* Bytes still in the store, should no header be available */
+  ds_offset = *p_offset - *p_pos;
+
   while ((p_hdr = get_header (ap_prc, a_pid)))
     {
       ds_offset = dump_temp_store (ap_prc, a_pid, p_hdr);
@@ -604,12 +646,11 @@ flush_temp_store (oggdmux_prc_t * ap_prc, const OMX_U32 a_pid)
       if (a_pid == ARATELIA_OGG_DEMUXER_AUDIO_PORT_BASE_INDEX)
         {
           g_total_released += p_hdr->nFilledLen;
-          OMX_U32 * p_offset = get_store_offset_ptr (ap_prc, a_pid);
           TIZ_TRACE (handleOf (ap_prc),
                      "total released [%d] "
                      "total read [%d] store [%d] last read [%d] diff [%d]",
-                     g_total_released, g_total_read, *p_offset, g_last_read,
-                     g_total_read - (g_total_released + *p_offset));
+                     g_total_released, g_total_read, ds_offset, g_last_read,
+                     g_total_read - (g_total_released + ds_offset));
         }
 #endif
       if (ap_prc->file_eos_ && 0 == ds_offset)
@@ -828,6 +869,8 @@ do_flush (oggdmux_prc_t * ap_prc)
   (void) oggz_purge (ap_prc->p_oggz_);
   ap_prc->aud_store_offset_ = 0;
   ap_prc->vid_store_offset_ = 0;
+  ap_prc->aud_store_pos_ = 0;
+  ap_prc->vid_store_pos_ = 0;
   /* Release any buffers held  */
   return release_all_buffers (ap_prc, OMX_ALL);
 }
@@ -1096,6 +1139,8 @@ oggdmux_prc_ctor (void * ap_obj, va_list * app)
   p_prc->vid_store_size_ = 0;
   p_prc->aud_store_offset_ = 0;
   p_prc->vid_store_offset_ = 0;
+  p_prc->aud_store_pos_ = 0;
+  p_prc->vid_store_pos_ = 0;
   p_prc->file_eos_ = false;
   p_prc->aud_eos_ = false;
   p_prc->vid_eos_ = false;
@@ -58,6 +58,8 @@ struct oggdmux_prc
   OMX_U32 vid_store_size_;
   OMX_U32 aud_store_offset_;
   OMX_U32 vid_store_offset_;
+  OMX_U32 aud_store_pos_;
+  OMX_U32 vid_store_pos_;
   bool file_eos_;
   bool aud_eos_;
   bool vid_eos_;
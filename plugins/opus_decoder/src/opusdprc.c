@@ -33,7 +33,6 @@
 #include <assert.h>
 #include <limits.h>
 #include <string.h>
-#include <math.h>
 
 #include <tizplatform.h>
 
@@ -44,20 +43,6 @@
 #include "opusdprc.h"
 #include "opusdprc_decls.h"
 
-#ifdef HAVE_LRINTF
-#define float2int(x) lrintf (x)
-#else
-#define float2int(flt) ((int) (floor (.5 + flt)))
-#endif
-
-#ifndef HAVE_FMINF
-#define fminf(_x, _y) ((_x) < (_y) ? (_x) : (_y))
-#endif
-
-#ifndef HAVE_FMAXF
-#define fmaxf(_x, _y) ((_x) > (_y) ? (_x) : (_y))
-#endif
-
 #ifdef TIZ_LOG_CATEGORY_NAME
 #undef TIZ_LOG_CATEGORY_NAME
 #define TIZ_LOG_CATEGORY_NAME "tiz.opus_decoder.prc"
@@ -422,9 +407,7 @@ transform_buffer (opusd_prc_t * ap_prc)
     opus_int32 len = p_in->nFilledLen;
     int fec = 0;
     float * output = NULL;
-    short * out = NULL;
     unsigned out_len = 0;
-    int i = 0;
     int tmp_skip = 0;
     int frame_size = opus_multistream_decode_float (ap_prc->p_opus_dec_, p_data,
                                                     len, ap_prc->p_out_buf_,
@@ -445,12 +428,8 @@ transform_buffer (opusd_prc_t * ap_prc)
         out_len = frame_size - tmp_skip;
 
         /* Convert to short and save to output file */
-        out = (short *) (p_out->pBuffer + p_out->nOffset);
-        for (i = 0; i < (int) out_len * ap_prc->channels_; ++i)
-          {
-            out[i] = (short) float2int (
-              fmaxf (-32768, fminf (output[i] * 32768.f, 32767)));
-          }
+        tiz_pcm_float_to_s16 ((int16_t *) (p_out->pBuffer + p_out->nOffset),
+                              output, out_len * ap_prc->channels_);
 
         if ((p_in->nFlags & OMX_BUFFERFLAG_EOS) > 0)
           {
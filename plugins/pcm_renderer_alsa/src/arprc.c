@@ -34,7 +34,6 @@
 #include <errno.h>
 #include <math.h>
 #include <string.h>
-#include <byteswap.h>
 
 #include <tizplatform.h>
 
@@ -436,37 +435,6 @@ do_flush (ar_prc_t * ap_prc)
   return release_header (ap_prc);
 }
 
-static float
-sint_to_float (const int a_sample)
-{
-  float f;
-  if (a_sample >= 0)
-    {
-      f = a_sample / 32767.0;
-    }
-  else
-    {
-      f = a_sample / 32768.0;
-    }
-  return f;
-}
-
-static int
-float_to_sint (const float a_sample)
-{
-  float f;
-  f = a_sample * 32767;
-  if (f < -32768)
-    {
-      f = -32768;
-    }
-  if (f > 32767)
-    {
-      f = 32767;
-    }
-  return (int) f;
-}
-
 static void
 adjust_gain (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
              const snd_pcm_uframes_t a_samples_per_channel)
@@ -476,23 +444,11 @@ adjust_gain (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
 
   if (ARATELIA_AUDIO_RENDERER_DEFAULT_GAIN_VALUE != ap_prc->gain_)
     {
-      int i;
       int gainadj = (int) (ap_prc->gain_ * 256.);
       float gain = pow (10., gainadj / 5120.);
-      /*       gain = 3.1f; */
-      /*       fprintf (stderr, "%f samples %ld\n", gain, a_samples_per_channel); */
-      OMX_S16 * pcm = (OMX_S16 *) (ap_hdr->pBuffer + ap_hdr->nOffset);
-      for (i = 0; i < a_samples_per_channel; i++)
-        {
-          float f = sint_to_float (*pcm);
-          f *= gain;
-          int v = float_to_sint (f);
-          *(pcm++) = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
-          f = sint_to_float (*pcm);
-          f *= gain;
-          v = float_to_sint (f);
-          *(pcm++) = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
-        }
+      tiz_pcm_s16_gain ((int16_t *) (ap_hdr->pBuffer + ap_hdr->nOffset),
+                        a_samples_per_channel * ap_prc->pcmmode_.nChannels,
+                        gain);
     }
 }
 
@@ -504,15 +460,8 @@ swap_byte_order_s16 (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
   assert (ap_hdr);
   assert (ap_hdr->pBuffer);
 
-  {
-    OMX_S16 * p_pcm = (OMX_S16 *) (ap_hdr->pBuffer + ap_hdr->nOffset);
-    int i = 0;
-    for (i = 0; i < a_samples; ++i)
-      {
-        *p_pcm = bswap_16 (*p_pcm);
-        p_pcm++;
-      }
-  }
+  tiz_pcm_s16_bswap ((int16_t *) (ap_hdr->pBuffer + ap_hdr->nOffset),
+                     a_samples);
 }
 
 static void
@@ -53,6 +53,9 @@ extern "C" {
 #define ARATELIA_SPOTIFY_SOURCE_DEFAULT_CACHE_SECONDS 6
 #define ARATELIA_SPOTIFY_SOURCE_MIN_CACHE_SECONDS 7
 #define ARATELIA_SPOTIFY_SOURCE_MAX_CACHE_SECONDS 12
+/* Size of the pcm store, in seconds of 44.1KHz, 16-bit stereo audio */
+#define ARATELIA_SPOTIFY_SOURCE_STORE_SECONDS 8
+#define ARATELIA_SPOTIFY_SOURCE_STORE_BYTES_PER_SECOND (44100 * 2 * 2)
 
 #ifdef __cplusplus
 }
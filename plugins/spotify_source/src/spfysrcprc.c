@@ -45,6 +45,7 @@
 
 #include <tizkernel.h>
 #include <tizscheduler.h>
+#include <tizdatachan.h>
 
 #include "spfysrc.h"
 #include "spfysrcprc.h"
@@ -87,6 +88,8 @@ static void
 end_of_track_handler (OMX_PTR ap_prc, tiz_event_pluggable_t * ap_event);
 static OMX_ERRORTYPE
 obtain_next_url (spfysrc_prc_t * ap_prc, int a_skip_value);
+static void
+music_delivery_handler (OMX_PTR ap_prc, tiz_data_chan_t * ap_chan);
 
 #define on_spotifyweb_error_ret_omx_oom(expr)                                \
   do                                                                         \
@@ -107,15 +110,6 @@ extern const uint8_t g_appkey[];
 /* The size of the application key. */
 extern const size_t g_appkey_size;
 
-typedef struct spfy_music_delivery_data spfy_music_delivery_data_t;
-struct spfy_music_delivery_data
-{
-  sp_session * p_sess;
-  sp_audioformat format;
-  void * p_frames;
-  int num_frames;
-};
-
 static char *
 concat (const char * s1, const char * s2)
 {
@@ -170,7 +164,7 @@ static void
 reset_stream_parameters (spfysrc_prc_t * ap_prc)
 {
   assert (ap_prc);
-  tiz_buffer_clear (ap_prc->p_store_);
+  tiz_data_chan_clear (ap_prc->p_store_);
   ap_prc->initial_cache_bytes_
     = ((ARATELIA_SPOTIFY_SOURCE_DEFAULT_BIT_RATE_KBITS * 1000) / 8)
       * ARATELIA_SPOTIFY_SOURCE_DEFAULT_CACHE_SECONDS;
@@ -581,13 +575,20 @@ static OMX_ERRORTYPE
 allocate_temp_data_store (spfysrc_prc_t * ap_prc)
 {
   OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  size_t store_bytes = ARATELIA_SPOTIFY_SOURCE_STORE_SECONDS
+                       * ARATELIA_SPOTIFY_SOURCE_STORE_BYTES_PER_SECOND;
   assert (ap_prc);
   TIZ_INIT_OMX_PORT_STRUCT (port_def, ARATELIA_SPOTIFY_SOURCE_PORT_INDEX);
   tiz_check_omx (
     tiz_api_GetParameter (tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
                           OMX_IndexParamPortDefinition, &port_def));
   assert (ap_prc->p_store_ == NULL);
-  return tiz_buffer_init (&(ap_prc->p_store_), port_def.nBufferSize);
+  /* The store is filled directly from libspotify's thread, and it must be
+     able to hold more than max_cache_bytes_, since delivery only pauses once
+     that has been exceeded. */
+  store_bytes = MAX (store_bytes, port_def.nBufferSize);
+  return tiz_data_chan_init (&(ap_prc->p_store_), ap_prc, store_bytes,
+                             music_delivery_handler);
 }
 
 static inline void
@@ -597,7 +598,7 @@ deallocate_temp_data_store (
 /*@ensures isnull ap_prc->p_store_@ */
 {
   assert (ap_prc);
-  tiz_buffer_destroy (ap_prc->p_store_);
+  tiz_data_chan_destroy (ap_prc->p_store_);
   ap_prc->p_store_ = NULL;
 }
 
@@ -727,7 +728,8 @@ reevaluate_cache (spfysrc_prc_t * ap_prc)
 
   if (ap_prc->p_sp_session_ && !ap_prc->initial_cache_bytes_)
     {
-      const int current_cache_bytes = tiz_buffer_available (ap_prc->p_store_);
+      const int current_cache_bytes
+        = tiz_data_chan_available (ap_prc->p_store_);
       if (current_cache_bytes > ap_prc->max_cache_bytes_
           && !ap_prc->spotify_paused_)
         {
@@ -751,30 +753,33 @@ consume_cache (spfysrc_prc_t * ap_prc)
   /* Also, control here the delivery of the next eos flag */
   if (ap_prc->eos_ && ap_prc->bytes_till_eos_ <= 0)
     {
-      ap_prc->bytes_till_eos_ = tiz_buffer_available (ap_prc->p_store_);
+      ap_prc->bytes_till_eos_ = tiz_data_chan_available (ap_prc->p_store_);
     }
 
   TIZ_TRACE (handleOf (ap_prc),
-             "store [%d] initial_cache [%d] min_cache [%d] max_cache [%d]",
-             tiz_buffer_available (ap_prc->p_store_),
+             "store [%zu] initial_cache [%d] min_cache [%d] max_cache [%d]",
+             tiz_data_chan_available (ap_prc->p_store_),
              ap_prc->initial_cache_bytes_, ap_prc->min_cache_bytes_,
              ap_prc->max_cache_bytes_);
 
-  if (tiz_buffer_available (ap_prc->p_store_) > ap_prc->initial_cache_bytes_)
+  if (tiz_data_chan_available (ap_prc->p_store_)
+      > ap_prc->initial_cache_bytes_)
     {
+      const void * p_stored = NULL;
       int nbytes_stored = 0;
       OMX_BUFFERHEADERTYPE * p_out = NULL;
 
       /* Reset the initial size */
       ap_prc->initial_cache_bytes_ = 0;
 
-      while ((nbytes_stored = tiz_buffer_available (ap_prc->p_store_)) > 0
+      while ((nbytes_stored = tiz_data_chan_peek (ap_prc->p_store_, &p_stored))
+               > 0
              && (p_out = buffer_needed (ap_prc)) != NULL)
         {
-          int nbytes_copied = copy_to_omx_buffer (
-            p_out, tiz_buffer_get (ap_prc->p_store_), nbytes_stored);
+          int nbytes_copied = copy_to_omx_buffer (p_out, p_stored,
+                                                  nbytes_stored);
+          tiz_data_chan_advance (ap_prc->p_store_, nbytes_copied);
           tiz_check_omx (release_buffer (ap_prc));
-          (void) tiz_buffer_advance (ap_prc->p_store_, nbytes_copied);
           p_out = NULL;
         }
     }
@@ -972,81 +977,54 @@ metadata_updated (sp_session * sess)
 }
 
 static void
-music_delivery_handler (OMX_PTR ap_prc, tiz_event_pluggable_t * ap_event)
+music_delivery_handler (OMX_PTR ap_prc, tiz_data_chan_t * ap_chan)
 {
   spfysrc_prc_t * p_prc = ap_prc;
+  OMX_U32 channels = 0;
+  OMX_U32 samplerate = 0;
 
   assert (p_prc);
-  assert (ap_event);
+  assert (ap_chan);
 
-  TIZ_TRACE (handleOf (ap_prc), "p_data [%p] ", ap_event->p_data);
+  TIZ_TRACE (handleOf (ap_prc), "store [%zu] spotify_paused_ [%s]",
+             tiz_data_chan_available (ap_chan),
+             p_prc->spotify_paused_ ? "YES" : "NO");
 
   /* Decide if spotify music delivery needs pause/re-start */
-  reevaluate_cache (ap_prc);
+  reevaluate_cache (p_prc);
 
-  if (!p_prc->stopping_ && ap_event->p_data)
+  if (p_prc->stopping_)
     {
-      spfy_music_delivery_data_t * p_data = ap_event->p_data;
-      int nbytes
-        = p_data->num_frames * sizeof (int16_t) * p_data->format.channels;
-      OMX_U8 * p_in = (OMX_U8 *) p_data->p_frames;
-      OMX_BUFFERHEADERTYPE * p_out = NULL;
+      tiz_data_chan_clear (ap_chan);
+      return;
+    }
 
-      TIZ_TRACE (handleOf (ap_prc),
-                 "nbytes [%d] spotify_paused_ [%s] store [%d]", nbytes,
-                 p_prc->spotify_paused_ ? "YES" : "NO",
-                 tiz_buffer_available (p_prc->p_store_));
+  consume_cache (p_prc);
 
-      consume_cache (p_prc);
-      if (!p_prc->spotify_paused_)
-        {
-          while (nbytes > 0 && (p_out = buffer_needed (p_prc)) != NULL
-                 && !p_prc->initial_cache_bytes_)
-            {
-              int nbytes_copied = copy_to_omx_buffer (p_out, p_in, nbytes);
-              (void) release_buffer (p_prc);
-              nbytes -= nbytes_copied;
-              p_in += nbytes_copied;
-            }
-        }
-
-      if (nbytes > 0)
-        {
-          int nbytes_stored = 0;
-          if ((nbytes_stored = tiz_buffer_push (p_prc->p_store_, p_in, nbytes))
-              < nbytes)
-            {
-              TIZ_ERROR (handleOf (p_prc),
-                         "Unable to store all the data (wanted %d, "
-                         "stored %d).",
-                         nbytes, nbytes_stored);
-              assert (0);
-            }
-          nbytes -= nbytes_stored;
-        }
-      if (p_prc->auto_detect_on_
-          || p_prc->num_channels_ != p_data->format.channels
-          || p_prc->samplerate_ != p_data->format.sample_rate)
-        {
-          p_prc->auto_detect_on_ = false;
-          p_prc->num_channels_ = p_data->format.channels;
-          p_prc->samplerate_ = p_data->format.sample_rate;
-          p_prc->audio_coding_type_ = OMX_AUDIO_CodingPCM;
-          set_audio_coding_on_port (p_prc);
-          set_pcm_audio_info_on_port (p_prc);
-          /* And now trigger the OMX_EventPortFormatDetected and
-             OMX_EventPortSettingsChanged events or a
-             OMX_ErrorFormatNotDetected event */
-          send_port_auto_detect_events (p_prc);
-        }
-      tiz_mem_free (p_data->p_frames);
-      tiz_mem_free (ap_event->p_data);
+  /* These are published by music_delivery before the data they describe */
+  channels = __atomic_load_n (&(p_prc->delivery_channels_), __ATOMIC_RELAXED);
+  samplerate
+    = __atomic_load_n (&(p_prc->delivery_samplerate_), __ATOMIC_RELAXED);
+  if (p_prc->auto_detect_on_ || p_prc->num_channels_ != channels
+      || p_prc->samplerate_ != samplerate)
+    {
+      p_prc->auto_detect_on_ = false;
+      p_prc->num_channels_ = channels;
+      p_prc->samplerate_ = samplerate;
+      p_prc->audio_coding_type_ = OMX_AUDIO_CodingPCM;
+      set_audio_coding_on_port (p_prc);
+      set_pcm_audio_info_on_port (p_prc);
+      /* And now trigger the OMX_EventPortFormatDetected and
+         OMX_EventPortSettingsChanged events or a
+         OMX_ErrorFormatNotDetected event */
+      send_port_auto_detect_events (p_prc);
     }
-  tiz_mem_free (ap_event);
 }
 
 /**
  * This callback is used from libspotify whenever there is PCM data available.
+ * The frames are copied straight into the component's store; when it is
+ * full, no frames are consumed and libspotify will deliver them again later.
  *
  * @note This function is called from an internal session thread!
  */
@@ -1054,45 +1032,33 @@ static int
 music_delivery (sp_session * sess, const sp_audioformat * format,
                 const void * frames, int num_frames)
 {
-  int num_frames_delivered = 0;
-  if (num_frames > 0)
+  spfysrc_prc_t * p_prc = sp_session_userdata (sess);
+  size_t pcm_buffer_len = 0;
+
+  assert (p_prc);
+  assert (p_prc->p_store_);
+  assert (format);
+
+  if (num_frames <= 0)
     {
-      /* We'll only send another pluggable event into the component's main
-         event queue if there are a few spaces available. Otherwise, we'll ask
-         Spotify to wait a little. */
-      if (tiz_comp_event_queue_unused_spaces (
-            handleOf (sp_session_userdata (sess)))
-          >= SPFYSRC_MIN_QUEUE_UNUSED_SPACES)
-        {
-          spfy_music_delivery_data_t * p_data
-            = tiz_mem_calloc (1, sizeof (spfy_music_delivery_data_t));
-          if (p_data)
-            {
-              size_t pcm_buffer_len
-                = num_frames * sizeof (int16_t) * format->channels;
-              assert (sess);
-              assert (format);
-              assert (frames);
-              p_data->p_sess = sess;
-              p_data->format.sample_type = format->sample_type;
-              p_data->format.sample_rate = format->sample_rate;
-              p_data->format.channels = format->channels;
-              p_data->p_frames = tiz_mem_alloc (pcm_buffer_len);
-              memcpy (p_data->p_frames, frames, pcm_buffer_len);
-              p_data->num_frames = num_frames;
-              TIZ_PRINTF_DBG_YEL (
-                "music_delivery - num frames : %d pcm_buffer_len : %d - "
-                "spaces %d\n",
-                num_frames, pcm_buffer_len,
-                tiz_comp_event_queue_unused_spaces (
-                  handleOf (sp_session_userdata (sess))));
-              post_spotify_event (sp_session_userdata (sess),
-                                  music_delivery_handler, p_data);
-              num_frames_delivered = num_frames;
-            }
-        }
+      return 0;
     }
-  return num_frames_delivered;
+
+  assert (frames);
+  pcm_buffer_len = num_frames * sizeof (int16_t) * format->channels;
+  __atomic_store_n (&(p_prc->delivery_channels_), format->channels,
+                    __ATOMIC_RELAXED);
+  __atomic_store_n (&(p_prc->delivery_samplerate_), format->sample_rate,
+                    __ATOMIC_RELAXED);
+  if (tiz_data_chan_write (p_prc->p_store_, frames, pcm_buffer_len)
+      < pcm_buffer_len)
+    {
+      return 0;
+    }
+
+  TIZ_PRINTF_DBG_YEL ("music_delivery - num frames : %d pcm_buffer_len : %zu\n",
+                      num_frames, pcm_buffer_len);
+  return num_frames;
 }
 
 static void
@@ -1294,6 +1260,8 @@ spfysrc_prc_ctor (void * ap_obj, va_list * app)
   p_prc->min_cache_bytes_ = 0;
   p_prc->max_cache_bytes_ = 0;
   p_prc->p_store_ = NULL;
+  p_prc->delivery_channels_ = 0;
+  p_prc->delivery_samplerate_ = 0;
   p_prc->p_session_timer_ = NULL;
   p_prc->p_shuffle_lst_ = NULL;
   TIZ_INIT_OMX_STRUCT (p_prc->session_);
@@ -39,6 +39,7 @@ extern "C" {
 #include <OMX_Core.h>
 
 #include <tizprc_decls.h>
+#include <tizdatachan.h>
 #include <tizspotify_c.h>
 
 typedef struct spfysrc_prc spfysrc_prc_t;
@@ -58,7 +59,10 @@ struct spfysrc_prc
   int initial_cache_bytes_;
   int min_cache_bytes_;
   int max_cache_bytes_;
-  tiz_buffer_t * p_store_; /* The component's pcm buffer */
+  tiz_data_chan_t * p_store_; /* The component's pcm buffer, filled directly
+                                 from libspotify's thread */
+  OMX_U32 delivery_channels_;   /* Format of the pcm data last delivered by */
+  OMX_U32 delivery_samplerate_; /* libspotify (written on its thread) */
   tiz_event_timer_t * p_session_timer_;
   tiz_shuffle_lst_t * p_shuffle_lst_;
   OMX_TIZONIA_AUDIO_PARAM_SPOTIFYSESSIONTYPE session_;
@@ -174,18 +174,6 @@ store_data (vorbisd_prc_t * ap_prc, const OMX_U8 * ap_data, OMX_U32 a_nbytes)
   return a_nbytes - nbytes_to_copy;
 }
 
-static inline void
-write_frame_float_ilv (float * to, const float * from, const int channels)
-{
-  int i = 0;
-  assert (to);
-  assert (from);
-  for (i = 0; i < channels; ++i)
-    {
-      to[i] = from[i];
-    }
-}
-
 static OMX_ERRORTYPE
 update_pcm_mode (vorbisd_prc_t * ap_prc, const OMX_U32 a_samplerate,
                  const OMX_U32 a_channels)
@@ -288,6 +276,57 @@ store_stream_metadata (vorbisd_prc_t * ap_prc)
                               NULL);
 }
 
+static OMX_ERRORTYPE
+release_output_batch (vorbisd_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  if (ap_prc->nout_batch_ > 0)
+    {
+      TIZ_TRACE (handleOf (ap_prc), "Releasing [%d] output HEADERS",
+                 ap_prc->nout_batch_);
+      tiz_check_omx (tiz_krn_release_buffers (
+        tiz_get_krn (handleOf (ap_prc)),
+        ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX, ap_prc->p_out_batch_,
+        ap_prc->nout_batch_));
+      ap_prc->nout_batch_ = 0;
+    }
+  return OMX_ErrorNone;
+}
+
+/* Completed output headers are held back and released in batches, so that
+   a tunnelled peer is woken up once per batch rather than once per header. */
+static OMX_ERRORTYPE
+batch_output_header (vorbisd_prc_t * ap_prc)
+{
+  OMX_BUFFERHEADERTYPE ** pp_hdr = NULL;
+  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
+
+  assert (ap_prc);
+  assert (ap_prc->nout_batch_ < OUTPUT_BATCH_SIZE);
+
+  pp_hdr = tiz_filter_prc_get_header_ptr (
+    ap_prc, ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX);
+  assert (pp_hdr);
+  p_hdr = *pp_hdr;
+
+  if (p_hdr)
+    {
+      TIZ_TRACE (handleOf (ap_prc),
+                 "Batching HEADER [%p] nFilledLen [%d] nFlags [%d]", p_hdr,
+                 p_hdr->nFilledLen, p_hdr->nFlags);
+      p_hdr->nOffset = 0;
+      ap_prc->p_out_batch_[ap_prc->nout_batch_++] = p_hdr;
+      *pp_hdr = NULL;
+
+      if (OUTPUT_BATCH_SIZE == ap_prc->nout_batch_
+          || (p_hdr->nFlags & OMX_BUFFERFLAG_EOS) != 0)
+        {
+          return release_output_batch (ap_prc);
+        }
+    }
+  return OMX_ErrorNone;
+}
+
 static int
 fishsound_decoded_callback (FishSound * ap_fsound, float * app_pcm[],
                             long frames, void * ap_user_data)
@@ -344,22 +383,16 @@ fishsound_decoded_callback (FishSound * ap_fsound, float * app_pcm[],
 
   {
     /* write decoded PCM samples */
-    size_t i = 0;
     size_t frame_len = sizeof (float) * p_prc->fsinfo_.channels;
     size_t frames_alloc = ((p_out->nAllocLen - p_out->nOffset) / frame_len);
     size_t frames_to_write = (frames > frames_alloc) ? frames_alloc : frames;
     size_t bytes_to_write = frames_to_write * frame_len;
     assert (p_out);
 
-    for (i = 0; i < frames_to_write; ++i)
-      {
-        size_t frame_offset = i * frame_len;
-        size_t float_offset = i * p_prc->fsinfo_.channels;
-        float * out
-          = (float *) (p_out->pBuffer + p_out->nOffset + frame_offset);
-        write_frame_float_ilv (out, ((float *) app_pcm) + float_offset,
-                               p_prc->fsinfo_.channels);
-      }
+    /* libfishsound is in interleaved mode, so app_pcm is really a single
+       float array with the frames already laid out as the output wants
+       them */
+    memcpy (p_out->pBuffer + p_out->nOffset, app_pcm, bytes_to_write);
     p_out->nFilledLen += bytes_to_write;
     p_out->nOffset += bytes_to_write;
 
@@ -371,8 +404,7 @@ fishsound_decoded_callback (FishSound * ap_fsound, float * app_pcm[],
         TIZ_TRACE (handleOf (p_prc), "Need to store [%d] bytes",
                    nbytes_remaining);
         nbytes_remaining = store_data (
-          p_prc, (OMX_U8 *) (app_pcm[frames_to_write * sizeof (float)]),
-          nbytes_remaining);
+          p_prc, ((OMX_U8 *) app_pcm) + bytes_to_write, nbytes_remaining);
       }
 
     if (tiz_filter_prc_is_eos (p_prc))
@@ -383,8 +415,7 @@ fishsound_decoded_callback (FishSound * ap_fsound, float * app_pcm[],
         TIZ_TRACE (handleOf (p_prc), "Propagating EOS flag to output");
       }
     /* TODO: Shouldn't ignore this rc */
-    (void) tiz_filter_prc_release_header (
-      p_prc, ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX);
+    (void) batch_output_header (p_prc);
     /* Let's process one input buffer at a time, for now */
     rc = FISH_SOUND_STOP_OK;
   }
@@ -455,8 +486,7 @@ transform_buffer (vorbisd_prc_t * ap_prc)
           TIZ_TRACE (handleOf (ap_prc), "Let's propagate EOS flag to output");
           p_out->nFlags |= OMX_BUFFERFLAG_EOS;
           p_in->nFlags &= ~(1 << OMX_BUFFERFLAG_EOS);
-          tiz_check_omx (tiz_filter_prc_release_header (
-            ap_prc, ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX));
+          tiz_check_omx (batch_output_header (ap_prc));
         }
     }
   /*   raise(SIGTRAP); */
@@ -566,6 +596,10 @@ do_flush (vorbisd_prc_t * ap_prc, OMX_U32 a_pid)
       reset_stream_parameters (ap_prc);
     }
   /* Release any buffers held  */
+  if (OMX_ALL == a_pid || ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX == a_pid)
+    {
+      tiz_check_omx (release_output_batch (ap_prc));
+    }
   return tiz_filter_prc_release_header (ap_prc, a_pid);
 }
 
@@ -584,6 +618,7 @@ vorbisd_prc_ctor (void * ap_obj, va_list * app)
   p_prc->p_store_ = NULL;
   p_prc->store_size_ = 0;
   p_prc->store_offset_ = 0;
+  p_prc->nout_batch_ = 0;
   return p_prc;
 }
 
@@ -645,6 +680,7 @@ vorbisd_prc_transfer_and_process (void * ap_obj, OMX_U32 a_pid)
 static OMX_ERRORTYPE
 vorbisd_prc_stop_and_return (void * ap_obj)
 {
+  tiz_check_omx (release_output_batch (ap_obj));
   return tiz_filter_prc_release_all_headers (ap_obj);
 }
 
@@ -676,10 +712,13 @@ vorbisd_prc_buffers_ready (const void * ap_obj)
         {
           p_out->nFlags |= OMX_BUFFERFLAG_EOS;
           tiz_filter_prc_update_eos_flag (p_prc, false);
-          tiz_check_omx (tiz_filter_prc_release_header (
-            p_prc, ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX));
+          tiz_check_omx (batch_output_header (p_prc));
         }
     }
+
+  /* No more output headers can be produced for now; release whatever is still
+     pending in the output batch */
+  tiz_check_omx (release_output_batch (p_prc));
   return rc;
 }
 
@@ -700,6 +739,10 @@ vorbisd_prc_port_disable (const void * ap_prc, OMX_U32 a_pid)
       reset_stream_parameters (p_prc);
     }
   tiz_filter_prc_update_port_disabled_flag (p_prc, a_pid, true);
+  if (OMX_ALL == a_pid || ARATELIA_VORBIS_DECODER_OUTPUT_PORT_INDEX == a_pid)
+    {
+      tiz_check_omx (release_output_batch (p_prc));
+    }
   return tiz_filter_prc_release_header (p_prc, a_pid);
 }
 
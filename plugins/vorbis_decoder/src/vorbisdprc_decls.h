@@ -39,6 +39,8 @@ extern "C" {
 #include <tizfilterprc.h>
 #include <tizfilterprc_decls.h>
 
+#define OUTPUT_BATCH_SIZE 4 /* Max output headers released in one go. */
+
 typedef struct vorbisd_prc vorbisd_prc_t;
 struct vorbisd_prc
 {
@@ -51,6 +53,8 @@ struct vorbisd_prc
   OMX_U8 * p_store_;
   OMX_U32 store_size_;
   OMX_U32 store_offset_;
+  OMX_BUFFERHEADERTYPE * p_out_batch_[OUTPUT_BATCH_SIZE];
+  OMX_U32 nout_batch_;
 };
 
 typedef struct vorbisd_prc_class vorbisd_prc_class_t;
@@ -49,6 +49,9 @@ extern "C" {
 #define ARATELIA_VP8_DECODER_PORT_NONCONTIGUOUS OMX_FALSE
 #define ARATELIA_VP8_DECODER_PORT_ALIGNMENT 0
 #define ARATELIA_VP8_DECODER_PORT_SUPPLIERPREF OMX_BufferSupplyInput
+/* Upper limit for OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE::nThreads; VP8 frames
+   have at most 8 token partitions */
+#define ARATELIA_VP8_DECODER_MAX_THREADS 8
 
 #ifdef __cplusplus
 }
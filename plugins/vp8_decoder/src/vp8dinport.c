@@ -35,7 +35,19 @@
 
 static void * vp8d_inport_ctor (void * ap_obj, va_list * app)
 {
-   return super_ctor (typeOf (ap_obj, "vp8dinport"), ap_obj, app);
+   vp8d_inport_t * p_obj
+     = super_ctor (typeOf (ap_obj, "vp8dinport"), ap_obj, app);
+   assert (p_obj);
+
+   tiz_port_register_index (p_obj, OMX_TizoniaIndexParamVideoVp8Decoder);
+
+   p_obj->decoder_.nSize = sizeof (OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE);
+   p_obj->decoder_.nVersion.nVersion = OMX_VERSION;
+   p_obj->decoder_.nPortIndex = ARATELIA_VP8_DECODER_INPUT_PORT_INDEX;
+   p_obj->decoder_.nThreads = 0; /* i.e. one per online cpu */
+   p_obj->decoder_.bFrameParallel = OMX_FALSE;
+
+   return p_obj;
 }
 
 static void * vp8d_inport_dtor (void * ap_obj)
@@ -47,6 +59,26 @@ static void * vp8d_inport_dtor (void * ap_obj)
  * from tiz_api
  */
 
+static OMX_ERRORTYPE
+vp8d_inport_GetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
+                          OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
+{
+  const vp8d_inport_t * p_obj = ap_obj;
+
+  assert (p_obj);
+  assert (ap_struct);
+
+  if (OMX_TizoniaIndexParamVideoVp8Decoder == a_index) {
+    memcpy (ap_struct, &(p_obj->decoder_),
+            sizeof (OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE));
+    return OMX_ErrorNone;
+  }
+
+  /* Delegate to the base port */
+  return super_GetParameter (typeOf (ap_obj, "vp8dinport"), ap_obj, ap_hdl,
+                             a_index, ap_struct);
+}
+
 static OMX_ERRORTYPE
 vp8d_inport_SetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                           OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
@@ -57,6 +89,24 @@ vp8d_inport_SetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   assert (ap_hdl);
   assert (ap_struct);
 
+  if (OMX_TizoniaIndexParamVideoVp8Decoder == a_index) {
+    vp8d_inport_t * p_obj = (vp8d_inport_t *) ap_obj;
+    const OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE * p_decoder = ap_struct;
+
+    if (p_decoder->nThreads > ARATELIA_VP8_DECODER_MAX_THREADS) {
+      TIZ_ERROR (ap_hdl, "[OMX_ErrorBadParameter] : nThreads [%u] > [%u]",
+                 p_decoder->nThreads, ARATELIA_VP8_DECODER_MAX_THREADS);
+      return OMX_ErrorBadParameter;
+    }
+
+    p_obj->decoder_.nThreads = p_decoder->nThreads;
+    p_obj->decoder_.bFrameParallel = p_decoder->bFrameParallel;
+    TIZ_TRACE (ap_hdl, "nThreads [%u] bFrameParallel [%s]",
+               p_obj->decoder_.nThreads,
+               p_obj->decoder_.bFrameParallel == OMX_TRUE ? "TRUE" : "FALSE");
+    return OMX_ErrorNone;
+  }
+
   if (a_index == OMX_IndexParamPortDefinition) {
     vp8d_prc_t * p_prc = tiz_get_prc (ap_hdl);
     OMX_VIDEO_PORTDEFINITIONTYPE * p_def = &(p_prc->port_def_.format.video);
@@ -136,6 +186,8 @@ vp8d_inport_init (void * ap_tos, void * ap_hdl)
     /* TIZ_CLASS_COMMENT: class destructor */
     dtor, vp8d_inport_dtor,
     /* TIZ_CLASS_COMMENT: */
+    tiz_api_GetParameter, vp8d_inport_GetParameter,
+    /* TIZ_CLASS_COMMENT: */
     tiz_api_SetParameter, vp8d_inport_SetParameter,
     /* TIZ_CLASS_COMMENT: stop value*/
     0);
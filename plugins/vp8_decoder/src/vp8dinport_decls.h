@@ -20,6 +20,8 @@
 #ifndef VP8DINPORT_DECLS_H
 #define VP8DINPORT_DECLS_H
 
+#include <OMX_TizoniaExt.h>
+
 #include <tizvp8port_decls.h>
 
 typedef struct vp8d_inport vp8d_inport_t;
@@ -27,6 +29,7 @@ struct vp8d_inport
 {
    /* Object */
    const tiz_vp8port_t _;
+   OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE decoder_;
 };
 
 typedef struct vp8d_inport_class vp8d_inport_class_t;
@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   vp8dplane.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia - VP8 decoder image plane copy
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include "vp8dplane.h"
+
+static size_t
+copy_plane (uint8_t * ap_dst, const uint8_t * ap_src, const int a_stride,
+            const unsigned int a_width, const unsigned int a_height)
+{
+  const size_t plane_size = (size_t) a_width * a_height;
+
+  if (a_stride == (int) a_width)
+    {
+      /* No padding between rows: the whole plane is one block */
+      memcpy (ap_dst, ap_src, plane_size);
+    }
+  else
+    {
+      const uint8_t * p_src_end = ap_src + (ptrdiff_t) a_stride * a_height;
+      for (; ap_src != p_src_end; ap_src += a_stride, ap_dst += a_width)
+        {
+          memcpy (ap_dst, ap_src, a_width);
+        }
+    }
+
+  return plane_size;
+}
+
+size_t
+vp8d_plane_i420_size (const unsigned int a_width, const unsigned int a_height)
+{
+  const size_t cw = (1 + a_width) / 2;
+  const size_t ch = (1 + a_height) / 2;
+  return (size_t) a_width * a_height + 2 * cw * ch;
+}
+
+size_t
+vp8d_plane_copy_i420 (uint8_t * ap_dst, const size_t a_dst_len,
+                      const vpx_image_t * ap_img)
+{
+  const unsigned int cw = (1 + ap_img->d_w) / 2;
+  const unsigned int ch = (1 + ap_img->d_h) / 2;
+  const size_t total = vp8d_plane_i420_size (ap_img->d_w, ap_img->d_h);
+  uint8_t * p_dst = ap_dst;
+
+  assert (ap_dst);
+  assert (ap_img);
+
+  if (total > a_dst_len)
+    {
+      return 0;
+    }
+
+  p_dst += copy_plane (p_dst, ap_img->planes[VPX_PLANE_Y],
+                       ap_img->stride[VPX_PLANE_Y], ap_img->d_w, ap_img->d_h);
+  p_dst += copy_plane (p_dst, ap_img->planes[VPX_PLANE_U],
+                       ap_img->stride[VPX_PLANE_U], cw, ch);
+  p_dst += copy_plane (p_dst, ap_img->planes[VPX_PLANE_V],
+                       ap_img->stride[VPX_PLANE_V], cw, ch);
+
+  assert (p_dst - ap_dst == (ptrdiff_t) total);
+  return total;
+}
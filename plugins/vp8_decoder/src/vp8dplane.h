@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   vp8dplane.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia - VP8 decoder image plane copy
+ *
+ *
+ */
+
+#ifndef VP8DPLANE_H
+#define VP8DPLANE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vpx_image.h>
+
+/**
+ * Returns the number of bytes needed to hold an I420 picture of the given
+ * dimensions, without any padding.
+ */
+size_t
+vp8d_plane_i420_size (const unsigned int a_width, const unsigned int a_height);
+
+/**
+ * Copies the visible area of a decoded image into a contiguous buffer: the
+ * Y plane first, then the U and V planes, without any padding.
+ *
+ * Planes (or rows, when the decoder's stride is wider than the picture) are
+ * copied with a single memcpy each.
+ *
+ * @param ap_dst The destination buffer.
+ * @param a_dst_len The size of the destination buffer.
+ * @param ap_img The decoded image (I420).
+ * @return The number of bytes written, or 0 if the destination buffer is too
+ * small.
+ */
+size_t
+vp8d_plane_copy_i420 (uint8_t * ap_dst, const size_t a_dst_len,
+                      const vpx_image_t * ap_img);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VP8DPLANE_H */
@@ -36,14 +36,18 @@
 #include <assert.h>
 #include <limits.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <tizplatform.h>
 
 #include <tizkernel.h>
 
+#include <OMX_TizoniaExt.h>
+
 #include "vp8d.h"
 #include "vp8dprc.h"
 #include "vp8dprc_decls.h"
+#include "vp8dplane.h"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
 #undef TIZ_LOG_CATEGORY_NAME
@@ -692,21 +696,6 @@ read_frame (vp8d_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_inhdr)
   return rc;
 }
 
-static void
-out_put (OMX_BUFFERHEADERTYPE * p_hdr, const uint8_t * buf, unsigned int len)
-{
-  memcpy (p_hdr->pBuffer + p_hdr->nOffset, buf, len);
-  p_hdr->nOffset += len;
-  p_hdr->nFilledLen = p_hdr->nOffset;
-
-  if (p_hdr->nFilledLen > p_hdr->nAllocLen)
-    {
-      TIZ_LOG (TIZ_PRIORITY_TRACE, "len [%d] nFilledLen [%d] nAllocLen [%d]",
-               len, p_hdr->nFilledLen, p_hdr->nAllocLen);
-      assert (p_hdr->nFilledLen <= p_hdr->nAllocLen);
-    }
-}
-
 static OMX_ERRORTYPE
 decode_frame (vp8d_prc_t * ap_prc)
 {
@@ -726,8 +715,8 @@ decode_frame (vp8d_prc_t * ap_prc)
 
   if ((img = vpx_codec_get_frame (&(ap_prc->vp8ctx_), &iter)))
     {
-      unsigned int y;
-      uint8_t * buf = img->planes[VPX_PLANE_Y];
+      OMX_BUFFERHEADERTYPE * p_hdr = ap_prc->p_outhdr_;
+      size_t copied = 0;
 
 #if 0
       {
@@ -746,27 +735,23 @@ decode_frame (vp8d_prc_t * ap_prc)
         }
 #endif
 
-      for (y = 0; y < img->d_h; y++)
-        {
-          out_put (ap_prc->p_outhdr_, buf, img->d_w);
-          buf += img->stride[VPX_PLANE_Y];
-        }
-
-      buf = img->planes[VPX_PLANE_U];
+      assert (p_hdr);
+      assert (p_hdr->nAllocLen >= p_hdr->nOffset);
 
-      for (y = 0; y < (1 + img->d_h) / 2; y++)
+      copied = vp8d_plane_copy_i420 (p_hdr->pBuffer + p_hdr->nOffset,
+                                     p_hdr->nAllocLen - p_hdr->nOffset, img);
+      if (!copied)
         {
-          out_put (ap_prc->p_outhdr_, buf, (1 + img->d_w) / 2);
-          buf += img->stride[VPX_PLANE_U];
+          TIZ_ERROR (handleOf (ap_prc),
+                     "[OMX_ErrorInsufficientResources] : frame [%ux%u] does "
+                     "not fit in output buffer (nAllocLen [%u] nOffset [%u])",
+                     img->d_w, img->d_h, p_hdr->nAllocLen, p_hdr->nOffset);
+          rc = OMX_ErrorInsufficientResources;
+          goto end;
         }
 
-      buf = img->planes[VPX_PLANE_V];
-
-      for (y = 0; y < (1 + img->d_h) / 2; y++)
-        {
-          out_put (ap_prc->p_outhdr_, buf, (1 + img->d_w) / 2);
-          buf += img->stride[VPX_PLANE_V];
-        }
+      p_hdr->nOffset += copied;
+      p_hdr->nFilledLen = p_hdr->nOffset;
     }
 
 end:
@@ -909,22 +894,74 @@ vp8d_prc_dtor (void * ap_obj)
  * from tiz_srv class
  */
 
+static unsigned int
+decoder_threads (const OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE * ap_decoder)
+{
+  unsigned int threads = ap_decoder->nThreads;
+  if (0 == threads)
+    {
+      const long ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = ncpus > 0 ? (unsigned int) ncpus : 1;
+    }
+  return MIN (threads, ARATELIA_VP8_DECODER_MAX_THREADS);
+}
+
+static int
+decoder_flags (vp8d_prc_t * ap_prc,
+               const OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE * ap_decoder)
+{
+  int flags = 0;
+
+  /* TODO : vp8 decoder flags */
+  /*   flags = (postprc ? VPX_CODEC_USE_POSTPRC : 0) | */
+  /*     (ec_enabled ? VPX_CODEC_USE_ERROR_CONCEALMENT : 0); */
+
+  if (OMX_TRUE == ap_decoder->bFrameParallel)
+    {
+#if defined(VPX_CODEC_USE_FRAME_THREADING) \
+  && defined(VPX_CODEC_CAP_FRAME_THREADING)
+      if (vpx_codec_get_caps (ifaces[0].iface) & VPX_CODEC_CAP_FRAME_THREADING)
+        {
+          flags |= VPX_CODEC_USE_FRAME_THREADING;
+        }
+      else
+#endif
+        {
+          TIZ_NOTICE (handleOf (ap_prc),
+                      "Frame-parallel decoding not supported by [%s]",
+                      vpx_codec_iface_name (ifaces[0].iface));
+        }
+    }
+
+  return flags;
+}
+
 static OMX_ERRORTYPE
 vp8d_prc_allocate_resources (void * ap_obj, OMX_U32 a_pid)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   vp8d_prc_t * ap_prc = ap_obj;
+  OMX_TIZONIA_VIDEO_PARAM_VP8DECODERTYPE decoder;
+  vpx_codec_dec_cfg_t cfg;
   int flags = 0;
 
   assert (ap_prc);
 
-  /* TODO : vp8 decoder flags */
-  /*   flags = (postprc ? VPX_CODEC_USE_POSTPRC : 0) | */
-  /*     (ec_enabled ? VPX_CODEC_USE_ERROR_CONCEALMENT : 0); */
+  TIZ_INIT_OMX_PORT_STRUCT (decoder, ARATELIA_VP8_DECODER_INPUT_PORT_INDEX);
+  tiz_check_omx (tiz_api_GetParameter (
+    tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
+    OMX_TizoniaIndexParamVideoVp8Decoder, &decoder));
+
+  tiz_mem_set (&cfg, 0, sizeof (cfg));
+  cfg.threads = decoder_threads (&decoder);
+  flags = decoder_flags (ap_prc, &decoder);
+
+  TIZ_DEBUG (handleOf (ap_prc), "threads [%u] flags [0x%x]", cfg.threads,
+             flags);
 
   /* Initialize codec */
   bail_on_vpx_err_with_omx_err (
-    vpx_codec_dec_init (&(ap_prc->vp8ctx_), ifaces[0].iface, NULL, flags),
+    vpx_codec_dec_init (&(ap_prc->vp8ctx_), ifaces[0].iface, &cfg, flags),
     OMX_ErrorInsufficientResources);
 
 end:
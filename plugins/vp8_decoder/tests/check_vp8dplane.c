@@ -0,0 +1,411 @@
+/**
+ * Copyright (C) 2011-2018 Aratelia Limited - Juan A. Rubio
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_vp8dplane.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  VP8 decoder plane copy unit tests and decoding fps benchmark
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <check.h>
+
+#define VPX_CODEC_DISABLE_COMPAT 1
+#include <vpx_decoder.h>
+#include <vpx_encoder.h>
+#include <vp8cx.h>
+#include <vp8dx.h>
+
+#include <tizplatform.h>
+
+#include "vp8dplane.h"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.vp8_decoder.check"
+#endif
+
+#define VP8DPLANE_TEST_TIMEOUT 300
+#define VP8DPLANE_TEST_FRAMES 60
+#define VP8DPLANE_TEST_BITRATE_KBPS 6000
+
+/* One compressed frame */
+typedef struct check_frame check_frame_t;
+struct check_frame
+{
+  uint8_t * p_data;
+  size_t size;
+};
+
+static double
+plane_now_secs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void
+fill_image (vpx_image_t * ap_img, const int a_frame)
+{
+  unsigned int x = 0;
+  unsigned int y = 0;
+  unsigned int seed = (unsigned int) a_frame * 2654435761u;
+
+  /* A moving gradient with some noise, so that the encoder has to spend bits
+     on every macroblock */
+  for (y = 0; y < ap_img->d_h; ++y)
+    {
+      uint8_t * p_row = ap_img->planes[VPX_PLANE_Y]
+                        + (ptrdiff_t) y * ap_img->stride[VPX_PLANE_Y];
+      for (x = 0; x < ap_img->d_w; ++x)
+        {
+          seed = seed * 1103515245u + 12345u;
+          p_row[x] = (uint8_t) (x + y + 4 * a_frame + ((seed >> 16) & 0x1f));
+        }
+    }
+
+  for (y = 0; y < (1 + ap_img->d_h) / 2; ++y)
+    {
+      uint8_t * p_u = ap_img->planes[VPX_PLANE_U]
+                      + (ptrdiff_t) y * ap_img->stride[VPX_PLANE_U];
+      uint8_t * p_v = ap_img->planes[VPX_PLANE_V]
+                      + (ptrdiff_t) y * ap_img->stride[VPX_PLANE_V];
+      for (x = 0; x < (1 + ap_img->d_w) / 2; ++x)
+        {
+          p_u[x] = (uint8_t) (128 + x - y + a_frame);
+          p_v[x] = (uint8_t) (128 - x + y - a_frame);
+        }
+    }
+}
+
+static void
+store_packets (vpx_codec_ctx_t * ap_enc, check_frame_t * ap_frames,
+               int * ap_nframes)
+{
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t * p_pkt = NULL;
+
+  while ((p_pkt = vpx_codec_get_cx_data (ap_enc, &iter)))
+    {
+      if (VPX_CODEC_CX_FRAME_PKT == p_pkt->kind
+          && *ap_nframes < VP8DPLANE_TEST_FRAMES)
+        {
+          check_frame_t * p_frame = &ap_frames[(*ap_nframes)++];
+          p_frame->size = p_pkt->data.frame.sz;
+          p_frame->p_data = malloc (p_frame->size);
+          ck_assert (p_frame->p_data != NULL);
+          memcpy (p_frame->p_data, p_pkt->data.frame.buf, p_frame->size);
+        }
+    }
+}
+
+/* Produces a VP8 stream with eight token partitions per frame */
+static int
+encode_stream (const unsigned int a_width, const unsigned int a_height,
+               check_frame_t * ap_frames)
+{
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_image_t img;
+  int nframes = 0;
+  int i = 0;
+
+  ck_assert (VPX_CODEC_OK
+             == vpx_codec_enc_config_default (vpx_codec_vp8_cx (), &cfg, 0));
+  cfg.g_w = a_width;
+  cfg.g_h = a_height;
+  cfg.g_timebase.num = 1;
+  cfg.g_timebase.den = 30;
+  cfg.rc_target_bitrate = VP8DPLANE_TEST_BITRATE_KBPS;
+  cfg.g_lag_in_frames = 0;
+
+  ck_assert (VPX_CODEC_OK
+             == vpx_codec_enc_init (&enc, vpx_codec_vp8_cx (), &cfg, 0));
+  ck_assert (VPX_CODEC_OK == vpx_codec_control (&enc, VP8E_SET_CPUUSED, 16));
+  ck_assert (VPX_CODEC_OK
+             == vpx_codec_control (&enc, VP8E_SET_TOKEN_PARTITIONS,
+                                   VP8_EIGHT_TOKENPARTITION));
+  ck_assert (vpx_img_alloc (&img, VPX_IMG_FMT_I420, a_width, a_height, 16)
+             != NULL);
+
+  for (i = 0; i < VP8DPLANE_TEST_FRAMES; ++i)
+    {
+      fill_image (&img, i);
+      ck_assert (VPX_CODEC_OK
+                 == vpx_codec_encode (&enc, &img, i, 1, 0, VPX_DL_REALTIME));
+      store_packets (&enc, ap_frames, &nframes);
+    }
+
+  /* Flush the encoder */
+  ck_assert (VPX_CODEC_OK
+             == vpx_codec_encode (&enc, NULL, -1, 1, 0, VPX_DL_REALTIME));
+  store_packets (&enc, ap_frames, &nframes);
+
+  vpx_img_free (&img);
+  vpx_codec_destroy (&enc);
+  return nframes;
+}
+
+/* Decodes the whole stream the way vp8dprc does, including the copy of the
+   decoded planes into an output buffer, and returns the frames per second
+   achieved */
+static double
+decode_stream (const check_frame_t * ap_frames, const int a_nframes,
+               const unsigned int a_threads, uint8_t * ap_out,
+               const size_t a_out_len)
+{
+  vpx_codec_ctx_t dec;
+  vpx_codec_dec_cfg_t cfg;
+  double start = 0;
+  int decoded = 0;
+  int i = 0;
+
+  memset (&cfg, 0, sizeof (cfg));
+  cfg.threads = a_threads;
+  ck_assert (VPX_CODEC_OK
+             == vpx_codec_dec_init (&dec, &vpx_codec_vp8_dx_algo, &cfg, 0));
+
+  start = plane_now_secs ();
+  for (i = 0; i < a_nframes; ++i)
+    {
+      vpx_codec_iter_t iter = NULL;
+      vpx_image_t * p_img = NULL;
+
+      ck_assert (VPX_CODEC_OK
+                 == vpx_codec_decode (&dec, ap_frames[i].p_data,
+                                      (unsigned int) ap_frames[i].size, NULL,
+                                      0));
+      while ((p_img = vpx_codec_get_frame (&dec, &iter)))
+        {
+          ck_assert (vp8d_plane_copy_i420 (ap_out, a_out_len, p_img) > 0);
+          ++decoded;
+        }
+    }
+
+  ck_assert_int_eq (decoded, a_nframes);
+  vpx_codec_destroy (&dec);
+  return decoded / (plane_now_secs () - start);
+}
+
+static void
+benchmark_resolution (const unsigned int a_width, const unsigned int a_height)
+{
+  check_frame_t frames[VP8DPLANE_TEST_FRAMES];
+  const size_t out_len = vp8d_plane_i420_size (a_width, a_height);
+  uint8_t * p_out = malloc (out_len);
+  const long ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+  const unsigned int threads
+    = ncpus < 2 ? 2 : (ncpus > 8 ? 8 : (unsigned int) ncpus);
+  double fps_single = 0;
+  double fps_multi = 0;
+  int nframes = 0;
+  int i = 0;
+
+  ck_assert (p_out != NULL);
+  memset (frames, 0, sizeof (frames));
+
+  nframes = encode_stream (a_width, a_height, frames);
+  ck_assert_int_eq (nframes, VP8DPLANE_TEST_FRAMES);
+
+  fps_single = decode_stream (frames, nframes, 1, p_out, out_len);
+  fps_multi = decode_stream (frames, nframes, threads, p_out, out_len);
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "vp8 decode %ux%u (8 token partitions) : 1 thread [%.1f] fps - "
+           "%u threads [%.1f] fps",
+           a_width, a_height, fps_single, threads, fps_multi);
+
+  for (i = 0; i < nframes; ++i)
+    {
+      free (frames[i].p_data);
+    }
+  free (p_out);
+}
+
+/* Builds an image that points into a caller-provided buffer, where every
+   byte of the visible area is derived from its plane and coordinates */
+static void
+make_image (vpx_image_t * ap_img, uint8_t * ap_buf, const unsigned int a_width,
+            const unsigned int a_height, const int a_stride_pad)
+{
+  const unsigned int cw = (1 + a_width) / 2;
+  const unsigned int ch = (1 + a_height) / 2;
+  const int ystride = (int) a_width + a_stride_pad;
+  const int cstride = (int) cw + (a_stride_pad ? a_stride_pad / 2 : 0);
+  unsigned int plane = 0;
+  unsigned int x = 0;
+  unsigned int y = 0;
+
+  memset (ap_img, 0, sizeof (*ap_img));
+  ap_img->fmt = VPX_IMG_FMT_I420;
+  ap_img->d_w = a_width;
+  ap_img->d_h = a_height;
+  ap_img->stride[VPX_PLANE_Y] = ystride;
+  ap_img->stride[VPX_PLANE_U] = cstride;
+  ap_img->stride[VPX_PLANE_V] = cstride;
+  ap_img->planes[VPX_PLANE_Y] = ap_buf;
+  ap_img->planes[VPX_PLANE_U] = ap_buf + (ptrdiff_t) ystride * a_height;
+  ap_img->planes[VPX_PLANE_V]
+    = ap_img->planes[VPX_PLANE_U] + (ptrdiff_t) cstride * ch;
+
+  for (plane = VPX_PLANE_Y; plane <= VPX_PLANE_V; ++plane)
+    {
+      const unsigned int w = plane == VPX_PLANE_Y ? a_width : cw;
+      const unsigned int h = plane == VPX_PLANE_Y ? a_height : ch;
+      for (y = 0; y < h; ++y)
+        {
+          uint8_t * p_row
+            = ap_img->planes[plane] + (ptrdiff_t) y * ap_img->stride[plane];
+          for (x = 0; x < w; ++x)
+            {
+              p_row[x] = (uint8_t) (plane * 85 + y * 7 + x);
+            }
+          /* Poison the padding */
+          memset (p_row + w, 0xee, ap_img->stride[plane] - w);
+        }
+    }
+}
+
+static void
+verify_copy (const vpx_image_t * ap_img, const uint8_t * ap_out)
+{
+  const unsigned int cw = (1 + ap_img->d_w) / 2;
+  const unsigned int ch = (1 + ap_img->d_h) / 2;
+  unsigned int plane = 0;
+  unsigned int x = 0;
+  unsigned int y = 0;
+
+  for (plane = VPX_PLANE_Y; plane <= VPX_PLANE_V; ++plane)
+    {
+      const unsigned int w = plane == VPX_PLANE_Y ? ap_img->d_w : cw;
+      const unsigned int h = plane == VPX_PLANE_Y ? ap_img->d_h : ch;
+      for (y = 0; y < h; ++y)
+        {
+          for (x = 0; x < w; ++x)
+            {
+              ck_assert_int_eq (*ap_out++, (uint8_t) (plane * 85 + y * 7 + x));
+            }
+        }
+    }
+}
+
+START_TEST (test_vp8dplane_copy)
+{
+  /* Even and odd dimensions, with and without stride padding */
+  static const unsigned int dims[][2]
+    = {{176, 144}, {177, 145}, {1280, 720}, {31, 1}};
+  static const int pads[] = {0, 32, 64};
+  size_t d = 0;
+  size_t p = 0;
+
+  for (d = 0; d < sizeof (dims) / sizeof (dims[0]); ++d)
+    {
+      for (p = 0; p < sizeof (pads) / sizeof (pads[0]); ++p)
+        {
+          const unsigned int w = dims[d][0];
+          const unsigned int h = dims[d][1];
+          const size_t out_len = vp8d_plane_i420_size (w, h);
+          uint8_t * p_src = malloc ((w + pads[p]) * (h + 1) * 2);
+          uint8_t * p_out = malloc (out_len + 1);
+          vpx_image_t img;
+
+          ck_assert (p_src != NULL && p_out != NULL);
+          make_image (&img, p_src, w, h, pads[p]);
+
+          p_out[out_len] = 0x5a;
+          ck_assert (vp8d_plane_copy_i420 (p_out, out_len, &img) == out_len);
+          verify_copy (&img, p_out);
+          /* Nothing written past the picture */
+          ck_assert_int_eq (p_out[out_len], 0x5a);
+
+          /* A buffer one byte short is rejected */
+          ck_assert (vp8d_plane_copy_i420 (p_out, out_len - 1, &img) == 0);
+
+          free (p_src);
+          free (p_out);
+        }
+    }
+}
+END_TEST
+
+START_TEST (test_vp8dplane_decode_fps_720p)
+{
+  benchmark_resolution (1280, 720);
+}
+END_TEST
+
+START_TEST (test_vp8dplane_decode_fps_1080p)
+{
+  benchmark_resolution (1920, 1080);
+}
+END_TEST
+
+Suite *
+vp8dplane_suite (void)
+{
+  TCase * tc_plane;
+  TCase * tc_bench;
+  Suite * s = suite_create ("vp8_decoder");
+
+  /* test case */
+  tc_plane = tcase_create ("Decoded plane copy");
+  tcase_add_test (tc_plane, test_vp8dplane_copy);
+  suite_add_tcase (s, tc_plane);
+
+  tc_bench = tcase_create ("Decoding frames per second");
+  tcase_set_timeout (tc_bench, VP8DPLANE_TEST_TIMEOUT);
+  tcase_add_test (tc_bench, test_vp8dplane_decode_fps_720p);
+  tcase_add_test (tc_bench, test_vp8dplane_decode_fps_1080p);
+  suite_add_tcase (s, tc_bench);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed = 0;
+  SRunner * sr = srunner_create (vp8dplane_suite ());
+  tiz_log_init ();
+  srunner_set_log (sr, "-");
+  srunner_run_all (sr, CK_VERBOSE);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+  tiz_log_deinit ();
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
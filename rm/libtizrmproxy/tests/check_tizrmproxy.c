@@ -35,6 +35,8 @@
 #include <dirent.h>
 #include <assert.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
 #include <limits.h>
 
 #include "tizplatform.h"
@@ -67,6 +69,8 @@ char *pg_rmd_path      = NULL;
 #define COMPONENT2_PRIORITY 2
 #define COMPONENT2_GROUP_ID 200
 
+#define THROUGHPUT_TEST_PAIRS 1000
+
 #define INFINITE_WAIT 0xffffffff
 /* duration of event timeout in msec when we expect event to be set */
 #define TIMEOUT_EXPECTING_SUCCESS 500
@@ -187,6 +191,19 @@ dump_rmdb (const char * p_dest_path)
   return rv;
 }
 
+static void
+stop_rm_daemon (pid_t a_pid)
+{
+  int status = 0;
+
+  fail_if (-1 == kill (a_pid, SIGTERM));
+
+  /* The daemon has written its state to the db once it has exited */
+  fail_if (a_pid != waitpid (a_pid, &status, 0));
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "RM daemon [PID %d] exited - status [%d]",
+           a_pid, status);
+}
+
 static OMX_ERRORTYPE
 _ctx_init (cc_ctx_t * app_ctx)
 {
@@ -544,8 +561,7 @@ START_TEST (test_proxy_acquire_and_release)
 
       if (!daemon_existed)
         {
-          error = kill (pid, SIGTERM);
-          fail_if (error == -1);
+          stop_rm_daemon (pid);
         }
 
       /* Check db */
@@ -636,8 +652,7 @@ START_TEST (test_proxy_acquire_and_destroy_no_release)
 
       if (!daemon_existed)
         {
-          error = kill (pid, SIGTERM);
-          fail_if (error == -1);
+          stop_rm_daemon (pid);
         }
 
       /* Check db */
@@ -740,8 +755,7 @@ START_TEST (test_proxy_wait_cancel_wait)
 
           if (!daemon_existed)
             {
-              error = kill (pid, SIGTERM);
-              fail_if (error == -1);
+              stop_rm_daemon (pid);
             }
 
           /* Check db */
@@ -904,8 +918,7 @@ START_TEST (test_proxy_busy_resource_management)
 
           if (!daemon_existed)
             {
-              error = kill (pid, SIGTERM);
-              fail_if (error == -1);
+              stop_rm_daemon (pid);
             }
 
           /* Check db */
@@ -1086,8 +1099,7 @@ START_TEST (test_proxy_resource_preemption)
 
           if (!daemon_existed)
             {
-              error = kill (pid, SIGTERM);
-              fail_if (error == -1);
+              stop_rm_daemon (pid);
             }
 
           /* Check db */
@@ -1117,6 +1129,110 @@ START_TEST (test_proxy_resource_preemption)
 }
 END_TEST
 
+START_TEST (test_proxy_acquire_release_throughput)
+{
+  tiz_rm_error_t error = TIZ_RM_SUCCESS;
+  int rc, daemon_existed = 1;
+  tiz_rm_t p_rm;
+  pid_t pid;
+  OMX_UUIDTYPE uuid_omx;
+  OMX_PRIORITYMGMTTYPE primgmt;
+  tiz_rm_proxy_callbacks_t cbacks;
+  struct timeval start, end;
+  double elapsed = 0;
+  int i = 0;
+
+  /* Init RM database */
+  fail_if (!refresh_rm_db ());
+  rc = system ("./updatedb.sh db_acquire_and_release.sql3");
+
+  /* Dump its initial contents */
+  fail_if (!dump_rmdb ("test_proxy_acquire_release_throughput.before.dump"));
+
+  /* Check if an RM daemon is running already */
+  if ((pid = check_tizrmproxy_find_proc ("tizrmd"))
+      || (pid = check_tizrmproxy_find_proc ("lt-tizrmd")))
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "RM Process [PID %d] FOUND", pid);
+    }
+
+  if (-1 == pid)
+    {
+      /* Start the rm daemon */
+      pid = fork ();
+      fail_if (pid == -1);
+      daemon_existed = 0;
+    }
+
+  if (pid)
+    {
+
+      sleep (1);
+
+      /* Generate a uuid */
+      tiz_uuid_generate (&uuid_omx);
+
+      primgmt.nSize = sizeof (OMX_PRIORITYMGMTTYPE);
+      primgmt.nVersion.nVersion = OMX_VERSION;
+      primgmt.nGroupPriority = COMPONENT1_PRIORITY;
+      primgmt.nGroupID = COMPONENT1_GROUP_ID;
+
+      cbacks.pf_waitend = &check_tizrmproxy_comp1_wait_complete;
+      cbacks.pf_preempt = &check_tizrmproxy_comp1_preemption_req;
+      cbacks.pf_preempt_end = &check_tizrmproxy_comp1_preemption_complete;
+
+      error =
+        tiz_rm_proxy_init (&p_rm, COMPONENT1_NAME,
+                          (const OMX_UUIDTYPE *) &uuid_omx, &primgmt, &cbacks,
+                          NULL);
+      fail_if (error != TIZ_RM_SUCCESS);
+
+      gettimeofday (&start, NULL);
+      for (i = 0; i < THROUGHPUT_TEST_PAIRS; ++i)
+        {
+          error = tiz_rm_proxy_acquire (&p_rm, TIZ_RM_RESOURCE_DUMMY, 1);
+          fail_if (error != TIZ_RM_SUCCESS);
+
+          error = tiz_rm_proxy_release (&p_rm, TIZ_RM_RESOURCE_DUMMY, 1);
+          fail_if (error != TIZ_RM_SUCCESS);
+        }
+      gettimeofday (&end, NULL);
+      elapsed = (end.tv_sec - start.tv_sec)
+        + (end.tv_usec - start.tv_usec) / 1e6;
+
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "[%.0f] acquire/release pairs/s",
+               THROUGHPUT_TEST_PAIRS / elapsed);
+
+      error = tiz_rm_proxy_destroy (&p_rm);
+      fail_if (error != TIZ_RM_SUCCESS);
+
+      if (!daemon_existed)
+        {
+          stop_rm_daemon (pid);
+        }
+
+      /* Check db */
+      fail_if (!dump_rmdb ("test_proxy_acquire_release_throughput.after.dump"));
+
+      rc =
+        system
+        ("cmp -s /tmp/test_proxy_acquire_release_throughput.before.dump /tmp/test_proxy_acquire_release_throughput.after.dump");
+
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "DB comparison check [%s]",
+                 (rc == 0 ? "SUCCESS" : "FAILED"));
+      fail_if (rc != 0);
+
+    }
+  else
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "Starting the RM Daemon");
+      const char *arg0 = "";
+      error = execlp (pg_rmd_path, arg0, (char *) NULL);
+      fail_if (error == -1);
+    }
+}
+END_TEST
+
 Suite *
 rmproxy_suite (void)
 {
@@ -1134,6 +1250,7 @@ rmproxy_suite (void)
   tcase_add_test (tc_proxy, test_proxy_wait_cancel_wait);
   tcase_add_test (tc_proxy, test_proxy_busy_resource_management);
   tcase_add_test (tc_proxy, test_proxy_resource_preemption);
+  tcase_add_test (tc_proxy, test_proxy_acquire_release_throughput);
   suite_add_tcase (s, tc_proxy);
 
   return s;
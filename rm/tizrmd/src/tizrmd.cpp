@@ -53,12 +53,22 @@ static const char *TIZ_RM_DAEMON_NAME = "com.aratelia.tiz.tizrmd";
 // Object path, a.k.a. node
 static const char *TIZ_RM_DAEMON_PATH = "/com/aratelia/tiz/tizrmd";
 
-tizrmd::tizrmd (Tiz::DBus::Connection &a_connection, char const *ap_dbname)
+// Maximum time (in ms) a change to the allocation ledger waits before it is
+// written to the database
+static const int TIZ_RM_DAEMON_SYNC_INTERVAL = 100;
+
+tizrmd::tizrmd (Tiz::DBus::Connection &a_connection,
+                Tiz::DBus::BusDispatcher &a_dispatcher, char const *ap_dbname)
   : Tiz::DBus::ObjectAdaptor (a_connection, TIZ_RM_DAEMON_PATH),
     rmdb_ (ap_dbname),
-    waiters_ ()
+    waiters_ (),
+    sync_timeout_ (TIZ_RM_DAEMON_SYNC_INTERVAL, true, &a_dispatcher)
 {
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Constructing tizrmd...");
+  sync_timeout_.enabled (false);
+  sync_timeout_.expired = new Tiz::DBus::Callback< tizrmd, void,
+                                                   Tiz::DBus::DefaultTimeout & >(
+      this, &tizrmd::sync_timeout_expired);
   rmdb_.connect ();
 }
 
@@ -67,6 +77,21 @@ tizrmd::~tizrmd ()
   rmdb_.disconnect ();
 }
 
+void tizrmd::schedule_sync ()
+{
+  sync_timeout_.enabled (true);
+}
+
+void tizrmd::sync_timeout_expired (Tiz::DBus::DefaultTimeout &timeout)
+{
+  // If the database can't be written to right now, the changes are kept and
+  // retried on the next expiration
+  if (TIZ_RM_SUCCESS == rmdb_.sync ())
+  {
+    timeout.enabled (false);
+  }
+}
+
 int32_t tizrmd::acquire (const uint32_t &rid, const uint32_t &quantity,
                          const std::string &cname,
                          const std::vector< uint8_t > &uuid,
@@ -78,6 +103,9 @@ int32_t tizrmd::acquire (const uint32_t &rid, const uint32_t &quantity,
            "quantity [%d] - grpid [%d] - pri [%d]...",
            cname.c_str (), rid, quantity, grpid, pri);
 
+  // The request may modify the allocation ledger
+  schedule_sync ();
+
   // Reserve the resources now
   if (TIZ_RM_SUCCESS
       != (rc = rmdb_.acquire_resource (rid, quantity, cname, uuid, grpid, pri)))
@@ -181,6 +209,9 @@ int32_t tizrmd::release (const uint32_t &rid, const uint32_t &quantity,
            "quantity [%d]",
            cname.c_str (), rid, quantity);
 
+  // The request may modify the allocation ledger
+  schedule_sync ();
+
   // Release the resources now...
   if (TIZ_RM_SUCCESS != (ret_val = rmdb_.release_resource (rid, quantity, cname,
                                                           uuid, grpid, pri)))
@@ -234,6 +265,9 @@ int32_t tizrmd::wait (const uint32_t &rid, const uint32_t &quantity,
 {
   tiz_rm_error_t ret_val = TIZ_RM_SUCCESS;
 
+  // The request may modify the allocation ledger
+  schedule_sync ();
+
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "'%s': waiting for rid [%d] - "
            "quantity [%d]",
@@ -340,6 +374,9 @@ int32_t tizrmd::preemption_conf (const uint32_t &rid, const uint32_t &quantity,
   preemptlist_t::iterator it
       = preemptions_.find (tizrmowner (cname, uuid, grpid, pri, rid, quantity));
 
+  // The request may modify the allocation ledger
+  schedule_sync ();
+
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmd::preemption_conf : "
            "'%s': resource id [%d] "
@@ -413,6 +450,9 @@ int32_t tizrmd::relinquish_all (const std::string &cname,
 {
   tiz_rm_error_t ret_val = TIZ_RM_SUCCESS;
 
+  // The request may modify the allocation ledger
+  schedule_sync ();
+
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmd::relinquish_all: '%s' : "
            "Releasing all resources and resource requests",
@@ -478,7 +518,7 @@ int main ()
     Tiz::DBus::Connection conn = Tiz::DBus::Connection::SessionBus ();
     conn.request_name (TIZ_RM_DAEMON_NAME);
 
-    tizrmd server (conn, rmdb_path.c_str ());
+    tizrmd server (conn, dispatcher, rmdb_path.c_str ());
 
     dispatcher.enter ();
   }
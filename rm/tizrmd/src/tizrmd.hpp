@@ -59,7 +59,8 @@ class tizrmd : public com::aratelia::tiz::tizrmif_adaptor,
 {
 
 public:
-  tizrmd (Tiz::DBus::Connection &connection, char const *ap_dbname);
+  tizrmd (Tiz::DBus::Connection &connection,
+          Tiz::DBus::BusDispatcher &dispatcher, char const *ap_dbname);
   ~tizrmd ();
 
   /**
@@ -162,10 +163,17 @@ private:
   typedef std::deque< tizrmwaiter > waitlist_t;
   typedef std::map< tizrmowner, tizrmpreemptor > preemptlist_t;
 
+private:
+  void schedule_sync ();
+  void sync_timeout_expired (Tiz::DBus::DefaultTimeout &timeout);
+
 private:
   tizrmdb rmdb_;
   waitlist_t waiters_;
   preemptlist_t preemptions_;
+  // Database writes are deferred and coalesced; this timer flushes them
+  // once the daemon is done with the current requests
+  Tiz::DBus::DefaultTimeout sync_timeout_;
 };
 
 #endif  // TIZRMD_HPP
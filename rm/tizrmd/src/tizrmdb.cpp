@@ -34,8 +34,6 @@
 #include <sqlite3.h>
 
 #include <vector>
-#include <sstream>
-#include <iostream>
 
 #include <boost/assert.hpp>
 
@@ -52,18 +50,34 @@ static const char *TIZ_RM_DB_DROP_ALLOC_TABLE
     = "drop table if exists allocation";
 static const char *TIZ_RM_DB_CREATE_ALLOC_TABLE =
   "create table allocation(cname varchar(255), uuid varchar(16), grpid "
-  "smallint, pri smallint, resid smallint, allocation mediumint)";
-
-// static const char *TIZ_RM_DB_RESNAMES_FROM_RESOURCES
-//     = "select resname from resources";
-// static const char *TIZ_RM_DB_RESIDS_FROM_RESOURCES
-//     = "select resid from resources";
-
-static const char *TIZ_RM_DB_CNAMES_FROM_COMPONENTS
-    = "select cname from components";
-
-tizrmdb::tizrmdb (char const *ap_dbname) : pdb_ (0), dbname_ (ap_dbname)
+  "smallint, pri smallint, resid smallint, allocation mediumint, "
+  "primary key(uuid, resid))";
+
+// The hot queries, indexed by tizrmdb::stmt_id_t
+static const char *TIZ_RM_DB_STMTS[] = {
+  "begin transaction",
+  "commit transaction",
+  "rollback transaction",
+  "select 1 from components where cname=?1 limit 1",
+  "select requirement from components where cname=?1 and resid=?2",
+  "select current from resources where resid=?1",
+  "update resources set current=?1 where resid=?2",
+  "insert or replace into allocation (cname, uuid, grpid, pri, resid, "
+  "allocation) values(?1, ?2, ?3, ?4, ?5, ?6)",
+  "delete from allocation where uuid=?1 and resid=?2"
+};
+
+tizrmdb::tizrmdb (char const *ap_dbname)
+  : pdb_ (0),
+    dbname_ (ap_dbname),
+    allocs_ (),
+    dirty_allocs_ (),
+    dirty_resources_ ()
 {
+  for (int i = 0; i < STMT_MAX; ++i)
+  {
+    stmts_[i] = 0;
+  }
 }
 
 tizrmdb::~tizrmdb ()
@@ -88,6 +102,10 @@ tiz_rm_error_t tizrmdb::connect ()
     else
     {
       rc = reset_alloc_table ();
+      if (rc == SQLITE_OK)
+      {
+        rc = prepare_stmts ();
+      }
       if (rc != SQLITE_OK)
       {
         TIZ_LOG (TIZ_PRIORITY_TRACE, "Could not init db [%s]",
@@ -131,11 +149,17 @@ int tizrmdb::close ()
   int rc = SQLITE_OK;
   if (pdb_)
   {
+    (void)sync ();
+    finalize_stmts ();
     rc = sqlite3_close (pdb_);
     pdb_ = 0;
     dbname_.clear ();
   }
 
+  allocs_.clear ();
+  dirty_allocs_.clear ();
+  dirty_resources_.clear ();
+
   return rc;
 }
 
@@ -166,28 +190,147 @@ int tizrmdb::reset_alloc_table ()
     TIZ_LOG (TIZ_PRIORITY_TRACE, "Created allocation table succesfully");
   }
 
+  // The allocation table is rebuilt from scratch, and so is the ledger
+  allocs_.clear ();
+  dirty_allocs_.clear ();
+
   return rc;
 }
 
+int tizrmdb::prepare_stmts ()
+{
+  int rc = SQLITE_OK;
+
+  BOOST_ASSERT (pdb_);
+
+  for (int i = 0; i < STMT_MAX && SQLITE_OK == rc; ++i)
+  {
+    rc = sqlite3_prepare_v2 (pdb_, TIZ_RM_DB_STMTS[i], -1, &stmts_[i], NULL);
+    if (SQLITE_OK != rc)
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "Could not prepare [%s] - [%s]",
+               TIZ_RM_DB_STMTS[i], sqlite3_errmsg (pdb_));
+    }
+  }
+
+  if (SQLITE_OK != rc)
+  {
+    finalize_stmts ();
+  }
+
+  return rc;
+}
+
+void tizrmdb::finalize_stmts ()
+{
+  for (int i = 0; i < STMT_MAX; ++i)
+  {
+    if (stmts_[i])
+    {
+      (void)sqlite3_finalize (stmts_[i]);
+      stmts_[i] = 0;
+    }
+  }
+}
+
+sqlite3_stmt *tizrmdb::stmt (const stmt_id_t id) const
+{
+  sqlite3_stmt *p_stmt = stmts_[id];
+  if (p_stmt)
+  {
+    (void)sqlite3_reset (p_stmt);
+    (void)sqlite3_clear_bindings (p_stmt);
+  }
+  return p_stmt;
+}
+
+int tizrmdb::step_stmt (const stmt_id_t id) const
+{
+  int rc = sqlite3_step (stmts_[id]);
+  (void)sqlite3_reset (stmts_[id]);
+  return (SQLITE_DONE == rc || SQLITE_ROW == rc) ? SQLITE_OK : rc;
+}
+
+bool tizrmdb::comp_requirement (const std::string &cname,
+                                const unsigned int &rid,
+                                int &requirement) const
+{
+  bool ret_val = false;
+  sqlite3_stmt *p_stmt = stmt (STMT_COMP_REQUIREMENT);
+
+  if (p_stmt)
+  {
+    sqlite3_bind_text (p_stmt, 1, cname.c_str (), -1, SQLITE_STATIC);
+    sqlite3_bind_int (p_stmt, 2, rid);
+    if (SQLITE_ROW == sqlite3_step (p_stmt))
+    {
+      requirement = sqlite3_column_int (p_stmt, 0);
+      ret_val = true;
+    }
+    (void)sqlite3_reset (p_stmt);
+  }
+
+  return ret_val;
+}
+
+bool tizrmdb::resource_current (const unsigned int &rid, int &current) const
+{
+  bool ret_val = false;
+  sqlite3_stmt *p_stmt = NULL;
+  resource_map_t::const_iterator it = dirty_resources_.find (rid);
+
+  // Availability changes that have not been synced yet take precedence
+  if (it != dirty_resources_.end ())
+  {
+    current = it->second;
+    return true;
+  }
+
+  p_stmt = stmt (STMT_RES_CURRENT);
+  if (p_stmt)
+  {
+    sqlite3_bind_int (p_stmt, 1, rid);
+    if (SQLITE_ROW == sqlite3_step (p_stmt))
+    {
+      current = sqlite3_column_int (p_stmt, 0);
+      ret_val = true;
+    }
+    (void)sqlite3_reset (p_stmt);
+  }
+
+  return ret_val;
+}
+
+void tizrmdb::set_resource_current (const unsigned int &rid,
+                                    const int current)
+{
+  dirty_resources_[rid] = current;
+}
+
+void tizrmdb::set_alloc (const alloc_key_t &key, const alloc_t &alloc)
+{
+  allocs_[key] = alloc;
+  dirty_allocs_.insert (key);
+}
+
+void tizrmdb::erase_alloc (const alloc_key_t &key)
+{
+  allocs_.erase (key);
+  dirty_allocs_.insert (key);
+}
+
 bool tizrmdb::resource_available (const unsigned int &rid,
                                   const unsigned int &quantity) const
 {
   bool ret_val = false;
-  int rc = SQLITE_OK;
-  char query[255];
+  int current = 0;
 
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmdb::resource_available : Checking resource "
            " availability for resid [%d] - quantity [%d]",
            rid, quantity);
 
-  snprintf (query, sizeof(query),
-            "select * from resources where resid='%d' and current>='%d'", rid,
-            quantity);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK == rc && !vdata_.empty ())
+  if (resource_current (rid, current) && current >= (int)quantity)
   {
     TIZ_LOG (TIZ_PRIORITY_TRACE,
              "tizrmdb::resource_available : "
@@ -202,20 +345,11 @@ bool tizrmdb::resource_available (const unsigned int &rid,
 bool tizrmdb::resource_provisioned (const unsigned int &rid) const
 {
   bool ret_val = false;
-  int rc = SQLITE_OK;
-  char query[255];
+  int current = 0;
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "tizrmdb::resource_provisioned");
 
-  snprintf (query, sizeof(query), "select * from resources where resid='%d'",
-            rid);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK == rc && !vdata_.empty ())
-  {
-    ret_val = true;
-  }
+  ret_val = resource_current (rid, current);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Resource id [%d] is [%s]", rid,
            (ret_val == true ? "PROVISIONED" : "NOT PROVISIONED"));
@@ -228,8 +362,6 @@ bool tizrmdb::resource_acquired (const std::vector< unsigned char > &uuid,
                                  const unsigned int &quantity) const
 {
   bool ret_val = false;
-  int rc = SQLITE_OK;
-  char query[255];
   char uuid_str[129];
 
   tiz_uuid_str (&uuid[0], uuid_str);
@@ -239,14 +371,9 @@ bool tizrmdb::resource_acquired (const std::vector< unsigned char > &uuid,
            "rid [%d] - quantity [%d]",
            uuid_str, rid, quantity);
 
-  snprintf (query, sizeof(query),
-            "select * from allocation where uuid='%s' and resid='%d' "
-            "and allocation>='%d'",
-            uuid_str, rid, quantity);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK == rc && !vdata_.empty ())
+  alloc_map_t::const_iterator it
+      = allocs_.find (alloc_key_t (rid, std::string (uuid_str)));
+  if (it != allocs_.end () && it->second.quantity >= quantity)
   {
     ret_val = true;
   }
@@ -264,23 +391,16 @@ bool tizrmdb::resource_acquired (const std::vector< unsigned char > &uuid,
 bool tizrmdb::comp_provisioned (const std::string &cname) const
 {
   bool ret_val = false;
-  int rc = SQLITE_OK;
+  sqlite3_stmt *p_stmt = stmt (STMT_COMP_EXISTS);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "tizrmdb::comp_provisioned : Checking [%s]",
            cname.c_str ());
 
-  rc = run_query (TIZ_RM_DB_CNAMES_FROM_COMPONENTS);
-
-  if (SQLITE_OK == rc)
+  if (p_stmt)
   {
-    for (std::vector< std::string >::iterator it = vdata_.begin ();
-         it < vdata_.end (); ++it)
-    {
-      if (cname.compare (*it) == 0)
-      {
-        ret_val = true;
-      }
-    }
+    sqlite3_bind_text (p_stmt, 1, cname.c_str (), -1, SQLITE_STATIC);
+    ret_val = (SQLITE_ROW == sqlite3_step (p_stmt));
+    (void)sqlite3_reset (p_stmt);
   }
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "'%s' is [%s]", cname.c_str (),
@@ -293,8 +413,7 @@ bool tizrmdb::comp_provisioned_with_resid (const std::string &cname,
                                            const unsigned int &rid) const
 {
   bool ret_val = false;
-  int rc = SQLITE_OK;
-  char query[255];
+  int requirement = 0;
 
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmdb::comp_provisioned_with_resid : "
@@ -302,16 +421,7 @@ bool tizrmdb::comp_provisioned_with_resid (const std::string &cname,
            "resource id [%d]",
            cname.c_str (), rid);
 
-  snprintf (query, sizeof(query),
-            "select * from components where cname='%s' and resid=%d",
-            cname.c_str (), rid);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK == rc && !vdata_.empty ())
-  {
-    ret_val = true;
-  }
+  ret_val = comp_requirement (cname, rid, requirement);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "'%s' : is [%s] with resource id [%d]",
            cname.c_str (),
@@ -325,8 +435,6 @@ tiz_rm_error_t tizrmdb::acquire_resource (
     const std::string &cname, const std::vector< unsigned char > &uuid,
     const unsigned int &grpid, const unsigned int &pri)
 {
-  int rc = SQLITE_OK;
-  char query[500];
   char uuid_str[129];
   int current = 0;
   int requirement = 0;
@@ -341,7 +449,7 @@ tiz_rm_error_t tizrmdb::acquire_resource (
 
   // Check that the component is provisioned and is allowed access to the
   // resource
-  if (!comp_provisioned_with_resid (cname, rid))
+  if (!comp_requirement (cname, rid, requirement))
   {
     TIZ_LOG (TIZ_PRIORITY_TRACE,
              "tizrmdb::acquire_resource : "
@@ -350,7 +458,6 @@ tiz_rm_error_t tizrmdb::acquire_resource (
     return TIZ_RM_COMPONENT_NOT_PROVISIONED;
   }
 
-  requirement = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
   // TODO: Replace this with proper error check
   assert (requirement >= 0);
 
@@ -371,7 +478,7 @@ tiz_rm_error_t tizrmdb::acquire_resource (
   }
 
   // Check that the requested resource is provisioned and there is availability
-  if (!resource_available (rid, quantity))
+  if (!resource_current (rid, current) || current < (int)quantity)
   {
     TIZ_LOG (TIZ_PRIORITY_TRACE,
              "tizrmdb::acquire_resource : "
@@ -380,45 +487,21 @@ tiz_rm_error_t tizrmdb::acquire_resource (
     return TIZ_RM_NOT_ENOUGH_RESOURCE_AVAILABLE;
   }
 
-  current = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
-
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmdb::acquire_resource: "
            "Resource [%d]: available [%d] units ...",
            rid, current);
 
-  snprintf (query, sizeof(query),
-            "insert or replace into allocation (cname, uuid, grpid, "
-            "pri, resid, allocation) "
-            "values('%s', '%s', %d, %d, %d, %d)",
-            cname.c_str (), uuid_str, grpid, pri, rid, quantity);
+  // The allocation is recorded in the ledger; the database is brought up to
+  // date on the next sync
+  set_resource_current (rid, current - quantity);
 
-  rc = run_query (query);
-
-  if (SQLITE_OK != rc)
-  {
-    TIZ_LOG (TIZ_PRIORITY_TRACE,
-             "tizrmdb::acquire_resource : "
-             "'%s' : Could not update allocation table",
-             cname.c_str ());
-    return TIZ_RM_DATABASE_ERROR;
-  }
-
-  snprintf (query, sizeof(query),
-            "update resources set current=%d where resid=%d",
-            current - quantity, rid);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK != rc)
-  {
-    TIZ_LOG (TIZ_PRIORITY_TRACE,
-             "tizrmdb::acquire_resource : "
-             "Could not update resource table "
-             "for resource [%s]",
-             rid);
-    return TIZ_RM_DATABASE_ERROR;
-  }
+  alloc_t alloc;
+  alloc.cname = cname;
+  alloc.grpid = grpid;
+  alloc.pri = pri;
+  alloc.quantity = quantity;
+  set_alloc (alloc_key_t (rid, std::string (uuid_str)), alloc);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmdb::acquire_resource: "
@@ -433,8 +516,6 @@ tiz_rm_error_t tizrmdb::release_resource (
     const std::string &cname, const std::vector< unsigned char > &uuid,
     const unsigned int &grpid, const unsigned int &pri)
 {
-  int rc = SQLITE_OK;
-  char query[500];
   char uuid_str[129];
   int current = 0;
   int requirement = 0;
@@ -446,13 +527,12 @@ tiz_rm_error_t tizrmdb::release_resource (
 
   // Check that the component is provisioned and is allowed to access the
   // resource
-  if (!comp_provisioned_with_resid (cname, rid))
+  if (!comp_requirement (cname, rid, requirement))
   {
     TIZ_LOG (TIZ_PRIORITY_TRACE, "'%s' is not provisioned...", cname.c_str ());
     return TIZ_RM_COMPONENT_NOT_PROVISIONED;
   }
 
-  requirement = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
   // TODO: Replace this with proper error check
   assert (requirement >= 0);
 
@@ -470,8 +550,12 @@ tiz_rm_error_t tizrmdb::release_resource (
     return TIZ_RM_NOT_ENOUGH_RESOURCE_PROVISIONED;
   }
 
+  tiz_uuid_str (&uuid[0], uuid_str);
+  const alloc_key_t key (rid, std::string (uuid_str));
+  alloc_map_t::iterator it = allocs_.find (key);
+
   // Check that the resource was effectively acquired by the component
-  if (!resource_acquired (uuid, rid, quantity))
+  if (it == allocs_.end () || it->second.quantity < quantity)
   {
     TIZ_LOG (TIZ_PRIORITY_TRACE,
              "Resource [%d] cannot be released: "
@@ -480,76 +564,35 @@ tiz_rm_error_t tizrmdb::release_resource (
     return TIZ_RM_NOT_ENOUGH_RESOURCE_ACQUIRED;
   }
 
-  current = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
-
   TIZ_LOG (TIZ_PRIORITY_TRACE,
-           "Resource [%d]: current allocation [%d] units ...", rid, current);
+           "Resource [%d]: current allocation [%d] units ...", rid,
+           it->second.quantity);
 
-  tiz_uuid_str (&uuid[0], uuid_str);
-
-  // Update allocation table to reflect the resource release...
-
-  // ... first delete the the row...
-  snprintf (query, sizeof(query),
-            "delete from allocation where "
-            "cname='%s' and uuid='%s' and resid=%d",
-            cname.c_str (), uuid_str, rid);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK != rc)
+  // Update the ledger to reflect the resource release, keeping the entry only
+  // if there's some resource allocation remaining
+  if (it->second.quantity - quantity)
   {
-    TIZ_LOG (TIZ_PRIORITY_TRACE,
-             "'%s' : Could not update allocation "
-             "table ",
-             cname.c_str ());
-    return TIZ_RM_DATABASE_ACCESS_ERROR;
+    alloc_t alloc;
+    alloc.cname = cname;
+    alloc.grpid = grpid;
+    alloc.pri = pri;
+    alloc.quantity = it->second.quantity - quantity;
+    set_alloc (key, alloc);
   }
-
-  //... now create a new one, only if there's some resource allocation
-  // remaining
-  if (current - quantity)
+  else
   {
-    // TODO : This string is duplicated. Move to a constant
-    snprintf (query, sizeof(query),
-              "insert or replace into allocation (cname, uuid, grpid, pri, "
-              "resid, allocation) values('%s', '%s', %d, %d, %d, %d)",
-              cname.c_str (), uuid_str, grpid, pri, rid, current - quantity);
-
-    rc = run_query (query);
-
-    if (SQLITE_OK != rc)
-    {
-      TIZ_LOG (TIZ_PRIORITY_TRACE, "'%s' : Could not update allocation table",
-               cname.c_str ());
-      return TIZ_RM_DATABASE_ACCESS_ERROR;
-    }
+    erase_alloc (key);
   }
 
   // Now, obtain the current resource availability
-  if (!resource_available (rid, 0))
+  if (!resource_current (rid, current))
   {
     TIZ_LOG (TIZ_PRIORITY_TRACE, "Resource [%d] not available...", rid);
     return TIZ_RM_NOT_ENOUGH_RESOURCE_AVAILABLE;
   }
 
-  current = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
-
-  // Now update the resource table...
-  snprintf (query, sizeof(query),
-            "update resources set current=%d where resid=%d",
-            current + quantity, rid);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK != rc)
-  {
-    TIZ_LOG (TIZ_PRIORITY_TRACE,
-             "Could not update resource table "
-             "for resource [%s]",
-             rid);
-    return TIZ_RM_DATABASE_ACCESS_ERROR;
-  }
+  // Now update the resource availability...
+  set_resource_current (rid, current + quantity);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "'%s' : Succesfully released [%d] units of "
@@ -562,8 +605,6 @@ tiz_rm_error_t tizrmdb::release_resource (
 tiz_rm_error_t tizrmdb::release_all (const std::string &cname,
                                     const std::vector< unsigned char > &uuid)
 {
-  int rc = SQLITE_OK;
-  char query[500];
   char uuid_str[129];
   int current = 0;
   int remaining = 0;
@@ -577,59 +618,33 @@ tiz_rm_error_t tizrmdb::release_all (const std::string &cname,
 
   for (int rid = 0; rid < TIZ_RM_RESOURCE_MAX; ++rid)
   {
-    if (resource_acquired (uuid, rid, 0))
+    const alloc_key_t key (rid, std::string (uuid_str));
+    alloc_map_t::iterator it = allocs_.find (key);
+    if (it != allocs_.end ())
     {
-      const std::string cname = vdata_[0];
-      current = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
+      const std::string owner_cname = it->second.cname;
+      current = it->second.quantity;
 
       TIZ_LOG (TIZ_PRIORITY_TRACE,
                "'%s' uuid [%s] : Resource [%d] "
                "current allocation is "
                "[%d] units ...",
-               cname.c_str (), uuid_str, rid, current);
+               owner_cname.c_str (), uuid_str, rid, current);
 
-      // Update allocation table to reflect the resource release...
-      snprintf (query, sizeof(query),
-                "delete from allocation where "
-                "cname='%s' and uuid='%s' and resid=%d",
-                cname.c_str (), uuid_str, rid);
-
-      rc = run_query (query);
-
-      if (SQLITE_OK != rc)
-      {
-        TIZ_LOG (TIZ_PRIORITY_TRACE,
-                 "'%s' : Could not update allocation "
-                 "table ",
-                 cname.c_str ());
-        return TIZ_RM_DATABASE_ACCESS_ERROR;
-      }
+      // Update the ledger to reflect the resource release...
+      erase_alloc (key);
 
       // Now, obtain the current resource availability
-      resource_available (rid, 0);
-
-      remaining = strtol (vdata_[vdata_.size () - 1].c_str (), NULL, 0);
-
-      // Now update the resource table...
-      snprintf (query, sizeof(query),
-                "update resources set current=%d where resid=%d",
-                remaining + current, rid);
+      remaining = 0;
+      (void)resource_current (rid, remaining);
 
-      rc = run_query (query);
-
-      if (SQLITE_OK != rc)
-      {
-        TIZ_LOG (TIZ_PRIORITY_TRACE,
-                 "Could not update resource table "
-                 "for resource [%s]",
-                 rid);
-        return TIZ_RM_DATABASE_ACCESS_ERROR;
-      }
+      // Now update the resource availability...
+      set_resource_current (rid, remaining + current);
 
       TIZ_LOG (TIZ_PRIORITY_TRACE,
                "'%s':  Released [%d] units of "
                "resource  id [%d]",
-               cname.c_str (), current, rid);
+               owner_cname.c_str (), current, rid);
     }
   }
 
@@ -640,9 +655,6 @@ tiz_rm_error_t tizrmdb::find_owners (const unsigned int &rid,
                                     const unsigned int &pri,
                                     tiz_rm_owners_list_t &owners) const
 {
-  int rc = SQLITE_OK;
-  char query[500];
-
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "tizrmdb::find_owners : resource id [%d] "
            "pri > [%d]",
@@ -650,41 +662,32 @@ tiz_rm_error_t tizrmdb::find_owners (const unsigned int &rid,
 
   owners.clear ();
 
-  snprintf (query, sizeof(query),
-            "select * from allocation where resid='%d' and pri>'%d'", rid, pri);
-
-  rc = run_query (query);
-
-  if (SQLITE_OK != rc)
+  // The ledger is ordered by resource id first, so the owners of this
+  // resource are contiguous
+  for (alloc_map_t::const_iterator it
+       = allocs_.lower_bound (alloc_key_t (rid, std::string ()));
+       it != allocs_.end () && it->first.first == rid; ++it)
   {
-    return TIZ_RM_DATABASE_ERROR;
-  }
+    const alloc_t &alloc = it->second;
+    if (alloc.pri <= pri)
+    {
+      continue;
+    }
 
-  int headingsize = vcol_head_.size ();
-  int datasize = vdata_.size ();
-  int num_cols = headingsize ? datasize / headingsize : 0;
-  for (int i = 0; i < num_cols; ++i)
-  {
-    int idx = i * headingsize;
     std::vector< unsigned char > uuid_vec;
     OMX_UUIDTYPE uuid_array;
-    tiz_str_uuid (vdata_[idx + 1].data (), &uuid_array);
+    tiz_str_uuid (it->first.second.c_str (), &uuid_array);
 
     uuid_vec.assign (&uuid_array[0], &uuid_array[0] + 128);
 
-    int owner_grpid = strtol (vdata_[idx + 2].c_str (), NULL, 0);
-    int owner_pri = strtol (vdata_[idx + 3].c_str (), NULL, 0);
-    int owner_rid = strtol (vdata_[idx + 4].c_str (), NULL, 0);
-    int owner_quantity = strtol (vdata_[idx + 5].c_str (), NULL, 0);
-
     TIZ_LOG (TIZ_PRIORITY_TRACE,
              "tizrmdb::find_owners : owner [%s] "
              "uuid [%s] grpid [%d] pri [%d] rid [%d] quantity [%d]",
-             vdata_[idx].c_str (), vdata_[idx + 1].c_str (), owner_grpid,
-             owner_pri, owner_rid, owner_quantity);
+             alloc.cname.c_str (), it->first.second.c_str (), alloc.grpid,
+             alloc.pri, rid, alloc.quantity);
 
-    owners.push_back (tizrmowner (vdata_[idx], uuid_vec, owner_grpid, owner_pri,
-                                  owner_rid, owner_quantity));
+    owners.push_back (tizrmowner (alloc.cname, uuid_vec, alloc.grpid,
+                                  alloc.pri, rid, alloc.quantity));
   }
 
   // Sort the owners list in ascending priority order, using tizrmowner's
@@ -700,82 +703,83 @@ tiz_rm_error_t tizrmdb::find_owners (const unsigned int &rid,
   return TIZ_RM_SUCCESS;
 }
 
-int tizrmdb::run_query (char const *ap_sql)
+bool tizrmdb::sync_pending () const
 {
-  int rc = SQLITE_OK;
-  char *p_errmsg;
-  char **pp_result;
-  int nrow, ncol;
+  return !dirty_allocs_.empty () || !dirty_resources_.empty ();
+}
 
-  BOOST_ASSERT (ap_sql);
+tiz_rm_error_t tizrmdb::sync ()
+{
+  int rc = SQLITE_OK;
 
-  TIZ_LOG (TIZ_PRIORITY_TRACE, "Running query [%s]", ap_sql);
+  if (!sync_pending () || !stmts_[STMT_BEGIN])
+  {
+    return TIZ_RM_SUCCESS;
+  }
 
-  vcol_head_.clear ();
-  vdata_.clear ();
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "tizrmdb::sync : [%d] allocation changes - "
+           "[%d] resource changes",
+           dirty_allocs_.size (), dirty_resources_.size ());
 
-  rc = sqlite3_get_table (pdb_, ap_sql, &pp_result, &nrow, &ncol, &p_errmsg);
+  rc = step_stmt (STMT_BEGIN);
 
-  TIZ_LOG (TIZ_PRIORITY_TRACE, "Running query [%s] rc [%d] nrow [%d] ncol [%d]",
-           ap_sql, rc, nrow, ncol);
+  for (resource_map_t::const_iterator it = dirty_resources_.begin ();
+       SQLITE_OK == rc && it != dirty_resources_.end (); ++it)
+  {
+    sqlite3_stmt *p_stmt = stmt (STMT_RES_UPDATE_CURRENT);
+    sqlite3_bind_int (p_stmt, 1, it->second);
+    sqlite3_bind_int (p_stmt, 2, it->first);
+    rc = step_stmt (STMT_RES_UPDATE_CURRENT);
+  }
 
-  if (SQLITE_OK == rc)
+  for (alloc_key_set_t::const_iterator it = dirty_allocs_.begin ();
+       SQLITE_OK == rc && it != dirty_allocs_.end (); ++it)
   {
-    for (int i = 0; i < ncol; ++i)
-    {
-      vcol_head_.push_back (pp_result[i]);
+    const unsigned int rid = it->first;
+    const std::string &uuid_str = it->second;
+    alloc_map_t::const_iterator alloc_it = allocs_.find (*it);
+    sqlite3_stmt *p_stmt = NULL;
+
+    if (alloc_it != allocs_.end ())
+    {
+      const alloc_t &alloc = alloc_it->second;
+      p_stmt = stmt (STMT_ALLOC_UPSERT);
+      sqlite3_bind_text (p_stmt, 1, alloc.cname.c_str (), -1, SQLITE_STATIC);
+      sqlite3_bind_text (p_stmt, 2, uuid_str.c_str (), -1, SQLITE_STATIC);
+      sqlite3_bind_int (p_stmt, 3, alloc.grpid);
+      sqlite3_bind_int (p_stmt, 4, alloc.pri);
+      sqlite3_bind_int (p_stmt, 5, rid);
+      sqlite3_bind_int (p_stmt, 6, alloc.quantity);
+      rc = step_stmt (STMT_ALLOC_UPSERT);
     }
-
-    for (int i = 0; i < ncol * nrow; ++i)
+    else
     {
-      vdata_.push_back (pp_result[ncol + i]);
+      p_stmt = stmt (STMT_ALLOC_DELETE);
+      sqlite3_bind_text (p_stmt, 1, uuid_str.c_str (), -1, SQLITE_STATIC);
+      sqlite3_bind_int (p_stmt, 2, rid);
+      rc = step_stmt (STMT_ALLOC_DELETE);
     }
   }
-  else
+
+  if (SQLITE_OK == rc)
   {
-    TIZ_LOG (TIZ_PRIORITY_TRACE, "Query execution failure: [%s] - [%s]",
-             sqlite_error_str (rc).c_str (), p_errmsg);
+    rc = step_stmt (STMT_COMMIT);
   }
 
-  TIZ_LOG (TIZ_PRIORITY_TRACE, "Run query [%s] rc [%d]", ap_sql, rc);
-
-  sqlite3_free_table (pp_result);
-
-  print_query_result ();
-
-  return rc;
-}
-
-int tizrmdb::run_query (char const *ap_sql) const
-{
-  return const_cast< tizrmdb * >(this)->run_query (ap_sql);
-}
-
-void tizrmdb::print_query_result () const
-{
-  TIZ_LOG (TIZ_PRIORITY_TRACE,
-           "tizrmdb::print_query_result : vdata_.size() [%d]"
-           " vcol_head_.size() [%d]",
-           vdata_.size (), vcol_head_.size ());
-
-  if (!vcol_head_.empty ())
+  if (SQLITE_OK != rc)
   {
-    int headingsize = vcol_head_.size ();
-    std::stringstream headings;
-    for (int i = 0; i < headingsize; ++i)
-    {
-      headings << "[" << vcol_head_[i] << "] \t\t\t ";
-    }
-    TIZ_LOG (TIZ_PRIORITY_TRACE, "%s", headings.str ().c_str ());
-
-    int datasize = vdata_.size ();
-    std::stringstream data;
-    for (int i = 0; i < datasize; ++i)
-    {
-      data << "[" << vdata_[i] << "] \t\t ";
-    }
-    TIZ_LOG (TIZ_PRIORITY_TRACE, "%s", data.str ().c_str ());
+    // Keep the changes around; they will be retried on the next sync
+    TIZ_LOG (TIZ_PRIORITY_TRACE, "Could not sync the database [%s]",
+             sqlite_error_str (rc).c_str ());
+    (void)step_stmt (STMT_ROLLBACK);
+    return TIZ_RM_DATABASE_ACCESS_ERROR;
   }
+
+  dirty_allocs_.clear ();
+  dirty_resources_.clear ();
+
+  return TIZ_RM_SUCCESS;
 }
 
 std::string tizrmdb::sqlite_error_str (int error) const
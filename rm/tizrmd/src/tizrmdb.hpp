@@ -29,8 +29,13 @@
 #define TIZRMDB_HPP
 
 class sqlite3;
+struct sqlite3_stmt;
 
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/utility.hpp>
 
@@ -82,22 +87,74 @@ public:
   bool comp_provisioned_with_resid (const std::string &cname,
                                     const unsigned int &rid) const;
 
+  /**
+   * Write the allocation and resource availability changes accumulated since
+   * the last call to the database, in a single transaction.
+   */
+  tiz_rm_error_t sync ();
+
+  bool sync_pending () const;
+
+private:
+  // The statements used on the acquire/release paths; they are prepared
+  // once, when the database is connected
+  enum stmt_id_t
+  {
+    STMT_BEGIN = 0,
+    STMT_COMMIT,
+    STMT_ROLLBACK,
+    STMT_COMP_EXISTS,
+    STMT_COMP_REQUIREMENT,
+    STMT_RES_CURRENT,
+    STMT_RES_UPDATE_CURRENT,
+    STMT_ALLOC_UPSERT,
+    STMT_ALLOC_DELETE,
+    STMT_MAX
+  };
+
+  // An entry in the allocation ledger
+  struct alloc_t
+  {
+    std::string cname;
+    unsigned int grpid;
+    unsigned int pri;
+    unsigned int quantity;
+  };
+
+  // Allocations are keyed by resource id and owner uuid (in string form)
+  typedef std::pair< unsigned int, std::string > alloc_key_t;
+  typedef std::map< alloc_key_t, alloc_t > alloc_map_t;
+  typedef std::set< alloc_key_t > alloc_key_set_t;
+  // Resource id -> units currently available, pending to be written
+  typedef std::map< unsigned int, int > resource_map_t;
+
 private:
   int open (char const *ap_dbname);
   int close ();
   int reset_alloc_table ();
 
-  int run_query (char const *ap_sql);
-  int run_query (char const *ap_sql) const;
+  int prepare_stmts ();
+  void finalize_stmts ();
+  sqlite3_stmt *stmt (const stmt_id_t id) const;
+  int step_stmt (const stmt_id_t id) const;
+
+  bool comp_requirement (const std::string &cname, const unsigned int &rid,
+                         int &requirement) const;
+  bool resource_current (const unsigned int &rid, int &current) const;
+  void set_resource_current (const unsigned int &rid, const int current);
+
+  void set_alloc (const alloc_key_t &key, const alloc_t &alloc);
+  void erase_alloc (const alloc_key_t &key);
 
-  void print_query_result () const;
   std::string sqlite_error_str (int error) const;
 
 private:
   sqlite3 *pdb_;
   std::string dbname_;
-  mutable std::vector< std::string > vcol_head_;
-  mutable std::vector< std::string > vdata_;
+  sqlite3_stmt *stmts_[STMT_MAX];
+  alloc_map_t allocs_;
+  alloc_key_set_t dirty_allocs_;
+  resource_map_t dirty_resources_;
 };
 
 #endif  // TIZRMDB_HPP